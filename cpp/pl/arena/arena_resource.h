@@ -0,0 +1,65 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include "cpp/pl/arena/arena.h"
+
+#include <cassert>
+#include <cstdint>
+#include <memory_resource>
+
+namespace pl {
+
+/**
+ * @class ArenaMemoryResource
+ * @brief 基于Arena的std::pmr::memory_resource，deallocate是空操作，
+ * 所有内存在Arena析构的时候统一释放。与Arena一样，不是线程安全的。
+ */
+class ArenaMemoryResource final : public std::pmr::memory_resource {
+public:
+    explicit ArenaMemoryResource(Arena* arena) : arena_(arena) { assert(arena_ != nullptr); }
+
+    ~ArenaMemoryResource() override = default;
+
+    ArenaMemoryResource(const ArenaMemoryResource&) = delete;
+    ArenaMemoryResource& operator=(const ArenaMemoryResource&) = delete;
+
+    [[nodiscard]] Arena* arena() const { return arena_; }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        if (alignment <= Arena::POINTER_SIZE) {
+            return arena_->allocate_aligned(bytes);
+        }
+        // Arena只保证按指针大小对齐，更大的对齐要求通过多申请一些内存来满足
+        char* ptr = arena_->allocate_aligned(bytes + alignment);
+        auto addr = reinterpret_cast<uintptr_t>(ptr);
+        addr = (addr + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+        return reinterpret_cast<void*>(addr);
+    }
+
+    void do_deallocate(void* /*p*/, std::size_t /*bytes*/, std::size_t /*alignment*/) override {}
+
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    Arena* arena_;
+};
+
+} // namespace pl
@@ -15,8 +15,13 @@
 // Authors: liubang (it.liubang@gmail.com)
 
 #include "cpp/pl/arena/arena.h"
+#include "cpp/pl/arena/arena_resource.h"
 
+#include <cstdint>
 #include <gtest/gtest.h>
+#include <memory_resource>
+#include <string>
+#include <vector>
 
 TEST(arena, allocate) {
     constexpr std::size_t ptr_char_size = sizeof(char*);
@@ -40,3 +45,26 @@ TEST(arena, allocate) {
     usage += 12345 + ptr_char_size;
     EXPECT_EQ(arena.memory_usage(), usage);
 }
+
+TEST(arena, memory_resource) {
+    pl::Arena arena;
+    pl::ArenaMemoryResource resource(&arena);
+
+    std::pmr::vector<std::pmr::string> strs(&resource);
+    for (int i = 0; i < 1024; ++i) {
+        strs.emplace_back(std::to_string(i) + std::string(32, 'x'));
+    }
+    for (int i = 0; i < 1024; ++i) {
+        EXPECT_EQ(std::to_string(i) + std::string(32, 'x'), std::string_view(strs[i]));
+    }
+    EXPECT_GT(arena.memory_usage(), 1024 * 32);
+
+    // over aligned allocation
+    void* p = resource.allocate(100, 64);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) % 64);
+
+    pl::Arena other_arena;
+    pl::ArenaMemoryResource other(&other_arena);
+    EXPECT_TRUE(resource.is_equal(resource));
+    EXPECT_FALSE(resource.is_equal(other));
+}
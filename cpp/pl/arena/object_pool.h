@@ -0,0 +1,253 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace pl {
+
+/**
+ * @class ObjectPool
+ * @brief 定长对象池，每个线程维护一个本地空闲链表，分配和释放都不需要加锁。
+ *
+ * 内存以slab为单位向系统申请，本地空闲对象超过上限时，按批归还到全局链表，本地为空时
+ * 从全局链表取一批，全局链表也为空时才申请新的slab。对象可以在任意线程释放(cross-thread return)，释放后挂到释放线程的
+ * 本地链表上，通过全局链表在线程之间流动。slab在进程退出前不会归还给系统。
+ */
+template <typename T> class ObjectPool {
+public:
+    // 每个slab的大致字节数
+    static constexpr std::size_t SLAB_BYTES = 64 * 1024;
+    // 本地空闲链表中最多缓存的对象个数
+    static constexpr std::size_t LOCAL_CACHE_LIMIT = 256;
+    // 本地与全局之间一次转移的对象个数
+    static constexpr std::size_t BATCH_SIZE = LOCAL_CACHE_LIMIT / 2;
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    static ObjectPool& instance() {
+        // 不析构，避免进程退出时其他线程的本地缓存还在归还对象
+        static auto* pool = new ObjectPool();
+        return *pool;
+    }
+
+    [[nodiscard]] void* allocate() {
+        if (cacheDestroyed()) {
+            return allocateGlobal();
+        }
+        LocalCache& cache = localCache();
+        if (cache.head == nullptr) {
+            refill(&cache);
+        }
+        FreeNode* node = cache.head;
+        cache.head = node->next;
+        --cache.count;
+        return node;
+    }
+
+    void deallocate(void* ptr) {
+        assert(ptr != nullptr);
+        auto* node = static_cast<FreeNode*>(ptr);
+        if (cacheDestroyed()) {
+            node->next = nullptr;
+            std::lock_guard<std::mutex> lock(mutex_);
+            batches_.push_back({node, 1});
+            return;
+        }
+        LocalCache& cache = localCache();
+        node->next = cache.head;
+        cache.head = node;
+        if (++cache.count >= LOCAL_CACHE_LIMIT) {
+            release(&cache, BATCH_SIZE);
+        }
+    }
+
+    template <typename... Args> [[nodiscard]] T* create(Args&&... args) {
+        void* ptr = allocate();
+        return new (ptr) T(std::forward<Args>(args)...);
+    }
+
+    void destroy(T* obj) {
+        obj->~T();
+        deallocate(obj);
+    }
+
+    // 已经向系统申请的slab个数
+    [[nodiscard]] std::size_t slabCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return slabs_.size();
+    }
+
+    [[nodiscard]] std::size_t memoryUsage() const {
+        return slabCount() * SLOTS_PER_SLAB * SLOT_SIZE;
+    }
+
+private:
+    struct FreeNode {
+        FreeNode* next;
+    };
+
+    struct Batch {
+        FreeNode* head;
+        std::size_t count;
+    };
+
+    struct LocalCache {
+        FreeNode* head{nullptr};
+        std::size_t count{0};
+    };
+
+    // 线程退出时把本地缓存归还到全局链表
+    struct ThreadCache : LocalCache {
+        ~ThreadCache() {
+            if (this->head != nullptr) {
+                ObjectPool::instance().release(this, this->count);
+            }
+            cacheDestroyed() = true;
+        }
+    };
+
+    static constexpr std::size_t SLOT_ALIGN = std::max(alignof(T), alignof(FreeNode));
+    static constexpr std::size_t SLOT_SIZE =
+        (std::max(sizeof(T), sizeof(FreeNode)) + SLOT_ALIGN - 1) / SLOT_ALIGN * SLOT_ALIGN;
+    static constexpr std::size_t SLOTS_PER_SLAB = std::max<std::size_t>(SLAB_BYTES / SLOT_SIZE, 1);
+
+    ObjectPool() = default;
+    ~ObjectPool() = default;
+
+    static LocalCache& localCache() {
+        thread_local ThreadCache cache;
+        return cache;
+    }
+
+    // 本线程的本地缓存是否已经析构。其他thread_local对象的析构函数可能在本地缓存之后
+    // 还在分配或释放对象，此时直接走全局链表。bool没有析构函数，线程退出前一直可以访问
+    static bool& cacheDestroyed() {
+        thread_local bool destroyed = false;
+        return destroyed;
+    }
+
+    void* allocateGlobal() {
+        LocalCache cache;
+        refill(&cache);
+        FreeNode* node = cache.head;
+        cache.head = node->next;
+        if (--cache.count > 0) {
+            release(&cache, cache.count);
+        }
+        return node;
+    }
+
+    // 从全局链表取一批对象，全局链表为空时申请新的slab
+    void refill(LocalCache* cache) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!batches_.empty()) {
+            Batch batch = batches_.back();
+            batches_.pop_back();
+            cache->head = batch.head;
+            cache->count = batch.count;
+            return;
+        }
+
+        // 新的slab按批切分，第一批留给当前线程，其余的放到全局链表
+        char* slab = static_cast<char*>(
+            ::operator new(SLOTS_PER_SLAB * SLOT_SIZE, std::align_val_t(SLOT_ALIGN)));
+        slabs_.push_back(slab);
+        for (std::size_t begin = 0; begin < SLOTS_PER_SLAB; begin += BATCH_SIZE) {
+            std::size_t end = std::min(begin + BATCH_SIZE, SLOTS_PER_SLAB);
+            FreeNode* head = nullptr;
+            for (std::size_t i = end; i > begin; --i) {
+                auto* node = reinterpret_cast<FreeNode*>(slab + (i - 1) * SLOT_SIZE);
+                node->next = head;
+                head = node;
+            }
+            if (begin == 0) {
+                cache->head = head;
+                cache->count = end;
+            } else {
+                batches_.push_back({head, end - begin});
+            }
+        }
+    }
+
+    // 将本地链表尾部的n个对象归还到全局链表，头部是最近释放的对象，留给当前线程复用
+    void release(LocalCache* cache, std::size_t n) {
+        assert(n > 0 && n <= cache->count);
+        FreeNode* head = nullptr;
+        if (n == cache->count) {
+            head = cache->head;
+            cache->head = nullptr;
+        } else {
+            FreeNode* tail = cache->head;
+            for (std::size_t i = 1; i < cache->count - n; ++i) {
+                tail = tail->next;
+            }
+            head = tail->next;
+            tail->next = nullptr;
+        }
+        cache->count -= n;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        batches_.push_back({head, n});
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<Batch> batches_;
+    std::vector<char*> slabs_;
+};
+
+/**
+ * @class ObjectPoolAllocator
+ * @brief 单个对象的分配走ObjectPool，可以配合std::allocate_shared使用，此时对象和
+ * shared_ptr的控制块在同一个池化的slot中
+ */
+template <typename T> struct ObjectPoolAllocator {
+    using value_type = T;
+
+    ObjectPoolAllocator() noexcept = default;
+
+    template <typename U> ObjectPoolAllocator(const ObjectPoolAllocator<U>& /*other*/) noexcept {}
+
+    [[nodiscard]] T* allocate(std::size_t n) {
+        if (n == 1) {
+            return static_cast<T*>(ObjectPool<T>::instance().allocate());
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+    }
+
+    void deallocate(T* ptr, std::size_t n) noexcept {
+        if (n == 1) {
+            ObjectPool<T>::instance().deallocate(ptr);
+            return;
+        }
+        ::operator delete(ptr, std::align_val_t(alignof(T)));
+    }
+
+    template <typename U> bool operator==(const ObjectPoolAllocator<U>& /*other*/) const noexcept {
+        return true;
+    }
+};
+
+} // namespace pl
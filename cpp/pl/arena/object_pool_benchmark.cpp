@@ -0,0 +1,106 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/arena/arena.h"
+#include "cpp/pl/arena/object_pool.h"
+
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <tbb/scalable_allocator.h>
+#include <vector>
+
+namespace {
+
+// 大小与sst中的Cell接近
+struct Object {
+    char data[72];
+};
+
+template <typename Alloc> void run(benchmark::State& state, Alloc&& alloc) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    std::vector<Object*> objs(n);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < n; ++i) {
+            objs[i] = alloc.allocate();
+            benchmark::DoNotOptimize(objs[i]);
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            alloc.deallocate(objs[i]);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+struct NewDelete {
+    Object* allocate() { return new Object; }
+    void deallocate(Object* obj) { delete obj; }
+};
+
+struct Malloc {
+    Object* allocate() { return static_cast<Object*>(::malloc(sizeof(Object))); }
+    void deallocate(Object* obj) { ::free(obj); }
+};
+
+// 与jemalloc类似，tbbmalloc也是带线程本地缓存的通用分配器
+struct ScalableMalloc {
+    Object* allocate() { return static_cast<Object*>(::scalable_malloc(sizeof(Object))); }
+    void deallocate(Object* obj) { ::scalable_free(obj); }
+};
+
+// arena不能单独释放对象，每轮结束后整体释放
+struct ArenaAlloc {
+    pl::Arena arena;
+    Object* allocate() {
+        return reinterpret_cast<Object*>(arena.allocate_aligned(sizeof(Object)));
+    }
+    void deallocate(Object* /*obj*/) {}
+};
+
+struct Pool {
+    Object* allocate() {
+        return static_cast<Object*>(pl::ObjectPool<Object>::instance().allocate());
+    }
+    void deallocate(Object* obj) { pl::ObjectPool<Object>::instance().deallocate(obj); }
+};
+
+} // namespace
+
+static void BM_new_delete(benchmark::State& state) { run(state, NewDelete()); }
+
+static void BM_malloc(benchmark::State& state) { run(state, Malloc()); }
+
+static void BM_scalable_malloc(benchmark::State& state) { run(state, ScalableMalloc()); }
+
+static void BM_arena(benchmark::State& state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    for (auto _ : state) {
+        ArenaAlloc alloc;
+        for (std::size_t i = 0; i < n; ++i) {
+            benchmark::DoNotOptimize(alloc.allocate());
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+static void BM_object_pool(benchmark::State& state) { run(state, Pool()); }
+
+BENCHMARK(BM_new_delete)->Range(1 << 6, 1 << 14)->ThreadRange(1, 8);
+BENCHMARK(BM_malloc)->Range(1 << 6, 1 << 14)->ThreadRange(1, 8);
+BENCHMARK(BM_scalable_malloc)->Range(1 << 6, 1 << 14)->ThreadRange(1, 8);
+BENCHMARK(BM_arena)->Range(1 << 6, 1 << 14)->ThreadRange(1, 8);
+BENCHMARK(BM_object_pool)->Range(1 << 6, 1 << 14)->ThreadRange(1, 8);
@@ -0,0 +1,171 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/arena/object_pool.h"
+
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Foo {
+    Foo(int a, std::string b) : a(a), b(std::move(b)) {}
+    int a;
+    std::string b;
+};
+
+struct alignas(64) Aligned {
+    char data[8];
+};
+
+struct Tiny {
+    char c;
+};
+
+struct Late {
+    int value;
+};
+
+// 在对象池的本地缓存之前构造，线程退出时在它之后析构
+struct LateHolder {
+    ~LateHolder() {
+        auto& pool = pl::ObjectPool<Late>::instance();
+        for (Late* obj : objs) {
+            pool.destroy(obj);
+        }
+        // 本地缓存析构之后仍然可以分配
+        pool.destroy(pool.create(Late{1}));
+    }
+
+    std::vector<Late*> objs;
+};
+
+} // namespace
+
+TEST(object_pool, create_and_destroy) {
+    auto& pool = pl::ObjectPool<Foo>::instance();
+    Foo* foo = pool.create(1, "hello");
+    EXPECT_EQ(foo->a, 1);
+    EXPECT_EQ(foo->b, "hello");
+    pool.destroy(foo);
+
+    // 刚释放的对象会被优先复用
+    Foo* bar = pool.create(2, "world");
+    EXPECT_EQ(bar, foo);
+    EXPECT_EQ(bar->a, 2);
+    EXPECT_EQ(bar->b, "world");
+    pool.destroy(bar);
+}
+
+TEST(object_pool, alignment) {
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 1000; ++i) {
+        void* ptr = pl::ObjectPool<Aligned>::instance().allocate();
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % alignof(Aligned), 0);
+        ptrs.push_back(ptr);
+    }
+    for (void* ptr : ptrs) {
+        pl::ObjectPool<Aligned>::instance().deallocate(ptr);
+    }
+
+    // 对象小于一个指针时，slot至少能放下空闲链表的指针
+    std::set<void*> tiny;
+    for (int i = 0; i < 1000; ++i) {
+        void* ptr = pl::ObjectPool<Tiny>::instance().allocate();
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % alignof(void*), 0);
+        EXPECT_TRUE(tiny.insert(ptr).second);
+    }
+    for (void* ptr : tiny) {
+        pl::ObjectPool<Tiny>::instance().deallocate(ptr);
+    }
+}
+
+TEST(object_pool, cross_thread_return) {
+    auto& pool = pl::ObjectPool<Foo>::instance();
+    constexpr int N = 10000;
+    std::vector<Foo*> objs(N);
+
+    std::thread producer([&]() {
+        for (int i = 0; i < N; ++i) {
+            objs[i] = pool.create(i, std::to_string(i));
+        }
+    });
+    producer.join();
+    std::size_t slabs = pool.slabCount();
+
+    std::thread consumer([&]() {
+        for (int i = 0; i < N; ++i) {
+            EXPECT_EQ(objs[i]->a, i);
+            EXPECT_EQ(objs[i]->b, std::to_string(i));
+            pool.destroy(objs[i]);
+        }
+    });
+    consumer.join();
+
+    // 其他线程归还的对象可以被当前线程复用，不需要申请新的slab
+    for (int i = 0; i < N; ++i) {
+        objs[i] = pool.create(i, "");
+    }
+    EXPECT_EQ(pool.slabCount(), slabs);
+    for (Foo* obj : objs) {
+        pool.destroy(obj);
+    }
+}
+
+TEST(object_pool, use_after_thread_cache_destroyed) {
+    auto& pool = pl::ObjectPool<Late>::instance();
+    std::thread worker([&]() {
+        thread_local LateHolder holder;
+        for (int i = 0; i < 1000; ++i) {
+            holder.objs.push_back(pool.create(Late{i}));
+        }
+    });
+    worker.join();
+    std::size_t slabs = pool.slabCount();
+
+    // 线程退出后归还的对象都回到了全局链表
+    std::vector<Late*> objs;
+    for (int i = 0; i < 1000; ++i) {
+        objs.push_back(pool.create(Late{i}));
+    }
+    EXPECT_EQ(pool.slabCount(), slabs);
+    for (Late* obj : objs) {
+        pool.destroy(obj);
+    }
+}
+
+TEST(object_pool, allocate_shared) {
+    std::vector<std::shared_ptr<Foo>> foos;
+    for (int i = 0; i < 100; ++i) {
+        foos.push_back(std::allocate_shared<Foo>(pl::ObjectPoolAllocator<Foo>(), i, "foo"));
+    }
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(foos[i]->a, i);
+        EXPECT_EQ(foos[i]->b, "foo");
+    }
+
+    std::vector<int, pl::ObjectPoolAllocator<int>> ints;
+    for (int i = 0; i < 100; ++i) {
+        ints.push_back(i);
+    }
+    EXPECT_EQ(ints.size(), 100);
+    EXPECT_EQ(ints[99], 99);
+}
@@ -0,0 +1,57 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+namespace pl {
+
+/**
+ * @brief Whether pdep/pext are implemented in hardware. AMD cpus before Zen3 (family 0x19)
+ * support bmi2, but pdep/pext are microcoded and take hundreds of cycles
+ */
+inline bool fast_bmi2() {
+#if defined(__x86_64__)
+    static const bool fast = [] {
+        if (!__builtin_cpu_supports("bmi2")) {
+            return false;
+        }
+        if (!__builtin_cpu_is("amd")) {
+            return true;
+        }
+        unsigned int eax = 0;
+        unsigned int ebx = 0;
+        unsigned int ecx = 0;
+        unsigned int edx = 0;
+        if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0) {
+            return false;
+        }
+        unsigned int family = (eax >> 8) & 0xF;
+        if (family == 0xF) {
+            family += (eax >> 20) & 0xFF;
+        }
+        return family >= 0x19;
+    }();
+    return fast;
+#else
+    return false;
+#endif
+}
+
+} // namespace pl
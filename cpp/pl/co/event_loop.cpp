@@ -0,0 +1,271 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/co/event_loop.h"
+#include "cpp/pl/log/logger.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace pl::co {
+
+namespace {
+
+thread_local EventLoop* current_loop = nullptr;
+
+constexpr int MAX_EVENTS = 256;
+
+} // namespace
+
+EventLoop::EventLoop(ThreadPool* blocking_pool) : blocking_pool_(blocking_pool) {
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        throw std::runtime_error(std::string("epoll_create1: ") + ::strerror(errno));
+    }
+    event_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (event_fd_ < 0) {
+        ::close(epoll_fd_);
+        throw std::runtime_error(std::string("eventfd: ") + ::strerror(errno));
+    }
+    struct epoll_event ev {};
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, event_fd_, &ev);
+}
+
+EventLoop::~EventLoop() {
+    ::close(event_fd_);
+    ::close(epoll_fd_);
+}
+
+EventLoop* EventLoop::current() { return current_loop; }
+
+void EventLoop::run() {
+    EventLoop* prev = current_loop;
+    current_loop = this;
+    while (!stop_.load(std::memory_order_acquire)) {
+        runReady();
+        fireTimers();
+        poll(ready_.empty() ? nextTimeout() : 0);
+    }
+    current_loop = prev;
+}
+
+void EventLoop::stop() {
+    stop_.store(true, std::memory_order_release);
+    uint64_t one = 1;
+    [[maybe_unused]] auto n = ::write(event_fd_, &one, sizeof(one));
+}
+
+void EventLoop::schedule(std::coroutine_handle<> handle) {
+    if (current_loop == this) {
+        ready_.push_back(handle);
+        return;
+    }
+    bool wakeup = false;
+    {
+        std::lock_guard<std::mutex> lock(remote_mutex_);
+        wakeup = remote_.empty();
+        remote_.push_back(handle);
+    }
+    if (wakeup) {
+        uint64_t one = 1;
+        [[maybe_unused]] auto n = ::write(event_fd_, &one, sizeof(one));
+    }
+}
+
+void EventLoop::spawn(Task<void> task) { schedule(detail::runDetached(std::move(task)).handle()); }
+
+void EventLoop::addTimer(Clock::time_point deadline, std::coroutine_handle<> handle) {
+    assert(current_loop == this);
+    timers_.push({deadline, timer_seq_++, handle});
+}
+
+std::unique_ptr<IoState> EventLoop::registerFd(int fd) {
+    auto state = std::make_unique<IoState>();
+    state->fd = fd;
+    struct epoll_event ev {};
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    ev.data.ptr = state.get();
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        throw std::runtime_error(std::string("epoll_ctl: ") + ::strerror(errno));
+    }
+    return state;
+}
+
+void EventLoop::unregisterFd(IoState* state) {
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, state->fd, nullptr);
+}
+
+void EventLoop::runReady() {
+    // 只执行本轮开始前就绪的协程，避免不停yield的协程饿死io和定时器
+    std::size_t n = ready_.size();
+    for (std::size_t i = 0; i < n; ++i) {
+        auto handle = ready_.front();
+        ready_.pop_front();
+        handle.resume();
+    }
+}
+
+void EventLoop::poll(int timeout_ms) {
+    struct epoll_event events[MAX_EVENTS];
+    int n = ::epoll_wait(epoll_fd_, events, MAX_EVENTS, timeout_ms);
+    if (n < 0) {
+        if (errno != EINTR) {
+            LOG_ERROR << "epoll_wait error: " << ::strerror(errno);
+        }
+        return;
+    }
+    for (int i = 0; i < n; ++i) {
+        auto* state = static_cast<IoState*>(events[i].data.ptr);
+        if (state == nullptr) {
+            uint64_t value;
+            [[maybe_unused]] auto r = ::read(event_fd_, &value, sizeof(value));
+            drainRemote();
+            continue;
+        }
+        uint32_t ev = events[i].events;
+        // 出错或者对端关闭时同时唤醒读写两端，由重试的系统调用返回具体的错误
+        if ((ev & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0) {
+            state->readable = true;
+            if (state->reader) {
+                ready_.push_back(std::exchange(state->reader, nullptr));
+            }
+        }
+        if ((ev & (EPOLLOUT | EPOLLHUP | EPOLLERR)) != 0) {
+            state->writable = true;
+            if (state->writer) {
+                ready_.push_back(std::exchange(state->writer, nullptr));
+            }
+        }
+    }
+}
+
+void EventLoop::drainRemote() {
+    std::vector<std::coroutine_handle<>> remote;
+    {
+        std::lock_guard<std::mutex> lock(remote_mutex_);
+        remote.swap(remote_);
+    }
+    ready_.insert(ready_.end(), remote.begin(), remote.end());
+}
+
+int EventLoop::nextTimeout() const {
+    if (timers_.empty()) {
+        return -1;
+    }
+    auto now = Clock::now();
+    auto deadline = timers_.top().deadline;
+    if (deadline <= now) {
+        return 0;
+    }
+    // 向上取整，避免提前醒来之后空转
+    auto ms = std::chrono::ceil<std::chrono::milliseconds>(deadline - now).count();
+    return static_cast<int>(std::min<int64_t>(ms, INT32_MAX));
+}
+
+void EventLoop::fireTimers() {
+    auto now = Clock::now();
+    while (!timers_.empty() && timers_.top().deadline <= now) {
+        ready_.push_back(timers_.top().handle);
+        timers_.pop();
+    }
+}
+
+namespace detail {
+
+DetachedTask runDetached(Task<void> task) {
+    try {
+        co_await std::move(task);
+    } catch (const std::exception& e) {
+        LOG_ERROR << "uncaught exception in coroutine: " << e.what();
+    } catch (...) {
+        LOG_ERROR << "uncaught unknown exception in coroutine";
+    }
+}
+
+} // namespace detail
+
+Scheduler::Scheduler(std::size_t threads, std::size_t blocking_threads)
+    : blocking_pool_(std::max<std::size_t>(blocking_threads, 1)) {
+    threads = std::max<std::size_t>(threads, 1);
+    for (std::size_t i = 0; i < threads; ++i) {
+        loops_.emplace_back(std::make_unique<EventLoop>(&blocking_pool_));
+    }
+    // 进程允许使用的核，受taskset或者cgroup cpuset限制时不一定从0开始连续编号
+    std::vector<int> cpus;
+#if defined(__linux__)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (::sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+    // 每个事件循环绑定到一个允许的核上，核不够时不绑定，绑定失败不影响正确性
+    if (threads > cpus.size()) {
+        cpus.clear();
+    }
+    for (std::size_t i = 0; i < threads; ++i) {
+        int cpu = cpus.empty() ? -1 : cpus[i];
+        threads_.emplace_back([this, i, cpu]() {
+#if defined(__linux__)
+            if (cpu >= 0) {
+                cpu_set_t cpuset;
+                CPU_ZERO(&cpuset);
+                CPU_SET(cpu, &cpuset);
+                ::pthread_setaffinity_np(::pthread_self(), sizeof(cpuset), &cpuset);
+            }
+#endif
+            loops_[i]->run();
+        });
+    }
+}
+
+Scheduler::~Scheduler() {
+    for (auto& loop : loops_) {
+        loop->stop();
+    }
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void Scheduler::spawn(Task<void> task) {
+    std::size_t index = next_.fetch_add(1, std::memory_order_relaxed) % loops_.size();
+    spawn(index, std::move(task));
+}
+
+void Scheduler::spawn(std::size_t index, Task<void> task) {
+    loops_[index]->spawn(std::move(task));
+}
+
+} // namespace pl::co
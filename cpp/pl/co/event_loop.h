@@ -0,0 +1,220 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include "cpp/pl/co/task.h"
+#include "cpp/pl/thread/thread_pool.h"
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace pl::co {
+
+/**
+ * 注册到EventLoop上的fd的状态，fd以边缘触发的方式注册一次，
+ * 事件到达时如果没有协程在等待，记录下就绪状态，下次等待时直接返回
+ */
+struct IoState {
+    int fd{-1};
+    bool readable{false};
+    bool writable{false};
+    std::coroutine_handle<> reader;
+    std::coroutine_handle<> writer;
+};
+
+/**
+ * @class EventLoop
+ * @brief 基于epoll的单线程事件循环，负责执行就绪的协程、处理io事件以及定时器。
+ *
+ * 除了schedule之外的接口都只能在事件循环所在的线程中调用；schedule可以在任意线程调用，
+ * 其他线程提交的协程通过eventfd唤醒事件循环
+ */
+class EventLoop {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit EventLoop(ThreadPool* blocking_pool = nullptr);
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    // 当前线程正在运行的事件循环，不在事件循环线程中时返回nullptr
+    static EventLoop* current();
+
+    // 执行事件循环，直到调用stop
+    void run();
+
+    // 可以在任意线程调用
+    void stop();
+
+    // 可以在任意线程调用
+    void schedule(std::coroutine_handle<> handle);
+
+    // 在当前事件循环中后台执行task
+    void spawn(Task<void> task);
+
+    void addTimer(Clock::time_point deadline, std::coroutine_handle<> handle);
+
+    // fd必须是非阻塞的，在close之前需要调用unregisterFd
+    std::unique_ptr<IoState> registerFd(int fd);
+    void unregisterFd(IoState* state);
+
+    // 用于执行文件io这类无法通过epoll异步化的阻塞操作，可能为空
+    [[nodiscard]] ThreadPool* blockingPool() const { return blocking_pool_; }
+
+private:
+    void runReady();
+    void poll(int timeout_ms);
+    void drainRemote();
+    int nextTimeout() const;
+    void fireTimers();
+
+private:
+    struct Timer {
+        Clock::time_point deadline;
+        uint64_t seq;
+        std::coroutine_handle<> handle;
+
+        bool operator>(const Timer& other) const {
+            return deadline != other.deadline ? deadline > other.deadline : seq > other.seq;
+        }
+    };
+
+    int epoll_fd_{-1};
+    int event_fd_{-1};
+    ThreadPool* const blocking_pool_;
+    std::atomic<bool> stop_{false};
+    std::deque<std::coroutine_handle<>> ready_;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<>> timers_;
+    uint64_t timer_seq_{0};
+
+    // 其他线程提交的协程，remote_从空变为非空时写一次eventfd
+    std::mutex remote_mutex_;
+    std::vector<std::coroutine_handle<>> remote_;
+};
+
+/**
+ * @class Scheduler
+ * @brief 每个线程(默认每个核)一个EventLoop，spawn的任务按轮询分配到各个事件循环上，
+ * 任务一旦开始执行就固定在所属的事件循环上
+ */
+class Scheduler {
+public:
+    explicit Scheduler(std::size_t threads = std::thread::hardware_concurrency(),
+                       std::size_t blocking_threads = 4);
+    ~Scheduler();
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    void spawn(Task<void> task);
+
+    void spawn(std::size_t index, Task<void> task);
+
+    /**
+     * @brief 在调度器上执行task，阻塞等待结果。不能在事件循环线程中调用
+     */
+    template <typename T> T blockOn(Task<T> task);
+
+    [[nodiscard]] std::size_t size() const { return loops_.size(); }
+
+    [[nodiscard]] EventLoop& loop(std::size_t index) { return *loops_[index]; }
+
+private:
+    std::vector<std::unique_ptr<EventLoop>> loops_;
+    std::vector<std::thread> threads_;
+    // 放在loops_之后，先于事件循环析构，保证阻塞任务完成时事件循环还存在
+    ThreadPool blocking_pool_;
+    std::atomic<std::size_t> next_{0};
+};
+
+namespace detail {
+
+DetachedTask runDetached(Task<void> task);
+
+template <typename T> Task<void> fulfill(Task<T> task, std::promise<T> promise) {
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await std::move(task);
+            promise.set_value();
+        } else {
+            promise.set_value(co_await std::move(task));
+        }
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+    }
+}
+
+} // namespace detail
+
+template <typename T> T Scheduler::blockOn(Task<T> task) {
+    assert(EventLoop::current() == nullptr);
+    std::promise<T> promise;
+    auto future = promise.get_future();
+    spawn(detail::fulfill(std::move(task), std::move(promise)));
+    return future.get();
+}
+
+/**
+ * 让出执行权，当前协程重新排到事件循环就绪队列的末尾
+ */
+struct YieldAwaiter {
+    [[nodiscard]] bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle) const {
+        EventLoop::current()->schedule(handle);
+    }
+
+    void await_resume() const noexcept {}
+};
+
+inline YieldAwaiter yield() { return {}; }
+
+struct SleepAwaiter {
+    EventLoop::Clock::time_point deadline;
+
+    [[nodiscard]] bool await_ready() const noexcept {
+        return deadline <= EventLoop::Clock::now();
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) const {
+        EventLoop::current()->addTimer(deadline, handle);
+    }
+
+    void await_resume() const noexcept {}
+};
+
+template <typename Rep, typename Period>
+SleepAwaiter sleep_for(std::chrono::duration<Rep, Period> duration) {
+    return {EventLoop::Clock::now() +
+            std::chrono::duration_cast<EventLoop::Clock::duration>(duration)};
+}
+
+inline SleepAwaiter sleep_until(EventLoop::Clock::time_point deadline) { return {deadline}; }
+
+} // namespace pl::co
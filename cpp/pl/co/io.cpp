@@ -0,0 +1,282 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/co/io.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <unistd.h>
+
+namespace pl::co {
+
+namespace {
+
+void setNonBlocking(int fd) {
+    int flags = ::fcntl(fd, F_GETFL, 0);
+    ::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+sockaddr_in makeAddress(std::string_view host, uint16_t port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    std::string h(host);
+    if (h.empty() || h == "0.0.0.0") {
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    } else if (::inet_pton(AF_INET, h.c_str(), &addr.sin_addr) != 1) {
+        throw std::invalid_argument("invalid ipv4 address: " + h);
+    }
+    return addr;
+}
+
+int newSocket() {
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw std::system_error(errno, std::system_category(), "socket");
+    }
+    return fd;
+}
+
+/**
+ * 把阻塞操作放到事件循环的阻塞线程池中执行，执行完成后回到原来的事件循环
+ */
+template <typename Fn> struct OffloadAwaiter {
+    Fn fn;
+    EventLoop* loop{nullptr};
+    ssize_t result{0};
+
+    bool await_ready() {
+        loop = EventLoop::current();
+        if (loop == nullptr || loop->blockingPool() == nullptr) {
+            result = fn();
+            return true;
+        }
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        (void)loop->blockingPool()->submit([this, handle]() {
+            result = fn();
+            loop->schedule(handle);
+        });
+    }
+
+    ssize_t await_resume() const noexcept { return result; }
+};
+
+template <typename Fn> OffloadAwaiter<Fn> offload(Fn fn) { return {std::move(fn)}; }
+
+} // namespace
+
+struct Socket::ReadyAwaiter {
+    IoState* state;
+    bool read;
+
+    [[nodiscard]] bool await_ready() const noexcept {
+        return read ? state->readable : state->writable;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) const noexcept {
+        (read ? state->reader : state->writer) = handle;
+    }
+
+    void await_resume() const noexcept {}
+};
+
+Socket::Socket(int fd) : loop_(EventLoop::current()) {
+    if (loop_ == nullptr) {
+        ::close(fd);
+        throw std::logic_error("Socket must be created in an event loop");
+    }
+    setNonBlocking(fd);
+    state_ = loop_->registerFd(fd);
+}
+
+Socket::Socket(Socket&& other) noexcept
+    : loop_(std::exchange(other.loop_, nullptr)), state_(std::move(other.state_)) {}
+
+Socket& Socket::operator=(Socket&& other) noexcept {
+    if (this != &other) {
+        close();
+        loop_ = std::exchange(other.loop_, nullptr);
+        state_ = std::move(other.state_);
+    }
+    return *this;
+}
+
+Socket Socket::listen(std::string_view host, uint16_t port, int backlog) {
+    int fd = newSocket();
+    int on = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    sockaddr_in addr = makeAddress(host, port);
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(fd, backlog) != 0) {
+        int err = errno;
+        ::close(fd);
+        throw std::system_error(err, std::system_category(), "listen");
+    }
+    return Socket(fd);
+}
+
+Task<Socket> Socket::connect(std::string_view host, uint16_t port) {
+    sockaddr_in addr = makeAddress(host, port);
+    Socket socket(newSocket());
+    int on = 1;
+    ::setsockopt(socket.fd(), IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    if (::connect(socket.fd(), reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        if (errno != EINPROGRESS) {
+            throw std::system_error(errno, std::system_category(), "connect");
+        }
+        socket.state_->writable = false;
+        co_await socket.writable();
+        int err = 0;
+        socklen_t len = sizeof(err);
+        ::getsockopt(socket.fd(), SOL_SOCKET, SO_ERROR, &err, &len);
+        if (err != 0) {
+            throw std::system_error(err, std::system_category(), "connect");
+        }
+    }
+    co_return socket;
+}
+
+Task<int> Socket::accept() {
+    for (;;) {
+        int fd = ::accept4(state_->fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd >= 0) {
+            co_return fd;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            state_->readable = false;
+            co_await readable();
+        } else if (errno != EINTR && errno != ECONNABORTED) {
+            co_return -errno;
+        }
+    }
+}
+
+Task<ssize_t> Socket::read(void* buf, std::size_t len) {
+    for (;;) {
+        ssize_t n = ::read(state_->fd, buf, len);
+        if (n >= 0) {
+            co_return n;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            state_->readable = false;
+            co_await readable();
+        } else if (errno != EINTR) {
+            co_return -errno;
+        }
+    }
+}
+
+Task<ssize_t> Socket::write(const void* buf, std::size_t len) {
+    for (;;) {
+        ssize_t n = ::send(state_->fd, buf, len, MSG_NOSIGNAL);
+        if (n >= 0) {
+            co_return n;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            state_->writable = false;
+            co_await writable();
+        } else if (errno != EINTR) {
+            co_return -errno;
+        }
+    }
+}
+
+Task<ssize_t> Socket::writeAll(const void* buf, std::size_t len) {
+    const char* p = static_cast<const char*>(buf);
+    std::size_t written = 0;
+    while (written < len) {
+        ssize_t n = co_await write(p + written, len - written);
+        if (n < 0) {
+            co_return n;
+        }
+        written += static_cast<std::size_t>(n);
+    }
+    co_return static_cast<ssize_t>(written);
+}
+
+void Socket::close() {
+    if (state_ != nullptr) {
+        loop_->unregisterFd(state_.get());
+        ::close(state_->fd);
+        state_.reset();
+        loop_ = nullptr;
+    }
+}
+
+void Socket::shutdownWrite() {
+    if (state_ != nullptr) {
+        ::shutdown(state_->fd, SHUT_WR);
+    }
+}
+
+uint16_t Socket::localPort() const {
+    sockaddr_in addr{};
+    socklen_t len = sizeof(addr);
+    if (state_ == nullptr || ::getsockname(state_->fd, reinterpret_cast<sockaddr*>(&addr), &len)) {
+        return 0;
+    }
+    return ntohs(addr.sin_port);
+}
+
+Socket::ReadyAwaiter Socket::readable() { return {state_.get(), true}; }
+
+Socket::ReadyAwaiter Socket::writable() { return {state_.get(), false}; }
+
+File& File::operator=(File&& other) noexcept {
+    if (this != &other) {
+        close();
+        fd_ = std::exchange(other.fd_, -1);
+    }
+    return *this;
+}
+
+File File::open(const std::string& path, int flags, mode_t mode) {
+    return File(::open(path.c_str(), flags | O_CLOEXEC, mode));
+}
+
+Task<ssize_t> File::pread(void* buf, std::size_t len, off_t offset) {
+    int fd = fd_;
+    co_return co_await offload([fd, buf, len, offset]() -> ssize_t {
+        ssize_t n = ::pread(fd, buf, len, offset);
+        return n < 0 ? -errno : n;
+    });
+}
+
+Task<ssize_t> File::pwrite(const void* buf, std::size_t len, off_t offset) {
+    int fd = fd_;
+    co_return co_await offload([fd, buf, len, offset]() -> ssize_t {
+        ssize_t n = ::pwrite(fd, buf, len, offset);
+        return n < 0 ? -errno : n;
+    });
+}
+
+void File::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+} // namespace pl::co
@@ -0,0 +1,125 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include "cpp/pl/co/event_loop.h"
+#include "cpp/pl/co/task.h"
+
+#include <coroutine>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+/**
+ * 协程化的io操作，出错时返回-errno，与io_uring的约定一致
+ */
+namespace pl::co {
+
+/**
+ * @class Socket
+ * @brief 非阻塞socket，注册在创建它的事件循环上，之后只能在这个事件循环的协程中使用
+ */
+class Socket {
+public:
+    Socket() = default;
+
+    // 接管fd，fd会被设置为非阻塞并注册到当前的事件循环
+    explicit Socket(int fd);
+
+    Socket(Socket&& other) noexcept;
+    Socket& operator=(Socket&& other) noexcept;
+
+    Socket(const Socket&) = delete;
+    Socket& operator=(const Socket&) = delete;
+
+    ~Socket() { close(); }
+
+    // 监听host:port，port为0时由系统分配，可以通过localPort获取
+    static Socket listen(std::string_view host, uint16_t port, int backlog = 1024);
+
+    static Task<Socket> connect(std::string_view host, uint16_t port);
+
+    // 返回新连接的fd，出错时返回-errno
+    Task<int> accept();
+
+    // 读到的字节数，0表示对端关闭
+    Task<ssize_t> read(void* buf, std::size_t len);
+
+    Task<ssize_t> write(const void* buf, std::size_t len);
+
+    // 写完所有数据，返回写入的字节数，出错时返回-errno
+    Task<ssize_t> writeAll(const void* buf, std::size_t len);
+
+    void close();
+
+    void shutdownWrite();
+
+    [[nodiscard]] int fd() const { return state_ ? state_->fd : -1; }
+
+    [[nodiscard]] bool valid() const { return state_ != nullptr; }
+
+    [[nodiscard]] uint16_t localPort() const;
+
+private:
+    struct ReadyAwaiter;
+
+    ReadyAwaiter readable();
+    ReadyAwaiter writable();
+
+private:
+    EventLoop* loop_{nullptr};
+    std::unique_ptr<IoState> state_;
+};
+
+/**
+ * @class File
+ * @brief 普通文件无法通过epoll异步化，读写操作在事件循环的阻塞线程池中执行，
+ * 完成后回到原来的事件循环继续执行。没有阻塞线程池时直接在当前线程执行
+ */
+class File {
+public:
+    File() = default;
+    explicit File(int fd) : fd_(fd) {}
+
+    File(File&& other) noexcept : fd_(std::exchange(other.fd_, -1)) {}
+    File& operator=(File&& other) noexcept;
+
+    File(const File&) = delete;
+    File& operator=(const File&) = delete;
+
+    ~File() { close(); }
+
+    // 失败时返回的File无效，errno保存了错误码
+    static File open(const std::string& path, int flags, mode_t mode = 0644);
+
+    Task<ssize_t> pread(void* buf, std::size_t len, off_t offset);
+
+    Task<ssize_t> pwrite(const void* buf, std::size_t len, off_t offset);
+
+    void close();
+
+    [[nodiscard]] int fd() const { return fd_; }
+
+    [[nodiscard]] bool valid() const { return fd_ >= 0; }
+
+private:
+    int fd_{-1};
+};
+
+} // namespace pl::co
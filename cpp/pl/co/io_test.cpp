@@ -0,0 +1,125 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/co/event_loop.h"
+#include "cpp/pl/co/io.h"
+#include "cpp/pl/co/when.h"
+
+#include <fcntl.h>
+#include <string>
+#include <system_error>
+#include <unistd.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+pl::co::Task<void> echo(pl::co::Socket conn) {
+    char buf[4096];
+    for (;;) {
+        ssize_t n = co_await conn.read(buf, sizeof(buf));
+        if (n <= 0) {
+            break;
+        }
+        if (co_await conn.writeAll(buf, n) < 0) {
+            break;
+        }
+    }
+}
+
+pl::co::Task<void> serve(pl::co::Socket* listener, int connections) {
+    for (int i = 0; i < connections; ++i) {
+        int fd = co_await listener->accept();
+        if (fd < 0) {
+            co_return;
+        }
+        pl::co::EventLoop::current()->spawn(echo(pl::co::Socket(fd)));
+    }
+}
+
+pl::co::Task<std::string> roundTrip(uint16_t port, std::string payload) {
+    pl::co::Socket socket = co_await pl::co::Socket::connect("127.0.0.1", port);
+    co_await socket.writeAll(payload.data(), payload.size());
+    socket.shutdownWrite();
+    std::string received;
+    char buf[4096];
+    for (;;) {
+        ssize_t n = co_await socket.read(buf, sizeof(buf));
+        if (n <= 0) {
+            break;
+        }
+        received.append(buf, n);
+    }
+    co_return received;
+}
+
+pl::co::Task<std::vector<std::string>> echoTest(int clients) {
+    pl::co::Socket listener = pl::co::Socket::listen("127.0.0.1", 0);
+    uint16_t port = listener.localPort();
+    std::vector<pl::co::Task<std::string>> tasks;
+    for (int i = 0; i < clients; ++i) {
+        // 足够大，需要多次读写才能完成
+        tasks.emplace_back(roundTrip(port, std::string(1 << 20, static_cast<char>('a' + i))));
+    }
+    auto server = serve(&listener, clients);
+    pl::co::EventLoop::current()->spawn(std::move(server));
+    co_return co_await pl::co::when_all(std::move(tasks));
+}
+
+pl::co::Task<std::string> fileTest(std::string path) {
+    pl::co::File file = pl::co::File::open(path, O_CREAT | O_TRUNC | O_RDWR);
+    if (!file.valid()) {
+        co_return "";
+    }
+    std::string data = "hello coroutine file io";
+    ssize_t n = co_await file.pwrite(data.data(), data.size(), 0);
+    if (n != static_cast<ssize_t>(data.size())) {
+        co_return "";
+    }
+    std::string out(data.size(), '\0');
+    n = co_await file.pread(out.data(), out.size(), 0);
+    out.resize(n < 0 ? 0 : n);
+    co_return out;
+}
+
+} // namespace
+
+TEST(CoIoTest, echo) {
+    pl::co::Scheduler scheduler(2, 1);
+    auto results = scheduler.blockOn(echoTest(4));
+    ASSERT_EQ(results.size(), 4);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(results[i], std::string(1 << 20, static_cast<char>('a' + i)));
+    }
+}
+
+TEST(CoIoTest, connect_refused) {
+    pl::co::Scheduler scheduler(1, 1);
+    // 先占一个端口再关掉，保证连接会被拒绝
+    uint16_t port = scheduler.blockOn([]() -> pl::co::Task<uint16_t> {
+        pl::co::Socket listener = pl::co::Socket::listen("127.0.0.1", 0);
+        co_return listener.localPort();
+    }());
+    EXPECT_THROW(scheduler.blockOn(roundTrip(port, "x")), std::system_error);
+}
+
+TEST(CoIoTest, file) {
+    pl::co::Scheduler scheduler(1, 1);
+    std::string path = "/tmp/co_io_test_" + std::to_string(::getpid());
+    EXPECT_EQ(scheduler.blockOn(fileTest(path)), "hello coroutine file io");
+    ::unlink(path.c_str());
+}
@@ -0,0 +1,221 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include <cassert>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace pl::co {
+
+template <typename T = void> class Task;
+
+namespace detail {
+
+class PromiseBase {
+public:
+    // co_await一个Task时才开始执行(lazy)，执行结束后通过symmetric transfer直接切换到等待者，
+    // 不会在调用栈上无限嵌套
+    struct FinalAwaiter {
+        [[nodiscard]] bool await_ready() const noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
+            return h.promise().continuation_;
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() noexcept { exception_ = std::current_exception(); }
+
+    void setContinuation(std::coroutine_handle<> continuation) noexcept {
+        continuation_ = continuation;
+    }
+
+protected:
+    void rethrowIfException() {
+        if (exception_) {
+            std::rethrow_exception(exception_);
+        }
+    }
+
+private:
+    std::coroutine_handle<> continuation_{std::noop_coroutine()};
+    std::exception_ptr exception_;
+};
+
+template <typename T> class Promise final : public PromiseBase {
+public:
+    Task<T> get_return_object() noexcept;
+
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U&&, T>>>
+    void return_value(U&& value) noexcept(std::is_nothrow_constructible_v<T, U&&>) {
+        value_.emplace(std::forward<U>(value));
+    }
+
+    T result() {
+        rethrowIfException();
+        assert(value_.has_value());
+        return std::move(*value_);
+    }
+
+private:
+    std::optional<T> value_;
+};
+
+template <> class Promise<void> final : public PromiseBase {
+public:
+    Task<void> get_return_object() noexcept;
+
+    void return_void() noexcept {}
+
+    void result() { rethrowIfException(); }
+};
+
+} // namespace detail
+
+/**
+ * @class Task
+ * @brief 无栈协程任务，创建后不会立即执行，被co_await时才开始执行。Task独占协程帧，
+ * 析构时销毁协程帧，因此不能在协程执行完之前析构
+ */
+template <typename T> class [[nodiscard]] Task {
+public:
+    using promise_type = detail::Promise<T>;
+    using value_type = T;
+
+    Task() noexcept = default;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() { destroy(); }
+
+    [[nodiscard]] bool valid() const noexcept { return handle_ != nullptr; }
+
+    [[nodiscard]] bool done() const noexcept { return handle_ == nullptr || handle_.done(); }
+
+    auto operator co_await() && noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            [[nodiscard]] bool await_ready() const noexcept { return !handle || handle.done(); }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().setContinuation(awaiting);
+                return handle;
+            }
+
+            T await_resume() { return handle.promise().result(); }
+        };
+        return Awaiter{handle_};
+    }
+
+    // 供调度器直接启动协程使用
+    [[nodiscard]] std::coroutine_handle<promise_type> handle() const noexcept { return handle_; }
+
+private:
+    void destroy() noexcept {
+        if (handle_) {
+            handle_.destroy();
+            handle_ = nullptr;
+        }
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle_{nullptr};
+};
+
+namespace detail {
+
+template <typename T> inline Task<T> Promise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline Task<void> Promise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+/**
+ * 自己管理生命周期的协程，执行结束后自动销毁协程帧，用于把一个Task放到调度器上后台执行。
+ * 结束时如果设置了next，通过symmetric transfer切换过去
+ */
+class DetachedTask {
+public:
+    struct promise_type {
+        std::coroutine_handle<> next{std::noop_coroutine()};
+
+        DetachedTask get_return_object() noexcept {
+            return DetachedTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        auto final_suspend() noexcept {
+            struct FinalAwaiter {
+                [[nodiscard]] bool await_ready() const noexcept { return false; }
+
+                std::coroutine_handle<> await_suspend(
+                    std::coroutine_handle<promise_type> h) noexcept {
+                    std::coroutine_handle<> next = h.promise().next;
+                    h.destroy();
+                    return next;
+                }
+
+                void await_resume() noexcept {}
+            };
+            return FinalAwaiter{};
+        }
+
+        void return_void() noexcept {}
+
+        // 协程体内部负责捕获异常
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+
+    explicit DetachedTask(std::coroutine_handle<promise_type> handle) noexcept
+        : handle_(handle) {}
+
+    [[nodiscard]] std::coroutine_handle<promise_type> handle() const noexcept { return handle_; }
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+} // namespace detail
+
+} // namespace pl::co
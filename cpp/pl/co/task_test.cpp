@@ -0,0 +1,173 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/co/event_loop.h"
+#include "cpp/pl/co/task.h"
+#include "cpp/pl/co/when.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+pl::co::Task<int> answer() { co_return 42; }
+
+pl::co::Task<int> add(int a, int b) {
+    int x = co_await answer();
+    co_return x + a + b;
+}
+
+pl::co::Task<std::unique_ptr<std::string>> moveOnly() {
+    co_return std::make_unique<std::string>("move only");
+}
+
+pl::co::Task<void> fail() {
+    throw std::runtime_error("oops");
+    co_return;
+}
+
+// 深度递归依赖symmetric transfer，否则会栈溢出
+pl::co::Task<int> depth(int n) {
+    if (n == 0) {
+        co_return 0;
+    }
+    co_return co_await depth(n - 1) + 1;
+}
+
+pl::co::Task<int> sleepAndReturn(int ms, int value) {
+    co_await pl::co::sleep_for(std::chrono::milliseconds(ms));
+    co_return value;
+}
+
+} // namespace
+
+class CoTaskTest : public ::testing::Test {
+protected:
+    pl::co::Scheduler scheduler_{2, 1};
+};
+
+TEST_F(CoTaskTest, basic) {
+    EXPECT_EQ(scheduler_.blockOn(add(1, 2)), 45);
+    EXPECT_EQ(*scheduler_.blockOn(moveOnly()), "move only");
+    EXPECT_THROW(scheduler_.blockOn(fail()), std::runtime_error);
+    EXPECT_EQ(scheduler_.blockOn(depth(1000)), 1000);
+}
+
+TEST_F(CoTaskTest, lazy) {
+    bool started = false;
+    // 协程lambda不能有捕获，lambda对象在协程执行之前就已经析构了
+    auto task = [](bool* started) -> pl::co::Task<void> {
+        *started = true;
+        co_return;
+    }(&started);
+    EXPECT_FALSE(started);
+    scheduler_.blockOn(std::move(task));
+    EXPECT_TRUE(started);
+}
+
+TEST_F(CoTaskTest, timer_and_yield) {
+    auto start = std::chrono::steady_clock::now();
+    scheduler_.blockOn([]() -> pl::co::Task<void> {
+        co_await pl::co::sleep_for(std::chrono::milliseconds(20));
+        co_await pl::co::yield();
+    }());
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+}
+
+TEST_F(CoTaskTest, when_all) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<pl::co::Task<int>> tasks;
+    for (int i = 0; i < 10; ++i) {
+        tasks.emplace_back(sleepAndReturn(30, i));
+    }
+    auto results = scheduler_.blockOn(pl::co::when_all(std::move(tasks)));
+    // 子任务是并发执行的
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(300));
+    ASSERT_EQ(results.size(), 10);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(results[i], i);
+    }
+
+    auto [a, b] = scheduler_.blockOn(pl::co::when_all(answer(), moveOnly()));
+    EXPECT_EQ(a, 42);
+    EXPECT_EQ(*b, "move only");
+
+    std::vector<pl::co::Task<void>> voids;
+    voids.emplace_back(fail());
+    voids.emplace_back([]() -> pl::co::Task<void> { co_return; }());
+    EXPECT_THROW(scheduler_.blockOn(pl::co::when_all(std::move(voids))), std::runtime_error);
+
+    EXPECT_TRUE(scheduler_.blockOn(pl::co::when_all(std::vector<pl::co::Task<int>>())).empty());
+}
+
+TEST_F(CoTaskTest, when_any) {
+    std::vector<pl::co::Task<int>> tasks;
+    tasks.emplace_back(sleepAndReturn(200, 1));
+    tasks.emplace_back(sleepAndReturn(10, 2));
+    tasks.emplace_back(sleepAndReturn(100, 3));
+    auto [index, value] = scheduler_.blockOn(pl::co::when_any(std::move(tasks)));
+    EXPECT_EQ(index, 1);
+    EXPECT_EQ(value, 2);
+
+    std::vector<pl::co::Task<int>> ready;
+    ready.emplace_back(answer());
+    EXPECT_EQ(scheduler_.blockOn(pl::co::when_any(std::move(ready))).second, 42);
+
+    // 其余任务在后台继续执行，等它们结束之后再销毁调度器
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+}
+
+TEST_F(CoTaskTest, when_any_loop) {
+    // 等待者通过对称转移恢复，同步完成和异步完成的子任务交替出现也不会让栈一直增长
+    int sum = scheduler_.blockOn([]() -> pl::co::Task<int> {
+        int sum = 0;
+        for (int i = 0; i < 100000; ++i) {
+            std::vector<pl::co::Task<int>> tasks;
+            if (i % 2 == 0) {
+                tasks.emplace_back(answer());
+            } else {
+                tasks.emplace_back([]() -> pl::co::Task<int> {
+                    co_await pl::co::yield();
+                    co_return 42;
+                }());
+            }
+            sum += (co_await pl::co::when_any(std::move(tasks))).second;
+        }
+        co_return sum;
+    }());
+    EXPECT_EQ(sum, 42 * 100000);
+}
+
+TEST_F(CoTaskTest, spawn) {
+    std::atomic<int> count{0};
+    for (int i = 0; i < 100; ++i) {
+        scheduler_.spawn([](std::atomic<int>* count) -> pl::co::Task<void> {
+            co_await pl::co::yield();
+            count->fetch_add(1);
+        }(&count));
+    }
+    while (count.load() < 100) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(count.load(), 100);
+}
@@ -0,0 +1,306 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include "cpp/pl/co/task.h"
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace pl::co {
+
+namespace detail {
+
+/**
+ * 计数器初始值为子任务个数加一，每个子任务完成时减一，等待者挂起完成之后再减一，
+ * 最后一个减到0的负责恢复等待者，这样子任务同步完成时也不会在await_suspend返回之前恢复等待者
+ */
+struct WhenAllCounter {
+    explicit WhenAllCounter(std::size_t n) : remaining(n + 1) {}
+
+    std::atomic<std::size_t> remaining;
+    std::coroutine_handle<> continuation;
+
+    bool arrive() noexcept { return remaining.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+};
+
+/**
+ * 包装一个子任务，结束时通知WhenAllCounter
+ */
+class WhenAllNotifier {
+public:
+    struct promise_type {
+        WhenAllCounter* counter{nullptr};
+
+        WhenAllNotifier get_return_object() noexcept {
+            return WhenAllNotifier(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        auto final_suspend() noexcept {
+            struct FinalAwaiter {
+                [[nodiscard]] bool await_ready() const noexcept { return false; }
+
+                std::coroutine_handle<> await_suspend(
+                    std::coroutine_handle<promise_type> h) noexcept {
+                    WhenAllCounter* counter = h.promise().counter;
+                    return counter->arrive() ? counter->continuation : std::noop_coroutine();
+                }
+
+                void await_resume() noexcept {}
+            };
+            return FinalAwaiter{};
+        }
+
+        void return_void() noexcept {}
+
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+
+    explicit WhenAllNotifier(std::coroutine_handle<promise_type> handle) noexcept
+        : handle_(handle) {}
+
+    WhenAllNotifier(WhenAllNotifier&& other) noexcept
+        : handle_(std::exchange(other.handle_, nullptr)) {}
+
+    WhenAllNotifier(const WhenAllNotifier&) = delete;
+    WhenAllNotifier& operator=(const WhenAllNotifier&) = delete;
+
+    ~WhenAllNotifier() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    void start(WhenAllCounter* counter) noexcept {
+        handle_.promise().counter = counter;
+        handle_.resume();
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+// 子任务的结果，void任务只需要记录异常
+template <typename T> struct ResultSlot {
+    std::optional<T> value;
+    std::exception_ptr exception;
+};
+
+template <> struct ResultSlot<void> {
+    std::exception_ptr exception;
+};
+
+template <typename T> WhenAllNotifier makeNotifier(Task<T>& task, ResultSlot<T>& slot) {
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await std::move(task);
+        } else {
+            slot.value.emplace(co_await std::move(task));
+        }
+    } catch (...) {
+        slot.exception = std::current_exception();
+    }
+}
+
+struct WhenAllAwaiter {
+    std::vector<WhenAllNotifier>& notifiers;
+    WhenAllCounter& counter;
+
+    [[nodiscard]] bool await_ready() const noexcept { return notifiers.empty(); }
+
+    bool await_suspend(std::coroutine_handle<> continuation) noexcept {
+        counter.continuation = continuation;
+        for (auto& notifier : notifiers) {
+            notifier.start(&counter);
+        }
+        // 返回false表示所有子任务都已经完成，不需要挂起
+        return !counter.arrive();
+    }
+
+    void await_resume() const noexcept {}
+};
+
+template <typename Slots> void rethrowFirst(const Slots& slots) {
+    for (const auto& slot : slots) {
+        if (slot.exception) {
+            std::rethrow_exception(slot.exception);
+        }
+    }
+}
+
+template <typename... Ts, std::size_t... Is>
+Task<std::tuple<Ts...>> whenAllTuple(std::index_sequence<Is...> /*unused*/, Task<Ts>... tasks) {
+    std::tuple<ResultSlot<Ts>...> slots;
+    std::vector<WhenAllNotifier> notifiers;
+    notifiers.reserve(sizeof...(Ts));
+    (notifiers.emplace_back(makeNotifier(tasks, std::get<Is>(slots))), ...);
+    WhenAllCounter counter(sizeof...(Ts));
+    co_await WhenAllAwaiter{notifiers, counter};
+    (
+        [&]() {
+            if (std::get<Is>(slots).exception) {
+                std::rethrow_exception(std::get<Is>(slots).exception);
+            }
+        }(),
+        ...);
+    co_return std::tuple<Ts...>(std::move(*std::get<Is>(slots).value)...);
+}
+
+template <typename T> struct WhenAnyState {
+    std::vector<Task<T>> tasks;
+    // 子任务全部完成和等待者挂起完成各占一个，与WhenAllCounter的用法相同
+    std::atomic<int> pending{2};
+    std::atomic<bool> finished{false};
+    std::coroutine_handle<> continuation;
+    std::size_t index{0};
+    ResultSlot<T> result;
+};
+
+// 协程结束时通过对称转移恢复next，不在协程体内直接resume，避免同步完成的任务层层递归
+struct ContinueWith {
+    std::coroutine_handle<> next;
+
+    [[nodiscard]] bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<DetachedTask::promise_type> h) const noexcept {
+        h.promise().next = next;
+        return false;
+    }
+
+    void await_resume() const noexcept {}
+};
+
+// 自己管理生命周期，通过shared_ptr保证其他子任务结束之前状态一直有效
+template <typename T> DetachedTask whenAnyRunner(std::shared_ptr<WhenAnyState<T>> state,
+                                                 std::size_t index) {
+    ResultSlot<T> slot;
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await std::move(state->tasks[index]);
+        } else {
+            slot.value.emplace(co_await std::move(state->tasks[index]));
+        }
+    } catch (...) {
+        slot.exception = std::current_exception();
+    }
+    if (!state->finished.exchange(true, std::memory_order_acq_rel)) {
+        state->index = index;
+        state->result = std::move(slot);
+        if (state->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            co_await ContinueWith{state->continuation};
+        }
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief 并发执行所有任务，全部完成后返回各自的结果；有任务抛出异常时，
+ * 等待所有任务结束后重新抛出第一个异常
+ */
+template <typename T> Task<std::vector<T>> when_all(std::vector<Task<T>> tasks) {
+    std::vector<detail::ResultSlot<T>> slots(tasks.size());
+    std::vector<detail::WhenAllNotifier> notifiers;
+    notifiers.reserve(tasks.size());
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+        notifiers.emplace_back(detail::makeNotifier(tasks[i], slots[i]));
+    }
+    detail::WhenAllCounter counter(tasks.size());
+    co_await detail::WhenAllAwaiter{notifiers, counter};
+    detail::rethrowFirst(slots);
+    std::vector<T> results;
+    results.reserve(slots.size());
+    for (auto& slot : slots) {
+        results.emplace_back(std::move(*slot.value));
+    }
+    co_return results;
+}
+
+inline Task<void> when_all(std::vector<Task<void>> tasks) {
+    std::vector<detail::ResultSlot<void>> slots(tasks.size());
+    std::vector<detail::WhenAllNotifier> notifiers;
+    notifiers.reserve(tasks.size());
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+        notifiers.emplace_back(detail::makeNotifier(tasks[i], slots[i]));
+    }
+    detail::WhenAllCounter counter(tasks.size());
+    co_await detail::WhenAllAwaiter{notifiers, counter};
+    detail::rethrowFirst(slots);
+}
+
+template <typename... Ts> Task<std::tuple<Ts...>> when_all(Task<Ts>... tasks) {
+    static_assert((!std::is_void_v<Ts> && ...), "use when_all(std::vector<Task<void>>)");
+    return detail::whenAllTuple(std::index_sequence_for<Ts...>{}, std::move(tasks)...);
+}
+
+/**
+ * @brief 并发执行所有任务，返回第一个完成的任务的下标和结果。其余任务不会被取消，
+ * 会在后台继续执行到结束，因此它们引用的对象需要比任务活得更久
+ */
+template <typename T>
+Task<std::conditional_t<std::is_void_v<T>, std::size_t, std::pair<std::size_t, T>>> when_any(
+    std::vector<Task<T>> tasks) {
+    auto state = std::make_shared<detail::WhenAnyState<T>>();
+    state->tasks = std::move(tasks);
+    const std::size_t n = state->tasks.size();
+
+    // 持有裸指针即可，协程帧中的state保证其有效
+    struct Awaiter {
+        const std::shared_ptr<detail::WhenAnyState<T>>* state;
+        std::size_t n;
+
+        [[nodiscard]] bool await_ready() const noexcept { return n == 0; }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) {
+            (*state)->continuation = continuation;
+            for (std::size_t i = 0; i < n; ++i) {
+                detail::whenAnyRunner<T>(*state, i).handle().resume();
+            }
+            // 第一个完成的任务已经同步结束时直接转移到等待者
+            return (*state)->pending.fetch_sub(1, std::memory_order_acq_rel) == 1
+                       ? continuation
+                       : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+    co_await Awaiter{&state, n};
+    if (n == 0) {
+        throw std::invalid_argument("when_any requires at least one task");
+    }
+
+    if (state->result.exception) {
+        std::rethrow_exception(state->result.exception);
+    }
+    if constexpr (std::is_void_v<T>) {
+        co_return state->index;
+    } else {
+        co_return std::make_pair(state->index, std::move(*state->result.value));
+    }
+}
+
+} // namespace pl::co
@@ -0,0 +1,86 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include "cpp/pl/fiber/sync.h"
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace pl::fiber {
+
+/**
+ * @class Channel
+ * @brief fiber之间传递数据的有界通道，满时send挂起，空时recv挂起。
+ * close之后send返回false，recv取完剩余的数据之后返回std::nullopt
+ */
+template <typename T> class Channel {
+public:
+    explicit Channel(std::size_t capacity) : capacity_(capacity == 0 ? 1 : capacity) {}
+
+    Channel(const Channel&) = delete;
+    Channel& operator=(const Channel&) = delete;
+
+    bool send(T value) {
+        std::unique_lock<Mutex> lock(mutex_);
+        not_full_.wait(lock, [this]() { return closed_ || queue_.size() < capacity_; });
+        if (closed_) {
+            return false;
+        }
+        queue_.push_back(std::move(value));
+        lock.unlock();
+        not_empty_.notify_one();
+        return true;
+    }
+
+    std::optional<T> recv() {
+        std::unique_lock<Mutex> lock(mutex_);
+        not_empty_.wait(lock, [this]() { return closed_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            return std::nullopt;
+        }
+        T value = std::move(queue_.front());
+        queue_.pop_front();
+        lock.unlock();
+        not_full_.notify_one();
+        return value;
+    }
+
+    void close() {
+        {
+            std::lock_guard<Mutex> lock(mutex_);
+            closed_ = true;
+        }
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    [[nodiscard]] std::size_t capacity() const { return capacity_; }
+
+private:
+    const std::size_t capacity_;
+    Mutex mutex_;
+    ConditionVariable not_empty_;
+    ConditionVariable not_full_;
+    std::deque<T> queue_;
+    bool closed_{false};
+};
+
+} // namespace pl::fiber
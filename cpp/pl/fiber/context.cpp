@@ -0,0 +1,181 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/fiber/context.h"
+
+// pl_jump_context和pl_make_context改编自Boost.Context的以下源文件，保持了相同的栈帧布局
+// 和寄存器保存顺序，只修改了符号名：
+//   libs/context/src/asm/jump_x86_64_sysv_elf_gas.S
+//   libs/context/src/asm/make_x86_64_sysv_elf_gas.S
+//   libs/context/src/asm/jump_arm64_aapcs_elf_gas.S
+//   libs/context/src/asm/make_arm64_aapcs_elf_gas.S
+//
+// 原始代码的版权和许可声明如下：
+//
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+// clang-format off
+#if defined(__x86_64__) && defined(__ELF__)
+
+// 栈上的布局(从低地址到高地址)：mxcsr/x87控制字, r12, r13, r14, r15, rbx, rbp, 返回地址
+__asm__(
+    ".text\n"
+    ".globl pl_jump_context\n"
+    ".type pl_jump_context,@function\n"
+    ".align 16\n"
+    "pl_jump_context:\n"
+    "    leaq -0x38(%rsp), %rsp\n"
+    "    stmxcsr (%rsp)\n"
+    "    fnstcw 0x4(%rsp)\n"
+    "    movq %r12, 0x8(%rsp)\n"
+    "    movq %r13, 0x10(%rsp)\n"
+    "    movq %r14, 0x18(%rsp)\n"
+    "    movq %r15, 0x20(%rsp)\n"
+    "    movq %rbx, 0x28(%rsp)\n"
+    "    movq %rbp, 0x30(%rsp)\n"
+    "    movq %rsp, %rax\n"
+    "    movq %rdi, %rsp\n"
+    "    movq 0x38(%rsp), %r8\n"
+    "    ldmxcsr (%rsp)\n"
+    "    fldcw 0x4(%rsp)\n"
+    "    movq 0x8(%rsp), %r12\n"
+    "    movq 0x10(%rsp), %r13\n"
+    "    movq 0x18(%rsp), %r14\n"
+    "    movq 0x20(%rsp), %r15\n"
+    "    movq 0x28(%rsp), %rbx\n"
+    "    movq 0x30(%rsp), %rbp\n"
+    "    leaq 0x40(%rsp), %rsp\n"
+    // 返回值Transfer{rax, rdx}，同时作为新上下文入口函数的参数{rdi, rsi}
+    "    movq %rsi, %rdx\n"
+    "    movq %rax, %rdi\n"
+    "    jmp *%r8\n"
+    ".size pl_jump_context,.-pl_jump_context\n"
+
+    ".globl pl_make_context\n"
+    ".type pl_make_context,@function\n"
+    ".align 16\n"
+    "pl_make_context:\n"
+    "    movq %rdi, %rax\n"
+    "    andq $-16, %rax\n"
+    "    leaq -0x40(%rax), %rax\n"
+    // 入口函数保存在rbx的位置，由trampoline跳转过去
+    "    movq %rdx, 0x28(%rax)\n"
+    "    stmxcsr (%rax)\n"
+    "    fnstcw 0x4(%rax)\n"
+    "    leaq pl_context_trampoline(%rip), %rcx\n"
+    "    movq %rcx, 0x38(%rax)\n"
+    "    leaq pl_context_finish(%rip), %rcx\n"
+    "    movq %rcx, 0x30(%rax)\n"
+    "    ret\n"
+    "pl_context_trampoline:\n"
+    // 压入finish作为入口函数的返回地址，同时保证进入入口函数时栈是16字节对齐的
+    "    push %rbp\n"
+    "    jmp *%rbx\n"
+    "pl_context_finish:\n"
+    "    call abort@PLT\n"
+    "    hlt\n"
+    ".size pl_make_context,.-pl_make_context\n"
+    ".section .note.GNU-stack,\"\",%progbits\n"
+    ".text\n");
+
+#elif defined(__aarch64__) && defined(__ELF__)
+
+// 栈上的布局(从低地址到高地址)：d8-d15, x19-x28, fp, lr, pc
+__asm__(
+    ".text\n"
+    ".globl pl_jump_context\n"
+    ".type pl_jump_context,%function\n"
+    ".align 4\n"
+    "pl_jump_context:\n"
+    "    sub sp, sp, #0xb0\n"
+    "    stp d8, d9, [sp, #0x00]\n"
+    "    stp d10, d11, [sp, #0x10]\n"
+    "    stp d12, d13, [sp, #0x20]\n"
+    "    stp d14, d15, [sp, #0x30]\n"
+    "    stp x19, x20, [sp, #0x40]\n"
+    "    stp x21, x22, [sp, #0x50]\n"
+    "    stp x23, x24, [sp, #0x60]\n"
+    "    stp x25, x26, [sp, #0x70]\n"
+    "    stp x27, x28, [sp, #0x80]\n"
+    "    stp x29, x30, [sp, #0x90]\n"
+    "    str x30, [sp, #0xa0]\n"
+    "    mov x4, sp\n"
+    "    mov sp, x0\n"
+    "    ldp d8, d9, [sp, #0x00]\n"
+    "    ldp d10, d11, [sp, #0x10]\n"
+    "    ldp d12, d13, [sp, #0x20]\n"
+    "    ldp d14, d15, [sp, #0x30]\n"
+    "    ldp x19, x20, [sp, #0x40]\n"
+    "    ldp x21, x22, [sp, #0x50]\n"
+    "    ldp x23, x24, [sp, #0x60]\n"
+    "    ldp x25, x26, [sp, #0x70]\n"
+    "    ldp x27, x28, [sp, #0x80]\n"
+    "    ldp x29, x30, [sp, #0x90]\n"
+    // 返回值Transfer{x0, x1}，同时作为新上下文入口函数的参数
+    "    mov x0, x4\n"
+    "    ldr x4, [sp, #0xa0]\n"
+    "    add sp, sp, #0xb0\n"
+    "    ret x4\n"
+    ".size pl_jump_context,.-pl_jump_context\n"
+
+    ".globl pl_make_context\n"
+    ".type pl_make_context,%function\n"
+    ".align 4\n"
+    "pl_make_context:\n"
+    "    and x0, x0, ~0xF\n"
+    "    sub x0, x0, #0xb0\n"
+    "    str x2, [x0, #0xa0]\n"
+    // 入口函数返回时进入finish
+    "    adr x1, pl_context_finish\n"
+    "    str x1, [x0, #0x98]\n"
+    "    ret x30\n"
+    "pl_context_finish:\n"
+    "    bl abort\n"
+    ".size pl_make_context,.-pl_make_context\n"
+    ".section .note.GNU-stack,\"\",%progbits\n"
+    ".text\n");
+
+#else
+#error "pl::fiber context switch is only implemented for x86_64 and aarch64 ELF"
+#endif
+// clang-format on
@@ -0,0 +1,54 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include <cstddef>
+
+/**
+ * 手写的上下文切换，只保存callee-saved寄存器以及浮点控制字，不涉及信号掩码，
+ * 因此不会像swapcontext那样每次切换都陷入内核。接口以及context.cpp中的汇编实现改编自
+ * Boost.Context的fcontext(Boost Software License 1.0)，许可声明见context.cpp
+ */
+namespace pl::fiber {
+
+// 指向被挂起的上下文保存在其栈上的寄存器
+using ContextPtr = void*;
+
+struct Transfer {
+    // 切换过来之前的上下文，切回去时使用
+    ContextPtr context;
+    void* data;
+};
+
+using ContextEntry = void (*)(Transfer);
+
+extern "C" {
+
+/**
+ * @brief 挂起当前上下文并切换到to，data会传递给目标上下文。
+ * 返回值是之后切换回来时对方传递的Transfer
+ */
+Transfer pl_jump_context(ContextPtr to, void* data);
+
+/**
+ * @brief 在[stack_top - size, stack_top)上创建一个新的上下文，第一次切换到它的时候执行entry。
+ * entry不能返回，执行完之后需要切换到其他上下文
+ */
+ContextPtr pl_make_context(void* stack_top, std::size_t size, ContextEntry entry);
+}
+
+} // namespace pl::fiber
@@ -0,0 +1,152 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+// _longjmp在_FORTIFY_SOURCE下会检查目标栈，不允许跳到另一个栈上
+#undef _FORTIFY_SOURCE
+
+#include "cpp/pl/fiber/context.h"
+#include "cpp/pl/fiber/fiber.h"
+#include "cpp/pl/fiber/stack.h"
+
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <csetjmp>
+#include <ucontext.h>
+
+/**
+ * 比较co/impl中两种实现所用的切换方式与手写的上下文切换，每次迭代是一次来回(两次切换)
+ */
+namespace {
+
+pl::fiber::StackPool& stackPool() {
+    static pl::fiber::StackPool pool(64 * 1024);
+    return pool;
+}
+
+// 手写的上下文切换
+void pingEntry(pl::fiber::Transfer transfer) {
+    for (;;) {
+        transfer = pl::fiber::pl_jump_context(transfer.context, nullptr);
+    }
+}
+
+void BM_JumpContext(benchmark::State& state) {
+    pl::fiber::Stack stack = stackPool().allocate();
+    pl::fiber::ContextPtr ctx = pl::fiber::pl_make_context(stack.top, stack.size, pingEntry);
+    for (auto _ : state) {
+        ctx = pl::fiber::pl_jump_context(ctx, nullptr).context;
+    }
+    stackPool().deallocate(stack);
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+
+// swapcontext，与co/impl/context_impl.cpp相同，每次切换都要调用sigprocmask
+ucontext_t uc_main;
+ucontext_t uc_co;
+
+void ucontextEntry() {
+    for (;;) {
+        ::swapcontext(&uc_co, &uc_main);
+    }
+}
+
+void BM_SwapContext(benchmark::State& state) {
+    pl::fiber::Stack stack = stackPool().allocate();
+    ::getcontext(&uc_co);
+    uc_co.uc_stack.ss_sp = static_cast<char*>(stack.top) - stack.size;
+    uc_co.uc_stack.ss_size = stack.size;
+    uc_co.uc_link = &uc_main;
+    ::makecontext(&uc_co, ucontextEntry, 0);
+    for (auto _ : state) {
+        ::swapcontext(&uc_main, &uc_co);
+    }
+    stackPool().deallocate(stack);
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+
+// setjmp/longjmp，与co/impl/setjmp_impl.cpp相同。setjmp无法创建新的栈，第一次通过ucontext进入，
+// 之后都用不保存信号掩码的_setjmp/_longjmp切换
+std::jmp_buf jb_main;
+std::jmp_buf jb_co;
+
+void setjmpEntry() {
+    for (;;) {
+        if (_setjmp(jb_co) == 0) {
+            _longjmp(jb_main, 1);
+        }
+    }
+}
+
+void BM_SetjmpLongjmp(benchmark::State& state) {
+    pl::fiber::Stack stack = stackPool().allocate();
+    ucontext_t boot;
+    ucontext_t co;
+    ::getcontext(&co);
+    co.uc_stack.ss_sp = static_cast<char*>(stack.top) - stack.size;
+    co.uc_stack.ss_size = stack.size;
+    co.uc_link = nullptr;
+    ::makecontext(&co, setjmpEntry, 0);
+    if (_setjmp(jb_main) == 0) {
+        ::swapcontext(&boot, &co);
+    }
+    for (auto _ : state) {
+        if (_setjmp(jb_main) == 0) {
+            _longjmp(jb_co, 1);
+        }
+    }
+    stackPool().deallocate(stack);
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+
+// 包含调度开销的yield：fiber让出之后重新进入worker的队列再被恢复
+void BM_FiberYield(benchmark::State& state) {
+    const auto fibers = static_cast<int>(state.range(0));
+    constexpr int YIELDS = 1000;
+    pl::fiber::Scheduler scheduler(1);
+    for (auto _ : state) {
+        for (int i = 0; i < fibers; ++i) {
+            scheduler.spawn([]() {
+                for (int j = 0; j < YIELDS; ++j) {
+                    pl::fiber::this_fiber::yield();
+                }
+            });
+        }
+        scheduler.join();
+    }
+    state.SetItemsProcessed(state.iterations() * fibers * YIELDS);
+}
+
+void BM_FiberSpawn(benchmark::State& state) {
+    const auto fibers = static_cast<int>(state.range(0));
+    pl::fiber::Scheduler scheduler(1);
+    std::atomic<int> count{0};
+    for (auto _ : state) {
+        for (int i = 0; i < fibers; ++i) {
+            scheduler.spawn([&count]() { count.fetch_add(1, std::memory_order_relaxed); });
+        }
+        scheduler.join();
+    }
+    benchmark::DoNotOptimize(count.load());
+    state.SetItemsProcessed(state.iterations() * fibers);
+}
+
+} // namespace
+
+BENCHMARK(BM_JumpContext);
+BENCHMARK(BM_SwapContext);
+BENCHMARK(BM_SetjmpLongjmp);
+BENCHMARK(BM_FiberYield)->Arg(1)->Arg(16)->UseRealTime();
+BENCHMARK(BM_FiberSpawn)->Arg(1000)->UseRealTime();
@@ -0,0 +1,187 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/fiber/fiber.h"
+#include "cpp/pl/arena/object_pool.h"
+#include "cpp/pl/log/logger.h"
+
+#include <cassert>
+#include <exception>
+#include <thread>
+
+#if defined(__SANITIZE_ADDRESS__)
+#define PL_FIBER_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define PL_FIBER_ASAN 1
+#endif
+#endif
+
+#ifdef PL_FIBER_ASAN
+#include <sanitizer/common_interface_defs.h>
+#endif
+
+namespace pl::fiber {
+
+namespace detail {
+
+namespace {
+
+thread_local Fiber* current_fiber = nullptr;
+
+// 开启ASan时需要告诉它栈的切换，否则会把另一个栈上的访问当成越界
+inline void startSwitch(void** fake_stack, const void* bottom, std::size_t size) {
+#ifdef PL_FIBER_ASAN
+    __sanitizer_start_switch_fiber(fake_stack, bottom, size);
+#else
+    (void)fake_stack, (void)bottom, (void)size;
+#endif
+}
+
+inline void finishSwitch(void* fake_stack, const void** bottom, std::size_t* size) {
+#ifdef PL_FIBER_ASAN
+    __sanitizer_finish_switch_fiber(fake_stack, bottom, size);
+#else
+    (void)fake_stack, (void)bottom, (void)size;
+#endif
+}
+
+} // namespace
+
+__attribute__((noinline)) Fiber* currentFiber() { return current_fiber; }
+
+Fiber::Fiber(Scheduler* scheduler, Stack stack, pl::Task fn)
+    : scheduler_(scheduler),
+      stack_(stack),
+      fn_(std::move(fn)),
+      context_(pl_make_context(stack.top, stack.size, &Fiber::entry)) {}
+
+void Fiber::entry(Transfer transfer) {
+    auto* fiber = static_cast<Fiber*>(transfer.data);
+    fiber->caller_ = transfer.context;
+    finishSwitch(nullptr, &fiber->caller_bottom_, &fiber->caller_size_);
+    try {
+        fiber->fn_();
+    } catch (const std::exception& e) {
+        LOG_ERROR << "uncaught exception in fiber: " << e.what();
+    } catch (...) {
+        LOG_ERROR << "uncaught unknown exception in fiber";
+    }
+    // 闭包在fiber的栈上析构
+    fiber->fn_.reset();
+    fiber->done_ = true;
+    // fiber的栈不会再使用了，不需要保存fake stack
+    startSwitch(nullptr, fiber->caller_bottom_, fiber->caller_size_);
+    pl_jump_context(fiber->caller_, nullptr);
+    // 结束的fiber不会再被恢复
+    std::terminate();
+}
+
+void Fiber::resume() {
+    Fiber* prev = current_fiber;
+    current_fiber = this;
+    void* fake_stack = nullptr;
+    startSwitch(&fake_stack, static_cast<char*>(stack_.top) - stack_.size, stack_.size);
+    Transfer transfer = pl_jump_context(context_, this);
+    finishSwitch(fake_stack, nullptr, nullptr);
+    current_fiber = prev;
+    context_ = transfer.context;
+
+    Scheduler* scheduler = scheduler_;
+    if (done_) {
+        scheduler->finish(this);
+        return;
+    }
+    Spinlock* lock = std::exchange(unlock_after_switch_, nullptr);
+    bool reschedule = std::exchange(reschedule_, false);
+    // 之后fiber可能已经在其他worker上恢复执行，不能再访问this
+    if (lock != nullptr) {
+        lock->unlock();
+    } else if (reschedule) {
+        scheduler->schedule(this);
+    }
+}
+
+void Fiber::switchOut() {
+    startSwitch(&fake_stack_, caller_bottom_, caller_size_);
+    Transfer transfer = pl_jump_context(caller_, nullptr);
+    // 可能在另一个worker上恢复，需要更新caller的栈
+    finishSwitch(fake_stack_, &caller_bottom_, &caller_size_);
+    caller_ = transfer.context;
+}
+
+void Fiber::suspend(Spinlock* lock) {
+    unlock_after_switch_ = lock;
+    switchOut();
+}
+
+void Fiber::yield() {
+    reschedule_ = true;
+    switchOut();
+}
+
+void Fiber::wake() { scheduler_->schedule(this); }
+
+} // namespace detail
+
+Scheduler::Scheduler(std::size_t threads, std::size_t stack_size)
+    : stacks_(stack_size), pool_(threads) {}
+
+Scheduler::~Scheduler() { join(); }
+
+void Scheduler::join() {
+    assert(!this_fiber::inFiber());
+    std::size_t n = alive_.load(std::memory_order_acquire);
+    while (n != 0) {
+        alive_.wait(n, std::memory_order_acquire);
+        n = alive_.load(std::memory_order_acquire);
+    }
+}
+
+void Scheduler::spawnTask(pl::Task fn) {
+    Stack stack = stacks_.allocate();
+    auto* fiber = ObjectPool<detail::Fiber>::instance().create(this, stack, std::move(fn));
+    alive_.fetch_add(1, std::memory_order_relaxed);
+    schedule(fiber);
+}
+
+void Scheduler::schedule(detail::Fiber* fiber) {
+    pool_.execute([fiber]() { fiber->resume(); });
+}
+
+void Scheduler::finish(detail::Fiber* fiber) {
+    Stack stack = fiber->stack();
+    ObjectPool<detail::Fiber>::instance().destroy(fiber);
+    stacks_.deallocate(stack);
+    if (alive_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        alive_.notify_all();
+    }
+}
+
+namespace this_fiber {
+
+void yield() {
+    detail::Fiber* fiber = detail::currentFiber();
+    if (fiber != nullptr) {
+        fiber->yield();
+    } else {
+        std::this_thread::yield();
+    }
+}
+
+} // namespace this_fiber
+
+} // namespace pl::fiber
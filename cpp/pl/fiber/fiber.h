@@ -0,0 +1,162 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include "cpp/pl/fiber/context.h"
+#include "cpp/pl/fiber/stack.h"
+#include "cpp/pl/thread/task.h"
+#include "cpp/pl/thread/work_stealing_pool.h"
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+
+namespace pl::fiber {
+
+class Scheduler;
+
+namespace detail {
+
+/**
+ * 保护等待队列的自旋锁，临界区只有几条指令
+ */
+class Spinlock {
+public:
+    void lock() {
+        while (flag_.exchange(true, std::memory_order_acquire)) {
+            while (flag_.load(std::memory_order_relaxed)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void unlock() { flag_.store(false, std::memory_order_release); }
+
+private:
+    std::atomic<bool> flag_{false};
+};
+
+/**
+ * @class Fiber
+ * @brief 有栈协程，由Scheduler创建，在worker线程上通过resume执行，挂起之后可以在任意worker上恢复
+ */
+class Fiber {
+public:
+    Fiber(Scheduler* scheduler, Stack stack, pl::Task fn);
+
+    Fiber(const Fiber&) = delete;
+    Fiber& operator=(const Fiber&) = delete;
+
+    // 在worker线程上切换到fiber执行，直到fiber挂起或者结束
+    void resume();
+
+    /**
+     * @brief 挂起当前fiber，只能在fiber内部调用。lock不为空时，由worker在切换完成之后释放，
+     * 保证其他线程拿到锁之后看到的fiber一定已经挂起了，可以安全地wake
+     */
+    void suspend(Spinlock* lock = nullptr);
+
+    // 重新放回调度队列，让其他fiber先执行
+    void yield();
+
+    // 把挂起的fiber放回调度队列，可以在任意线程调用
+    void wake();
+
+    [[nodiscard]] Stack stack() const { return stack_; }
+
+private:
+    static void entry(Transfer transfer);
+    void switchOut();
+
+private:
+    Scheduler* const scheduler_;
+    const Stack stack_;
+    pl::Task fn_;
+    // fiber挂起时保存的上下文
+    ContextPtr context_{nullptr};
+    // 执行fiber的worker的上下文，每次resume都可能不同
+    ContextPtr caller_{nullptr};
+    // 只在开启ASan时使用
+    const void* caller_bottom_{nullptr};
+    std::size_t caller_size_{0};
+    void* fake_stack_{nullptr};
+    Spinlock* unlock_after_switch_{nullptr};
+    bool reschedule_{false};
+    bool done_{false};
+};
+
+/**
+ * @brief 当前线程上正在执行的fiber，不在fiber中时返回nullptr。
+ * fiber恢复执行时可能已经换了线程，不能在切换前后复用thread_local变量的地址，
+ * 所以每次都通过这个不会被内联的函数获取
+ */
+Fiber* currentFiber();
+
+} // namespace detail
+
+/**
+ * @class Scheduler
+ * @brief M:N的fiber调度器，fiber作为任务运行在WorkStealingPool上，挂起的fiber被唤醒时重新
+ * 提交到线程池，可能被其他worker窃取执行。fiber的栈从StackPool分配，结束后回收复用
+ */
+class Scheduler {
+public:
+    explicit Scheduler(std::size_t threads = std::thread::hardware_concurrency(),
+                       std::size_t stack_size = StackPool::DEFAULT_STACK_SIZE);
+
+    // 等待所有fiber执行结束，因此不能有永远阻塞的fiber
+    ~Scheduler();
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    template <typename F> void spawn(F&& fn) { spawnTask(pl::Task(std::forward<F>(fn))); }
+
+    // 阻塞等待所有fiber执行结束，不能在fiber中调用
+    void join();
+
+    [[nodiscard]] std::size_t size() const { return pool_.size(); }
+
+    // 还没有结束的fiber的个数
+    [[nodiscard]] std::size_t alive() const { return alive_.load(std::memory_order_acquire); }
+
+    [[nodiscard]] const StackPool& stackPool() const { return stacks_; }
+
+private:
+    friend class detail::Fiber;
+
+    void spawnTask(pl::Task fn);
+    void schedule(detail::Fiber* fiber);
+    void finish(detail::Fiber* fiber);
+
+private:
+    StackPool stacks_;
+    std::atomic<std::size_t> alive_{0};
+    // 放在最后，先于stacks_析构
+    WorkStealingPool pool_;
+};
+
+namespace this_fiber {
+
+void yield();
+
+[[nodiscard]] inline bool inFiber() { return detail::currentFiber() != nullptr; }
+
+} // namespace this_fiber
+
+} // namespace pl::fiber
@@ -0,0 +1,220 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/fiber/channel.h"
+#include "cpp/pl/fiber/context.h"
+#include "cpp/pl/fiber/fiber.h"
+#include "cpp/pl/fiber/stack.h"
+#include "cpp/pl/fiber/sync.h"
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+struct PingPong {
+    pl::fiber::ContextPtr main{nullptr};
+    int count{0};
+};
+
+void pingPongEntry(pl::fiber::Transfer transfer) {
+    auto* state = static_cast<PingPong*>(transfer.data);
+    state->main = transfer.context;
+    for (;;) {
+        ++state->count;
+        state->main = pl::fiber::pl_jump_context(state->main, nullptr).context;
+    }
+}
+
+} // namespace
+
+TEST(FiberTest, context) {
+    pl::fiber::StackPool pool(64 * 1024);
+    pl::fiber::Stack stack = pool.allocate();
+    PingPong state;
+    pl::fiber::ContextPtr ctx = pl::fiber::pl_make_context(stack.top, stack.size, pingPongEntry);
+    for (int i = 1; i <= 100; ++i) {
+        ctx = pl::fiber::pl_jump_context(ctx, &state).context;
+        EXPECT_EQ(state.count, i);
+    }
+    pool.deallocate(stack);
+}
+
+TEST(FiberTest, stack_pool) {
+    pl::fiber::StackPool pool(10000, 2);
+    EXPECT_EQ(pool.stackSize() % 4096, 0);
+    EXPECT_GE(pool.stackSize(), 10000);
+
+    pl::fiber::Stack a = pool.allocate();
+    pl::fiber::Stack b = pool.allocate();
+    pl::fiber::Stack c = pool.allocate();
+    // 整个栈都是可写的
+    static_cast<char*>(a.top)[-1] = 1;
+    static_cast<char*>(a.top)[-static_cast<std::ptrdiff_t>(a.size)] = 1;
+    pool.deallocate(a);
+    pool.deallocate(b);
+    pool.deallocate(c);
+    EXPECT_EQ(pool.cached(), 2);
+    pl::fiber::Stack d = pool.allocate();
+    EXPECT_EQ(d.top, b.top);
+    pool.deallocate(d);
+}
+
+TEST(FiberTest, guard_page) {
+    pl::fiber::StackPool pool;
+    pl::fiber::Stack stack = pool.allocate();
+    auto* below = static_cast<volatile char*>(stack.top) - stack.size - 1;
+    EXPECT_DEATH(*below = 1, "");
+    pool.deallocate(stack);
+}
+
+TEST(FiberTest, spawn_and_yield) {
+    pl::fiber::Scheduler scheduler(4);
+    std::atomic<int> count{0};
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    for (int i = 0; i < 1000; ++i) {
+        scheduler.spawn([&]() {
+            for (int j = 0; j < 10; ++j) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    threads.insert(std::this_thread::get_id());
+                }
+                pl::fiber::this_fiber::yield();
+            }
+            count.fetch_add(1);
+        });
+    }
+    scheduler.join();
+    EXPECT_EQ(count.load(), 1000);
+    EXPECT_EQ(scheduler.alive(), 0);
+    EXPECT_FALSE(threads.empty());
+    // 栈被回收复用，不会为每个fiber保留一个栈
+    EXPECT_GT(scheduler.stackPool().cached(), 0);
+}
+
+TEST(FiberTest, nested_spawn) {
+    pl::fiber::Scheduler scheduler(2);
+    std::atomic<int> count{0};
+    scheduler.spawn([&]() {
+        for (int i = 0; i < 100; ++i) {
+            scheduler.spawn([&]() { count.fetch_add(1); });
+        }
+    });
+    scheduler.join();
+    EXPECT_EQ(count.load(), 100);
+}
+
+TEST(FiberTest, mutex) {
+    pl::fiber::Scheduler scheduler(4);
+    pl::fiber::Mutex mutex;
+    int64_t counter = 0;
+    for (int i = 0; i < 100; ++i) {
+        scheduler.spawn([&]() {
+            for (int j = 0; j < 1000; ++j) {
+                std::lock_guard<pl::fiber::Mutex> lock(mutex);
+                ++counter;
+                if (j % 100 == 0) {
+                    // 持有锁时挂起，其他fiber会阻塞在锁上
+                    pl::fiber::this_fiber::yield();
+                }
+            }
+        });
+    }
+    scheduler.join();
+    EXPECT_EQ(counter, 100000);
+}
+
+TEST(FiberTest, condition_variable) {
+    pl::fiber::Scheduler scheduler(4);
+    pl::fiber::Mutex mutex;
+    pl::fiber::ConditionVariable cv;
+    bool ready = false;
+    std::atomic<int> woken{0};
+    for (int i = 0; i < 50; ++i) {
+        scheduler.spawn([&]() {
+            std::unique_lock<pl::fiber::Mutex> lock(mutex);
+            cv.wait(lock, [&]() { return ready; });
+            woken.fetch_add(1);
+        });
+    }
+    scheduler.spawn([&]() {
+        for (int i = 0; i < 10; ++i) {
+            pl::fiber::this_fiber::yield();
+        }
+        {
+            std::lock_guard<pl::fiber::Mutex> lock(mutex);
+            ready = true;
+        }
+        cv.notify_all();
+    });
+    scheduler.join();
+    EXPECT_EQ(woken.load(), 50);
+}
+
+TEST(FiberTest, channel) {
+    pl::fiber::Scheduler scheduler(4);
+    pl::fiber::Channel<int> channel(8);
+    constexpr int PRODUCERS = 4;
+    constexpr int ITEMS = 10000;
+    std::atomic<int> producers{PRODUCERS};
+    std::atomic<int64_t> sum{0};
+    std::atomic<int> received{0};
+
+    for (int p = 0; p < PRODUCERS; ++p) {
+        scheduler.spawn([&, p]() {
+            for (int i = 0; i < ITEMS; ++i) {
+                EXPECT_TRUE(channel.send(p * ITEMS + i));
+            }
+            if (producers.fetch_sub(1) == 1) {
+                channel.close();
+            }
+        });
+    }
+    for (int c = 0; c < 3; ++c) {
+        scheduler.spawn([&]() {
+            while (auto value = channel.recv()) {
+                sum.fetch_add(*value);
+                received.fetch_add(1);
+            }
+        });
+    }
+    scheduler.join();
+
+    constexpr int64_t N = PRODUCERS * ITEMS;
+    EXPECT_EQ(received.load(), N);
+    EXPECT_EQ(sum.load(), N * (N - 1) / 2);
+
+    scheduler.spawn([&]() {
+        EXPECT_FALSE(channel.send(0));
+        EXPECT_FALSE(channel.recv().has_value());
+    });
+    scheduler.join();
+}
+
+TEST(FiberTest, exception) {
+    pl::fiber::Scheduler scheduler(1);
+    std::atomic<bool> after{false};
+    scheduler.spawn([]() { throw std::runtime_error("oops"); });
+    scheduler.spawn([&]() { after = true; });
+    scheduler.join();
+    EXPECT_TRUE(after.load());
+}
@@ -0,0 +1,89 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/fiber/stack.h"
+
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace pl::fiber {
+
+namespace {
+
+std::size_t roundUp(std::size_t n, std::size_t align) { return (n + align - 1) / align * align; }
+
+} // namespace
+
+StackPool::StackPool(std::size_t stack_size, std::size_t max_cached)
+    : page_size_(static_cast<std::size_t>(::sysconf(_SC_PAGESIZE))),
+      stack_size_(roundUp(stack_size, page_size_)),
+      max_cached_(max_cached) {}
+
+StackPool::~StackPool() {
+    for (const auto& stack : free_) {
+        unmap(stack);
+    }
+}
+
+Stack StackPool::allocate() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!free_.empty()) {
+            Stack stack = free_.back();
+            free_.pop_back();
+            return stack;
+        }
+    }
+
+    std::size_t mapped = stack_size_ + page_size_;
+    void* mem = ::mmap(nullptr, mapped, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+    if (mem == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    if (::mprotect(mem, page_size_, PROT_NONE) != 0) {
+        ::munmap(mem, mapped);
+        throw std::bad_alloc();
+    }
+    return {static_cast<char*>(mem) + mapped, stack_size_};
+}
+
+void StackPool::deallocate(Stack stack) {
+    if (!stack.valid()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_.size() < max_cached_) {
+            free_.push_back(stack);
+            return;
+        }
+    }
+    unmap(stack);
+}
+
+std::size_t StackPool::cached() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return free_.size();
+}
+
+void StackPool::unmap(Stack stack) const {
+    std::size_t mapped = stack.size + page_size_;
+    ::munmap(static_cast<char*>(stack.top) - mapped, mapped);
+}
+
+} // namespace pl::fiber
@@ -0,0 +1,69 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace pl::fiber {
+
+struct Stack {
+    // 栈向低地址增长，top是可用区域的最高地址
+    void* top{nullptr};
+    std::size_t size{0};
+
+    [[nodiscard]] bool valid() const { return top != nullptr; }
+};
+
+/**
+ * @class StackPool
+ * @brief mmap分配的协程栈，最低地址处有一个不可访问的保护页，栈溢出时直接触发SIGSEGV
+ * 而不是悄悄地写坏相邻的内存。释放的栈缓存起来复用，避免频繁的mmap/munmap
+ */
+class StackPool {
+public:
+    // size会向上对齐到页大小，不包括保护页
+    explicit StackPool(std::size_t stack_size = DEFAULT_STACK_SIZE, std::size_t max_cached = 1024);
+    ~StackPool();
+
+    StackPool(const StackPool&) = delete;
+    StackPool& operator=(const StackPool&) = delete;
+
+    // 失败时抛出std::bad_alloc
+    Stack allocate();
+
+    void deallocate(Stack stack);
+
+    [[nodiscard]] std::size_t stackSize() const { return stack_size_; }
+
+    [[nodiscard]] std::size_t cached() const;
+
+    static constexpr std::size_t DEFAULT_STACK_SIZE = 256 * 1024;
+
+private:
+    void unmap(Stack stack) const;
+
+private:
+    const std::size_t page_size_;
+    const std::size_t stack_size_;
+    const std::size_t max_cached_;
+    mutable std::mutex mutex_;
+    std::vector<Stack> free_;
+};
+
+} // namespace pl::fiber
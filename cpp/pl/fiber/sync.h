@@ -0,0 +1,133 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include "cpp/pl/fiber/fiber.h"
+
+#include <cassert>
+#include <deque>
+#include <mutex>
+
+/**
+ * fiber感知的同步原语，阻塞时只挂起当前fiber，worker线程会继续执行其他fiber。
+ * 只能在fiber中使用
+ */
+namespace pl::fiber {
+
+class Mutex {
+public:
+    Mutex() = default;
+    Mutex(const Mutex&) = delete;
+    Mutex& operator=(const Mutex&) = delete;
+
+    void lock() {
+        detail::Fiber* fiber = detail::currentFiber();
+        assert(fiber != nullptr);
+        lock_.lock();
+        if (!locked_) {
+            locked_ = true;
+            lock_.unlock();
+            return;
+        }
+        waiters_.push_back(fiber);
+        // 被唤醒时锁已经直接转交给了当前fiber
+        fiber->suspend(&lock_);
+    }
+
+    bool try_lock() {
+        std::lock_guard<detail::Spinlock> guard(lock_);
+        if (locked_) {
+            return false;
+        }
+        locked_ = true;
+        return true;
+    }
+
+    void unlock() {
+        detail::Fiber* next = nullptr;
+        {
+            std::lock_guard<detail::Spinlock> guard(lock_);
+            assert(locked_);
+            if (waiters_.empty()) {
+                locked_ = false;
+                return;
+            }
+            next = waiters_.front();
+            waiters_.pop_front();
+        }
+        next->wake();
+    }
+
+private:
+    detail::Spinlock lock_;
+    bool locked_{false};
+    std::deque<detail::Fiber*> waiters_;
+};
+
+class ConditionVariable {
+public:
+    ConditionVariable() = default;
+    ConditionVariable(const ConditionVariable&) = delete;
+    ConditionVariable& operator=(const ConditionVariable&) = delete;
+
+    void wait(std::unique_lock<Mutex>& lock) {
+        detail::Fiber* fiber = detail::currentFiber();
+        assert(fiber != nullptr);
+        // 先进入等待队列再释放mutex，避免错过释放mutex之后到挂起之前的通知
+        lock_.lock();
+        waiters_.push_back(fiber);
+        lock.unlock();
+        fiber->suspend(&lock_);
+        lock.lock();
+    }
+
+    template <typename Predicate> void wait(std::unique_lock<Mutex>& lock, Predicate pred) {
+        while (!pred()) {
+            wait(lock);
+        }
+    }
+
+    void notify_one() {
+        detail::Fiber* fiber = nullptr;
+        {
+            std::lock_guard<detail::Spinlock> guard(lock_);
+            if (waiters_.empty()) {
+                return;
+            }
+            fiber = waiters_.front();
+            waiters_.pop_front();
+        }
+        fiber->wake();
+    }
+
+    void notify_all() {
+        std::deque<detail::Fiber*> waiters;
+        {
+            std::lock_guard<detail::Spinlock> guard(lock_);
+            waiters.swap(waiters_);
+        }
+        for (auto* fiber : waiters) {
+            fiber->wake();
+        }
+    }
+
+private:
+    detail::Spinlock lock_;
+    std::deque<detail::Fiber*> waiters_;
+};
+
+} // namespace pl::fiber
@@ -29,6 +29,9 @@ class FileDescriptor : public DisableCopyAndMove {
 public:
     FileDescriptor() = default;
     virtual ~FileDescriptor() = default;
+
+    // 底层的内核文件描述符，用于sendfile/splice这类零拷贝的操作。不是内核文件时返回-1
+    [[nodiscard]] virtual int native_handle() const { return -1; }
 };
 
 using FileDescriptorRef = std::shared_ptr<FileDescriptor>;
@@ -51,6 +51,7 @@ TEST(file_system, posix_filesystem) {
     // open for read
     st = fs->open("/tmp/test.file", O_RDONLY, &fd);
     EXPECT_TRUE(st.ok());
+    EXPECT_GE(fd->native_handle(), 0);
     char buffer[10];
     std::string_view result;
     st = fs->pread(fd, 0, 10, buffer, &result);
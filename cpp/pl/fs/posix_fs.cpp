@@ -51,6 +51,8 @@ public:
         fd_ = -1;
     }
 
+    [[nodiscard]] int native_handle() const override { return fd_; }
+
 private:
     int fd_{-1};
     std::string file_path_;
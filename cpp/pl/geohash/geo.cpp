@@ -49,7 +49,8 @@ bool Geo::geo_get_distance_if_in_rectangle(double width_m,
     if (lat_distance > height_m / 2) {
         return false;
     }
-    double lng_distance = geo_distance(p2, p1);
+    // the same as redis, the longitude distance is measured along the latitude of the point
+    double lng_distance = geo_distance(p2, {p1.lng, p2.lat});
     if (lng_distance > width_m / 2) {
         return false;
     }
@@ -111,7 +112,74 @@ bool Geo::geohash_bouding_box(const GeoHash::GeoShape& shape, GeoHash::Area* bou
 }
 
 void Geo::geohash_cal_area_by_shape(const GeoHash::GeoShape& shape,
-                                    GeoHash::GeoHashRadius* radius) {}
+                                    GeoHash::GeoHashRadius* radius) {
+    GeoHash::Area bounds;
+    geohash_bouding_box(shape, &bounds);
+
+    double lng = shape.center.lng;
+    double lat = shape.center.lat;
+    double radius_meters = shape.type == GeoHash::GeoShape::CIRCULAR_TYPE
+                               ? shape.t.radius
+                               : std::sqrt((shape.t.r.width / 2) * (shape.t.r.width / 2) +
+                                           (shape.t.r.height / 2) * (shape.t.r.height / 2));
+    radius_meters *= shape.conversion;
+
+    uint8_t steps = estimate_steps_by_radius(radius_meters, lat);
+
+    GeoHash::HashBits hash;
+    GeoHash::Area area;
+    GeoHash::Neighbors neighbors;
+    GeoHash::encode_wgs84(lng, lat, steps, &hash);
+    GeoHash::neighbors(&hash, &neighbors);
+    GeoHash::decode_wgs84(hash, &area);
+
+    // check if the step is enough at the limits of the covered area. Sometimes when the search
+    // area is near an edge of the area, the estimated step is not small enough, since one of the
+    // north / south / west / east square is too near to the search area to cover everything.
+    bool decrease_step = false;
+    {
+        GeoHash::Area north;
+        GeoHash::Area south;
+        GeoHash::Area east;
+        GeoHash::Area west;
+        GeoHash::decode_wgs84(neighbors.n, &north);
+        GeoHash::decode_wgs84(neighbors.s, &south);
+        GeoHash::decode_wgs84(neighbors.e, &east);
+        GeoHash::decode_wgs84(neighbors.w, &west);
+
+        if (north.max_lat() < bounds.max_lat() || south.min_lat() > bounds.min_lat() ||
+            east.max_lng() < bounds.max_lng() || west.min_lng() > bounds.min_lng()) {
+            decrease_step = true;
+        }
+    }
+
+    if (steps > 1 && decrease_step) {
+        steps--;
+        GeoHash::encode_wgs84(lng, lat, steps, &hash);
+        GeoHash::neighbors(&hash, &neighbors);
+        GeoHash::decode_wgs84(hash, &area);
+    }
+
+    // exclude the search areas that are useless
+    if (steps >= 2) {
+        if (area.min_lat() < bounds.min_lat()) {
+            neighbors.s = neighbors.sw = neighbors.se = {0, 0};
+        }
+        if (area.max_lat() > bounds.max_lat()) {
+            neighbors.n = neighbors.ne = neighbors.nw = {0, 0};
+        }
+        if (area.min_lng() < bounds.min_lng()) {
+            neighbors.w = neighbors.sw = neighbors.nw = {0, 0};
+        }
+        if (area.max_lng() > bounds.max_lng()) {
+            neighbors.e = neighbors.se = neighbors.ne = {0, 0};
+        }
+    }
+
+    radius->hash = hash;
+    radius->neighbors = neighbors;
+    radius->area = area;
+}
 
 uint64_t Geo::geohash_align52bits(const GeoHash::HashBits& hash) {
     uint64_t bits = hash.bits;
@@ -14,9 +14,12 @@
 
 // Authors: liubang (it.liubang@gmail.com)
 
+#pragma once
+
 #include "geohash.h"
 
 #include <cmath>
+#include <cstddef>
 #include <set>
 
 namespace pl {
@@ -46,7 +49,8 @@ public:
     /**
      * @brief Judge whether a point is in the axis-aligned rectangle, when the distance between a
      * searched point and the center point is less than or equal to height/2 or width /2 in height
-     * and width, the point is the rectangle.
+     * and width, the point is the rectangle. The width is measured along the latitude of the
+     * point like GEOSEARCH BYBOX of redis.
      *
      * @param width_m the rectangle width
      * @param height_m the rectangle height
@@ -61,6 +65,44 @@ public:
                                                  const GeoHash::Point& p2,
                                                  double* distance);
 
+    /**
+     * @brief Batch version of geo_distance over structure-of-arrays lng/lat buffers, out[i] is
+     * the distance between center and (lngs[i], lats[i]). sin/cos are approximated by
+     * polynomials, the relative error is less than 1e-9.
+     */
+    static void geo_distance_batch(const GeoHash::Point& center,
+                                   const double* lngs,
+                                   const double* lats,
+                                   std::size_t n,
+                                   double* out);
+
+    /**
+     * @brief Batch version of geo_get_distance_if_in_radius, the indexes of the points in the
+     * radius are written to selected and their distances to distances
+     *
+     * @return the number of points in the radius
+     */
+    static std::size_t geo_get_distance_if_in_radius_batch(const GeoHash::Point& center,
+                                                           double radius,
+                                                           const double* lngs,
+                                                           const double* lats,
+                                                           std::size_t n,
+                                                           uint32_t* selected,
+                                                           double* distances);
+
+    /**
+     * @brief Batch version of geo_get_distance_if_in_rectangle, the output is the same as
+     * geo_get_distance_if_in_radius_batch
+     */
+    static std::size_t geo_get_distance_if_in_rectangle_batch(double width_m,
+                                                              double height_m,
+                                                              const GeoHash::Point& center,
+                                                              const double* lngs,
+                                                              const double* lats,
+                                                              std::size_t n,
+                                                              uint32_t* selected,
+                                                              double* distances);
+
     /**
      * @brief return the bounding box of the search area by shape
      *
@@ -0,0 +1,254 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "geo.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace pl {
+
+namespace {
+
+constexpr double PI = M_PI;
+constexpr double HALF_PI = M_PI / 2;
+
+// a of the haversine formula is in [0, 1], a rejected point is marked by a larger value
+constexpr double REJECTED = 4.0;
+
+// coefficients of the taylor series of sin, up to x^15. The error is less than 1e-11 in
+// [-pi/2, pi/2]
+constexpr double S1 = -1.0 / 6;
+constexpr double S2 = 1.0 / 120;
+constexpr double S3 = -1.0 / 5040;
+constexpr double S4 = 1.0 / 362880;
+constexpr double S5 = -1.0 / 39916800;
+constexpr double S6 = 1.0 / 6227020800;
+constexpr double S7 = -1.0 / 1307674368000;
+
+struct Center {
+    double lng; // radians
+    double lat; // radians
+    double cos_lat;
+    double d_r;
+};
+
+// sin(x) for x in [-pi/2, pi/2]
+inline double sin_poly(double x) {
+    double x2 = x * x;
+    double p = S7;
+    p = p * x2 + S6;
+    p = p * x2 + S5;
+    p = p * x2 + S4;
+    p = p * x2 + S3;
+    p = p * x2 + S2;
+    p = p * x2 + S1;
+    p = p * x2 + 1.0;
+    return x * p;
+}
+
+// |sin(x)| for x in [-pi, pi]
+inline double abs_sin_poly(double x) {
+    double ax = std::fabs(x);
+    return sin_poly(std::min(ax, PI - ax));
+}
+
+// cos(x) for x in [-pi/2, pi/2]
+inline double cos_poly(double x) { return sin_poly(HALF_PI - std::fabs(x)); }
+
+/**
+ * a[i] of the haversine formula, if max_dlat/max_lng_sin are not negative, the points out of the
+ * rectangle are marked as REJECTED
+ */
+void haversine_scalar(const Center& c,
+                      const double* lngs,
+                      const double* lats,
+                      std::size_t n,
+                      double max_dlat,
+                      double max_lng_sin,
+                      double* a) {
+    for (std::size_t i = 0; i < n; ++i) {
+        double lat = lats[i] * c.d_r;
+        double dlat = lat - c.lat;
+        double u = sin_poly(dlat * 0.5);
+        double v = abs_sin_poly((lngs[i] * c.d_r - c.lng) * 0.5);
+        double cos_lat = cos_poly(lat);
+        a[i] = u * u + c.cos_lat * cos_lat * v * v;
+        if (max_dlat >= 0 && (std::fabs(dlat) > max_dlat || cos_lat * v > max_lng_sin)) {
+            a[i] = REJECTED;
+        }
+    }
+}
+
+#if defined(__x86_64__)
+
+__attribute__((target("avx2,fma"))) inline __m256d sin_poly_avx2(__m256d x) {
+    __m256d x2 = _mm256_mul_pd(x, x);
+    __m256d p = _mm256_set1_pd(S7);
+    p = _mm256_fmadd_pd(p, x2, _mm256_set1_pd(S6));
+    p = _mm256_fmadd_pd(p, x2, _mm256_set1_pd(S5));
+    p = _mm256_fmadd_pd(p, x2, _mm256_set1_pd(S4));
+    p = _mm256_fmadd_pd(p, x2, _mm256_set1_pd(S3));
+    p = _mm256_fmadd_pd(p, x2, _mm256_set1_pd(S2));
+    p = _mm256_fmadd_pd(p, x2, _mm256_set1_pd(S1));
+    p = _mm256_fmadd_pd(p, x2, _mm256_set1_pd(1.0));
+    return _mm256_mul_pd(x, p);
+}
+
+__attribute__((target("avx2,fma"))) inline __m256d abs_avx2(__m256d x) {
+    return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
+}
+
+__attribute__((target("avx2,fma"))) void haversine_avx2(const Center& c,
+                                                         const double* lngs,
+                                                         const double* lats,
+                                                         std::size_t n,
+                                                         double max_dlat,
+                                                         double max_lng_sin,
+                                                         double* a) {
+    const __m256d d_r = _mm256_set1_pd(c.d_r);
+    const __m256d clng = _mm256_set1_pd(c.lng);
+    const __m256d clat = _mm256_set1_pd(c.lat);
+    const __m256d cos_lat = _mm256_set1_pd(c.cos_lat);
+    const __m256d half = _mm256_set1_pd(0.5);
+    const __m256d pi = _mm256_set1_pd(PI);
+    const __m256d half_pi = _mm256_set1_pd(HALF_PI);
+    const __m256d rejected = _mm256_set1_pd(REJECTED);
+    const __m256d vmax_dlat = _mm256_set1_pd(max_dlat);
+    const __m256d vmax_lng_sin = _mm256_set1_pd(max_lng_sin);
+    const bool rectangle = max_dlat >= 0;
+
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d lat = _mm256_mul_pd(_mm256_loadu_pd(lats + i), d_r);
+        __m256d dlat = _mm256_sub_pd(lat, clat);
+        __m256d u = sin_poly_avx2(_mm256_mul_pd(dlat, half));
+        __m256d lng = _mm256_fmsub_pd(_mm256_loadu_pd(lngs + i), d_r, clng);
+        __m256d dlng = abs_avx2(_mm256_mul_pd(lng, half));
+        __m256d v = sin_poly_avx2(_mm256_min_pd(dlng, _mm256_sub_pd(pi, dlng)));
+        __m256d cos_lat2 = sin_poly_avx2(_mm256_sub_pd(half_pi, abs_avx2(lat)));
+        __m256d w = _mm256_mul_pd(_mm256_mul_pd(cos_lat, cos_lat2), _mm256_mul_pd(v, v));
+        __m256d r = _mm256_fmadd_pd(u, u, w);
+        if (rectangle) {
+            __m256d out = _mm256_or_pd(
+                _mm256_cmp_pd(abs_avx2(dlat), vmax_dlat, _CMP_GT_OQ),
+                _mm256_cmp_pd(_mm256_mul_pd(cos_lat2, v), vmax_lng_sin, _CMP_GT_OQ));
+            r = _mm256_blendv_pd(r, rejected, out);
+        }
+        _mm256_storeu_pd(a + i, r);
+    }
+    haversine_scalar(c, lngs + i, lats + i, n - i, max_dlat, max_lng_sin, a + i);
+}
+
+#endif
+
+void haversine(const Center& c,
+               const double* lngs,
+               const double* lats,
+               std::size_t n,
+               double max_dlat,
+               double max_lng_sin,
+               double* a) {
+#if defined(__x86_64__)
+    static const bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    if (avx2) {
+        return haversine_avx2(c, lngs, lats, n, max_dlat, max_lng_sin, a);
+    }
+#endif
+    haversine_scalar(c, lngs, lats, n, max_dlat, max_lng_sin, a);
+}
+
+// the candidates are processed in blocks, so that a[] stays in the l1 cache
+constexpr std::size_t BLOCK_SIZE = 256;
+
+} // namespace
+
+void Geo::geo_distance_batch(const GeoHash::Point& center,
+                             const double* lngs,
+                             const double* lats,
+                             std::size_t n,
+                             double* out) {
+    Center c{deg_rad(center.lng), deg_rad(center.lat), std::cos(deg_rad(center.lat)), D_R};
+    haversine(c, lngs, lats, n, -1, -1, out);
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = 2.0 * EARTH_RADIUS_IN_METERS * std::asin(std::sqrt(std::min(out[i], 1.0)));
+    }
+}
+
+std::size_t Geo::geo_get_distance_if_in_radius_batch(const GeoHash::Point& center,
+                                                     double radius,
+                                                     const double* lngs,
+                                                     const double* lats,
+                                                     std::size_t n,
+                                                     uint32_t* selected,
+                                                     double* distances) {
+    Center c{deg_rad(center.lng), deg_rad(center.lat), std::cos(deg_rad(center.lat)), D_R};
+    // distance <= radius <=> a <= sin^2(radius / 2R), no asin for the rejected points
+    double half_angle = radius / (2.0 * EARTH_RADIUS_IN_METERS);
+    double max_a = half_angle >= HALF_PI ? 1.0 : std::sin(half_angle) * std::sin(half_angle);
+
+    double a[BLOCK_SIZE];
+    std::size_t k = 0;
+    for (std::size_t b = 0; b < n; b += BLOCK_SIZE) {
+        std::size_t m = std::min(BLOCK_SIZE, n - b);
+        haversine(c, lngs + b, lats + b, m, -1, -1, a);
+        for (std::size_t i = 0; i < m; ++i) {
+            if (a[i] <= max_a) {
+                selected[k] = static_cast<uint32_t>(b + i);
+                distances[k] = 2.0 * EARTH_RADIUS_IN_METERS * std::asin(std::sqrt(a[i]));
+                ++k;
+            }
+        }
+    }
+    return k;
+}
+
+std::size_t Geo::geo_get_distance_if_in_rectangle_batch(double width_m,
+                                                        double height_m,
+                                                        const GeoHash::Point& center,
+                                                        const double* lngs,
+                                                        const double* lats,
+                                                        std::size_t n,
+                                                        uint32_t* selected,
+                                                        double* distances) {
+    Center c{deg_rad(center.lng), deg_rad(center.lat), std::cos(deg_rad(center.lat)), D_R};
+    // the latitude distance is R * |dlat|, the longitude distance is measured along the latitude
+    // of the point like redis: 2R * asin(cos(lat) * |sin(dlng / 2)|)
+    double max_dlat = height_m / 2 / EARTH_RADIUS_IN_METERS;
+    double lng_angle = width_m / 4 / EARTH_RADIUS_IN_METERS;
+    double max_lng_sin = lng_angle >= HALF_PI ? 1.0 : std::sin(lng_angle);
+
+    double a[BLOCK_SIZE];
+    std::size_t k = 0;
+    for (std::size_t b = 0; b < n; b += BLOCK_SIZE) {
+        std::size_t m = std::min(BLOCK_SIZE, n - b);
+        haversine(c, lngs + b, lats + b, m, max_dlat, max_lng_sin, a);
+        for (std::size_t i = 0; i < m; ++i) {
+            if (a[i] != REJECTED) {
+                selected[k] = static_cast<uint32_t>(b + i);
+                distances[k] =
+                    2.0 * EARTH_RADIUS_IN_METERS * std::asin(std::sqrt(std::min(a[i], 1.0)));
+                ++k;
+            }
+        }
+    }
+    return k;
+}
+
+} // namespace pl
@@ -0,0 +1,145 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "geo.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+
+namespace {
+
+using pl::Geo;
+using pl::GeoHash;
+
+constexpr std::size_t N = 1 << 14;
+constexpr GeoHash::Point CENTER = {116.4, 39.9};
+// 半径查询的9个格子中大约一半的候选点在半径内
+constexpr double RADIUS = 20000;
+
+struct Points {
+    std::vector<double> lngs;
+    std::vector<double> lats;
+
+    Points() {
+        std::mt19937_64 rng(41);
+        std::uniform_real_distribution<double> lng(116.1, 116.7);
+        std::uniform_real_distribution<double> lat(39.7, 40.1);
+        for (std::size_t i = 0; i < N; ++i) {
+            lngs.push_back(lng(rng));
+            lats.push_back(lat(rng));
+        }
+    }
+};
+
+const Points& points() {
+    static const Points p;
+    return p;
+}
+
+void set_counters(benchmark::State& state) {
+    state.counters["points/s"] = benchmark::Counter(static_cast<double>(state.iterations() * N),
+                                                    benchmark::Counter::kIsRate);
+}
+
+void BM_DistanceScalar(benchmark::State& state) {
+    const auto& p = points();
+    std::vector<double> out(N);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < N; ++i) {
+            out[i] = Geo::geo_distance(CENTER, {p.lngs[i], p.lats[i]});
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    set_counters(state);
+}
+BENCHMARK(BM_DistanceScalar)->Unit(benchmark::kMicrosecond);
+
+void BM_DistanceBatch(benchmark::State& state) {
+    const auto& p = points();
+    std::vector<double> out(N);
+    for (auto _ : state) {
+        Geo::geo_distance_batch(CENTER, p.lngs.data(), p.lats.data(), N, out.data());
+        benchmark::DoNotOptimize(out.data());
+    }
+    set_counters(state);
+}
+BENCHMARK(BM_DistanceBatch)->Unit(benchmark::kMicrosecond);
+
+void BM_RadiusScalar(benchmark::State& state) {
+    const auto& p = points();
+    std::vector<uint32_t> selected(N);
+    std::vector<double> distances(N);
+    for (auto _ : state) {
+        std::size_t k = 0;
+        for (std::size_t i = 0; i < N; ++i) {
+            if (Geo::geo_get_distance_if_in_radius(CENTER, {p.lngs[i], p.lats[i]}, RADIUS,
+                                                   &distances[k])) {
+                selected[k++] = static_cast<uint32_t>(i);
+            }
+        }
+        benchmark::DoNotOptimize(k);
+    }
+    set_counters(state);
+}
+BENCHMARK(BM_RadiusScalar)->Unit(benchmark::kMicrosecond);
+
+void BM_RadiusBatch(benchmark::State& state) {
+    const auto& p = points();
+    std::vector<uint32_t> selected(N);
+    std::vector<double> distances(N);
+    for (auto _ : state) {
+        auto k = Geo::geo_get_distance_if_in_radius_batch(CENTER, RADIUS, p.lngs.data(),
+                                                          p.lats.data(), N, selected.data(),
+                                                          distances.data());
+        benchmark::DoNotOptimize(k);
+    }
+    set_counters(state);
+}
+BENCHMARK(BM_RadiusBatch)->Unit(benchmark::kMicrosecond);
+
+void BM_RectangleScalar(benchmark::State& state) {
+    const auto& p = points();
+    std::vector<uint32_t> selected(N);
+    std::vector<double> distances(N);
+    for (auto _ : state) {
+        std::size_t k = 0;
+        for (std::size_t i = 0; i < N; ++i) {
+            if (Geo::geo_get_distance_if_in_rectangle(2 * RADIUS, RADIUS, CENTER,
+                                                      {p.lngs[i], p.lats[i]}, &distances[k])) {
+                selected[k++] = static_cast<uint32_t>(i);
+            }
+        }
+        benchmark::DoNotOptimize(k);
+    }
+    set_counters(state);
+}
+BENCHMARK(BM_RectangleScalar)->Unit(benchmark::kMicrosecond);
+
+void BM_RectangleBatch(benchmark::State& state) {
+    const auto& p = points();
+    std::vector<uint32_t> selected(N);
+    std::vector<double> distances(N);
+    for (auto _ : state) {
+        auto k = Geo::geo_get_distance_if_in_rectangle_batch(2 * RADIUS, RADIUS, CENTER,
+                                                             p.lngs.data(), p.lats.data(), N,
+                                                             selected.data(), distances.data());
+        benchmark::DoNotOptimize(k);
+    }
+    set_counters(state);
+}
+BENCHMARK(BM_RectangleBatch)->Unit(benchmark::kMicrosecond);
+
+} // namespace
@@ -0,0 +1,124 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "geo.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+namespace pl {
+
+namespace {
+
+// 不是4的整数倍，覆盖AVX2的尾部处理
+constexpr std::size_t N = 10003;
+
+struct Points {
+    std::vector<double> lngs;
+    std::vector<double> lats;
+};
+
+Points random_points(double lng_min, double lng_max, double lat_min, double lat_max) {
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> lng(lng_min, lng_max);
+    std::uniform_real_distribution<double> lat(lat_min, lat_max);
+    Points p;
+    for (std::size_t i = 0; i < N; ++i) {
+        p.lngs.push_back(lng(rng));
+        p.lats.push_back(lat(rng));
+    }
+    return p;
+}
+
+} // namespace
+
+TEST(GeoBatchTest, distance) {
+    // 全球范围，包括跨越180度经线的点
+    auto p = random_points(-180, 180, -85, 85);
+    for (GeoHash::Point center : {GeoHash::Point{116.4, 39.9}, GeoHash::Point{179.9, -60.0},
+                                  GeoHash::Point{-0.1, 0.0}}) {
+        std::vector<double> distances(N);
+        Geo::geo_distance_batch(center, p.lngs.data(), p.lats.data(), N, distances.data());
+        for (std::size_t i = 0; i < N; ++i) {
+            double expected = Geo::geo_distance(center, {p.lngs[i], p.lats[i]});
+            ASSERT_NEAR(expected, distances[i], std::max(expected * 1e-9, 1e-6)) << i;
+        }
+    }
+}
+
+TEST(GeoBatchTest, radius) {
+    auto p = random_points(115, 118, 39, 41);
+    GeoHash::Point center = {116.4, 39.9};
+    for (double radius : {10.0, 1000.0, 50000.0, 1e8}) {
+        std::vector<uint32_t> selected(N);
+        std::vector<double> distances(N);
+        std::size_t n = Geo::geo_get_distance_if_in_radius_batch(
+            center, radius, p.lngs.data(), p.lats.data(), N, selected.data(), distances.data());
+        std::size_t k = 0;
+        for (std::size_t i = 0; i < N; ++i) {
+            double distance;
+            if (Geo::geo_get_distance_if_in_radius(center, {p.lngs[i], p.lats[i]}, radius,
+                                                   &distance)) {
+                ASSERT_LT(k, n);
+                EXPECT_EQ(i, selected[k]);
+                EXPECT_NEAR(distance, distances[k], std::max(distance * 1e-9, 1e-6));
+                ++k;
+            }
+        }
+        EXPECT_EQ(k, n) << radius;
+    }
+}
+
+TEST(GeoBatchTest, rectangle) {
+    auto p = random_points(115, 118, 39, 41);
+    GeoHash::Point center = {116.4, 39.9};
+    std::vector<uint32_t> selected(N);
+    std::vector<double> distances(N);
+    std::size_t n =
+        Geo::geo_get_distance_if_in_rectangle_batch(50000, 20000, center, p.lngs.data(),
+                                                    p.lats.data(), N, selected.data(),
+                                                    distances.data());
+    std::size_t k = 0;
+    for (std::size_t i = 0; i < N; ++i) {
+        double distance;
+        if (Geo::geo_get_distance_if_in_rectangle(50000, 20000, center, {p.lngs[i], p.lats[i]},
+                                                  &distance)) {
+            ASSERT_LT(k, n);
+            EXPECT_EQ(i, selected[k]);
+            EXPECT_NEAR(distance, distances[k], std::max(distance * 1e-9, 1e-6));
+            ++k;
+        }
+    }
+    EXPECT_GT(k, 0U);
+    EXPECT_EQ(k, n);
+}
+
+// 期望的结果按照redis geohashGetDistanceIfInRectangle的计算方式得到，经度方向的距离按照点所在的
+// 纬度计算
+TEST(GeoBatchTest, rectangle_high_latitude) {
+    const std::vector<double> lngs = {25.0, 27.0, 26.0, 27.69, 22.31, 27.60, 22.40, 28.0, 25.0};
+    const std::vector<double> lats = {70.0, 70.0, 69.5, 70.85, 70.85, 69.15, 69.15, 70.0, 70.95};
+    std::vector<uint32_t> selected(lngs.size());
+    std::vector<double> distances(lngs.size());
+    std::size_t n = Geo::geo_get_distance_if_in_rectangle_batch(
+        200000, 200000, {25.0, 70.0}, lngs.data(), lats.data(), lngs.size(), selected.data(),
+        distances.data());
+    selected.resize(n);
+    EXPECT_EQ((std::vector<uint32_t>{0, 1, 2, 3, 4}), selected);
+    EXPECT_NEAR(137771.04, distances[3], 0.01);
+}
+
+} // namespace pl
@@ -0,0 +1,199 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "geo_index.h"
+
+#include <algorithm>
+
+namespace pl {
+
+bool GeoIndex::add(Id id, double lng, double lat) {
+    GeoHash::HashBits hash;
+    if (!GeoHash::encode_wgs84(lng, lat, STEP, &hash)) {
+        return false;
+    }
+    auto [it, inserted] = members_.insert_or_assign(id, Member{seq_, {lng, lat}});
+    if (!inserted) {
+        ++stale_;
+    }
+    pending_.push_back({Geo::geohash_align52bits(hash), id, {lng, lat}, seq_++});
+    return true;
+}
+
+bool GeoIndex::remove(Id id) {
+    if (members_.erase(id) == 0) {
+        return false;
+    }
+    ++stale_;
+    return true;
+}
+
+bool GeoIndex::position(Id id, GeoHash::Point* point) const {
+    auto it = members_.find(id);
+    if (it == members_.end()) {
+        return false;
+    }
+    *point = it->second.point;
+    return true;
+}
+
+void GeoIndex::flush() {
+    if (pending_.empty() && stale_ == 0) {
+        return;
+    }
+    auto is_stale = [this](const Entry& e) {
+        auto it = members_.find(e.id);
+        return it == members_.end() || it->second.seq != e.seq;
+    };
+    if (stale_ > 0) {
+        entries_.erase(std::remove_if(entries_.begin(), entries_.end(), is_stale),
+                       entries_.end());
+        pending_.erase(std::remove_if(pending_.begin(), pending_.end(), is_stale),
+                       pending_.end());
+        stale_ = 0;
+    }
+    std::sort(pending_.begin(), pending_.end());
+    auto mid = static_cast<std::ptrdiff_t>(entries_.size());
+    entries_.insert(entries_.end(), pending_.begin(), pending_.end());
+    std::inplace_merge(entries_.begin(), entries_.begin() + mid, entries_.end());
+    pending_.clear();
+}
+
+void GeoIndex::probes(const GeoHash::GeoShape& shape,
+                      std::vector<std::pair<uint64_t, uint64_t>>* ranges) {
+    GeoHash::GeoHashRadius radius;
+    Geo::geohash_cal_area_by_shape(shape, &radius);
+    const GeoHash::HashBits cells[] = {
+        radius.hash,         radius.neighbors.n,  radius.neighbors.s,
+        radius.neighbors.e,  radius.neighbors.w,  radius.neighbors.ne,
+        radius.neighbors.nw, radius.neighbors.se, radius.neighbors.sw,
+    };
+    std::vector<std::pair<uint64_t, uint64_t>> cover;
+    for (auto cell : cells) {
+        if (cell.is_zero()) {
+            continue;
+        }
+        uint64_t min = Geo::geohash_align52bits(cell);
+        cell.bits++;
+        uint64_t max = Geo::geohash_align52bits(cell);
+        cover.emplace_back(min, max);
+    }
+    // adjacent cells are probed by a single range, and the same cell may be repeated for a huge
+    // radius
+    std::sort(cover.begin(), cover.end());
+    for (const auto& range : cover) {
+        if (!ranges->empty() && range.first <= ranges->back().second) {
+            ranges->back().second = std::max(ranges->back().second, range.second);
+        } else {
+            ranges->push_back(range);
+        }
+    }
+}
+
+std::size_t GeoIndex::filter(const GeoHash::GeoShape& shape) {
+    std::size_t n = lngs_.size();
+    selected_.resize(n);
+    distances_.resize(n);
+    if (shape.type == GeoHash::GeoShape::CIRCULAR_TYPE) {
+        return Geo::geo_get_distance_if_in_radius_batch(
+            shape.center, shape.t.radius * shape.conversion, lngs_.data(), lats_.data(), n,
+            selected_.data(), distances_.data());
+    }
+    return Geo::geo_get_distance_if_in_rectangle_batch(
+        shape.t.r.width * shape.conversion, shape.t.r.height * shape.conversion, shape.center,
+        lngs_.data(), lats_.data(), n, selected_.data(), distances_.data());
+}
+
+void GeoIndex::search(const GeoHash::GeoShape& shape,
+                      const SearchOptions& options,
+                      std::vector<Match>* matches) {
+    flush();
+    matches->clear();
+
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+    probes(shape, &ranges);
+
+    // the ranges are sorted, so every probe starts from where the previous one stopped. The
+    // candidates of a probe are copied to lng/lat buffers and filtered by the batch kernels
+    auto it = entries_.begin();
+    auto by_score = [](const Entry& e, uint64_t score) { return e.score < score; };
+    for (const auto& [min, max] : ranges) {
+        auto begin = std::lower_bound(it, entries_.end(), min, by_score);
+        it = std::lower_bound(begin, entries_.end(), max, by_score);
+        lngs_.clear();
+        lats_.clear();
+        for (auto e = begin; e != it; ++e) {
+            lngs_.push_back(e->point.lng);
+            lats_.push_back(e->point.lat);
+        }
+        std::size_t found = filter(shape);
+        for (std::size_t i = 0; i < found; ++i) {
+            const Entry& e = begin[selected_[i]];
+            matches->push_back({e.id, distances_[i], e.point, e.score});
+        }
+        if (options.any && options.count > 0 && matches->size() >= options.count) {
+            matches->resize(options.count);
+            break;
+        }
+    }
+
+    // COUNT without ANY returns the nearest ones
+    Sort sort = options.sort;
+    if (sort == Sort::NONE && options.count > 0 && !options.any) {
+        sort = Sort::ASC;
+    }
+    if (sort == Sort::NONE) {
+        return;
+    }
+    auto cmp = [sort](const Match& a, const Match& b) {
+        return sort == Sort::ASC ? a.distance < b.distance : a.distance > b.distance;
+    };
+    if (options.count > 0 && matches->size() > options.count) {
+        auto middle = matches->begin() + static_cast<std::ptrdiff_t>(options.count);
+        std::partial_sort(matches->begin(), middle, matches->end(), cmp);
+        matches->erase(middle, matches->end());
+    } else {
+        std::sort(matches->begin(), matches->end(), cmp);
+    }
+}
+
+void GeoIndex::search_radius(const GeoHash::Point& center,
+                             double radius,
+                             const SearchOptions& options,
+                             std::vector<Match>* matches) {
+    GeoHash::GeoShape shape{};
+    shape.type = GeoHash::GeoShape::CIRCULAR_TYPE;
+    shape.center = center;
+    shape.conversion = 1;
+    shape.t.radius = radius;
+    search(shape, options, matches);
+}
+
+void GeoIndex::search_box(const GeoHash::Point& center,
+                          double width,
+                          double height,
+                          const SearchOptions& options,
+                          std::vector<Match>* matches) {
+    GeoHash::GeoShape shape{};
+    shape.type = GeoHash::GeoShape::RECTANGLE_TYPE;
+    shape.center = center;
+    shape.conversion = 1;
+    shape.t.r.width = width;
+    shape.t.r.height = height;
+    search(shape, options, matches);
+}
+
+} // namespace pl
@@ -0,0 +1,157 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include "geo.h"
+#include "geohash.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace pl {
+
+/**
+ * @class GeoIndex
+ * @brief In-memory geo index like the GEO commands of redis. Members are sorted by the 52 bits
+ * geohash score, a radius or box search probes the score ranges of the 9 covering cells and
+ * filters the candidates by the exact distance.
+ *
+ * Additions are buffered and merged into the sorted entries by the next search, so bulk loading
+ * is a sort instead of a sorted insertion per member. Not thread-safe.
+ */
+class GeoIndex {
+public:
+    using Id = uint64_t;
+
+    enum class Sort {
+        NONE,
+        ASC,
+        DESC,
+    };
+
+    struct SearchOptions {
+        Sort sort = Sort::NONE;
+        // max number of results, 0 means unlimited
+        std::size_t count = 0;
+        // return as soon as count matches are found, they are not the nearest ones
+        bool any = false;
+    };
+
+    struct Match {
+        Id id;
+        double distance; // meters
+        GeoHash::Point point;
+        uint64_t score;
+    };
+
+public:
+    /**
+     * @brief Add a member, or update the position of an existing one
+     *
+     * @return false if the position is out of the wgs84 range of geohash
+     */
+    bool add(Id id, double lng, double lat);
+
+    /**
+     * @return false if the member does not exist
+     */
+    bool remove(Id id);
+
+    bool position(Id id, GeoHash::Point* point) const;
+
+    [[nodiscard]] std::size_t size() const { return members_.size(); }
+
+    /**
+     * @brief GEOSEARCH, find the members within the circle or the rectangle of the shape
+     *
+     * @param shape search area, radius/width/height are in shape.conversion meters
+     * @param options
+     * @param matches
+     */
+    void search(const GeoHash::GeoShape& shape,
+                const SearchOptions& options,
+                std::vector<Match>* matches);
+
+    /**
+     * @brief GEORADIUS, radius is in meters
+     */
+    void search_radius(const GeoHash::Point& center,
+                       double radius,
+                       const SearchOptions& options,
+                       std::vector<Match>* matches);
+
+    /**
+     * @brief GEOSEARCH BYBOX, width and height are in meters
+     */
+    void search_box(const GeoHash::Point& center,
+                    double width,
+                    double height,
+                    const SearchOptions& options,
+                    std::vector<Match>* matches);
+
+    /**
+     * @brief Calculate the score ranges [min, max) covering the shape, sorted and merged
+     */
+    static void probes(const GeoHash::GeoShape& shape,
+                       std::vector<std::pair<uint64_t, uint64_t>>* ranges);
+
+private:
+    struct Entry {
+        uint64_t score;
+        Id id;
+        GeoHash::Point point;
+        uint64_t seq;
+
+        bool operator<(const Entry& other) const {
+            return score != other.score ? score < other.score : id < other.id;
+        }
+    };
+
+    // merge the pending additions into entries and drop the stale ones
+    void flush();
+
+    // filter the candidates in lngs_/lats_ by the shape, return the number of selected ones
+    std::size_t filter(const GeoHash::GeoShape& shape);
+
+private:
+    static constexpr uint8_t STEP = 26; // 52 bits
+
+    // sorted by (score, id)
+    std::vector<Entry> entries_;
+    // unsorted additions
+    std::vector<Entry> pending_;
+    struct Member {
+        uint64_t seq;
+        GeoHash::Point point;
+    };
+
+    // the entry of a member with another seq is stale
+    std::unordered_map<Id, Member> members_;
+    uint64_t seq_{0};
+
+    // buffers of the batch filter, reused by searches
+    std::vector<double> lngs_;
+    std::vector<double> lats_;
+    std::vector<uint32_t> selected_;
+    std::vector<double> distances_;
+    // number of entries which are removed or updated, but not dropped yet
+    std::size_t stale_{0};
+};
+
+} // namespace pl
@@ -0,0 +1,134 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "geo_index.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+
+namespace {
+
+using pl::GeoHash;
+using pl::GeoIndex;
+
+constexpr std::size_t N = 4 << 20;
+
+// 北京周边(3° x 2°)均匀分布的点
+const std::vector<GeoHash::Point>& points() {
+    static const std::vector<GeoHash::Point> p = [] {
+        std::mt19937_64 rng(23);
+        std::uniform_real_distribution<double> lng(115.0, 118.0);
+        std::uniform_real_distribution<double> lat(39.0, 41.0);
+        std::vector<GeoHash::Point> v(N);
+        for (auto& pt : v) {
+            pt = {lng(rng), lat(rng)};
+        }
+        return v;
+    }();
+    return p;
+}
+
+GeoIndex& index() {
+    static GeoIndex idx = [] {
+        GeoIndex i;
+        const auto& p = points();
+        for (std::size_t n = 0; n < p.size(); ++n) {
+            i.add(n, p[n].lng, p[n].lat);
+        }
+        // merge the pending additions
+        std::vector<GeoIndex::Match> matches;
+        i.search_radius({116.4, 39.9}, 1, {}, &matches);
+        return i;
+    }();
+    return idx;
+}
+
+void BM_Build(benchmark::State& state) {
+    const auto& p = points();
+    for (auto _ : state) {
+        GeoIndex idx;
+        for (std::size_t n = 0; n < p.size(); ++n) {
+            idx.add(n, p[n].lng, p[n].lat);
+        }
+        std::vector<GeoIndex::Match> matches;
+        idx.search_radius({116.4, 39.9}, 1, {}, &matches);
+        benchmark::DoNotOptimize(matches.data());
+    }
+    state.counters["points/s"] = benchmark::Counter(static_cast<double>(state.iterations() * N),
+                                                    benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Build)->Unit(benchmark::kMillisecond)->Iterations(1);
+
+/**
+ * 随机中心点的半径查询，arg为半径(米)，统计每秒查询数和平均结果数
+ */
+void BM_Radius(benchmark::State& state) {
+    auto& idx = index();
+    double radius = static_cast<double>(state.range(0));
+    std::mt19937_64 rng(29);
+    std::uniform_real_distribution<double> lng(115.5, 117.5);
+    std::uniform_real_distribution<double> lat(39.5, 40.5);
+    std::vector<GeoIndex::Match> matches;
+    std::size_t found = 0;
+    for (auto _ : state) {
+        idx.search_radius({lng(rng), lat(rng)}, radius, {GeoIndex::Sort::ASC}, &matches);
+        found += matches.size();
+    }
+    state.counters["matches"] =
+        static_cast<double>(found) / static_cast<double>(state.iterations());
+    state.counters["qps"] = benchmark::Counter(static_cast<double>(state.iterations()),
+                                               benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Radius)->ArgName("radius")->Arg(100)->Arg(1000)->Arg(10000)->Unit(
+    benchmark::kMicrosecond);
+
+/**
+ * 取最近的10个点
+ */
+void BM_RadiusTopK(benchmark::State& state) {
+    auto& idx = index();
+    double radius = static_cast<double>(state.range(0));
+    std::mt19937_64 rng(31);
+    std::uniform_real_distribution<double> lng(115.5, 117.5);
+    std::uniform_real_distribution<double> lat(39.5, 40.5);
+    std::vector<GeoIndex::Match> matches;
+    for (auto _ : state) {
+        idx.search_radius({lng(rng), lat(rng)}, radius, {.count = 10}, &matches);
+        benchmark::DoNotOptimize(matches.data());
+    }
+    state.counters["qps"] = benchmark::Counter(static_cast<double>(state.iterations()),
+                                               benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_RadiusTopK)->ArgName("radius")->Arg(1000)->Arg(10000)->Unit(
+    benchmark::kMicrosecond);
+
+void BM_Box(benchmark::State& state) {
+    auto& idx = index();
+    double size = static_cast<double>(state.range(0));
+    std::mt19937_64 rng(37);
+    std::uniform_real_distribution<double> lng(115.5, 117.5);
+    std::uniform_real_distribution<double> lat(39.5, 40.5);
+    std::vector<GeoIndex::Match> matches;
+    for (auto _ : state) {
+        idx.search_box({lng(rng), lat(rng)}, size, size, {}, &matches);
+        benchmark::DoNotOptimize(matches.data());
+    }
+    state.counters["qps"] = benchmark::Counter(static_cast<double>(state.iterations()),
+                                               benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Box)->ArgName("size")->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+} // namespace
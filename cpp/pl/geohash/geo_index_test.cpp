@@ -0,0 +1,177 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "geo_index.h"
+#include "geo_test_util.h"
+
+#include <gtest/gtest.h>
+#include <set>
+
+namespace pl {
+
+namespace {
+
+// 高纬度的矩形中，经度方向的距离按照点所在的纬度计算。期望的结果按照redis
+// geohashGetDistanceIfInRectangle的计算方式得到
+const std::vector<std::pair<GeoHash::Point, bool>>& high_latitude_box() {
+    static const std::vector<std::pair<GeoHash::Point, bool>> points = {
+        {{25.0, 70.0}, true},    {{27.0, 70.0}, true},    {{26.0, 69.5}, true},
+        {{27.69, 70.85}, true},  {{22.31, 70.85}, true},  {{27.60, 69.15}, false},
+        {{22.40, 69.15}, false}, {{28.0, 70.0}, false},   {{25.0, 70.95}, false},
+    };
+    return points;
+}
+
+} // namespace
+
+TEST(GeoIndexTest, radius) {
+    auto points = random_points(20000, 1);
+    GeoIndex index;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        ASSERT_TRUE(index.add(i, points[i].lng, points[i].lat));
+    }
+    EXPECT_EQ(points.size(), index.size());
+
+    for (double radius : {100.0, 5000.0, 50000.0}) {
+        GeoHash::Point center = {116.4, 39.9};
+        std::vector<GeoIndex::Match> matches;
+        index.search_radius(center, radius, {GeoIndex::Sort::ASC}, &matches);
+
+        std::set<GeoIndex::Id> expected;
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            if (Geo::geo_distance(center, points[i]) <= radius) {
+                expected.insert(i);
+            }
+        }
+        std::set<GeoIndex::Id> actual;
+        for (std::size_t i = 0; i < matches.size(); ++i) {
+            actual.insert(matches[i].id);
+            EXPECT_LE(matches[i].distance, radius);
+            if (i > 0) {
+                EXPECT_LE(matches[i - 1].distance, matches[i].distance);
+            }
+        }
+        EXPECT_EQ(expected, actual) << radius;
+    }
+}
+
+TEST(GeoIndexTest, box) {
+    auto points = random_points(20000, 2);
+    GeoIndex index;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        index.add(i, points[i].lng, points[i].lat);
+    }
+    GeoHash::Point center = {116.4, 39.9};
+    std::vector<GeoIndex::Match> matches;
+    index.search_box(center, 20000, 10000, {}, &matches);
+
+    std::set<GeoIndex::Id> expected;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        double distance;
+        if (Geo::geo_get_distance_if_in_rectangle(20000, 10000, center, points[i], &distance)) {
+            expected.insert(i);
+        }
+    }
+    std::set<GeoIndex::Id> actual;
+    for (const auto& m : matches) {
+        actual.insert(m.id);
+    }
+    EXPECT_FALSE(expected.empty());
+    EXPECT_EQ(expected, actual);
+}
+
+TEST(GeoIndexTest, rectangle_high_latitude) {
+    GeoHash::Point center = {25.0, 70.0};
+    for (const auto& [point, in] : high_latitude_box()) {
+        double distance;
+        EXPECT_EQ(in, Geo::geo_get_distance_if_in_rectangle(200000, 200000, center, point,
+                                                            &distance))
+            << point;
+    }
+}
+
+TEST(GeoIndexTest, box_high_latitude) {
+    GeoIndex index;
+    const auto& points = high_latitude_box();
+    std::set<GeoIndex::Id> expected;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        index.add(i, points[i].first.lng, points[i].first.lat);
+        if (points[i].second) {
+            expected.insert(i);
+        }
+    }
+    std::vector<GeoIndex::Match> matches;
+    index.search_box({25.0, 70.0}, 200000, 200000, {}, &matches);
+    std::set<GeoIndex::Id> actual;
+    for (const auto& m : matches) {
+        actual.insert(m.id);
+    }
+    EXPECT_EQ(expected, actual);
+}
+
+TEST(GeoIndexTest, count) {
+    auto points = random_points(20000, 3);
+    GeoIndex index;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        index.add(i, points[i].lng, points[i].lat);
+    }
+    GeoHash::Point center = {116.4, 39.9};
+    std::vector<GeoIndex::Match> all;
+    index.search_radius(center, 20000, {GeoIndex::Sort::DESC}, &all);
+    ASSERT_GT(all.size(), 10U);
+
+    // the nearest ones
+    std::vector<GeoIndex::Match> top;
+    index.search_radius(center, 20000, {.count = 10}, &top);
+    ASSERT_EQ(10U, top.size());
+    for (std::size_t i = 0; i < top.size(); ++i) {
+        EXPECT_EQ(all[all.size() - 1 - i].id, top[i].id);
+    }
+
+    std::vector<GeoIndex::Match> any;
+    index.search_radius(center, 20000, {.count = 10, .any = true}, &any);
+    EXPECT_EQ(10U, any.size());
+}
+
+TEST(GeoIndexTest, update) {
+    GeoIndex index;
+    EXPECT_TRUE(index.add(1, 116.40, 39.90));
+    EXPECT_TRUE(index.add(2, 116.41, 39.91));
+    EXPECT_FALSE(index.add(3, 116.40, 89.0));
+
+    std::vector<GeoIndex::Match> matches;
+    index.search_radius({116.40, 39.90}, 5000, {}, &matches);
+    EXPECT_EQ(2U, matches.size());
+
+    // move 2 far away, then remove 1
+    EXPECT_TRUE(index.add(2, 121.47, 31.23));
+    EXPECT_TRUE(index.remove(1));
+    EXPECT_FALSE(index.remove(1));
+    EXPECT_EQ(1U, index.size());
+    index.search_radius({116.40, 39.90}, 5000, {}, &matches);
+    EXPECT_TRUE(matches.empty());
+
+    index.search_radius({121.47, 31.23}, 100, {}, &matches);
+    ASSERT_EQ(1U, matches.size());
+    EXPECT_EQ(2U, matches[0].id);
+
+    GeoHash::Point point;
+    EXPECT_TRUE(index.position(2, &point));
+    EXPECT_DOUBLE_EQ(121.47, point.lng);
+    EXPECT_FALSE(index.position(1, &point));
+}
+
+} // namespace pl
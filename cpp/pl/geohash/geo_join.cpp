@@ -0,0 +1,115 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "geo_join.h"
+
+#include "geo_index.h"
+
+#include <algorithm>
+
+namespace pl {
+
+GeoJoin::GeoJoin(std::vector<GeoHash::GeoShape> fences) : fences_(std::move(fences)) {
+    std::vector<std::pair<uint64_t, uint64_t>> probes;
+    for (std::size_t i = 0; i < fences_.size(); ++i) {
+        probes.clear();
+        GeoIndex::probes(fences_[i], &probes);
+        for (const auto& [min, max] : probes) {
+            ranges_.push_back({min, max, i});
+        }
+    }
+    std::sort(ranges_.begin(), ranges_.end(), [](const Range& a, const Range& b) {
+        return a.min != b.min ? a.min < b.min : a.fence < b.fence;
+    });
+}
+
+std::size_t GeoJoin::filter(const GeoHash::GeoShape& fence, std::size_t begin, std::size_t end) {
+    std::size_t n = end - begin;
+    if (selected_.size() < n) {
+        selected_.resize(n);
+        distances_.resize(n);
+    }
+    if (fence.type == GeoHash::GeoShape::CIRCULAR_TYPE) {
+        return Geo::geo_get_distance_if_in_radius_batch(
+            fence.center, fence.t.radius * fence.conversion, lngs_.data() + begin,
+            lats_.data() + begin, n, selected_.data(), distances_.data());
+    }
+    return Geo::geo_get_distance_if_in_rectangle_batch(
+        fence.t.r.width * fence.conversion, fence.t.r.height * fence.conversion, fence.center,
+        lngs_.data() + begin, lats_.data() + begin, n, selected_.data(), distances_.data());
+}
+
+void GeoJoin::join(const std::vector<GeoHash::Point>& points,
+                   std::vector<Pair>* pairs,
+                   Stats* stats) {
+    pairs->clear();
+    std::size_t n = points.size();
+
+    // sort the points by score, the invalid ones are dropped
+    lngs_.resize(n);
+    lats_.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        lngs_[i] = points[i].lng;
+        lats_[i] = points[i].lat;
+    }
+    std::vector<GeoHash::HashBits> hashes(n);
+    GeoHash::encode_batch_wgs84(lngs_.data(), lats_.data(), n, STEP, hashes.data());
+    std::vector<std::pair<uint64_t, std::size_t>> sorted;
+    sorted.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (!hashes[i].is_zero()) {
+            sorted.emplace_back(Geo::geohash_align52bits(hashes[i]), i);
+        }
+    }
+    std::sort(sorted.begin(), sorted.end());
+    std::size_t m = sorted.size();
+    scores_.resize(m);
+    order_.resize(m);
+    for (std::size_t i = 0; i < m; ++i) {
+        const auto& p = points[sorted[i].second];
+        scores_[i] = sorted[i].first;
+        order_[i] = sorted[i].second;
+        lngs_[i] = p.lng;
+        lats_[i] = p.lat;
+    }
+    lngs_.resize(m);
+    lats_.resize(m);
+
+    // the ranges are sorted by min, so the first point of a range never moves backwards
+    Stats total;
+    total.ranges = ranges_.size();
+    auto first = scores_.begin();
+    for (const auto& range : ranges_) {
+        first = std::lower_bound(first, scores_.end(), range.min);
+        auto last = std::lower_bound(first, scores_.end(), range.max);
+        if (first == last) {
+            continue;
+        }
+        auto begin = static_cast<std::size_t>(first - scores_.begin());
+        auto end = static_cast<std::size_t>(last - scores_.begin());
+        total.candidates += end - begin;
+        std::size_t found = filter(fences_[range.fence], begin, end);
+        for (std::size_t i = 0; i < found; ++i) {
+            pairs->push_back({order_[begin + selected_[i]], range.fence, distances_[i]});
+        }
+    }
+    total.matched = pairs->size();
+    if (stats != nullptr) {
+        *stats = total;
+    }
+}
+
+} // namespace pl
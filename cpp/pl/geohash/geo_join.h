@@ -0,0 +1,97 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include "geo.h"
+#include "geohash.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pl {
+
+/**
+ * @class GeoJoin
+ * @brief Spatial join of points against fences (circles and rectangles) on the 52 bits geohash
+ * score. Every fence is expanded into the score ranges of its covering cells, and the ranges of
+ * all fences are sorted once. A join sorts the points by score and merges the two sorted sides,
+ * so every range meets the run of points inside it, and the run is refined by the exact distance
+ * with the batch kernels of Geo. No fence is compared with the points outside of its cells.
+ *
+ * Not thread-safe, the buffers of the refinement are reused by joins.
+ */
+class GeoJoin {
+public:
+    struct Pair {
+        std::size_t point; // index in the joined points
+        std::size_t fence; // index in the fences
+        double distance;   // meters, from the center of the fence
+    };
+
+    struct Stats {
+        uint64_t ranges{0};     // score ranges of the fences
+        uint64_t candidates{0}; // points inside the ranges
+        uint64_t matched{0};
+    };
+
+public:
+    /**
+     * @param fences radius/width/height are in shape.conversion meters
+     */
+    explicit GeoJoin(std::vector<GeoHash::GeoShape> fences);
+
+    /**
+     * @brief Find all (point, fence) pairs that the point is inside the fence, the pairs of a
+     * fence are ordered by the score of the points. Points out of the wgs84 range of geohash
+     * match nothing.
+     */
+    void join(const std::vector<GeoHash::Point>& points,
+              std::vector<Pair>* pairs,
+              Stats* stats = nullptr);
+
+    [[nodiscard]] const std::vector<GeoHash::GeoShape>& fences() const { return fences_; }
+
+private:
+    struct Range {
+        uint64_t min;
+        uint64_t max; // exclusive
+        std::size_t fence;
+    };
+
+    // filter the points [begin, end) of the sorted points by the fence, return the number of
+    // selected ones
+    std::size_t filter(const GeoHash::GeoShape& fence, std::size_t begin, std::size_t end);
+
+private:
+    static constexpr uint8_t STEP = 26; // 52 bits
+
+    std::vector<GeoHash::GeoShape> fences_;
+    // sorted by min
+    std::vector<Range> ranges_;
+
+    // the joined points sorted by score, in structure-of-arrays for the batch kernels
+    std::vector<uint64_t> scores_;
+    std::vector<std::size_t> order_;
+    std::vector<double> lngs_;
+    std::vector<double> lats_;
+    // buffers of the refinement
+    std::vector<uint32_t> selected_;
+    std::vector<double> distances_;
+};
+
+} // namespace pl
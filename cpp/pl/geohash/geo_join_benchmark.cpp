@@ -0,0 +1,128 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "geo_join.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+
+namespace {
+
+using pl::Geo;
+using pl::GeoHash;
+using pl::GeoJoin;
+
+// 北京周边(3° x 2°)均匀分布的车辆位置
+std::vector<GeoHash::Point> points(std::size_t n) {
+    std::mt19937_64 rng(23);
+    std::uniform_real_distribution<double> lng(115.0, 118.0);
+    std::uniform_real_distribution<double> lat(39.0, 41.0);
+    std::vector<GeoHash::Point> v(n);
+    for (auto& p : v) {
+        p = {lng(rng), lat(rng)};
+    }
+    return v;
+}
+
+// 半径或边长在200米到5公里之间的电子围栏，一半圆形一半矩形
+std::vector<GeoHash::GeoShape> fences(std::size_t n) {
+    std::mt19937_64 rng(29);
+    std::uniform_real_distribution<double> lng(115.0, 118.0);
+    std::uniform_real_distribution<double> lat(39.0, 41.0);
+    std::uniform_real_distribution<double> size(200.0, 5000.0);
+    std::vector<GeoHash::GeoShape> v(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        v[i] = {};
+        v[i].center = {lng(rng), lat(rng)};
+        v[i].conversion = 1;
+        if (i % 2 == 0) {
+            v[i].type = GeoHash::GeoShape::CIRCULAR_TYPE;
+            v[i].t.radius = size(rng);
+        } else {
+            v[i].type = GeoHash::GeoShape::RECTANGLE_TYPE;
+            v[i].t.r.width = size(rng);
+            v[i].t.r.height = size(rng);
+        }
+    }
+    return v;
+}
+
+/**
+ * 基于geohash score的sort-merge join，args为点数和围栏数
+ */
+void BM_Join(benchmark::State& state) {
+    auto p = points(state.range(0));
+    GeoJoin join(fences(state.range(1)));
+    std::vector<GeoJoin::Pair> pairs;
+    GeoJoin::Stats stats;
+    for (auto _ : state) {
+        join.join(p, &pairs, &stats);
+        benchmark::DoNotOptimize(pairs.data());
+    }
+    state.counters["candidates"] = static_cast<double>(stats.candidates);
+    state.counters["pairs"] = static_cast<double>(pairs.size());
+    state.counters["points/s"] = benchmark::Counter(
+        static_cast<double>(state.iterations() * p.size()), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Join)
+    ->ArgNames({"points", "fences"})
+    ->Args({100000, 100})
+    ->Args({100000, 1000})
+    ->Args({1000000, 1000})
+    ->Args({1000000, 10000})
+    ->Unit(benchmark::kMillisecond);
+
+/**
+ * nested loop join，每个围栏用batch接口过滤所有的点
+ */
+void BM_NestedLoop(benchmark::State& state) {
+    auto p = points(state.range(0));
+    auto f = fences(state.range(1));
+    std::vector<double> lngs(p.size());
+    std::vector<double> lats(p.size());
+    for (std::size_t i = 0; i < p.size(); ++i) {
+        lngs[i] = p[i].lng;
+        lats[i] = p[i].lat;
+    }
+    std::vector<uint32_t> selected(p.size());
+    std::vector<double> distances(p.size());
+    std::size_t pairs = 0;
+    for (auto _ : state) {
+        pairs = 0;
+        for (const auto& fence : f) {
+            if (fence.type == GeoHash::GeoShape::CIRCULAR_TYPE) {
+                pairs += Geo::geo_get_distance_if_in_radius_batch(
+                    fence.center, fence.t.radius, lngs.data(), lats.data(), p.size(),
+                    selected.data(), distances.data());
+            } else {
+                pairs += Geo::geo_get_distance_if_in_rectangle_batch(
+                    fence.t.r.width, fence.t.r.height, fence.center, lngs.data(), lats.data(),
+                    p.size(), selected.data(), distances.data());
+            }
+        }
+        benchmark::DoNotOptimize(distances.data());
+    }
+    state.counters["pairs"] = static_cast<double>(pairs);
+    state.counters["points/s"] = benchmark::Counter(
+        static_cast<double>(state.iterations() * p.size()), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_NestedLoop)
+    ->ArgNames({"points", "fences"})
+    ->Args({100000, 100})
+    ->Args({100000, 1000})
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
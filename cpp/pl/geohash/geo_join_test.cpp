@@ -0,0 +1,132 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "geo_join.h"
+#include "geo_test_util.h"
+
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+
+namespace pl {
+
+namespace {
+
+// 一半圆形一半矩形
+std::vector<GeoHash::GeoShape> random_fences(std::size_t n, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> lng(115.0, 118.0);
+    std::uniform_real_distribution<double> lat(39.0, 41.0);
+    std::uniform_real_distribution<double> size(100.0, 20000.0);
+    std::vector<GeoHash::GeoShape> fences(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        auto& fence = fences[i];
+        fence = {};
+        fence.center = {lng(rng), lat(rng)};
+        fence.conversion = 1;
+        if (i % 2 == 0) {
+            fence.type = GeoHash::GeoShape::CIRCULAR_TYPE;
+            fence.t.radius = size(rng);
+        } else {
+            fence.type = GeoHash::GeoShape::RECTANGLE_TYPE;
+            fence.t.r.width = size(rng);
+            fence.t.r.height = size(rng);
+        }
+    }
+    return fences;
+}
+
+using PairSet = std::set<std::pair<std::size_t, std::size_t>>;
+
+PairSet nested_loop_join(const std::vector<GeoHash::Point>& points,
+                         const std::vector<GeoHash::GeoShape>& fences) {
+    PairSet result;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        for (std::size_t j = 0; j < fences.size(); ++j) {
+            const auto& fence = fences[j];
+            double distance;
+            bool in = fence.type == GeoHash::GeoShape::CIRCULAR_TYPE
+                          ? Geo::geo_get_distance_if_in_radius(fence.center, points[i],
+                                                               fence.t.radius, &distance)
+                          : Geo::geo_get_distance_if_in_rectangle(
+                                fence.t.r.width, fence.t.r.height, fence.center, points[i],
+                                &distance);
+            if (in) {
+                result.emplace(i, j);
+            }
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(GeoJoinTest, join) {
+    auto points = random_points(20000, 1);
+    auto fences = random_fences(200, 2);
+    GeoJoin join(fences);
+    std::vector<GeoJoin::Pair> pairs;
+    GeoJoin::Stats stats;
+    join.join(points, &pairs, &stats);
+
+    PairSet actual;
+    for (const auto& pair : pairs) {
+        EXPECT_TRUE(actual.emplace(pair.point, pair.fence).second);
+        EXPECT_NEAR(Geo::geo_distance(fences[pair.fence].center, points[pair.point]),
+                    pair.distance, 1e-3);
+    }
+    auto expected = nested_loop_join(points, fences);
+    EXPECT_FALSE(expected.empty());
+    EXPECT_EQ(expected, actual);
+    EXPECT_EQ(pairs.size(), stats.matched);
+    // 只有覆盖格子内的点才会被精确过滤
+    EXPECT_LT(stats.candidates, points.size() * fences.size() / 10);
+}
+
+TEST(GeoJoinTest, reuse) {
+    auto fences = random_fences(50, 3);
+    GeoJoin join(fences);
+    std::vector<GeoJoin::Pair> pairs;
+    for (uint64_t seed : {4, 5}) {
+        auto points = random_points(5000, seed);
+        join.join(points, &pairs);
+        PairSet actual;
+        for (const auto& pair : pairs) {
+            actual.emplace(pair.point, pair.fence);
+        }
+        EXPECT_EQ(nested_loop_join(points, fences), actual);
+    }
+}
+
+TEST(GeoJoinTest, invalid) {
+    GeoHash::GeoShape fence{};
+    fence.type = GeoHash::GeoShape::CIRCULAR_TYPE;
+    fence.center = {116.40, 39.90};
+    fence.conversion = 1000;
+    fence.t.radius = 5;
+    GeoJoin join({fence});
+    std::vector<GeoJoin::Pair> pairs;
+    join.join({{116.40, 89.0}, {116.41, 39.91}, {121.47, 31.23}, {116.40, 39.90}}, &pairs);
+    ASSERT_EQ(2U, pairs.size());
+    std::set<std::size_t> matched = {pairs[0].point, pairs[1].point};
+    EXPECT_EQ((std::set<std::size_t>{1, 3}), matched);
+
+    GeoJoin empty({});
+    empty.join({{116.40, 39.90}}, &pairs);
+    EXPECT_TRUE(pairs.empty());
+}
+
+} // namespace pl
@@ -0,0 +1,40 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include "geohash.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace pl {
+
+// 北京附近均匀分布的随机点，geo_index和geo_join的测试共用
+inline std::vector<GeoHash::Point> random_points(std::size_t n, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> lng(115.0, 118.0);
+    std::uniform_real_distribution<double> lat(39.0, 41.0);
+    std::vector<GeoHash::Point> points(n);
+    for (auto& p : points) {
+        p = {lng(rng), lat(rng)};
+    }
+    return points;
+}
+
+} // namespace pl
@@ -15,9 +15,15 @@
 // Authors: liubang (it.liubang@gmail.com)
 
 #include "geohash.h"
+#include "cpp/pl/bits/cpu.h"
 
+#include <algorithm>
 #include <array>
 
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
 namespace pl {
 
 namespace {
@@ -84,6 +90,112 @@ inline uint64_t deinterleave64(uint64_t interleaved) {
     return x | (y << 32);
 }
 
+// the standard geohash, used by the base32 strings
+constexpr inline GeoHash::Area STANDARD_RANGE = {
+    GeoHash::Point{-180, -90},
+    GeoHash::Point{180, 90},
+};
+
+constexpr char BASE32[] = "0123456789bcdefghjkmnpqrstuvwxyz";
+
+// bits of latitude and longitude in the interleaved hash
+constexpr uint64_t LAT_MASK = 0x5555555555555555ULL;
+constexpr uint64_t LNG_MASK = 0xaaaaaaaaaaaaaaaaULL;
+
+// points are normalized in blocks, then interleaved
+constexpr std::size_t BATCH_SIZE = 256;
+
+#if defined(__x86_64__)
+
+__attribute__((target("bmi2"))) void interleave_bmi2(const uint32_t* lat_offsets,
+                                                      const uint32_t* lng_offsets,
+                                                      std::size_t n,
+                                                      uint64_t* bits) {
+    for (std::size_t i = 0; i < n; ++i) {
+        bits[i] = _pdep_u64(lat_offsets[i], LAT_MASK) | _pdep_u64(lng_offsets[i], LNG_MASK);
+    }
+}
+
+__attribute__((target("bmi2"))) void deinterleave_bmi2(const GeoHash::HashBits* hashes,
+                                                        std::size_t n,
+                                                        uint32_t* lat_offsets,
+                                                        uint32_t* lng_offsets) {
+    for (std::size_t i = 0; i < n; ++i) {
+        lat_offsets[i] = static_cast<uint32_t>(_pext_u64(hashes[i].bits, LAT_MASK));
+        lng_offsets[i] = static_cast<uint32_t>(_pext_u64(hashes[i].bits, LNG_MASK));
+    }
+}
+
+#endif
+
+void interleave(const uint32_t* lat_offsets,
+                const uint32_t* lng_offsets,
+                std::size_t n,
+                uint64_t* bits) {
+#if defined(__x86_64__)
+    if (fast_bmi2()) {
+        return interleave_bmi2(lat_offsets, lng_offsets, n, bits);
+    }
+#endif
+    for (std::size_t i = 0; i < n; ++i) {
+        bits[i] = interleave64(lat_offsets[i], lng_offsets[i]);
+    }
+}
+
+void deinterleave(const GeoHash::HashBits* hashes,
+                  std::size_t n,
+                  uint32_t* lat_offsets,
+                  uint32_t* lng_offsets) {
+#if defined(__x86_64__)
+    if (fast_bmi2()) {
+        return deinterleave_bmi2(hashes, n, lat_offsets, lng_offsets);
+    }
+#endif
+    for (std::size_t i = 0; i < n; ++i) {
+        uint64_t sep = deinterleave64(hashes[i].bits);
+        lat_offsets[i] = static_cast<uint32_t>(sep);
+        lng_offsets[i] = static_cast<uint32_t>(sep >> 32);
+    }
+}
+
+/**
+ * @brief The same as GeoHash::encode for a block of at most BATCH_SIZE points, the points must
+ * be in both range and limits. The bits of the invalid points are zero.
+ *
+ * @return the number of valid points
+ */
+std::size_t encode_block(const GeoHash::Area& range,
+                         const GeoHash::Area& limits,
+                         const double* lngs,
+                         const double* lats,
+                         std::size_t n,
+                         uint8_t step,
+                         uint64_t* bits,
+                         bool* valid) {
+    uint32_t lat_offsets[BATCH_SIZE];
+    uint32_t lng_offsets[BATCH_SIZE];
+    const auto cells = static_cast<double>(1ULL << step);
+    const auto max_offset = static_cast<double>((1ULL << step) - 1);
+    const double min_lng = std::max(range.min_lng(), limits.min_lng());
+    const double max_lng = std::min(range.max_lng(), limits.max_lng());
+    const double min_lat = std::max(range.min_lat(), limits.min_lat());
+    const double max_lat = std::min(range.max_lat(), limits.max_lat());
+    std::size_t count = 0;
+    // branch free, so that the loop can be vectorized. The offsets of the invalid points are
+    // clamped, and dropped by the caller
+    for (std::size_t i = 0; i < n; ++i) {
+        valid[i] = lngs[i] >= min_lng && lngs[i] <= max_lng && lats[i] >= min_lat &&
+                   lats[i] <= max_lat;
+        double lng_offset = (lngs[i] - range.min_lng()) / range.lng_scale() * cells;
+        double lat_offset = (lats[i] - range.min_lat()) / range.lat_scale() * cells;
+        lng_offsets[i] = static_cast<uint32_t>(std::clamp(lng_offset, 0.0, max_offset));
+        lat_offsets[i] = static_cast<uint32_t>(std::clamp(lat_offset, 0.0, max_offset));
+        count += valid[i];
+    }
+    interleave(lat_offsets, lng_offsets, n, bits);
+    return count;
+}
+
 } // namespace
 
 bool GeoHash::encode(const Area& range, double lng, double lat, uint8_t step, HashBits* hash) {
@@ -110,6 +222,11 @@ bool GeoHash::encode(const Area& range, double lng, double lat, uint8_t step, Ha
     lng_offset *= (1ULL << step);
     lat_offset *= (1ULL << step);
 
+    // the max longitude/latitude belongs to the last cell
+    const auto max_offset = static_cast<double>((1ULL << step) - 1);
+    lng_offset = std::min(lng_offset, max_offset);
+    lat_offset = std::min(lat_offset, max_offset);
+
     hash->bits = interleave64(lat_offset, lng_offset);
 
     return true;
@@ -209,7 +326,7 @@ void GeoHash::move_y(HashBits* hash, int8_t d) {
         y = y - (z + 1);
     }
 
-    y = y & (0xaaaaaaaaaaaaaaaaULL >> (64 - hash->step * 2));
+    y = y & (0x5555555555555555ULL >> (64 - hash->step * 2));
     hash->bits = (x | y);
 }
 
@@ -256,4 +373,91 @@ void GeoHash::neighbors(const HashBits* hash, Neighbors* neighbors) {
     move_y(&neighbors->sw, -1);
 }
 
+std::size_t GeoHash::encode_batch(const Area& range,
+                                  const double* lngs,
+                                  const double* lats,
+                                  std::size_t n,
+                                  uint8_t step,
+                                  HashBits* hashes) {
+    if (range.is_zero() || step > GEO_MAX_STEP || step == 0) {
+        std::fill(hashes, hashes + n, HashBits{0, 0});
+        return 0;
+    }
+    uint64_t bits[BATCH_SIZE];
+    bool valid[BATCH_SIZE];
+    std::size_t count = 0;
+    for (std::size_t b = 0; b < n; b += BATCH_SIZE) {
+        std::size_t m = std::min(BATCH_SIZE, n - b);
+        count += encode_block(range, WGS84_RANGE, lngs + b, lats + b, m, step, bits, valid);
+        for (std::size_t i = 0; i < m; ++i) {
+            hashes[b + i] = valid[i] ? HashBits{bits[i], step} : HashBits{0, 0};
+        }
+    }
+    return count;
+}
+
+std::size_t GeoHash::encode_batch_wgs84(
+    const double* lngs, const double* lats, std::size_t n, uint8_t step, HashBits* hashes) {
+    return encode_batch(WGS84_RANGE, lngs, lats, n, step, hashes);
+}
+
+void GeoHash::decode_batch_to_point(
+    const Area& range, const HashBits* hashes, std::size_t n, double* lngs, double* lats) {
+    uint32_t lat_offsets[BATCH_SIZE];
+    uint32_t lng_offsets[BATCH_SIZE];
+    for (std::size_t b = 0; b < n; b += BATCH_SIZE) {
+        std::size_t m = std::min(BATCH_SIZE, n - b);
+        deinterleave(hashes + b, m, lat_offsets, lng_offsets);
+        for (std::size_t i = 0; i < m; ++i) {
+            double cells = static_cast<double>(1ULL << hashes[b + i].step);
+            double min_lat = range.min_lat() + (lat_offsets[i] * 1.0 / cells) * range.lat_scale();
+            double max_lat =
+                range.min_lat() + ((lat_offsets[i] + 1) * 1.0 / cells) * range.lat_scale();
+            double min_lng = range.min_lng() + (lng_offsets[i] * 1.0 / cells) * range.lng_scale();
+            double max_lng =
+                range.min_lng() + ((lng_offsets[i] + 1) * 1.0 / cells) * range.lng_scale();
+            lngs[b + i] = std::clamp((min_lng + max_lng) / 2, GEO_LNG_MIN, GEO_LNG_MAX);
+            lats[b + i] = std::clamp((min_lat + max_lat) / 2, GEO_LAT_MIN, GEO_LAT_MAX);
+        }
+    }
+}
+
+void GeoHash::decode_batch_to_point_wgs84(const HashBits* hashes,
+                                          std::size_t n,
+                                          double* lngs,
+                                          double* lats) {
+    decode_batch_to_point(WGS84_RANGE, hashes, n, lngs, lats);
+}
+
+std::size_t GeoHash::encode_base32_batch(
+    const double* lngs, const double* lats, std::size_t n, uint8_t length, char* out) {
+    if (length == 0 || length > 12) {
+        return 0;
+    }
+    // every character is 5 bits, the longitude comes first
+    auto bits_len = static_cast<uint8_t>(length * 5);
+    auto step = static_cast<uint8_t>((bits_len + 1) / 2);
+    uint64_t bits[BATCH_SIZE];
+    bool valid[BATCH_SIZE];
+    std::size_t count = 0;
+    for (std::size_t b = 0; b < n; b += BATCH_SIZE) {
+        std::size_t m = std::min(BATCH_SIZE, n - b);
+        count += encode_block(STANDARD_RANGE, STANDARD_RANGE, lngs + b, lats + b, m, step, bits,
+                              valid);
+        for (std::size_t i = 0; i < m; ++i) {
+            char* str = out + (b + i) * length;
+            if (!valid[i]) {
+                std::fill(str, str + length, '\0');
+                continue;
+            }
+            uint64_t hash = bits[i] >> (step * 2 - bits_len);
+            for (int j = length - 1; j >= 0; --j) {
+                str[j] = BASE32[hash & 0x1f];
+                hash >>= 5;
+            }
+        }
+    }
+    return count;
+}
+
 } // namespace pl
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <ostream>
 
@@ -142,6 +143,44 @@ public:
 
     static void neighbors(const HashBits* hash, Neighbors* neighbors);
 
+    /**
+     * @brief Batch version of encode, the bits are interleaved by pdep when the cpu supports
+     * bmi2. The hashes of the points out of the range are zero.
+     *
+     * @return the number of encoded points
+     */
+    static std::size_t encode_batch(const Area& range,
+                                    const double* lngs,
+                                    const double* lats,
+                                    std::size_t n,
+                                    uint8_t step,
+                                    HashBits* hashes);
+
+    static std::size_t encode_batch_wgs84(
+        const double* lngs, const double* lats, std::size_t n, uint8_t step, HashBits* hashes);
+
+    /**
+     * @brief Batch version of decode_area_to_point, (lngs[i], lats[i]) is the center of the area
+     * of hashes[i]. The hashes are not checked.
+     */
+    static void decode_batch_to_point(
+        const Area& range, const HashBits* hashes, std::size_t n, double* lngs, double* lats);
+
+    static void decode_batch_to_point_wgs84(const HashBits* hashes,
+                                            std::size_t n,
+                                            double* lngs,
+                                            double* lats);
+
+    /**
+     * @brief Encode the points to the standard base32 geohash strings (latitude in [-90, 90]),
+     * the strings are written to out one after another without separators.
+     *
+     * @param length number of characters of every string, in [1, 12]
+     * @return the number of encoded points, the strings of the invalid points are filled by '\0'
+     */
+    static std::size_t encode_base32_batch(
+        const double* lngs, const double* lats, std::size_t n, uint8_t length, char* out);
+
 private:
     static void move_x(HashBits* hash, int8_t d);
 
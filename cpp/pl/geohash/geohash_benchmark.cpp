@@ -0,0 +1,119 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "geohash.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+
+namespace {
+
+using pl::GeoHash;
+
+constexpr std::size_t N = 1 << 16;
+constexpr uint8_t STEP = 26;
+
+struct Points {
+    std::vector<double> lngs;
+    std::vector<double> lats;
+
+    Points() {
+        std::mt19937_64 rng(43);
+        std::uniform_real_distribution<double> lng(-180, 180);
+        std::uniform_real_distribution<double> lat(-85, 85);
+        for (std::size_t i = 0; i < N; ++i) {
+            lngs.push_back(lng(rng));
+            lats.push_back(lat(rng));
+        }
+    }
+};
+
+const Points& points() {
+    static const Points p;
+    return p;
+}
+
+void set_counters(benchmark::State& state) {
+    state.counters["points/s"] = benchmark::Counter(static_cast<double>(state.iterations() * N),
+                                                    benchmark::Counter::kIsRate);
+}
+
+void BM_Encode(benchmark::State& state) {
+    const auto& p = points();
+    std::vector<GeoHash::HashBits> hashes(N);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < N; ++i) {
+            GeoHash::encode_wgs84(p.lngs[i], p.lats[i], STEP, &hashes[i]);
+        }
+        benchmark::DoNotOptimize(hashes.data());
+    }
+    set_counters(state);
+}
+BENCHMARK(BM_Encode)->Unit(benchmark::kMicrosecond);
+
+void BM_EncodeBatch(benchmark::State& state) {
+    const auto& p = points();
+    std::vector<GeoHash::HashBits> hashes(N);
+    for (auto _ : state) {
+        GeoHash::encode_batch_wgs84(p.lngs.data(), p.lats.data(), N, STEP, hashes.data());
+        benchmark::DoNotOptimize(hashes.data());
+    }
+    set_counters(state);
+}
+BENCHMARK(BM_EncodeBatch)->Unit(benchmark::kMicrosecond);
+
+void BM_EncodeBase32Batch(benchmark::State& state) {
+    const auto& p = points();
+    std::vector<char> out(N * 11);
+    for (auto _ : state) {
+        GeoHash::encode_base32_batch(p.lngs.data(), p.lats.data(), N, 11, out.data());
+        benchmark::DoNotOptimize(out.data());
+    }
+    set_counters(state);
+}
+BENCHMARK(BM_EncodeBase32Batch)->Unit(benchmark::kMicrosecond);
+
+void BM_Decode(benchmark::State& state) {
+    const auto& p = points();
+    std::vector<GeoHash::HashBits> hashes(N);
+    GeoHash::encode_batch_wgs84(p.lngs.data(), p.lats.data(), N, STEP, hashes.data());
+    std::vector<GeoHash::Point> out(N);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < N; ++i) {
+            GeoHash::decode_to_point_wgs84(hashes[i], &out[i]);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    set_counters(state);
+}
+BENCHMARK(BM_Decode)->Unit(benchmark::kMicrosecond);
+
+void BM_DecodeBatch(benchmark::State& state) {
+    const auto& p = points();
+    std::vector<GeoHash::HashBits> hashes(N);
+    GeoHash::encode_batch_wgs84(p.lngs.data(), p.lats.data(), N, STEP, hashes.data());
+    std::vector<double> lngs(N);
+    std::vector<double> lats(N);
+    for (auto _ : state) {
+        GeoHash::decode_batch_to_point_wgs84(hashes.data(), N, lngs.data(), lats.data());
+        benchmark::DoNotOptimize(lngs.data());
+        benchmark::DoNotOptimize(lats.data());
+    }
+    set_counters(state);
+}
+BENCHMARK(BM_DecodeBatch)->Unit(benchmark::kMicrosecond);
+
+} // namespace
@@ -18,6 +18,7 @@
 #include "geohash.h"
 
 #include <gtest/gtest.h>
+#include <random>
 
 TEST(geohash, encode) {
     std::map<std::string, pl::GeoHash::Point> cases = {
@@ -34,3 +35,65 @@ TEST(geohash, encode) {
     //     EXPECT_EQ(k, pl::Geo::geohash_string(hash));
     // }
 }
+
+TEST(geohash, encode_batch) {
+    std::mt19937_64 rng(3);
+    std::uniform_real_distribution<double> lng(-180, 180);
+    std::uniform_real_distribution<double> lat(-89, 89);
+    // 不是256的整数倍，最后一个批次不满
+    constexpr std::size_t n = 1000;
+    std::vector<double> lngs(n);
+    std::vector<double> lats(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        lngs[i] = lng(rng);
+        lats[i] = lat(rng);
+    }
+    lngs[0] = 180;
+    lats[0] = pl::GeoHash::GEO_LAT_MAX;
+
+    for (uint8_t step : {1, 16, 26, 31}) {
+        std::vector<pl::GeoHash::HashBits> hashes(n);
+        std::size_t count = pl::GeoHash::encode_batch_wgs84(lngs.data(), lats.data(), n, step,
+                                                            hashes.data());
+        std::size_t expected_count = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            pl::GeoHash::HashBits hash;
+            if (pl::GeoHash::encode_wgs84(lngs[i], lats[i], step, &hash)) {
+                ++expected_count;
+                EXPECT_EQ(hash.bits, hashes[i].bits) << i;
+                EXPECT_EQ(hash.step, hashes[i].step);
+            } else {
+                EXPECT_TRUE(hashes[i].is_zero());
+            }
+        }
+        EXPECT_EQ(expected_count, count);
+
+        std::vector<double> dlngs(n);
+        std::vector<double> dlats(n);
+        pl::GeoHash::decode_batch_to_point_wgs84(hashes.data(), n, dlngs.data(), dlats.data());
+        for (std::size_t i = 0; i < n; ++i) {
+            pl::GeoHash::Point point;
+            if (pl::GeoHash::decode_to_point_wgs84(hashes[i], &point)) {
+                EXPECT_DOUBLE_EQ(point.lng, dlngs[i]);
+                EXPECT_DOUBLE_EQ(point.lat, dlats[i]);
+            }
+        }
+    }
+}
+
+TEST(geohash, encode_base32_batch) {
+    std::vector<double> lngs = {116.31, -5.6, 180, 200};
+    std::vector<double> lats = {40.04, 42.6, 90, 0};
+    std::string out(lngs.size() * 11, ' ');
+    EXPECT_EQ(3U, pl::GeoHash::encode_base32_batch(lngs.data(), lats.data(), lngs.size(), 11,
+                                                   out.data()));
+    // redis pads the 52 bits hash with a '0', the standard geohash uses 55 bits
+    EXPECT_EQ("wx4ey9n3gkv", out.substr(0, 11));
+    EXPECT_EQ("ezs42", out.substr(11, 5));
+    EXPECT_EQ("zzzzzzzzzzz", out.substr(22, 11));
+    EXPECT_EQ(std::string(11, '\0'), out.substr(33, 11));
+
+    std::string short_out(5, ' ');
+    pl::GeoHash::encode_base32_batch(lngs.data() + 1, lats.data() + 1, 1, 5, short_out.data());
+    EXPECT_EQ("ezs42", short_out);
+}
@@ -0,0 +1,133 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <vector>
+
+namespace pl {
+
+/**
+ * @class Buffer
+ * @brief 连接的读写缓冲区，[read_index, write_index)是可读的数据。
+ * 数据被消费之后前面留下的空间在需要时通过搬移数据复用，避免缓冲区无限增长
+ */
+class Buffer {
+public:
+    explicit Buffer(std::size_t initial_size = INITIAL_SIZE) : buf_(initial_size) {}
+
+    [[nodiscard]] std::size_t readable_bytes() const { return write_index_ - read_index_; }
+
+    [[nodiscard]] std::size_t writable_bytes() const { return buf_.size() - write_index_; }
+
+    [[nodiscard]] const char* peek() const { return buf_.data() + read_index_; }
+
+    [[nodiscard]] std::string_view view() const { return {peek(), readable_bytes()}; }
+
+    void retrieve(std::size_t n) {
+        if (n < readable_bytes()) {
+            read_index_ += n;
+        } else {
+            retrieve_all();
+        }
+    }
+
+    void retrieve_all() {
+        read_index_ = 0;
+        write_index_ = 0;
+    }
+
+    void append(std::string_view data) { append(data.data(), data.size()); }
+
+    void append(const char* data, std::size_t len) {
+        ensure_writable(len);
+        std::memcpy(begin_write(), data, len);
+        write_index_ += len;
+    }
+
+    void ensure_writable(std::size_t len) {
+        if (writable_bytes() >= len) {
+            return;
+        }
+        std::size_t readable = readable_bytes();
+        if (read_index_ + writable_bytes() >= len) {
+            std::memmove(buf_.data(), peek(), readable);
+            read_index_ = 0;
+            write_index_ = readable;
+        } else {
+            buf_.resize(write_index_ + len);
+        }
+    }
+
+    [[nodiscard]] char* begin_write() { return buf_.data() + write_index_; }
+
+    void has_written(std::size_t n) { write_index_ += n; }
+
+    /**
+     * @brief 从fd读取数据，缓冲区空间不够时先读到栈上的临时空间，再追加到缓冲区，
+     * 这样一次系统调用可以读取较多数据，缓冲区也不需要预先分配很大。
+     * 返回read的返回值，出错时errno被保留
+     */
+    ssize_t read_fd(int fd) {
+        char extra[EXTRA_SIZE];
+        const std::size_t writable = writable_bytes();
+        iovec vec[2];
+        vec[0].iov_base = begin_write();
+        vec[0].iov_len = writable;
+        vec[1].iov_base = extra;
+        vec[1].iov_len = sizeof(extra);
+        ssize_t n = ::readv(fd, vec, writable < sizeof(extra) ? 2 : 1);
+        if (n <= 0) {
+            return n;
+        }
+        if (static_cast<std::size_t>(n) <= writable) {
+            write_index_ += n;
+        } else {
+            write_index_ = buf_.size();
+            int saved_errno = errno;
+            append(extra, n - writable);
+            errno = saved_errno;
+        }
+        return n;
+    }
+
+    // 缓冲区占用的内存
+    [[nodiscard]] std::size_t capacity() const { return buf_.size(); }
+
+    // 清空并释放多余的内存，用于连接空闲时
+    void shrink() {
+        if (readable_bytes() == 0 && buf_.size() > INITIAL_SIZE) {
+            std::vector<char>(INITIAL_SIZE).swap(buf_);
+            retrieve_all();
+        }
+    }
+
+    static constexpr std::size_t INITIAL_SIZE = 4096;
+    static constexpr std::size_t EXTRA_SIZE = 65536;
+
+private:
+    std::vector<char> buf_;
+    std::size_t read_index_{0};
+    std::size_t write_index_{0};
+};
+
+} // namespace pl
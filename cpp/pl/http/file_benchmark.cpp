@@ -0,0 +1,165 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/fs/posix_fs.h"
+#include "cpp/pl/http/file_handler.h"
+#include "cpp/pl/http/http.h"
+
+#include <benchmark/benchmark.h>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * 通过loopback下载同一个文件，对比sendfile、splice和pread+write三种方式的吞吐，
+ * 以及服务端线程每发送1GB消耗的cpu时间。服务端只有一个reactor线程，通过它的cpu时钟统计
+ */
+namespace {
+
+constexpr std::size_t FILE_SIZE = 64 << 20;
+
+class Server {
+public:
+    Server() {
+        root_ = std::filesystem::temp_directory_path() /
+                ("file_benchmark_" + std::to_string(::getpid()));
+        std::filesystem::create_directories(root_);
+        std::string block(1 << 20, 'x');
+        std::ofstream out(root_ / "data.sst", std::ios::binary);
+        for (std::size_t i = 0; i < FILE_SIZE / block.size(); ++i) {
+            out << block;
+        }
+        out.close();
+
+        auto fs = std::make_shared<pl::PosixFileSystem>();
+        auto& router = server_.router();
+        router.get("/sendfile/*",
+                   pl::make_file_handler(fs, root_, "/sendfile", pl::FileTransfer::SENDFILE));
+        router.get("/splice/*",
+                   pl::make_file_handler(fs, root_, "/splice", pl::FileTransfer::SPLICE));
+        router.get("/copy/*", pl::make_file_handler(fs, root_, "/copy", pl::FileTransfer::COPY));
+        server_.init("127.0.0.1", "0");
+        server_.set_reactor_threads(1);
+        server_.listen();
+        thread_ = std::thread([this]() { server_.start(); });
+        pthread_getcpuclockid(thread_.native_handle(), &clock_);
+    }
+
+    ~Server() {
+        server_.stop();
+        thread_.join();
+        std::filesystem::remove_all(root_);
+    }
+
+    [[nodiscard]] uint16_t port() const { return server_.port(); }
+
+    // 服务端线程消耗的cpu时间，单位秒
+    [[nodiscard]] double cpu_seconds() const {
+        timespec ts{};
+        clock_gettime(clock_, &ts);
+        return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+    }
+
+    static Server& instance() {
+        static Server server;
+        return server;
+    }
+
+private:
+    std::filesystem::path root_;
+    pl::HttpServer server_;
+    std::thread thread_;
+    clockid_t clock_{};
+};
+
+int connect_to(uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// 读取一个响应，返回body的字节数
+std::size_t download(int fd, std::string_view request, std::vector<char>& buf) {
+    if (::write(fd, request.data(), request.size()) != static_cast<ssize_t>(request.size())) {
+        return 0;
+    }
+    std::string head;
+    std::size_t body = 0;
+    for (;;) {
+        ssize_t n = ::read(fd, buf.data(), buf.size());
+        if (n <= 0) {
+            return 0;
+        }
+        head.append(buf.data(), n);
+        auto end = head.find("\r\n\r\n");
+        if (end != std::string::npos) {
+            body = head.size() - end - 4;
+            break;
+        }
+    }
+    while (body < FILE_SIZE) {
+        ssize_t n = ::read(fd, buf.data(), std::min(buf.size(), FILE_SIZE - body));
+        if (n <= 0) {
+            return 0;
+        }
+        body += n;
+    }
+    return body;
+}
+
+void BM_FileDownload(benchmark::State& state, std::string_view mode) {
+    Server& server = Server::instance();
+    int fd = connect_to(server.port());
+    std::string request = "GET /" + std::string(mode) + "/data.sst HTTP/1.1\r\nHost: bench\r\n\r\n";
+    std::vector<char> buf(1 << 20);
+    std::size_t bytes = 0;
+    double cpu_start = server.cpu_seconds();
+    for (auto _ : state) {
+        std::size_t n = download(fd, request, buf);
+        if (n != FILE_SIZE) {
+            state.SkipWithError("download failed");
+            break;
+        }
+        bytes += n;
+    }
+    double cpu = server.cpu_seconds() - cpu_start;
+    ::close(fd);
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+    state.counters["server_cpu_ms_per_gb"] =
+        bytes == 0 ? 0 : cpu * 1e3 / (static_cast<double>(bytes) / (1 << 30));
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_FileDownload, sendfile, "sendfile")
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_FileDownload, splice, "splice")
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_FileDownload, copy, "copy")->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,216 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/http/file_handler.h"
+
+#include <cerrno>
+#include <charconv>
+#include <climits>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fmt/format.h>
+#include <sys/stat.h>
+#include <utility>
+
+namespace pl {
+
+namespace {
+
+bool parse_number(std::string_view s, uint64_t* value) {
+    if (s.empty()) {
+        return false;
+    }
+    auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), *value);
+    return ec == std::errc() && ptr == s.data() + s.size();
+}
+
+// 相对路径不能为空，不能是绝对路径，也不能包含".."
+bool is_safe_path(std::string_view path) {
+    if (path.empty() || path.front() == '/' || path.find('\0') != std::string_view::npos) {
+        return false;
+    }
+    while (!path.empty()) {
+        std::size_t pos = path.find('/');
+        std::string_view segment = path.substr(0, pos);
+        if (segment == "..") {
+            return false;
+        }
+        if (pos == std::string_view::npos) {
+            break;
+        }
+        path.remove_prefix(pos + 1);
+    }
+    return true;
+}
+
+// 解析符号链接之后的绝对路径，失败时返回空串
+std::string real_path(const std::string& path) {
+    char buf[PATH_MAX];
+    return ::realpath(path.c_str(), buf) == nullptr ? std::string() : std::string(buf);
+}
+
+// path必须是root本身或者位于root之下，root和path都是realpath的结果
+bool is_under(std::string_view root, std::string_view path) {
+    if (root.empty() || path.substr(0, root.size()) != root) {
+        return false;
+    }
+    return path.size() == root.size() || root == "/" || path[root.size()] == '/';
+}
+
+std::string_view content_type(std::string_view path) {
+    std::size_t dot = path.rfind('.');
+    std::string_view ext = dot == std::string_view::npos ? "" : path.substr(dot + 1);
+    if (ext == "html" || ext == "htm") {
+        return "text/html";
+    }
+    if (ext == "txt") {
+        return "text/plain";
+    }
+    if (ext == "json") {
+        return "application/json";
+    }
+    if (ext == "css") {
+        return "text/css";
+    }
+    if (ext == "js") {
+        return "application/javascript";
+    }
+    return "application/octet-stream";
+}
+
+} // namespace
+
+RangeResult parse_byte_range(std::string_view header,
+                             uint64_t size,
+                             uint64_t* offset,
+                             uint64_t* length) {
+    constexpr std::string_view UNIT = "bytes=";
+    if (header.substr(0, UNIT.size()) != UNIT) {
+        return RangeResult::NONE;
+    }
+    std::string_view spec = header.substr(UNIT.size());
+    std::size_t dash = spec.find('-');
+    // 多个区间需要multipart/byteranges，直接返回整个文件，RFC 9110允许忽略Range
+    if (dash == std::string_view::npos || spec.find(',') != std::string_view::npos) {
+        return RangeResult::NONE;
+    }
+    std::string_view first = spec.substr(0, dash);
+    std::string_view last = spec.substr(dash + 1);
+    uint64_t begin = 0;
+    uint64_t end = 0;
+    if (first.empty()) {
+        // 最后n个字节
+        uint64_t n = 0;
+        if (!parse_number(last, &n)) {
+            return RangeResult::NONE;
+        }
+        if (n == 0 || size == 0) {
+            return RangeResult::UNSATISFIABLE;
+        }
+        *length = std::min(n, size);
+        *offset = size - *length;
+        return RangeResult::OK;
+    }
+    if (!parse_number(first, &begin)) {
+        return RangeResult::NONE;
+    }
+    if (last.empty()) {
+        end = size == 0 ? 0 : size - 1;
+    } else if (!parse_number(last, &end) || end < begin) {
+        return RangeResult::NONE;
+    }
+    if (begin >= size) {
+        return RangeResult::UNSATISFIABLE;
+    }
+    end = std::min(end, size - 1);
+    *offset = begin;
+    *length = end - begin + 1;
+    return RangeResult::OK;
+}
+
+HttpHandler make_file_handler(FileSystemRef fs,
+                              std::string root,
+                              std::string prefix,
+                              FileTransfer transfer) {
+    // root只解析一次，之后请求的路径都要落在解析之后的root之下
+    std::string real_root = real_path(root);
+    return [fs = std::move(fs), root = std::move(real_root), prefix = std::move(prefix),
+            transfer](const HttpRequest& request, HttpResponse& response) {
+        std::string_view relative = request.path;
+        relative.remove_prefix(std::min(prefix.size(), relative.size()));
+        if (!relative.empty() && relative.front() == '/') {
+            relative.remove_prefix(1);
+        }
+        if (!is_safe_path(relative)) {
+            response.set_status(403);
+            return;
+        }
+        if (root.empty()) {
+            response.set_status(404);
+            return;
+        }
+        // handler运行在reactor线程上，这里只有一次路径解析、一次open和一次fstat。
+        // 符号链接可能指向root之外，所以用解析之后的路径检查，再以O_NOFOLLOW打开。
+        // O_NONBLOCK避免打开FIFO时阻塞reactor，对普通文件没有影响
+        std::string path = real_path(fmt::format("{}/{}", root, relative));
+        if (path.empty()) {
+            response.set_status(errno == ENOENT || errno == ENOTDIR ? 404 : 403);
+            return;
+        }
+        if (!is_under(root, path)) {
+            response.set_status(403);
+            return;
+        }
+        FileDescriptorRef fd;
+        if (!fs->open(path, O_RDONLY | O_CLOEXEC | O_NOFOLLOW | O_NONBLOCK, &fd).ok()) {
+            response.set_status(500);
+            return;
+        }
+        struct stat st {};
+        if (::fstat(fd->native_handle(), &st) != 0) {
+            response.set_status(500);
+            return;
+        }
+        if (!S_ISREG(st.st_mode)) {
+            response.set_status(404);
+            return;
+        }
+        auto size = static_cast<uint64_t>(st.st_size);
+
+        response.add_header("Accept-Ranges", "bytes");
+        uint64_t offset = 0;
+        uint64_t length = size;
+        std::string_view range = request.header("Range");
+        switch (range.empty() ? RangeResult::NONE
+                              : parse_byte_range(range, size, &offset, &length)) {
+        case RangeResult::NONE:
+            break;
+        case RangeResult::OK:
+            response.set_status(206);
+            response.add_header("Content-Range",
+                                fmt::format("bytes {}-{}/{}", offset, offset + length - 1, size));
+            break;
+        case RangeResult::UNSATISFIABLE:
+            response.set_status(416);
+            response.add_header("Content-Range", fmt::format("bytes */{}", size));
+            return;
+        }
+        response.set_content_type(content_type(path));
+        response.set_file({fs.get(), std::move(fd), offset, length}, transfer);
+    };
+}
+
+} // namespace pl
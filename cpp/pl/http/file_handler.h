@@ -0,0 +1,52 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include "cpp/pl/fs/fs.h"
+#include "cpp/pl/http/router.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace pl {
+
+enum class RangeResult {
+    // 没有Range头部或者不支持的格式(例如多个区间)，返回整个文件
+    NONE,
+    OK,
+    // 416
+    UNSATISFIABLE,
+};
+
+/**
+ * @brief 解析"bytes=a-b"、"bytes=a-"和"bytes=-n"三种形式的单个区间，结果裁剪到文件大小之内
+ */
+RangeResult parse_byte_range(std::string_view header,
+                             uint64_t size,
+                             uint64_t* offset,
+                             uint64_t* length);
+
+// 返回一个发送root目录下文件的handler，需要以前缀路由的方式注册在prefix下，
+// 请求路径去掉prefix之后就是文件相对于root的路径。文件通过transfer指定的方式零拷贝发送，
+// 支持单个区间的Range请求。路径中包含".."，或者解析符号链接之后位于root之外时返回403
+HttpHandler make_file_handler(FileSystemRef fs,
+                              std::string root,
+                              std::string prefix,
+                              FileTransfer transfer = FileTransfer::SENDFILE);
+
+} // namespace pl
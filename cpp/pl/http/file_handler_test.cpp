@@ -0,0 +1,279 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/fs/posix_fs.h"
+#include "cpp/pl/http/file_handler.h"
+#include "cpp/pl/http/http.h"
+
+#include <filesystem>
+#include <fstream>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+int connect_to(uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+struct Response {
+    int status{-1};
+    std::string headers;
+    std::string body;
+};
+
+class FileHandlerTest : public ::testing::TestWithParam<pl::FileTransfer> {
+protected:
+    void SetUp() override {
+        root_ = std::filesystem::temp_directory_path() /
+                ("file_handler_test_" + std::to_string(::getpid()));
+        std::filesystem::create_directories(root_ / "dir");
+        content_.resize(300 * 1024);
+        for (std::size_t i = 0; i < content_.size(); ++i) {
+            content_[i] = static_cast<char>('a' + i % 26);
+        }
+        std::ofstream(root_ / "data.sst", std::ios::binary) << content_;
+        std::ofstream(root_ / "empty.txt", std::ios::binary).flush();
+        // root之外的文件，通过符号链接也不能访问
+        outside_ = root_.string() + "_outside";
+        std::filesystem::create_directories(outside_);
+        std::ofstream(outside_ / "secret.txt", std::ios::binary) << "secret";
+        std::filesystem::create_symlink(outside_ / "secret.txt", root_ / "secret.txt");
+        std::filesystem::create_directory_symlink(outside_, root_ / "outside");
+        std::filesystem::create_symlink(root_ / "data.sst", root_ / "link.sst");
+
+        auto fs = std::make_shared<pl::PosixFileSystem>();
+        server_.router().get("/files/*", pl::make_file_handler(fs, root_, "/files", GetParam()));
+        server_.router().get("/hello",
+                             [](const pl::HttpRequest& /*request*/, pl::HttpResponse& response) {
+                                 response.set_body_view("hello");
+                             });
+        server_.init("127.0.0.1", "0");
+        server_.listen();
+        thread_ = std::thread([this]() { server_.start(); });
+
+        fd_ = connect_to(server_.port());
+        ASSERT_GE(fd_, 0);
+    }
+
+    void TearDown() override {
+        ::close(fd_);
+        server_.stop();
+        thread_.join();
+        std::filesystem::remove_all(root_);
+        std::filesystem::remove_all(outside_);
+    }
+
+    void send(std::string_view data) const {
+        while (!data.empty()) {
+            ssize_t n = ::write(fd_, data.data(), data.size());
+            ASSERT_GT(n, 0);
+            data.remove_prefix(n);
+        }
+    }
+
+    Response get(std::string_view path, std::string_view extra = "") {
+        send(fmt::format("GET {} HTTP/1.1\r\nHost: localhost\r\n{}\r\n", path, extra));
+        return recv_response();
+    }
+
+    Response recv_response() {
+        for (;;) {
+            auto end = buf_.find("\r\n\r\n");
+            if (end != std::string::npos) {
+                auto pos = buf_.find("Content-Length: ");
+                std::size_t length = std::stoul(buf_.substr(pos + 16));
+                if (buf_.size() >= end + 4 + length) {
+                    Response response;
+                    response.status = std::stoi(buf_.substr(9, 3));
+                    response.headers = buf_.substr(0, end + 2);
+                    response.body = buf_.substr(end + 4, length);
+                    buf_.erase(0, end + 4 + length);
+                    return response;
+                }
+            }
+            char tmp[65536];
+            ssize_t n = ::read(fd_, tmp, sizeof(tmp));
+            if (n <= 0) {
+                return {};
+            }
+            buf_.append(tmp, n);
+        }
+    }
+
+    std::filesystem::path root_;
+    std::filesystem::path outside_;
+    std::string content_;
+    pl::HttpServer server_;
+    std::thread thread_;
+    int fd_{-1};
+    std::string buf_;
+};
+
+} // namespace
+
+TEST(FileHandlerRangeTest, parse_byte_range) {
+    uint64_t offset = 0;
+    uint64_t length = 0;
+    EXPECT_EQ(pl::RangeResult::OK, pl::parse_byte_range("bytes=0-99", 1000, &offset, &length));
+    EXPECT_EQ(0, offset);
+    EXPECT_EQ(100, length);
+    EXPECT_EQ(pl::RangeResult::OK, pl::parse_byte_range("bytes=900-", 1000, &offset, &length));
+    EXPECT_EQ(900, offset);
+    EXPECT_EQ(100, length);
+    EXPECT_EQ(pl::RangeResult::OK, pl::parse_byte_range("bytes=-10", 1000, &offset, &length));
+    EXPECT_EQ(990, offset);
+    EXPECT_EQ(10, length);
+    EXPECT_EQ(pl::RangeResult::OK, pl::parse_byte_range("bytes=-5000", 1000, &offset, &length));
+    EXPECT_EQ(0, offset);
+    EXPECT_EQ(1000, length);
+    // 结束位置超出文件时裁剪到文件末尾
+    EXPECT_EQ(pl::RangeResult::OK, pl::parse_byte_range("bytes=990-5000", 1000, &offset, &length));
+    EXPECT_EQ(990, offset);
+    EXPECT_EQ(10, length);
+
+    EXPECT_EQ(pl::RangeResult::UNSATISFIABLE,
+              pl::parse_byte_range("bytes=1000-", 1000, &offset, &length));
+    EXPECT_EQ(pl::RangeResult::UNSATISFIABLE,
+              pl::parse_byte_range("bytes=-0", 1000, &offset, &length));
+    EXPECT_EQ(pl::RangeResult::NONE,
+              pl::parse_byte_range("bytes=0-1,5-6", 1000, &offset, &length));
+    EXPECT_EQ(pl::RangeResult::NONE, pl::parse_byte_range("bytes=5-1", 1000, &offset, &length));
+    EXPECT_EQ(pl::RangeResult::NONE, pl::parse_byte_range("items=0-1", 1000, &offset, &length));
+    EXPECT_EQ(pl::RangeResult::NONE, pl::parse_byte_range("bytes=x-1", 1000, &offset, &length));
+}
+
+TEST_P(FileHandlerTest, full_file) {
+    auto response = get("/files/data.sst");
+    EXPECT_EQ(200, response.status);
+    EXPECT_NE(std::string::npos, response.headers.find("Accept-Ranges: bytes\r\n"));
+    EXPECT_NE(std::string::npos,
+              response.headers.find("Content-Type: application/octet-stream\r\n"));
+    EXPECT_EQ(content_, response.body);
+
+    response = get("/files/empty.txt");
+    EXPECT_EQ(200, response.status);
+    EXPECT_TRUE(response.body.empty());
+}
+
+TEST_P(FileHandlerTest, range) {
+    auto response = get("/files/data.sst", "Range: bytes=100-199\r\n");
+    EXPECT_EQ(206, response.status);
+    EXPECT_NE(std::string::npos,
+              response.headers.find(fmt::format("Content-Range: bytes 100-199/{}\r\n",
+                                                content_.size())));
+    EXPECT_EQ(content_.substr(100, 100), response.body);
+
+    response = get("/files/data.sst", "Range: bytes=-1000\r\n");
+    EXPECT_EQ(206, response.status);
+    EXPECT_EQ(content_.substr(content_.size() - 1000), response.body);
+
+    response = get("/files/data.sst", fmt::format("Range: bytes={}-\r\n", content_.size()));
+    EXPECT_EQ(416, response.status);
+    EXPECT_NE(std::string::npos,
+              response.headers.find(fmt::format("Content-Range: bytes */{}\r\n", content_.size())));
+    EXPECT_TRUE(response.body.empty());
+}
+
+TEST_P(FileHandlerTest, not_found) {
+    EXPECT_EQ(404, get("/files/missing").status);
+    EXPECT_EQ(404, get("/files/dir").status);
+    EXPECT_EQ(403, get("/files/../etc/passwd").status);
+    EXPECT_EQ(403, get("/files/dir/../../data.sst").status);
+    // 连接仍然可用
+    EXPECT_EQ(206, get("/files/data.sst", "Range: bytes=0-0\r\n").status);
+}
+
+TEST_P(FileHandlerTest, symlink) {
+    EXPECT_EQ(403, get("/files/secret.txt").status);
+    EXPECT_EQ(403, get("/files/outside/secret.txt").status);
+    // root之内的符号链接可以访问
+    auto response = get("/files/link.sst");
+    EXPECT_EQ(200, response.status);
+    EXPECT_EQ(content_, response.body);
+}
+
+TEST_P(FileHandlerTest, head) {
+    send("HEAD /files/data.sst HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    char tmp[4096];
+    std::string head;
+    while (head.find("\r\n\r\n") == std::string::npos) {
+        ssize_t n = ::read(fd_, tmp, sizeof(tmp));
+        ASSERT_GT(n, 0);
+        head.append(tmp, n);
+    }
+    EXPECT_NE(std::string::npos,
+              head.find(fmt::format("Content-Length: {}\r\n", content_.size())));
+    EXPECT_EQ(head.size(), head.find("\r\n\r\n") + 4);
+    EXPECT_EQ("hello", get("/hello").body);
+}
+
+TEST_P(FileHandlerTest, pipelined) {
+    // 文件和普通响应交替出现时，顺序与请求的顺序一致
+    std::string requests;
+    for (int i = 0; i < 4; ++i) {
+        requests += "GET /files/data.sst HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        requests += "GET /hello HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    }
+    send(requests);
+    for (int i = 0; i < 4; ++i) {
+        auto response = recv_response();
+        EXPECT_EQ(200, response.status);
+        EXPECT_EQ(content_, response.body);
+        EXPECT_EQ("hello", recv_response().body);
+    }
+}
+
+TEST_P(FileHandlerTest, client_closes_mid_transfer) {
+    // 比socket缓冲区大得多的文件，客户端收到一部分之后关闭连接，服务端不能被SIGPIPE杀掉。
+    // 服务端正在发送时收到RST才会触发，重复多次以覆盖这个时间窗口
+    std::string big(8 << 20, 'x');
+    std::ofstream(root_ / "big.sst", std::ios::binary) << big;
+    for (int i = 0; i < 50; ++i) {
+        send("GET /files/big.sst HTTP/1.1\r\nHost: localhost\r\n\r\n");
+        // 先关闭写端，服务端进入CLOSE_WAIT，之后的RST让发送返回EPIPE
+        ::shutdown(fd_, SHUT_WR);
+        char tmp[65536];
+        for (int j = 0; j < 16; ++j) {
+            ASSERT_GT(::read(fd_, tmp, sizeof(tmp)), 0);
+        }
+        ::close(fd_);
+        fd_ = connect_to(server_.port());
+        ASSERT_GE(fd_, 0);
+    }
+
+    // 服务端仍然可以处理请求
+    EXPECT_EQ("hello", get("/hello").body);
+}
+
+INSTANTIATE_TEST_SUITE_P(FileTransfer,
+                         FileHandlerTest,
+                         ::testing::Values(pl::FileTransfer::SENDFILE,
+                                           pl::FileTransfer::SPLICE,
+                                           pl::FileTransfer::COPY));
@@ -15,29 +15,96 @@
 // Authors: liubang (it.liubang@gmail.com)
 
 #include "cpp/pl/http/http.h"
-#include "cpp/pl/scope/scope.h"
+
+#include <exception>
+#include <memory>
+#include <sys/uio.h>
 
 namespace pl {
 
-void HttpServer::on_accept(int connect_id) {
-    SCOPE_EXIT { ::close(connect_id); };
-    char buf[1024];
-    int ret = ::read(connect_id, buf, sizeof(buf));
-    if (ret == -1) {
-        LOG(WARN) << "read: " << ::strerror(errno);
+namespace {
+
+// 一次writev最多发送的响应个数
+constexpr std::size_t MAX_BATCH_RESPONSES = 64;
+
+} // namespace
+
+void HttpServer::on_accept(TcpConnection& conn) {
+    // std::any要求可拷贝，这里保存指针
+    conn.context() = std::make_shared<Session>();
+}
+
+void HttpServer::on_message(TcpConnection& conn, Buffer& input) {
+    auto& session = *std::any_cast<std::shared_ptr<Session>>(&conn.context());
+    auto& responses = session->responses;
+    std::string_view data = input.view();
+    std::size_t offset = 0;
+    bool close = false;
+
+    while (offset < data.size() && !close) {
+        auto status = session->parser.parse(data.substr(offset), &session->request);
+        if (status == HttpParser::Status::INCOMPLETE) {
+            break;
+        }
+        auto& response = responses.emplace_back();
+        if (status == HttpParser::Status::ERROR) {
+            response.set_status(session->parser.error_status());
+            response.finalize(false);
+            close = true;
+            break;
+        }
+        const HttpRequest& request = session->request;
+        handle(request, response);
+        close = !request.keep_alive;
+        response.finalize(!close, request.method == "HEAD");
+        offset += session->parser.consumed();
+        // chunked body保存在request中，解析下一个请求之前需要把可能引用它的响应发送出去
+        if (request.chunked || responses.size() >= MAX_BATCH_RESPONSES) {
+            write_responses(conn, responses);
+        }
+    }
+
+    // 响应可能引用请求中的数据，发送之后才能释放输入缓冲区
+    write_responses(conn, responses);
+    if (close) {
+        input.retrieve_all();
+        conn.shutdown();
+    } else {
+        input.retrieve(offset);
+    }
+}
+
+void HttpServer::handle(const HttpRequest& request, HttpResponse& response) const {
+    try {
+        router_.dispatch(request, response);
+    } catch (const std::exception& e) {
+        LOG(ERROR) << "handle " << request.method << " " << request.target << ": " << e.what();
+        response = HttpResponse(500);
+    }
+}
+
+void HttpServer::write_responses(TcpConnection& conn, std::vector<HttpResponse>& responses) {
+    if (responses.empty()) {
         return;
     }
-    auto str = std::string_view(buf, ret);
-    LOG(INFO) << "got: " << str;
-    std::string_view response = R"(
-HTTP/1.1 200 ok
-
-<h1>hello world</h1>
-    )";
-    ret = ::write(connect_id, response.data(), response.size());
-    if (ret == -1) {
-        LOG(WARN) << "write: " << ::strerror(errno);
+    iovec iov[MAX_BATCH_RESPONSES * 2];
+    int count = 0;
+    for (auto& response : responses) {
+        iov[count++] = {const_cast<char*>(response.head().data()), response.head().size()};
+        if (!response.body().empty()) {
+            iov[count++] = {const_cast<char*>(response.body().data()), response.body().size()};
+        }
+        // 文件需要排在前面的数据之后发送
+        if (response.file()) {
+            conn.send(iov, count);
+            conn.send_file(*response.file(), response.transfer());
+            count = 0;
+        }
+    }
+    if (count > 0) {
+        conn.send(iov, count);
     }
+    responses.clear();
 }
 
 } // namespace pl
@@ -14,14 +14,43 @@
 
 // Authors: liubang (it.liubang@gmail.com)
 
+#include "cpp/pl/http/http_parser.h"
+#include "cpp/pl/http/http_response.h"
+#include "cpp/pl/http/router.h"
 #include "cpp/pl/http/tcp.h"
 
+#include <vector>
+
 namespace pl {
 
+/**
+ * @class HttpServer
+ * @brief HTTP/1.1服务器，支持keep-alive和pipelining。一次可读事件中收到的多个请求依次处理，
+ * 响应按请求的顺序通过一次writev发送
+ */
 class HttpServer : public TcpServer {
 public:
+    // 需要在start之前注册路由
+    [[nodiscard]] Router& router() { return router_; }
+
+private:
+    // 每个连接的解析状态，保存在TcpConnection::context中
+    struct Session {
+        HttpParser parser;
+        HttpRequest request;
+        std::vector<HttpResponse> responses;
+    };
+
+    void on_accept(TcpConnection& conn) override;
+
+    void on_message(TcpConnection& conn, Buffer& input) override;
+
+    void handle(const HttpRequest& request, HttpResponse& response) const;
+
+    static void write_responses(TcpConnection& conn, std::vector<HttpResponse>& responses);
+
 private:
-    void on_accept(int connect_id) override;
+    Router router_;
 };
 
 } // namespace pl
@@ -0,0 +1,183 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/http/http.h"
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * 通过loopback对HttpServer压测：每个连接一个客户端线程，每次发送pipeline个请求，
+ * 收到全部响应之后再发下一批。统计吞吐以及每一批请求的延迟分位数
+ */
+namespace {
+
+constexpr int REQUESTS_PER_CONNECTION = 2000;
+
+class Server {
+public:
+    Server() {
+        server_.router().get("/hello",
+                             [](const pl::HttpRequest& /*request*/, pl::HttpResponse& response) {
+                                 response.set_content_type("text/plain");
+                                 response.set_body_view("hello world");
+                             });
+        server_.init("127.0.0.1", "0");
+        server_.set_reactor_threads(2);
+        server_.listen();
+        thread_ = std::thread([this]() { server_.start(); });
+    }
+
+    ~Server() {
+        server_.stop();
+        thread_.join();
+    }
+
+    [[nodiscard]] uint16_t port() const { return server_.port(); }
+
+    static Server& instance() {
+        static Server server;
+        return server;
+    }
+
+private:
+    pl::HttpServer server_;
+    std::thread thread_;
+};
+
+int connect_to(uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    int on = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    return fd;
+}
+
+bool read_bytes(int fd, char* buf, std::size_t len) {
+    while (len > 0) {
+        ssize_t n = ::read(fd, buf, len);
+        if (n <= 0) {
+            return false;
+        }
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+// 响应的长度是固定的，先请求一次得到
+std::size_t response_size(uint16_t port) {
+    int fd = connect_to(port);
+    std::string_view request = "GET /hello HTTP/1.1\r\nHost: bench\r\n\r\n";
+    (void)::write(fd, request.data(), request.size());
+    std::string response;
+    char buf[1024];
+    while (response.find("hello world") == std::string::npos) {
+        ssize_t n = ::read(fd, buf, sizeof(buf));
+        if (n <= 0) {
+            break;
+        }
+        response.append(buf, n);
+    }
+    ::close(fd);
+    return response.size();
+}
+
+void client(uint16_t port, int pipeline, std::size_t response_bytes,
+            std::vector<double>* latencies) {
+    int fd = connect_to(port);
+    if (fd < 0) {
+        return;
+    }
+    std::string batch;
+    for (int i = 0; i < pipeline; ++i) {
+        batch += "GET /hello HTTP/1.1\r\nHost: bench\r\n\r\n";
+    }
+    std::vector<char> buf(response_bytes * pipeline);
+    for (int sent = 0; sent < REQUESTS_PER_CONNECTION; sent += pipeline) {
+        auto start = std::chrono::steady_clock::now();
+        if (::write(fd, batch.data(), batch.size()) != static_cast<ssize_t>(batch.size()) ||
+            !read_bytes(fd, buf.data(), buf.size())) {
+            break;
+        }
+        latencies->push_back(
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+                .count());
+    }
+    ::close(fd);
+}
+
+double percentile(std::vector<double>& values, double p) {
+    if (values.empty()) {
+        return 0;
+    }
+    auto index = static_cast<std::size_t>(p * static_cast<double>(values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+void BM_HttpLoopback(benchmark::State& state) {
+    const auto connections = static_cast<int>(state.range(0));
+    const auto pipeline = static_cast<int>(state.range(1));
+    uint16_t port = Server::instance().port();
+    std::size_t response_bytes = response_size(port);
+    std::vector<double> all;
+
+    for (auto _ : state) {
+        std::vector<std::vector<double>> latencies(connections);
+        std::vector<std::thread> clients;
+        for (int i = 0; i < connections; ++i) {
+            clients.emplace_back(client, port, pipeline, response_bytes, &latencies[i]);
+        }
+        for (auto& t : clients) {
+            t.join();
+        }
+        for (auto& l : latencies) {
+            all.insert(all.end(), l.begin(), l.end());
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * connections * REQUESTS_PER_CONNECTION);
+    // 一批请求的往返延迟
+    state.counters["p50_us"] = percentile(all, 0.50);
+    state.counters["p90_us"] = percentile(all, 0.90);
+    state.counters["p99_us"] = percentile(all, 0.99);
+    state.counters["p999_us"] = percentile(all, 0.999);
+}
+
+} // namespace
+
+BENCHMARK(BM_HttpLoopback)
+    ->ArgNames({"conns", "pipeline"})
+    ->Args({1, 1})
+    ->Args({16, 1})
+    ->Args({64, 1})
+    ->Args({16, 16})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,355 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/http/http_parser.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace pl {
+
+namespace {
+
+constexpr std::string_view CRLF = "\r\n";
+// 分块大小这一行以及trailer中每一行的最大长度
+constexpr std::size_t MAX_LINE_SIZE = 4096;
+
+char lower(char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c; }
+
+bool iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (lower(a[i]) != lower(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// RFC 9110 tchar
+bool is_token_char(char c) {
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) {
+        return true;
+    }
+    return std::string_view("!#$%&'*+-.^_`|~").find(c) != std::string_view::npos;
+}
+
+bool is_token(std::string_view s) {
+    return !s.empty() && std::all_of(s.begin(), s.end(), is_token_char);
+}
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) {
+        s.remove_prefix(1);
+    }
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) {
+        s.remove_suffix(1);
+    }
+    return s;
+}
+
+bool parse_decimal(std::string_view s, std::size_t* out) {
+    if (s.empty()) {
+        return false;
+    }
+    std::size_t value = 0;
+    for (char c : s) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        if (value > (std::numeric_limits<std::size_t>::max() - 9) / 10) {
+            return false;
+        }
+        value = value * 10 + static_cast<std::size_t>(c - '0');
+    }
+    *out = value;
+    return true;
+}
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c = lower(c);
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+// 逗号分隔的列表中是否包含token
+bool has_token(std::string_view list, std::string_view token) {
+    while (!list.empty()) {
+        auto comma = list.find(',');
+        if (iequals(trim(list.substr(0, comma)), token)) {
+            return true;
+        }
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        list.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+} // namespace
+
+std::string_view HttpRequest::header(std::string_view name) const {
+    for (const auto& h : headers) {
+        if (iequals(h.name, name)) {
+            return h.value;
+        }
+    }
+    return {};
+}
+
+void HttpRequest::clear() {
+    method = {};
+    target = {};
+    path = {};
+    query = {};
+    minor_version = 1;
+    headers.clear();
+    body = {};
+    keep_alive = true;
+    chunked = false;
+    chunked_body.clear();
+}
+
+void HttpParser::reset() {
+    state_ = State::HEADER;
+    scanned_ = 0;
+    header_size_ = 0;
+    offset_ = 0;
+    content_length_ = 0;
+    chunk_remaining_ = 0;
+    consumed_ = 0;
+    error_status_ = 400;
+    body_.clear();
+}
+
+HttpParser::Status HttpParser::fail(int status) {
+    error_status_ = status;
+    return Status::ERROR;
+}
+
+HttpParser::Status HttpParser::parse(std::string_view data, HttpRequest* request) {
+    if (state_ == State::DONE) {
+        reset();
+    }
+    // 请求头只在请求完整时解析成指向data的视图，在此之前数据可能会被搬移
+    bool header_parsed = false;
+    if (state_ == State::HEADER) {
+        auto pos = data.find("\r\n\r\n", scanned_ >= 3 ? scanned_ - 3 : 0);
+        if (pos == std::string_view::npos) {
+            scanned_ = data.size();
+            return data.size() > max_header_size_ ? fail(431) : Status::INCOMPLETE;
+        }
+        header_size_ = pos + 4;
+        if (header_size_ > max_header_size_) {
+            return fail(431);
+        }
+        Status status = parse_header(data.substr(0, header_size_), request);
+        if (status != Status::COMPLETE) {
+            return status;
+        }
+        header_parsed = true;
+        offset_ = header_size_;
+        state_ = request->chunked ? State::CHUNK_SIZE : State::BODY;
+    }
+
+    if (state_ == State::BODY) {
+        if (data.size() - header_size_ < content_length_) {
+            return Status::INCOMPLETE;
+        }
+        if (!header_parsed) {
+            parse_header(data.substr(0, header_size_), request);
+        }
+        request->body = data.substr(header_size_, content_length_);
+        consumed_ = header_size_ + content_length_;
+        state_ = State::DONE;
+        return Status::COMPLETE;
+    }
+
+    Status status = parse_chunked(data);
+    if (status != Status::COMPLETE) {
+        return status;
+    }
+    if (!header_parsed) {
+        parse_header(data.substr(0, header_size_), request);
+    }
+    request->chunked_body.swap(body_);
+    request->body = request->chunked_body;
+    consumed_ = offset_;
+    state_ = State::DONE;
+    return Status::COMPLETE;
+}
+
+HttpParser::Status HttpParser::parse_header(std::string_view block, HttpRequest* request) {
+    request->clear();
+    content_length_ = 0;
+
+    // 请求行
+    auto line_end = block.find(CRLF);
+    std::string_view line = block.substr(0, line_end);
+    auto sp1 = line.find(' ');
+    auto sp2 = sp1 == std::string_view::npos ? sp1 : line.find(' ', sp1 + 1);
+    if (sp2 == std::string_view::npos) {
+        return fail(400);
+    }
+    request->method = line.substr(0, sp1);
+    request->target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    std::string_view version = line.substr(sp2 + 1);
+    if (!is_token(request->method) || request->target.empty() ||
+        request->target.find(' ') != std::string_view::npos) {
+        return fail(400);
+    }
+    if (version == "HTTP/1.1") {
+        request->minor_version = 1;
+    } else if (version == "HTTP/1.0") {
+        request->minor_version = 0;
+    } else {
+        return fail(version.substr(0, 5) == "HTTP/" ? 505 : 400);
+    }
+    auto question = request->target.find('?');
+    request->path = request->target.substr(0, question);
+    if (question != std::string_view::npos) {
+        request->query = request->target.substr(question + 1);
+    }
+    request->keep_alive = request->minor_version == 1;
+
+    // 请求头，block以空行结束
+    bool has_content_length = false;
+    std::size_t pos = line_end + 2;
+    while (pos < block.size()) {
+        line_end = block.find(CRLF, pos);
+        line = block.substr(pos, line_end - pos);
+        pos = line_end + 2;
+        if (line.empty()) {
+            break;
+        }
+        // 不支持obs-fold
+        if (line.front() == ' ' || line.front() == '\t') {
+            return fail(400);
+        }
+        auto colon = line.find(':');
+        if (colon == std::string_view::npos || !is_token(line.substr(0, colon))) {
+            return fail(400);
+        }
+        HttpHeader header{line.substr(0, colon), trim(line.substr(colon + 1))};
+        request->headers.push_back(header);
+
+        if (iequals(header.name, "content-length")) {
+            std::size_t length = 0;
+            if (!parse_decimal(header.value, &length) ||
+                (has_content_length && length != content_length_)) {
+                return fail(400);
+            }
+            has_content_length = true;
+            content_length_ = length;
+        } else if (iequals(header.name, "transfer-encoding")) {
+            // 只支持chunked，不支持与其他编码组合
+            auto comma = header.value.find(',');
+            if (comma != std::string_view::npos || !iequals(header.value, "chunked")) {
+                return fail(501);
+            }
+            request->chunked = true;
+        } else if (iequals(header.name, "connection")) {
+            if (has_token(header.value, "close")) {
+                request->keep_alive = false;
+            } else if (has_token(header.value, "keep-alive")) {
+                request->keep_alive = true;
+            }
+        }
+    }
+
+    // 同时出现时可能是请求走私，直接拒绝
+    if (request->chunked && has_content_length) {
+        return fail(400);
+    }
+    if (content_length_ > max_body_size_) {
+        return fail(413);
+    }
+    return Status::COMPLETE;
+}
+
+HttpParser::Status HttpParser::parse_chunked(std::string_view data) {
+    for (;;) {
+        switch (state_) {
+        case State::CHUNK_SIZE: {
+            auto line_end = data.find(CRLF, offset_);
+            if (line_end == std::string_view::npos) {
+                return data.size() - offset_ > MAX_LINE_SIZE ? fail(400) : Status::INCOMPLETE;
+            }
+            std::string_view line = data.substr(offset_, line_end - offset_);
+            // 忽略chunk-ext
+            line = trim(line.substr(0, line.find(';')));
+            if (line.empty() || line.size() > sizeof(std::size_t) * 2) {
+                return fail(400);
+            }
+            std::size_t size = 0;
+            for (char c : line) {
+                int v = hex_value(c);
+                if (v < 0) {
+                    return fail(400);
+                }
+                size = size * 16 + static_cast<std::size_t>(v);
+            }
+            if (size > max_body_size_ || body_.size() + size > max_body_size_) {
+                return fail(413);
+            }
+            offset_ = line_end + 2;
+            chunk_remaining_ = size;
+            state_ = size == 0 ? State::TRAILER : State::CHUNK_DATA;
+            break;
+        }
+        case State::CHUNK_DATA: {
+            // 已经到达的部分先拷贝出来，下次不需要重新扫描
+            std::size_t avail = std::min(chunk_remaining_, data.size() - offset_);
+            body_.append(data.data() + offset_, avail);
+            offset_ += avail;
+            chunk_remaining_ -= avail;
+            if (chunk_remaining_ > 0 || data.size() - offset_ < 2) {
+                return Status::INCOMPLETE;
+            }
+            if (data.substr(offset_, 2) != CRLF) {
+                return fail(400);
+            }
+            offset_ += 2;
+            state_ = State::CHUNK_SIZE;
+            break;
+        }
+        case State::TRAILER: {
+            auto line_end = data.find(CRLF, offset_);
+            if (line_end == std::string_view::npos) {
+                return data.size() - offset_ > MAX_LINE_SIZE ? fail(400) : Status::INCOMPLETE;
+            }
+            bool last = line_end == offset_;
+            offset_ = line_end + 2;
+            if (last) {
+                return Status::COMPLETE;
+            }
+            break;
+        }
+        default:
+            return fail(400);
+        }
+    }
+}
+
+} // namespace pl
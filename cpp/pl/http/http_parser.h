@@ -0,0 +1,108 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pl {
+
+struct HttpHeader {
+    std::string_view name;
+    std::string_view value;
+};
+
+/**
+ * @class HttpRequest
+ * @brief 解析出来的请求，除了chunked编码的body之外都直接指向连接的输入缓冲区，
+ * 只在处理请求期间有效
+ */
+struct HttpRequest {
+    std::string_view method;
+    // 完整的request-target，path和query是它的一部分
+    std::string_view target;
+    std::string_view path;
+    std::string_view query;
+    // HTTP/1.x中的x
+    int minor_version{1};
+    std::vector<HttpHeader> headers;
+    std::string_view body;
+    bool keep_alive{true};
+    bool chunked{false};
+    // chunked编码的body需要去掉分块信息，解码后保存在这里
+    std::string chunked_body;
+
+    // 大小写不敏感，不存在时返回空
+    [[nodiscard]] std::string_view header(std::string_view name) const;
+
+    void clear();
+};
+
+/**
+ * @class HttpParser
+ * @brief 增量的HTTP/1.1请求解析器。每次有新数据到达时，用缓冲区中从请求开始的所有数据调用parse，
+ * 解析器记住已经扫描过的位置，不会重复扫描。中间状态只保存偏移量，缓冲区扩容或者搬移数据不影响解析
+ */
+class HttpParser {
+public:
+    enum class Status { COMPLETE, INCOMPLETE, ERROR };
+
+    explicit HttpParser(std::size_t max_header_size = 64 * 1024,
+                        std::size_t max_body_size = 8 * 1024 * 1024)
+        : max_header_size_(max_header_size), max_body_size_(max_body_size) {}
+
+    /**
+     * @brief data从请求的第一个字节开始。返回COMPLETE时request被填充，consumed()是请求占用的字节数，
+     * 下一次调用parse开始解析新的请求
+     */
+    Status parse(std::string_view data, HttpRequest* request);
+
+    [[nodiscard]] std::size_t consumed() const { return consumed_; }
+
+    // 返回ERROR时应该回复的状态码
+    [[nodiscard]] int error_status() const { return error_status_; }
+
+    void reset();
+
+private:
+    enum class State { HEADER, BODY, CHUNK_SIZE, CHUNK_DATA, TRAILER, DONE };
+
+    Status parse_header(std::string_view data, HttpRequest* request);
+    Status parse_chunked(std::string_view data);
+    Status fail(int status);
+
+private:
+    const std::size_t max_header_size_;
+    const std::size_t max_body_size_;
+    State state_{State::HEADER};
+    // 已经扫描过的、确定不包含请求头结束标记的字节数
+    std::size_t scanned_{0};
+    // 请求头的长度，以及body或者当前chunk开始的位置
+    std::size_t header_size_{0};
+    std::size_t offset_{0};
+    std::size_t content_length_{0};
+    std::size_t chunk_remaining_{0};
+    std::size_t consumed_{0};
+    int error_status_{400};
+    // 解码中的chunked body
+    std::string body_;
+};
+
+} // namespace pl
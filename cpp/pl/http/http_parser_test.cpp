@@ -0,0 +1,151 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/http/http_parser.h"
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+using Status = pl::HttpParser::Status;
+
+TEST(HttpParserTest, simple_get) {
+    pl::HttpParser parser;
+    pl::HttpRequest request;
+    std::string data = "GET /index.html?a=1&b=2 HTTP/1.1\r\n"
+                       "Host: localhost\r\n"
+                       "User-Agent:  curl/8.0 \r\n"
+                       "\r\n";
+    ASSERT_EQ(parser.parse(data, &request), Status::COMPLETE);
+    EXPECT_EQ(parser.consumed(), data.size());
+    EXPECT_EQ(request.method, "GET");
+    EXPECT_EQ(request.target, "/index.html?a=1&b=2");
+    EXPECT_EQ(request.path, "/index.html");
+    EXPECT_EQ(request.query, "a=1&b=2");
+    EXPECT_EQ(request.minor_version, 1);
+    ASSERT_EQ(request.headers.size(), 2);
+    EXPECT_EQ(request.header("host"), "localhost");
+    EXPECT_EQ(request.header("USER-AGENT"), "curl/8.0");
+    EXPECT_EQ(request.header("accept"), "");
+    EXPECT_TRUE(request.keep_alive);
+    EXPECT_TRUE(request.body.empty());
+    // 零拷贝，视图指向输入数据
+    EXPECT_EQ(request.method.data(), data.data());
+}
+
+TEST(HttpParserTest, incremental) {
+    std::string data = "POST /submit HTTP/1.1\r\n"
+                       "Content-Length: 11\r\n"
+                       "\r\n"
+                       "hello world";
+    pl::HttpParser parser;
+    pl::HttpRequest request;
+    // 每次多到达一个字节，模拟数据被拆成很多个包
+    for (std::size_t i = 1; i < data.size(); ++i) {
+        std::string partial = data.substr(0, i);
+        ASSERT_EQ(parser.parse(partial, &request), Status::INCOMPLETE) << i;
+    }
+    ASSERT_EQ(parser.parse(data, &request), Status::COMPLETE);
+    EXPECT_EQ(request.method, "POST");
+    EXPECT_EQ(request.path, "/submit");
+    EXPECT_EQ(request.header("content-length"), "11");
+    EXPECT_EQ(request.body, "hello world");
+    EXPECT_EQ(parser.consumed(), data.size());
+}
+
+TEST(HttpParserTest, pipelined) {
+    std::string data;
+    for (int i = 0; i < 3; ++i) {
+        data += "GET /" + std::to_string(i) + " HTTP/1.1\r\nHost: x\r\n\r\n";
+    }
+    data += "GET /partial HTTP/1.1\r\n";
+    pl::HttpParser parser;
+    pl::HttpRequest request;
+    std::size_t offset = 0;
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_EQ(parser.parse(std::string_view(data).substr(offset), &request), Status::COMPLETE);
+        EXPECT_EQ(request.path, "/" + std::to_string(i));
+        offset += parser.consumed();
+    }
+    EXPECT_EQ(parser.parse(std::string_view(data).substr(offset), &request), Status::INCOMPLETE);
+}
+
+TEST(HttpParserTest, chunked) {
+    std::string data = "POST /upload HTTP/1.1\r\n"
+                       "Transfer-Encoding: chunked\r\n"
+                       "\r\n"
+                       "5\r\nhello\r\n"
+                       "1;ext=1\r\n \r\n"
+                       "A\r\n0123456789\r\n"
+                       "0\r\n"
+                       "Trailer: value\r\n"
+                       "\r\n"
+                       "GET /next HTTP/1.1\r\n\r\n";
+    const std::size_t first = data.find("GET /next");
+    pl::HttpParser parser;
+    pl::HttpRequest request;
+    for (std::size_t i = 1; i < first; ++i) {
+        std::string partial = data.substr(0, i);
+        ASSERT_EQ(parser.parse(partial, &request), Status::INCOMPLETE) << i;
+    }
+    ASSERT_EQ(parser.parse(data, &request), Status::COMPLETE);
+    EXPECT_TRUE(request.chunked);
+    EXPECT_EQ(request.body, "hello 0123456789");
+    EXPECT_EQ(request.path, "/upload");
+    EXPECT_EQ(parser.consumed(), first);
+
+    ASSERT_EQ(parser.parse(std::string_view(data).substr(first), &request), Status::COMPLETE);
+    EXPECT_EQ(request.path, "/next");
+    EXPECT_TRUE(request.body.empty());
+    EXPECT_FALSE(request.chunked);
+}
+
+TEST(HttpParserTest, keep_alive) {
+    pl::HttpParser parser;
+    pl::HttpRequest request;
+    ASSERT_EQ(parser.parse("GET / HTTP/1.0\r\n\r\n", &request), Status::COMPLETE);
+    EXPECT_FALSE(request.keep_alive);
+    ASSERT_EQ(parser.parse("GET / HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n", &request),
+              Status::COMPLETE);
+    EXPECT_TRUE(request.keep_alive);
+    ASSERT_EQ(parser.parse("GET / HTTP/1.1\r\nConnection: foo, close\r\n\r\n", &request),
+              Status::COMPLETE);
+    EXPECT_FALSE(request.keep_alive);
+}
+
+TEST(HttpParserTest, errors) {
+    auto error = [](std::string_view data, pl::HttpParser parser = pl::HttpParser()) {
+        pl::HttpRequest request;
+        if (parser.parse(data, &request) != Status::ERROR) {
+            return 0;
+        }
+        return parser.error_status();
+    };
+    EXPECT_EQ(error("GET /\r\n\r\n"), 400);
+    EXPECT_EQ(error("G(T / HTTP/1.1\r\n\r\n"), 400);
+    EXPECT_EQ(error("GET / HTTP/2.0\r\n\r\n"), 505);
+    EXPECT_EQ(error("GET / HTTP/1.1\r\nBad Header: x\r\n\r\n"), 400);
+    EXPECT_EQ(error("GET / HTTP/1.1\r\nA: b\r\n folded\r\n\r\n"), 400);
+    EXPECT_EQ(error("POST / HTTP/1.1\r\nContent-Length: abc\r\n\r\n"), 400);
+    EXPECT_EQ(error("POST / HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\n"), 400);
+    EXPECT_EQ(error("POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n"), 501);
+    EXPECT_EQ(error("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nContent-Length: 1\r\n\r\n"),
+              400);
+    EXPECT_EQ(error("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n"), 400);
+    EXPECT_EQ(error("POST / HTTP/1.1\r\nContent-Length: 100\r\n\r\n", pl::HttpParser(1024, 10)),
+              413);
+    EXPECT_EQ(error("GET / HTTP/1.1\r\nA: " + std::string(100, 'x'), pl::HttpParser(64, 10)), 431);
+}
@@ -0,0 +1,82 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/http/http_response.h"
+
+#include <fmt/format.h>
+#include <iterator>
+
+namespace pl {
+
+std::string_view HttpResponse::reason(int status) {
+    switch (status) {
+    case 200:
+        return "OK";
+    case 204:
+        return "No Content";
+    case 206:
+        return "Partial Content";
+    case 301:
+        return "Moved Permanently";
+    case 304:
+        return "Not Modified";
+    case 400:
+        return "Bad Request";
+    case 403:
+        return "Forbidden";
+    case 404:
+        return "Not Found";
+    case 405:
+        return "Method Not Allowed";
+    case 413:
+        return "Content Too Large";
+    case 416:
+        return "Range Not Satisfiable";
+    case 431:
+        return "Request Header Fields Too Large";
+    case 500:
+        return "Internal Server Error";
+    case 501:
+        return "Not Implemented";
+    case 505:
+        return "HTTP Version Not Supported";
+    default:
+        return "Unknown";
+    }
+}
+
+void HttpResponse::add_header(std::string_view name, std::string_view value) {
+    headers_.append(name).append(": ").append(value).append("\r\n");
+}
+
+void HttpResponse::finalize(bool keep_alive, bool head_only) {
+    head_.clear();
+    head_.reserve(headers_.size() + 96);
+    fmt::format_to(std::back_inserter(head_), "HTTP/1.1 {} {}\r\n", status_, reason(status_));
+    head_.append(headers_);
+    fmt::format_to(std::back_inserter(head_), "Content-Length: {}\r\n",
+                   file_ ? file_->length : body().size());
+    if (!keep_alive) {
+        head_.append("Connection: close\r\n");
+    }
+    head_.append("\r\n");
+    if (head_only) {
+        set_body_view({});
+        file_.reset();
+    }
+}
+
+} // namespace pl
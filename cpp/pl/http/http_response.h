@@ -0,0 +1,93 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include "cpp/pl/http/tcp.h"
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace pl {
+
+/**
+ * @class HttpResponse
+ * @brief 响应的状态行和头部序列化到一个字符串中，body单独存放，发送时通过writev一起写出，
+ * body不需要拷贝到头部后面。body也可以是文件的一个区间，发送时不经过用户态
+ */
+class HttpResponse {
+public:
+    explicit HttpResponse(int status = 200) : status_(status) {}
+
+    void set_status(int status) { status_ = status; }
+
+    [[nodiscard]] int status() const { return status_; }
+
+    // Content-Length和Connection由finalize添加
+    void add_header(std::string_view name, std::string_view value);
+
+    void set_content_type(std::string_view type) { add_header("Content-Type", type); }
+
+    void set_body(std::string body) {
+        body_storage_ = std::move(body);
+        body_ = {};
+        owns_body_ = true;
+    }
+
+    // 不拷贝body，body需要在响应发送之前一直有效，例如字符串常量或者请求中的数据
+    void set_body_view(std::string_view body) {
+        body_storage_.clear();
+        body_ = body;
+        owns_body_ = false;
+    }
+
+    // 自己持有的body在使用时才生成view，响应在vector中移动之后仍然有效
+    [[nodiscard]] std::string_view body() const {
+        return owns_body_ ? std::string_view(body_storage_) : body_;
+    }
+
+    // 以文件的一个区间作为body，会替换掉之前设置的body
+    void set_file(FileRange range, FileTransfer transfer = FileTransfer::SENDFILE) {
+        set_body_view({});
+        file_.emplace(std::move(range));
+        transfer_ = transfer;
+    }
+
+    [[nodiscard]] const std::optional<FileRange>& file() const { return file_; }
+
+    [[nodiscard]] FileTransfer transfer() const { return transfer_; }
+
+    // 生成状态行和头部，head_only用于HEAD请求，只保留Content-Length不发送body
+    void finalize(bool keep_alive, bool head_only = false);
+
+    [[nodiscard]] std::string_view head() const { return head_; }
+
+    static std::string_view reason(int status);
+
+private:
+    int status_;
+    std::string headers_;
+    std::string head_;
+    std::string body_storage_;
+    std::string_view body_;
+    // body存放在body_storage_中，body_不使用
+    bool owns_body_{false};
+    std::optional<FileRange> file_;
+    FileTransfer transfer_{FileTransfer::SENDFILE};
+};
+
+} // namespace pl
@@ -0,0 +1,207 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/http/http.h"
+
+#include <netinet/in.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+class HttpServerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        auto& router = server_.router();
+        router.get("/hello", [](const pl::HttpRequest& /*request*/, pl::HttpResponse& response) {
+            response.set_content_type("text/plain");
+            response.set_body_view("hello world");
+        });
+        router.post("/echo", [](const pl::HttpRequest& request, pl::HttpResponse& response) {
+            response.set_body_view(request.body);
+        });
+        router.get("/files/*", [](const pl::HttpRequest& request, pl::HttpResponse& response) {
+            response.set_body(std::string(request.path.substr(7)));
+        });
+        router.get("/throw", [](const pl::HttpRequest& /*request*/,
+                                pl::HttpResponse& /*response*/) {
+            throw std::runtime_error("oops");
+        });
+        server_.init("127.0.0.1", "0");
+        server_.set_reactor_threads(2);
+        server_.listen();
+        thread_ = std::thread([this]() { server_.start(); });
+        fd_ = connect_to(server_.port());
+        ASSERT_GE(fd_, 0);
+    }
+
+    void TearDown() override {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+        server_.stop();
+        thread_.join();
+    }
+
+    static int connect_to(uint16_t port) {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    void send(std::string_view data) const {
+        while (!data.empty()) {
+            ssize_t n = ::write(fd_, data.data(), data.size());
+            ASSERT_GT(n, 0);
+            data.remove_prefix(n);
+        }
+    }
+
+    // 读取一个完整的响应，返回状态码和body
+    std::pair<int, std::string> recv_response() {
+        for (;;) {
+            auto end = buf_.find("\r\n\r\n");
+            if (end != std::string::npos) {
+                int status = std::stoi(buf_.substr(9, 3));
+                auto pos = buf_.find("Content-Length: ");
+                std::size_t length = std::stoul(buf_.substr(pos + 16));
+                if (buf_.size() >= end + 4 + length) {
+                    std::string body = buf_.substr(end + 4, length);
+                    buf_.erase(0, end + 4 + length);
+                    return {status, body};
+                }
+            }
+            char tmp[4096];
+            ssize_t n = ::read(fd_, tmp, sizeof(tmp));
+            if (n <= 0) {
+                return {-1, ""};
+            }
+            buf_.append(tmp, n);
+        }
+    }
+
+    // 对端是否已经关闭连接
+    bool closed_by_peer() const {
+        char c;
+        return buf_.empty() && ::read(fd_, &c, 1) == 0;
+    }
+
+    pl::HttpServer server_;
+    std::thread thread_;
+    int fd_{-1};
+    std::string buf_;
+};
+
+} // namespace
+
+TEST_F(HttpServerTest, keep_alive) {
+    for (int i = 0; i < 10; ++i) {
+        send("GET /hello HTTP/1.1\r\nHost: x\r\n\r\n");
+        auto [status, body] = recv_response();
+        EXPECT_EQ(status, 200);
+        EXPECT_EQ(body, "hello world");
+    }
+}
+
+TEST_F(HttpServerTest, pipelining) {
+    std::string batch;
+    for (int i = 0; i < 100; ++i) {
+        std::string body = "body-" + std::to_string(i);
+        batch += "POST /echo HTTP/1.1\r\nContent-Length: " + std::to_string(body.size()) +
+                 "\r\n\r\n" + body;
+    }
+    send(batch);
+    for (int i = 0; i < 100; ++i) {
+        auto [status, body] = recv_response();
+        EXPECT_EQ(status, 200);
+        EXPECT_EQ(body, "body-" + std::to_string(i));
+    }
+}
+
+TEST_F(HttpServerTest, pipelining_owned_body) {
+    // set_body的响应在vector扩容时被移动，短body存放在string对象内部，长body在堆上
+    std::string batch;
+    for (int i = 0; i < 64; ++i) {
+        std::string name = i % 2 == 0 ? std::to_string(i) : std::string(100, 'a' + i % 26);
+        batch += "GET /files/" + name + " HTTP/1.1\r\n\r\n";
+    }
+    send(batch);
+    for (int i = 0; i < 64; ++i) {
+        std::string name = i % 2 == 0 ? std::to_string(i) : std::string(100, 'a' + i % 26);
+        auto [status, body] = recv_response();
+        EXPECT_EQ(status, 200);
+        EXPECT_EQ(body, name);
+    }
+}
+
+TEST_F(HttpServerTest, chunked) {
+    send("POST /echo HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+         "3\r\nabc\r\n3\r\ndef\r\n0\r\n\r\n"
+         "POST /echo HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+         "2\r\nxy\r\n0\r\n\r\n");
+    auto [s1, b1] = recv_response();
+    EXPECT_EQ(s1, 200);
+    EXPECT_EQ(b1, "abcdef");
+    auto [s2, b2] = recv_response();
+    EXPECT_EQ(s2, 200);
+    EXPECT_EQ(b2, "xy");
+}
+
+TEST_F(HttpServerTest, routing) {
+    send("GET /files/a/b.txt HTTP/1.1\r\n\r\n");
+    EXPECT_EQ(recv_response(), std::make_pair(200, std::string("a/b.txt")));
+    send("GET /missing HTTP/1.1\r\n\r\n");
+    EXPECT_EQ(recv_response().first, 404);
+    send("DELETE /hello HTTP/1.1\r\n\r\n");
+    EXPECT_EQ(recv_response().first, 405);
+    send("GET /throw HTTP/1.1\r\n\r\n");
+    EXPECT_EQ(recv_response().first, 500);
+    // HEAD使用GET的handler，但是不返回body
+    send("HEAD /hello HTTP/1.1\r\n\r\nGET /hello HTTP/1.1\r\n\r\n");
+    char head[256];
+    std::string all;
+    while (all.find("hello world") == std::string::npos) {
+        ssize_t n = ::read(fd_, head, sizeof(head));
+        ASSERT_GT(n, 0);
+        all.append(head, n);
+    }
+    auto head_end = all.find("\r\n\r\n");
+    EXPECT_NE(all.substr(0, head_end).find("Content-Length: 11"), std::string::npos);
+    // 第一个响应的头部之后紧跟着第二个响应
+    EXPECT_EQ(all.compare(head_end + 4, 8, "HTTP/1.1"), 0);
+}
+
+TEST_F(HttpServerTest, connection_close) {
+    send("GET /hello HTTP/1.1\r\nConnection: close\r\n\r\n");
+    EXPECT_EQ(recv_response().second, "hello world");
+    EXPECT_TRUE(closed_by_peer());
+}
+
+TEST_F(HttpServerTest, bad_request) {
+    send("BROKEN\r\n\r\n");
+    EXPECT_EQ(recv_response().first, 400);
+    EXPECT_TRUE(closed_by_peer());
+}
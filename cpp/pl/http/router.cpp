@@ -0,0 +1,77 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/http/router.h"
+
+#include <algorithm>
+
+namespace pl {
+
+const HttpHandler* Router::Route::find(std::string_view method) const {
+    for (const auto& [m, handler] : handlers) {
+        if (m == method) {
+            return &handler;
+        }
+    }
+    if (method == "HEAD") {
+        return find("GET");
+    }
+    return nullptr;
+}
+
+void Router::add(std::string_view method, std::string_view path, HttpHandler handler) {
+    if (path.size() >= 2 && path.substr(path.size() - 2) == "/*") {
+        std::string prefix(path.substr(0, path.size() - 1));
+        auto it = std::find_if(prefix_.begin(), prefix_.end(),
+                               [&](const auto& route) { return route.first == prefix; });
+        if (it == prefix_.end()) {
+            prefix_.emplace_back(prefix, Route{});
+            it = std::prev(prefix_.end());
+        }
+        it->second.handlers.emplace_back(method, std::move(handler));
+        std::stable_sort(prefix_.begin(), prefix_.end(), [](const auto& a, const auto& b) {
+            return a.first.size() > b.first.size();
+        });
+        return;
+    }
+    exact_[std::string(path)].handlers.emplace_back(method, std::move(handler));
+}
+
+void Router::dispatch(const HttpRequest& request, HttpResponse& response) const {
+    const Route* route = nullptr;
+    if (auto it = exact_.find(request.path); it != exact_.end()) {
+        route = &it->second;
+    } else {
+        for (const auto& [prefix, r] : prefix_) {
+            if (request.path.substr(0, prefix.size()) == prefix) {
+                route = &r;
+                break;
+            }
+        }
+    }
+    if (route == nullptr) {
+        response.set_status(404);
+        return;
+    }
+    const HttpHandler* handler = route->find(request.method);
+    if (handler == nullptr) {
+        response.set_status(405);
+        return;
+    }
+    (*handler)(request, response);
+}
+
+} // namespace pl
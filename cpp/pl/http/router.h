@@ -0,0 +1,66 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include "cpp/pl/http/http_parser.h"
+#include "cpp/pl/http/http_response.h"
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace pl {
+
+using HttpHandler = std::function<void(const HttpRequest&, HttpResponse&)>;
+
+// 按method和path分发请求。path以"/*"结尾时按前缀匹配，精确匹配优先，前缀匹配时最长的前缀优先。
+// 路由需要在服务器启动之前注册完，之后只读，可以在多个reactor线程中并发使用
+class Router {
+public:
+    void add(std::string_view method, std::string_view path, HttpHandler handler);
+
+    void get(std::string_view path, HttpHandler handler) { add("GET", path, std::move(handler)); }
+
+    void post(std::string_view path, HttpHandler handler) { add("POST", path, std::move(handler)); }
+
+    // 没有匹配的路径时返回404，路径匹配但是方法不匹配时返回405。HEAD请求使用GET的handler
+    void dispatch(const HttpRequest& request, HttpResponse& response) const;
+
+private:
+    struct Route {
+        std::vector<std::pair<std::string, HttpHandler>> handlers;
+
+        [[nodiscard]] const HttpHandler* find(std::string_view method) const;
+    };
+
+    struct StringHash {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view s) const {
+            return std::hash<std::string_view>()(s);
+        }
+    };
+
+    std::unordered_map<std::string, Route, StringHash, std::equal_to<>> exact_;
+    // 按前缀长度从长到短排列
+    std::vector<std::pair<std::string, Route>> prefix_;
+};
+
+} // namespace pl
@@ -14,10 +14,25 @@
 
 // Authors: liubang (it.liubang@gmail.com)
 
+#include "cpp/pl/fs/posix_fs.h"
+#include "cpp/pl/http/file_handler.h"
 #include "cpp/pl/http/http.h"
 
 int main(int argc, char* argv[]) {
     pl::HttpServer server;
+    server.router().get("/", [](const pl::HttpRequest& /*request*/, pl::HttpResponse& response) {
+        response.set_content_type("text/html");
+        response.set_body_view("<h1>hello world</h1>");
+    });
+    server.router().post("/echo", [](const pl::HttpRequest& request, pl::HttpResponse& response) {
+        response.set_body_view(request.body);
+    });
+    // 第一个参数指定静态文件目录，例如sstable所在的目录
+    if (argc > 1) {
+        server.router().get("/static/*",
+                            pl::make_file_handler(std::make_shared<pl::PosixFileSystem>(),
+                                                  argv[1], "/static"));
+    }
     server.init("127.0.0.1", "8099");
     LOG(INFO) << "server start on http://127.0.0.1:8099";
     server.start();
@@ -16,32 +16,649 @@
 
 #include "cpp/pl/http/tcp.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <climits>
+#include <csignal>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
+#include <sys/uio.h>
+#include <system_error>
 #include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace pl {
 
+namespace {
+
+// 每次可读事件最多accept的连接数，监听socket是水平触发的，剩下的下次再处理
+constexpr int MAX_ACCEPT_PER_EVENT = 128;
+constexpr int MAX_EVENTS = 256;
+// 每次sendfile/splice的最大字节数，避免一个大文件长时间占用reactor
+constexpr std::size_t MAX_TRANSFER_CHUNK = 1 << 20;
+// COPY方式每次读取的字节数
+constexpr std::size_t COPY_CHUNK = 64 << 10;
+
+[[noreturn]] void throw_errno(const char* op) {
+    throw std::system_error(errno, std::system_category(), op);
+}
+
+int create_listener(const SocketAddr& addr, int family) {
+    int fd = ::socket(family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        throw_errno("socket");
+    }
+    int on = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) == -1 ||
+        ::bind(fd, addr.addr, addr.addr_len) == -1 || ::listen(fd, SOMAXCONN) == -1) {
+        int err = errno;
+        ::close(fd);
+        throw std::system_error(err, std::system_category(), "listen");
+    }
+    return fd;
+}
+
+/**
+ * sendfile和splice不能像send一样带MSG_NOSIGNAL，对端已经关闭时会产生SIGPIPE。
+ * 调用期间在当前线程屏蔽SIGPIPE，调用产生的SIGPIPE在恢复屏蔽字之前取走，
+ * 不影响进程对SIGPIPE的处理方式。调用之前就已经挂起的SIGPIPE不属于这次调用，保持不变
+ */
+template <typename F> ssize_t without_sigpipe(F&& f) {
+    sigset_t sigpipe;
+    sigemptyset(&sigpipe);
+    sigaddset(&sigpipe, SIGPIPE);
+    sigset_t old;
+    ::pthread_sigmask(SIG_BLOCK, &sigpipe, &old);
+    sigset_t pending;
+    sigpending(&pending);
+    bool was_pending = sigismember(&pending, SIGPIPE) == 1;
+
+    ssize_t n = f();
+    int err = errno;
+    if (!was_pending) {
+        sigpending(&pending);
+        if (sigismember(&pending, SIGPIPE) == 1) {
+            timespec zero{};
+            while (::sigtimedwait(&sigpipe, nullptr, &zero) == -1 && errno == EINTR) {
+            }
+        }
+    }
+    ::pthread_sigmask(SIG_SETMASK, &old, nullptr);
+    errno = err;
+    return n;
+}
+
+} // namespace
+
+/**
+ * @class Reactor
+ * @brief 一个线程上的事件循环，负责自己的监听socket以及在这个socket上accept的所有连接
+ */
+class Reactor {
+public:
+    Reactor(TcpServer* server, int listen_fd)
+        : server_(server),
+          listen_fd_(listen_fd),
+          epoll_fd_(::epoll_create1(EPOLL_CLOEXEC)),
+          event_fd_(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+          idle_fd_(::open("/dev/null", O_RDONLY | O_CLOEXEC)) {
+        if (epoll_fd_ == -1 || event_fd_ == -1) {
+            throw_errno("epoll");
+        }
+        add(listen_fd_, EPOLLIN, &listen_fd_);
+        add(event_fd_, EPOLLIN, &event_fd_);
+    }
+
+    ~Reactor() {
+        connections_.clear();
+        ::close(listen_fd_);
+        ::close(event_fd_);
+        ::close(epoll_fd_);
+        if (idle_fd_ != -1) {
+            ::close(idle_fd_);
+        }
+    }
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    void run() {
+        epoll_event events[MAX_EVENTS];
+        while (!stop_.load(std::memory_order_acquire)) {
+            int n = ::epoll_wait(epoll_fd_, events, MAX_EVENTS, next_timeout());
+            if (n == -1) {
+                if (errno != EINTR) {
+                    LOG(ERROR) << "epoll_wait: " << ::strerror(errno);
+                    break;
+                }
+                continue;
+            }
+            for (int i = 0; i < n; ++i) {
+                void* ptr = events[i].data.ptr;
+                if (ptr == &listen_fd_) {
+                    handle_accept();
+                } else if (ptr == &event_fd_) {
+                    uint64_t value = 0;
+                    (void)::read(event_fd_, &value, sizeof(value));
+                } else {
+                    handle_event(static_cast<TcpConnection*>(ptr), events[i].events);
+                }
+            }
+            expire_close_timers();
+        }
+        for (auto& [fd, conn] : connections_) {
+            server_->on_close(*conn);
+        }
+        connections_.clear();
+    }
+
+    // 可以在任意线程调用
+    void stop() {
+        stop_.store(true, std::memory_order_release);
+        uint64_t one = 1;
+        (void)::write(event_fd_, &one, sizeof(one));
+    }
+
+    [[nodiscard]] TcpServer* server() const { return server_; }
+
+    // 连接关闭了写端，超时之后强制关闭。超时时间都相同，所以按截止时间排序的队列就是FIFO
+    void close_later(TcpConnection* conn) {
+        conn->close_deadline_ = std::chrono::steady_clock::now() + server_->close_timeout();
+        close_timers_.push_back({conn->close_deadline_, conn->fd(), conn});
+    }
+
+private:
+    struct CloseTimer {
+        std::chrono::steady_clock::time_point deadline;
+        int fd;
+        TcpConnection* conn;
+    };
+
+    // epoll_wait的超时时间，没有定时器时一直等待
+    int next_timeout() const {
+        if (close_timers_.empty()) {
+            return -1;
+        }
+        auto wait = std::chrono::ceil<std::chrono::milliseconds>(
+            close_timers_.front().deadline - std::chrono::steady_clock::now());
+        return static_cast<int>(std::max<std::chrono::milliseconds::rep>(wait.count(), 0));
+    }
+
+    void expire_close_timers() {
+        auto now = std::chrono::steady_clock::now();
+        while (!close_timers_.empty() && close_timers_.front().deadline <= now) {
+            CloseTimer timer = close_timers_.front();
+            close_timers_.pop_front();
+            // 连接可能已经关闭，fd也可能被新的连接复用
+            auto it = connections_.find(timer.fd);
+            if (it == connections_.end() || it->second.get() != timer.conn ||
+                timer.conn->state_ != TcpConnection::State::DISCONNECTING ||
+                timer.conn->close_deadline_ != timer.deadline) {
+                continue;
+            }
+            timer.conn->close();
+            remove_if_closed(timer.conn);
+        }
+    }
+
+    void add(int fd, uint32_t events, void* ptr) const {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.ptr = ptr;
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == -1) {
+            throw_errno("epoll_ctl");
+        }
+    }
+
+    void handle_accept() {
+        for (int i = 0; i < MAX_ACCEPT_PER_EVENT; ++i) {
+            SocketAddrStorage peer;
+            int fd =
+                ::accept4(listen_fd_, &peer.addr, &peer.addr_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd == -1) {
+                if (errno == EMFILE && idle_fd_ != -1) {
+                    // fd耗尽时用预留的fd接受连接并立即关闭，否则水平触发的监听socket会一直就绪
+                    ::close(idle_fd_);
+                    idle_fd_ = ::accept(listen_fd_, nullptr, nullptr);
+                    ::close(idle_fd_);
+                    idle_fd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+                    LOG(WARN) << "accept: too many open files";
+                } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR &&
+                           errno != ECONNABORTED) {
+                    LOG(ERROR) << "accept: " << ::strerror(errno);
+                }
+                return;
+            }
+            int on = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            auto conn = std::make_unique<TcpConnection>(this, fd, peer);
+            TcpConnection* ptr = conn.get();
+            connections_.emplace(fd, std::move(conn));
+            add(fd, EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, ptr);
+            server_->on_accept(*ptr);
+            remove_if_closed(ptr);
+        }
+    }
+
+    void handle_event(TcpConnection* conn, uint32_t events) {
+        if ((events & EPOLLERR) != 0) {
+            int err = 0;
+            socklen_t len = sizeof(err);
+            ::getsockopt(conn->fd(), SOL_SOCKET, SO_ERROR, &err, &len);
+            errno = err;
+            conn->handle_error("socket");
+        }
+        if ((events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) != 0) {
+            conn->handle_read();
+        }
+        if ((events & EPOLLOUT) != 0) {
+            conn->handle_write();
+        }
+        remove_if_closed(conn);
+    }
+
+    void remove_if_closed(TcpConnection* conn) {
+        if (conn->state_ != TcpConnection::State::CLOSED) {
+            return;
+        }
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, conn->fd(), nullptr);
+        server_->on_close(*conn);
+        connections_.erase(conn->fd());
+    }
+
+private:
+    TcpServer* const server_;
+    int listen_fd_;
+    int epoll_fd_;
+    int event_fd_;
+    int idle_fd_;
+    std::atomic<bool> stop_{false};
+    std::unordered_map<int, std::unique_ptr<TcpConnection>> connections_;
+    std::deque<CloseTimer> close_timers_;
+};
+
+TcpConnection::TcpConnection(Reactor* reactor, int fd, const SocketAddrStorage& peer)
+    : reactor_(reactor), fd_(fd), peer_(peer) {}
+
+TcpConnection::~TcpConnection() {
+    ::close(fd_);
+    if (pipe_[0] != -1) {
+        ::close(pipe_[0]);
+        ::close(pipe_[1]);
+    }
+}
+
+std::size_t TcpConnection::output_bytes() const {
+    std::size_t bytes = output_.readable_bytes();
+    for (const auto& file : files_) {
+        bytes += file.after.readable_bytes();
+    }
+    return bytes;
+}
+
+void TcpConnection::send(std::string_view data) {
+    if (state_ != State::CONNECTED) {
+        return;
+    }
+    std::size_t written = 0;
+    // 没有待发送的数据时直接写socket，大多数情况下可以一次写完，不需要拷贝
+    if (drained()) {
+        ssize_t n = ::send(fd_, data.data(), data.size(), MSG_NOSIGNAL);
+        if (n >= 0) {
+            written = static_cast<std::size_t>(n);
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            handle_error("send");
+            return;
+        }
+    }
+    if (written < data.size()) {
+        iovec iov{const_cast<char*>(data.data()), data.size()};
+        append_output(&iov, 1, written);
+    }
+}
+
+void TcpConnection::send(const struct iovec* iov, int count) {
+    if (state_ != State::CONNECTED) {
+        return;
+    }
+    std::size_t written = 0;
+    if (drained()) {
+        // 与send相同，对端已经关闭时不能产生SIGPIPE，writev没有对应的标志，使用sendmsg
+        msghdr msg{};
+        msg.msg_iov = const_cast<struct iovec*>(iov);
+        msg.msg_iovlen = static_cast<std::size_t>(std::min(count, IOV_MAX));
+        ssize_t n = ::sendmsg(fd_, &msg, MSG_NOSIGNAL);
+        if (n >= 0) {
+            written = static_cast<std::size_t>(n);
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            handle_error("sendmsg");
+            return;
+        }
+    }
+    append_output(iov, count, written);
+}
+
+void TcpConnection::append_output(const struct iovec* iov, int count, std::size_t skip) {
+    Buffer& buffer = tail();
+    for (int i = 0; i < count; ++i) {
+        if (skip >= iov[i].iov_len) {
+            skip -= iov[i].iov_len;
+            continue;
+        }
+        buffer.append(static_cast<const char*>(iov[i].iov_base) + skip, iov[i].iov_len - skip);
+        skip = 0;
+    }
+    if (reading_ && output_bytes() >= reactor_->server()->high_water_mark()) {
+        reading_ = false;
+    }
+}
+
+void TcpConnection::send_file(FileRange range, FileTransfer transfer) {
+    if (state_ != State::CONNECTED || range.length == 0) {
+        return;
+    }
+    // 文件本身不占用内存，不计入高水位
+    files_.push_back(PendingFile{std::move(range), transfer, Buffer()});
+    if (files_.size() == 1 && output_.readable_bytes() == 0) {
+        flush();
+    }
+}
+
+TcpConnection::TransferResult TcpConnection::transfer_file(PendingFile& file) {
+    FileRange& range = file.range;
+    int in = range.fd->native_handle();
+    if (in < 0) {
+        file.transfer = FileTransfer::COPY;
+    }
+    while (range.length > 0 || pipe_bytes_ > 0) {
+        if (file.transfer == FileTransfer::SPLICE) {
+            TransferResult result = splice_file(file, in);
+            if (result == TransferResult::DONE) {
+                continue;
+            }
+            return result;
+        }
+        if (file.transfer == FileTransfer::COPY) {
+            // 每次只读一块，发送完之后再读下一块，占用的内存有上限
+            std::size_t len = std::min<uint64_t>(range.length, COPY_CHUNK);
+            output_.ensure_writable(len);
+            ssize_t n = 0;
+            if (range.fs != nullptr) {
+                std::string_view result;
+                Status s = range.fs->pread(range.fd, range.offset, len, output_.begin_write(),
+                                           &result);
+                if (!s.ok()) {
+                    // 错误已经由文件系统记录
+                    state_ = State::CLOSED;
+                    return TransferResult::ERROR;
+                }
+                if (!result.empty() && result.data() != output_.begin_write()) {
+                    std::memmove(output_.begin_write(), result.data(), result.size());
+                }
+                n = static_cast<ssize_t>(result.size());
+            } else {
+                n = ::pread(in, output_.begin_write(), len, static_cast<off_t>(range.offset));
+            }
+            if (n <= 0) {
+                errno = n == 0 ? EIO : errno;
+                handle_error("pread");
+                return TransferResult::ERROR;
+            }
+            output_.has_written(n);
+            range.offset += n;
+            range.length -= n;
+            return range.length == 0 ? TransferResult::DONE : TransferResult::COPIED;
+        }
+        auto off = static_cast<off_t>(range.offset);
+        ssize_t n = without_sigpipe([&]() {
+            return ::sendfile(fd_, in, &off, std::min<uint64_t>(range.length, MAX_TRANSFER_CHUNK));
+        });
+        if (n > 0) {
+            range.offset += n;
+            range.length -= n;
+        } else if (n == 0) {
+            // 文件在发送过程中被截断了，已经无法按照Content-Length发送完整的响应
+            errno = EIO;
+            handle_error("sendfile");
+            return TransferResult::ERROR;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return TransferResult::BLOCKED;
+        } else if (errno == EINVAL || errno == ENOSYS) {
+            file.transfer = FileTransfer::SPLICE;
+        } else if (errno != EINTR) {
+            handle_error("sendfile");
+            return TransferResult::ERROR;
+        }
+    }
+    return TransferResult::DONE;
+}
+
+TcpConnection::TransferResult TcpConnection::splice_file(PendingFile& file, int in) {
+    FileRange& range = file.range;
+    if (pipe_[0] == -1 && ::pipe2(pipe_, O_NONBLOCK | O_CLOEXEC) == -1) {
+        file.transfer = FileTransfer::COPY;
+        return TransferResult::DONE;
+    }
+    // 管道为空时先从文件搬一批数据进去，再从管道搬到socket
+    if (pipe_bytes_ == 0) {
+        auto off = static_cast<loff_t>(range.offset);
+        ssize_t n = ::splice(in, &off, pipe_[1], nullptr,
+                             std::min<uint64_t>(range.length, MAX_TRANSFER_CHUNK),
+                             SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (n > 0) {
+            pipe_bytes_ = n;
+            range.offset += n;
+            range.length -= n;
+        } else if (n == -1 && (errno == EINVAL || errno == ENOSYS)) {
+            file.transfer = FileTransfer::COPY;
+            return TransferResult::DONE;
+        } else if (n == -1 && errno == EINTR) {
+            return TransferResult::DONE;
+        } else {
+            errno = n == 0 ? EIO : errno;
+            handle_error("splice");
+            return TransferResult::ERROR;
+        }
+    }
+    ssize_t n = without_sigpipe([&]() {
+        return ::splice(pipe_[0], nullptr, fd_, nullptr, pipe_bytes_,
+                        SPLICE_F_MOVE | SPLICE_F_NONBLOCK | SPLICE_F_MORE);
+    });
+    if (n > 0) {
+        pipe_bytes_ -= n;
+    } else if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return TransferResult::BLOCKED;
+    } else if (n == -1 && errno != EINTR) {
+        handle_error("splice");
+        return TransferResult::ERROR;
+    }
+    return TransferResult::DONE;
+}
+
+void TcpConnection::shutdown() {
+    if (state_ != State::CONNECTED) {
+        return;
+    }
+    state_ = State::DISCONNECTING;
+    if (drained()) {
+        shutdown_write();
+    }
+}
+
+void TcpConnection::shutdown_write() {
+    ::shutdown(fd_, SHUT_WR);
+    reactor_->close_later(this);
+}
+
+void TcpConnection::close() { state_ = State::CLOSED; }
+
+void TcpConnection::handle_error(const char* op) {
+    if (errno != ECONNRESET && errno != EPIPE) {
+        LOG(WARN) << op << ": " << ::strerror(errno);
+    }
+    state_ = State::CLOSED;
+}
+
+void TcpConnection::handle_read() {
+    if (state_ == State::CLOSED || peer_closed_) {
+        return;
+    }
+    for (;;) {
+        if (!reading_) {
+            read_pending_ = true;
+            return;
+        }
+        ssize_t n = input_.read_fd(fd_);
+        if (n > 0) {
+            reactor_->server()->on_message(*this, input_);
+            if (state_ == State::CLOSED) {
+                return;
+            }
+            continue;
+        }
+        if (n == 0) {
+            // 对端关闭了写端，还有数据没有发送完时等发送完再关闭
+            peer_closed_ = true;
+            if (drained()) {
+                state_ = State::CLOSED;
+            } else {
+                state_ = State::DISCONNECTING;
+            }
+            return;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return;
+        }
+        if (errno != EINTR) {
+            handle_error("read");
+            return;
+        }
+    }
+}
+
+void TcpConnection::handle_write() {
+    if (state_ == State::CLOSED || drained()) {
+        return;
+    }
+    flush();
+}
+
+void TcpConnection::flush() {
+    bool blocked = false;
+    while (!blocked) {
+        while (output_.readable_bytes() > 0) {
+            ssize_t n = ::send(fd_, output_.peek(), output_.readable_bytes(), MSG_NOSIGNAL);
+            if (n > 0) {
+                output_.retrieve(n);
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                blocked = true;
+                break;
+            } else if (errno != EINTR) {
+                handle_error("send");
+                return;
+            }
+        }
+        if (blocked || files_.empty()) {
+            break;
+        }
+        PendingFile& file = files_.front();
+        TransferResult result = transfer_file(file);
+        if (result == TransferResult::ERROR) {
+            return;
+        }
+        if (result == TransferResult::BLOCKED) {
+            blocked = true;
+        } else if (result == TransferResult::DONE) {
+            // 文件发送完，排在它后面的数据成为新的输出缓冲区
+            if (output_.readable_bytes() == 0) {
+                std::swap(output_, file.after);
+            } else {
+                output_.append(file.after.view());
+            }
+            files_.pop_front();
+        }
+    }
+
+    if (drained()) {
+        output_.shrink();
+        if (state_ == State::DISCONNECTING) {
+            if (peer_closed_) {
+                state_ = State::CLOSED;
+            } else {
+                shutdown_write();
+            }
+            return;
+        }
+    }
+    if (!reading_ && output_bytes() < reactor_->server()->high_water_mark() / 2) {
+        reading_ = true;
+        if (std::exchange(read_pending_, false)) {
+            handle_read();
+        }
+    }
+}
+
 void TcpServer::init(const std::string& host, const std::string& service) {
     resolver_ = std::make_unique<AddrResolver>();
     resolver_->resolve(host, service);
 }
 
-std::vector<std::thread> pool;
+TcpServer::TcpServer() = default;
 
-void TcpServer::start() {
+TcpServer::~TcpServer() = default;
+
+void TcpServer::listen() {
+    if (!reactors_.empty()) {
+        return;
+    }
     auto entry = resolver_->get_first_entry();
-    int sock_fd = entry.create_socket_and_bind();
-    for (;;) {
-        SocketAddrStorage peer_addr;
-        int conn_id = ::accept(sock_fd, &peer_addr.addr, &peer_addr.addr_len);
-        pool.emplace_back([this, conn_id] {
-            this->on_accept(conn_id);
-        });
+    int family = entry.curr->ai_family;
+    std::size_t threads = reactor_threads_ == 0 ? 1 : reactor_threads_;
+    // 端口为0时由系统分配，其他reactor需要绑定到第一个socket实际监听的地址上
+    SocketAddrStorage bound;
+    for (std::size_t i = 0; i < threads; ++i) {
+        int fd = create_listener(i == 0 ? entry.get_addr() : SocketAddr(bound), family);
+        if (i == 0) {
+            ::getsockname(fd, &bound.addr, &bound.addr_len);
+            port_ = ntohs(family == AF_INET6
+                              ? reinterpret_cast<sockaddr_in6*>(&bound.addr_storage)->sin6_port
+                              : reinterpret_cast<sockaddr_in*>(&bound.addr_storage)->sin_port);
+        }
+        try {
+            reactors_.emplace_back(std::make_unique<Reactor>(this, fd));
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
     }
+}
 
-    for (auto& t : pool) {
+void TcpServer::start() {
+    listen();
+    std::vector<std::thread> threads;
+    threads.reserve(reactors_.size() - 1);
+    for (std::size_t i = 1; i < reactors_.size(); ++i) {
+        threads.emplace_back([reactor = reactors_[i].get()]() { reactor->run(); });
+    }
+    reactors_[0]->run();
+    for (auto& t : threads) {
         t.join();
     }
 }
 
+void TcpServer::stop() {
+    for (auto& reactor : reactors_) {
+        reactor->stop();
+    }
+}
+
 } // namespace pl
@@ -14,14 +14,26 @@
 
 // Authors: liubang (it.liubang@gmail.com)
 
+#pragma once
+
+#include "cpp/pl/fs/fs.h"
+#include "cpp/pl/http/buffer.h"
 #include "cpp/pl/log/logger.h"
 
+#include <any>
 #include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <cstdio>
+#include <deque>
 #include <fcntl.h>
 #include <fmt/format.h>
 #include <memory>
 #include <netdb.h>
+#include <string_view>
+#include <thread>
+#include <vector>
 #if defined(__APPLE__) && defined(__MACH__)
 #include <sys/event.h>
 #elif defined(__linux__)
@@ -31,6 +43,7 @@
 #endif
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 namespace pl {
@@ -112,17 +125,182 @@ struct AddrResolver {
     AddrResolvedEntry get_first_entry() { return {head}; }
 };
 
+class Reactor;
+class TcpServer;
+
+// 发送文件的方式
+enum class FileTransfer {
+    // sendfile，数据不经过用户态
+    SENDFILE,
+    // 通过管道splice到socket，同样不经过用户态，用于不支持sendfile的文件
+    SPLICE,
+    // pread到用户态缓冲区再写socket
+    COPY,
+};
+
+// 文件中的一个区间，fs只在没有内核文件描述符时使用，可以为空
+struct FileRange {
+    FileSystem* fs{nullptr};
+    FileDescriptorRef fd;
+    uint64_t offset{0};
+    uint64_t length{0};
+};
+
+/**
+ * @class TcpConnection
+ * @brief 非阻塞的tcp连接，以边缘触发的方式注册在某个reactor上。
+ * 所有接口都只能在所属reactor的线程中调用，也就是TcpServer的回调中
+ */
+class TcpConnection {
+public:
+    TcpConnection(Reactor* reactor, int fd, const SocketAddrStorage& peer);
+    ~TcpConnection();
+
+    TcpConnection(const TcpConnection&) = delete;
+    TcpConnection& operator=(const TcpConnection&) = delete;
+
+    /**
+     * @brief 发送数据，socket写不下的部分追加到输出缓冲区，等可写时继续发送。
+     * 输出缓冲区超过高水位时暂停读取，降到低水位以下时恢复，防止对端只写不读时缓冲区无限增长
+     */
+    void send(std::string_view data);
+
+    // 通过writev一次发送多段数据，语义与send相同
+    void send(const struct iovec* iov, int count);
+
+    /**
+     * @brief 发送文件的一个区间，与send的数据按照调用的顺序发送。文件描述符在发送完之前一直被持有，
+     * sendfile/splice不被支持时依次退化为splice、copy
+     */
+    void send_file(FileRange range, FileTransfer transfer = FileTransfer::SENDFILE);
+
+    // 输出缓冲区的数据发送完之后关闭写端
+    void shutdown();
+
+    // 立即关闭连接，丢弃未发送的数据
+    void close();
+
+    [[nodiscard]] int fd() const { return fd_; }
+
+    [[nodiscard]] bool connected() const { return state_ == State::CONNECTED; }
+
+    // 因为背压暂停读取时返回false
+    [[nodiscard]] bool reading() const { return reading_; }
+
+    // 输出缓冲区中的字节数，不包括还没有发送的文件
+    [[nodiscard]] std::size_t output_bytes() const;
+
+    [[nodiscard]] const SocketAddrStorage& peer() const { return peer_; }
+
+    // 供上层协议保存连接相关的状态
+    [[nodiscard]] std::any& context() { return context_; }
+
+private:
+    friend class Reactor;
+
+    enum class State { CONNECTED, DISCONNECTING, CLOSED };
+
+    struct PendingFile {
+        FileRange range;
+        FileTransfer transfer;
+        // 在这个文件之后发送的数据
+        Buffer after;
+    };
+
+    enum class TransferResult { DONE, BLOCKED, COPIED, ERROR };
+
+    void handle_read();
+    void handle_write();
+    void handle_error(const char* op);
+    void flush();
+    // 关闭写端，对端在close_timeout之内没有关闭时由reactor强制关闭
+    void shutdown_write();
+    void append_output(const struct iovec* iov, int count, std::size_t skip);
+    // 新的数据追加到最后一个文件之后
+    Buffer& tail() { return files_.empty() ? output_ : files_.back().after; }
+    [[nodiscard]] bool drained() const { return output_.readable_bytes() == 0 && files_.empty(); }
+    TransferResult transfer_file(PendingFile& file);
+    TransferResult splice_file(PendingFile& file, int in);
+
+private:
+    Reactor* const reactor_;
+    const int fd_;
+    SocketAddrStorage peer_;
+    State state_{State::CONNECTED};
+    bool reading_{true};
+    // 暂停读取期间有数据到达，恢复时需要主动读一次，边缘触发不会再通知
+    bool read_pending_{false};
+    bool peer_closed_{false};
+    // 关闭写端之后等待对端关闭的截止时间
+    std::chrono::steady_clock::time_point close_deadline_;
+    Buffer input_;
+    Buffer output_;
+    std::deque<PendingFile> files_;
+    // splice使用的管道，第一次需要时创建
+    int pipe_[2]{-1, -1};
+    std::size_t pipe_bytes_{0};
+    std::any context_;
+};
+
+/**
+ * @class TcpServer
+ * @brief 多reactor的tcp服务器，每个reactor线程有自己的epoll和一个设置了SO_REUSEPORT的监听socket，
+ * 由内核把新连接分散到各个reactor上，连接之后的所有事件都在同一个线程中处理
+ */
 class TcpServer {
 public:
+    TcpServer();
+    virtual ~TcpServer();
+
+    TcpServer(const TcpServer&) = delete;
+    TcpServer& operator=(const TcpServer&) = delete;
+
     void init(const std::string& host, const std::string& service);
 
+    // 需要在listen之前调用
+    void set_reactor_threads(std::size_t threads) { reactor_threads_ = threads == 0 ? 1 : threads; }
+
+    void set_high_water_mark(std::size_t bytes) { high_water_mark_ = bytes; }
+
+    [[nodiscard]] std::size_t high_water_mark() const { return high_water_mark_; }
+
+    // 连接关闭写端之后等待对端关闭的最长时间，超时之后强制关闭，防止对端一直不关闭时连接泄漏
+    void set_close_timeout(std::chrono::milliseconds timeout) { close_timeout_ = timeout; }
+
+    [[nodiscard]] std::chrono::milliseconds close_timeout() const { return close_timeout_; }
+
+    // 创建监听socket和reactor，失败时抛出std::system_error。
+    // start会在需要时调用，提前调用可以在start之前拿到实际监听的端口
+    void listen();
+
+    [[nodiscard]] uint16_t port() const { return port_; }
+
+    // 执行所有reactor，阻塞直到stop
     void start();
 
+    // 可以在任意线程调用
+    void stop();
+
 protected:
-    virtual void on_accept(int connect_id) = 0;
+    friend class Reactor;
+    friend class TcpConnection;
+
+    virtual void on_accept(TcpConnection& conn) = 0;
+
+    // input中是所有还没有消费的数据，处理完的部分需要调用retrieve
+    virtual void on_message(TcpConnection& conn, Buffer& input) = 0;
+
+    virtual void on_close(TcpConnection& /*conn*/) {}
 
 protected:
     std::unique_ptr<AddrResolver> resolver_;
+
+private:
+    std::size_t reactor_threads_{std::thread::hardware_concurrency()};
+    std::size_t high_water_mark_{4 * 1024 * 1024};
+    std::chrono::milliseconds close_timeout_{5000};
+    uint16_t port_{0};
+    std::vector<std::unique_ptr<Reactor>> reactors_;
 };
 
 } // namespace pl
@@ -0,0 +1,285 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/http/tcp.h"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <netinet/in.h>
+#include <string>
+#include <sys/uio.h>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+class EchoServer : public pl::TcpServer {
+public:
+    std::atomic<int> accepted{0};
+    std::atomic<int> closed{0};
+    std::atomic<std::size_t> max_output{0};
+
+private:
+    void on_accept(pl::TcpConnection& /*conn*/) override { accepted.fetch_add(1); }
+
+    void on_message(pl::TcpConnection& conn, pl::Buffer& input) override {
+        conn.send(input.view());
+        input.retrieve_all();
+        std::size_t out = conn.output_bytes();
+        std::size_t prev = max_output.load();
+        while (out > prev && !max_output.compare_exchange_weak(prev, out)) {
+        }
+    }
+
+    void on_close(pl::TcpConnection& /*conn*/) override { closed.fetch_add(1); }
+};
+
+int connect_to(uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool write_all(int fd, const char* data, std::size_t len) {
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+std::string read_exactly(int fd, std::size_t len) {
+    std::string out(len, '\0');
+    std::size_t got = 0;
+    while (got < len) {
+        ssize_t n = ::read(fd, out.data() + got, len - got);
+        if (n <= 0) {
+            break;
+        }
+        got += n;
+    }
+    out.resize(got);
+    return out;
+}
+
+class TcpServerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        server_.init("127.0.0.1", "0");
+        server_.set_reactor_threads(4);
+        server_.set_high_water_mark(64 * 1024);
+        server_.listen();
+        ASSERT_NE(server_.port(), 0);
+        thread_ = std::thread([this]() { server_.start(); });
+    }
+
+    void TearDown() override {
+        server_.stop();
+        thread_.join();
+    }
+
+    EchoServer server_;
+    std::thread thread_;
+};
+
+} // namespace
+
+TEST_F(TcpServerTest, echo) {
+    constexpr int CLIENTS = 200;
+    std::vector<int> fds;
+    for (int i = 0; i < CLIENTS; ++i) {
+        int fd = connect_to(server_.port());
+        ASSERT_GE(fd, 0);
+        fds.push_back(fd);
+    }
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < CLIENTS; ++i) {
+            std::string msg = "hello " + std::to_string(i) + " " + std::to_string(round);
+            ASSERT_TRUE(write_all(fds[i], msg.data(), msg.size()));
+        }
+        for (int i = 0; i < CLIENTS; ++i) {
+            std::string msg = "hello " + std::to_string(i) + " " + std::to_string(round);
+            EXPECT_EQ(read_exactly(fds[i], msg.size()), msg);
+        }
+    }
+    for (int fd : fds) {
+        ::close(fd);
+    }
+    while (server_.closed.load() < CLIENTS) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(server_.accepted.load(), CLIENTS);
+}
+
+TEST_F(TcpServerTest, backpressure) {
+    int fd = connect_to(server_.port());
+    ASSERT_GE(fd, 0);
+    constexpr std::size_t SIZE = 16 * 1024 * 1024;
+    std::string payload(SIZE, '\0');
+    for (std::size_t i = 0; i < SIZE; ++i) {
+        payload[i] = static_cast<char>(i * 31 + i / 4096);
+    }
+
+    // 先写一段时间不读，服务端输出缓冲区达到高水位之后应该停止读取
+    std::thread writer([&]() { write_all(fd, payload.data(), payload.size()); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    std::string echoed = read_exactly(fd, SIZE);
+    writer.join();
+    ::close(fd);
+
+    EXPECT_TRUE(echoed == payload);
+    // 最多超出高水位一次读取的数据量
+    EXPECT_LE(server_.max_output.load(), 64 * 1024 + 2 * pl::Buffer::EXTRA_SIZE);
+}
+
+TEST_F(TcpServerTest, shutdown_after_response) {
+    class OneShot : public pl::TcpServer {
+        void on_accept(pl::TcpConnection& /*conn*/) override {}
+
+        void on_message(pl::TcpConnection& conn, pl::Buffer& input) override {
+            input.retrieve_all();
+            conn.send(std::string(1 << 20, 'x'));
+            conn.shutdown();
+        }
+    };
+
+    OneShot server;
+    server.init("127.0.0.1", "0");
+    server.set_reactor_threads(1);
+    server.listen();
+    std::thread t([&]() { server.start(); });
+
+    int fd = connect_to(server.port());
+    ASSERT_GE(fd, 0);
+    ASSERT_TRUE(write_all(fd, "x", 1));
+    std::string all;
+    char buf[65536];
+    ssize_t n = 0;
+    while ((n = ::read(fd, buf, sizeof(buf))) > 0) {
+        all.append(buf, n);
+    }
+    // 数据全部发送之后才关闭写端
+    EXPECT_EQ(all.size(), 1 << 20);
+    ::close(fd);
+
+    server.stop();
+    t.join();
+}
+
+TEST_F(TcpServerTest, close_timeout) {
+    class OneShot : public pl::TcpServer {
+    public:
+        std::atomic<int> closed{0};
+
+    private:
+        void on_accept(pl::TcpConnection& /*conn*/) override {}
+
+        void on_message(pl::TcpConnection& conn, pl::Buffer& input) override {
+            input.retrieve_all();
+            conn.send("bye");
+            conn.shutdown();
+        }
+
+        void on_close(pl::TcpConnection& /*conn*/) override { closed.fetch_add(1); }
+    };
+
+    OneShot server;
+    server.init("127.0.0.1", "0");
+    server.set_reactor_threads(1);
+    server.set_close_timeout(std::chrono::milliseconds(100));
+    server.listen();
+    std::thread t([&]() { server.start(); });
+
+    int fd = connect_to(server.port());
+    ASSERT_GE(fd, 0);
+    ASSERT_TRUE(write_all(fd, "x", 1));
+    EXPECT_EQ("bye", read_exactly(fd, 3));
+    char c = 0;
+    EXPECT_EQ(0, ::read(fd, &c, 1));
+    // 客户端一直不关闭，服务端在超时之后强制关闭连接
+    auto start = std::chrono::steady_clock::now();
+    while (server.closed.load() == 0 &&
+           std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(1, server.closed.load());
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(50));
+    ::close(fd);
+
+    server.stop();
+    t.join();
+}
+
+TEST_F(TcpServerTest, write_after_peer_closed) {
+    // 对端已经关闭之后继续写，不能因为SIGPIPE让进程退出
+    class LateWriter : public pl::TcpServer {
+    public:
+        std::promise<void> peer_closed;
+        std::atomic<int> closed{0};
+
+    private:
+        void on_accept(pl::TcpConnection& /*conn*/) override {}
+
+        void on_message(pl::TcpConnection& conn, pl::Buffer& input) override {
+            input.retrieve_all();
+            peer_closed.get_future().wait();
+            std::string data(1024, 'x');
+            struct iovec iov[2] = {{data.data(), data.size()}, {data.data(), data.size()}};
+            // 第一次写入成功，对端回复RST；之后的写入返回EPIPE
+            for (int i = 0; i < 3; ++i) {
+                conn.send(iov, 2);
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+        }
+
+        void on_close(pl::TcpConnection& /*conn*/) override { closed.fetch_add(1); }
+    };
+
+    LateWriter server;
+    server.init("127.0.0.1", "0");
+    server.set_reactor_threads(1);
+    server.listen();
+    std::thread t([&]() { server.start(); });
+
+    int fd = connect_to(server.port());
+    ASSERT_GE(fd, 0);
+    ASSERT_TRUE(write_all(fd, "x", 1));
+    ::close(fd);
+    server.peer_closed.set_value();
+    auto start = std::chrono::steady_clock::now();
+    while (server.closed.load() == 0 &&
+           std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(1, server.closed.load());
+
+    server.stop();
+    t.join();
+}
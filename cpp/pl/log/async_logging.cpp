@@ -0,0 +1,367 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/log/async_logging.h"
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <fmt/format.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace pl {
+
+namespace detail {
+
+LogRing::LogRing(std::size_t capacity)
+    : capacity_(std::bit_ceil(std::max<std::size_t>(capacity, 4096))),
+      mask_(capacity_ - 1),
+      data_(new char[capacity_]) {}
+
+bool LogRing::tryWrite(const char* data, std::size_t len) {
+    // head_只有生产者修改
+    std::size_t head = head_.load(std::memory_order_relaxed);
+    std::size_t tail = tail_.load(std::memory_order_acquire);
+    if (capacity_ - (head - tail) < len) {
+        return false;
+    }
+    std::size_t pos = head & mask_;
+    std::size_t first = std::min(len, capacity_ - pos);
+    std::memcpy(data_.get() + pos, data, first);
+    std::memcpy(data_.get(), data + first, len - first);
+    head_.store(head + len, std::memory_order_release);
+    return true;
+}
+
+int LogRing::readable(struct iovec* iov) const {
+    std::size_t tail = tail_.load(std::memory_order_relaxed);
+    std::size_t len = head_.load(std::memory_order_acquire) - tail;
+    if (len == 0) {
+        return 0;
+    }
+    std::size_t pos = tail & mask_;
+    std::size_t first = std::min(len, capacity_ - pos);
+    iov[0] = {data_.get() + pos, first};
+    if (first == len) {
+        return 1;
+    }
+    iov[1] = {data_.get(), len - first};
+    return 2;
+}
+
+void LogRing::consume(std::size_t len) {
+    tail_.store(tail_.load(std::memory_order_relaxed) + len, std::memory_order_release);
+}
+
+} // namespace detail
+
+namespace {
+
+std::atomic<uint64_t> g_next_id{1};
+
+// 线程退出时标记环形缓冲区，后台线程写完剩下的数据之后回收
+struct LocalRing {
+    uint64_t owner{0};
+    std::shared_ptr<detail::LogRing> ring;
+
+    ~LocalRing() {
+        if (ring) {
+            ring->closed.store(true, std::memory_order_release);
+        }
+    }
+};
+
+thread_local LocalRing t_ring;
+
+} // namespace
+
+AsyncLogging::AsyncLogging(Options options)
+    : options_(std::move(options)), id_(g_next_id.fetch_add(1, std::memory_order_relaxed)) {}
+
+AsyncLogging::~AsyncLogging() {
+    if (Logger::sink() == this) {
+        Logger::setSink(nullptr);
+    }
+    stop();
+}
+
+void AsyncLogging::start() {
+    std::lock_guard lock(mutex_);
+    if (running_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    stop_ = false;
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread([this]() { run(); });
+}
+
+void AsyncLogging::stop() {
+    {
+        std::lock_guard lock(mutex_);
+        if (!running_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        stop_ = true;
+    }
+    cond_.notify_one();
+    thread_.join();
+}
+
+detail::LogRing* AsyncLogging::localRing() {
+    if (t_ring.owner != id_) {
+        if (t_ring.ring) {
+            t_ring.ring->closed.store(true, std::memory_order_release);
+        }
+        t_ring.ring = std::make_shared<detail::LogRing>(options_.ring_size);
+        t_ring.owner = id_;
+        std::lock_guard lock(rings_mutex_);
+        rings_.push_back(t_ring.ring);
+    }
+    return t_ring.ring.get();
+}
+
+void AsyncLogging::append(const char* data, std::size_t len) { tryAppend(data, len); }
+
+bool AsyncLogging::tryAppend(const char* data, std::size_t len) {
+    detail::LogRing* ring = localRing();
+    if (ring->tryWrite(data, len)) {
+        // 过半时提前唤醒后台线程，降低溢出的概率
+        if (ring->size() > ring->capacity() / 2) {
+            wakeup();
+        }
+        return true;
+    }
+    if (options_.overflow == OverflowPolicy::BLOCK && len <= ring->capacity()) {
+        blocked_.fetch_add(1, std::memory_order_relaxed);
+        while (running_.load(std::memory_order_acquire)) {
+            wakeup();
+            std::this_thread::yield();
+            if (ring->tryWrite(data, len)) {
+                return true;
+            }
+        }
+    }
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    dropped_bytes_.fetch_add(len, std::memory_order_relaxed);
+    return false;
+}
+
+void AsyncLogging::wakeup() {
+    // 不加锁通知，极少数情况下丢失的唤醒最多延迟一个flush_interval
+    if (!wakeup_.exchange(true, std::memory_order_acq_rel)) {
+        cond_.notify_one();
+    }
+}
+
+void AsyncLogging::flush() {
+    std::unique_lock lock(mutex_);
+    if (!running_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    uint64_t seq = ++flush_requested_;
+    cond_.notify_one();
+    flushed_cond_.wait(lock, [&]() {
+        return flush_done_ >= seq || !running_.load(std::memory_order_relaxed);
+    });
+}
+
+AsyncLogging::Stats AsyncLogging::stats() const {
+    Stats stats;
+    stats.written_bytes = written_bytes_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    stats.dropped_bytes = dropped_bytes_.load(std::memory_order_relaxed);
+    stats.blocked = blocked_.load(std::memory_order_relaxed);
+    stats.files = files_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void AsyncLogging::run() {
+    roll();
+    for (;;) {
+        uint64_t target = 0;
+        bool stopping = false;
+        {
+            std::unique_lock lock(mutex_);
+            cond_.wait_for(lock, options_.flush_interval, [&]() {
+                return stop_ || wakeup_.load(std::memory_order_acquire) ||
+                       flush_requested_ > flush_done_;
+            });
+            wakeup_.store(false, std::memory_order_release);
+            target = flush_requested_;
+            stopping = stop_;
+        }
+        while (!drain()) {
+        }
+        if (file_bytes_ > 0 &&
+            std::chrono::steady_clock::now() - file_start_ >= options_.roll_interval) {
+            roll();
+        }
+        {
+            std::lock_guard lock(mutex_);
+            flush_done_ = target;
+        }
+        flushed_cond_.notify_all();
+        if (stopping) {
+            break;
+        }
+    }
+    if (fd_ != -1) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    {
+        std::lock_guard lock(mutex_);
+        running_.store(false, std::memory_order_release);
+    }
+    flushed_cond_.notify_all();
+}
+
+bool AsyncLogging::drain() {
+    std::vector<std::shared_ptr<detail::LogRing>> rings;
+    {
+        std::lock_guard lock(rings_mutex_);
+        rings = rings_;
+    }
+    iovec iov[IOV_MAX];
+    std::vector<std::pair<detail::LogRing*, std::size_t>> consumed;
+    int count = 0;
+    bool complete = true;
+    std::size_t start = rings.empty() ? 0 : drain_start_ % rings.size();
+    std::size_t next = start + 1;
+    for (std::size_t i = 0; i < rings.size(); ++i) {
+        if (count + 2 > IOV_MAX) {
+            // 下一次从没有轮到的缓冲区开始
+            next = start + i;
+            complete = false;
+            break;
+        }
+        const auto& ring = rings[(start + i) % rings.size()];
+        int n = ring->readable(iov + count);
+        std::size_t len = 0;
+        for (int i = 0; i < n; ++i) {
+            len += iov[count + i].iov_len;
+        }
+        if (n > 0) {
+            consumed.emplace_back(ring.get(), len);
+            count += n;
+        }
+    }
+    drain_start_ = next;
+    if (count > 0) {
+        writeAll(iov, count);
+    }
+    for (auto& [ring, len] : consumed) {
+        ring->consume(len);
+    }
+
+    // 回收线程已经退出并且数据已经写完的环形缓冲区
+    if (complete) {
+        std::lock_guard lock(rings_mutex_);
+        std::erase_if(rings_, [](const auto& ring) {
+            return ring->closed.load(std::memory_order_acquire) && ring->size() == 0;
+        });
+    }
+    return complete;
+}
+
+void AsyncLogging::writeAll(struct iovec* iov, int count) {
+    std::size_t total = 0;
+    for (int i = 0; i < count; ++i) {
+        total += iov[i].iov_len;
+    }
+    std::size_t left = total;
+    while (left > 0 && fd_ != -1) {
+        ssize_t n = ::writev(fd_, iov, count);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ::fprintf(stderr, "AsyncLogging: writev failed: %s\n", ::strerror(errno));
+            break;
+        }
+        left -= n;
+        // 跳过已经写完的部分
+        auto written = static_cast<std::size_t>(n);
+        while (count > 0 && written >= iov->iov_len) {
+            written -= iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if (count > 0) {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + written;
+            iov->iov_len -= written;
+        }
+    }
+    written_bytes_.fetch_add(total - left, std::memory_order_relaxed);
+    // 写失败的数据不会重试，调用方仍然会从缓冲区中消费掉
+    dropped_bytes_.fetch_add(left, std::memory_order_relaxed);
+    file_bytes_ += total - left;
+    if (file_bytes_ >= options_.roll_size) {
+        roll();
+    }
+}
+
+void AsyncLogging::roll() {
+    if (fd_ != -1) {
+        ::close(fd_);
+    }
+    std::time_t now = std::time(nullptr);
+    std::tm tm{};
+    ::localtime_r(&now, &tm);
+    char time[32];
+    std::strftime(time, sizeof(time), "%Y%m%d-%H%M%S", &tm);
+    // 文件名带上pid，避免多个进程写同一个文件；同一秒内可能滚动多次，再带上序号。
+    // 文件已经存在时(例如pid被复用)换一个序号，不追加到别人的文件中
+    std::string name;
+    for (;;) {
+        name = fmt::format("{}.{}.{}.{}.log", options_.basename, time, ::getpid(), file_seq_++);
+        fd_ = ::open(name.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (fd_ != -1 || errno != EEXIST) {
+            break;
+        }
+    }
+    if (fd_ == -1) {
+        ::fprintf(stderr, "AsyncLogging: open %s failed: %s\n", name.c_str(), ::strerror(errno));
+    } else {
+        files_.fetch_add(1, std::memory_order_relaxed);
+    }
+    file_bytes_ = 0;
+    file_start_ = std::chrono::steady_clock::now();
+    // 文件头不计入file_bytes_，否则roll_size小于文件头时会不停地滚动
+    const std::string& header = options_.file_header;
+    std::size_t written = 0;
+    while (fd_ != -1 && written < header.size()) {
+        ssize_t n = ::write(fd_, header.data() + written, header.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ::fprintf(stderr, "AsyncLogging: write %s failed: %s\n", name.c_str(),
+                      ::strerror(errno));
+            break;
+        }
+        written += n;
+    }
+    written_bytes_.fetch_add(written, std::memory_order_relaxed);
+}
+
+} // namespace pl
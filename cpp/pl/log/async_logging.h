@@ -0,0 +1,185 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include "cpp/pl/log/logger.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/uio.h>
+#include <thread>
+#include <vector>
+
+namespace pl {
+
+namespace detail {
+
+/**
+ * @class LogRing
+ * @brief 单生产者单消费者的字节环形缓冲区，生产者是某一个打日志的线程，消费者是后台写线程。
+ * 每次写入一条完整的日志之后才发布写位置，消费者看到的总是完整的日志
+ */
+class LogRing {
+public:
+    // capacity会向上取整为2的幂
+    explicit LogRing(std::size_t capacity);
+
+    LogRing(const LogRing&) = delete;
+    LogRing& operator=(const LogRing&) = delete;
+
+    // 空间不够时返回false，不会写入部分数据
+    bool tryWrite(const char* data, std::size_t len);
+
+    // 可读的数据，环形回绕时分成两段，返回段数
+    int readable(struct iovec* iov) const;
+
+    void consume(std::size_t len);
+
+    [[nodiscard]] std::size_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] std::size_t capacity() const { return capacity_; }
+
+    // 生产者线程退出之后设置，数据写完之后由消费者回收
+    std::atomic<bool> closed{false};
+
+private:
+    const std::size_t capacity_;
+    const std::size_t mask_;
+    std::unique_ptr<char[]> data_;
+    alignas(64) std::atomic<std::size_t> head_{0};
+    alignas(64) std::atomic<std::size_t> tail_{0};
+};
+
+} // namespace detail
+
+/**
+ * @class AsyncLogging
+ * @brief 异步日志后端。每个打日志的线程把格式化好的日志写入自己的无锁环形缓冲区，
+ * 后台线程定期或者在缓冲区过半时把所有缓冲区的数据通过writev批量写入文件，
+ * 文件大小或者时间超过阈值时滚动到新的文件。
+ *
+ * 使用时先start，再通过Logger::setSink安装；销毁之前需要先把sink替换掉，并且保证没有线程还在打日志
+ */
+class AsyncLogging : public LogSink {
+public:
+    // 环形缓冲区满时的处理方式
+    enum class OverflowPolicy {
+        // 丢弃这条日志并计数，打日志的线程永远不会被阻塞
+        DROP,
+        // 等待后台线程腾出空间，不丢日志
+        BLOCK,
+    };
+
+    struct Options {
+        // 日志文件的路径前缀，实际的文件名是basename.时间.pid.序号.log
+        std::string basename;
+        // 每个线程的环形缓冲区大小
+        std::size_t ring_size{1 << 20};
+        // 单个文件的最大字节数
+        std::size_t roll_size{256 << 20};
+        // 单个文件最长写多久
+        std::chrono::seconds roll_interval{std::chrono::hours(24)};
+        // 后台线程最长多久写一次文件
+        std::chrono::milliseconds flush_interval{100};
+        OverflowPolicy overflow{OverflowPolicy::DROP};
+        // 每个文件开头写入的数据，二进制日志需要设置为blog::sessionRecord()
+        std::string file_header;
+    };
+
+    struct Stats {
+        uint64_t written_bytes{0};
+        uint64_t dropped{0};
+        // 丢弃的字节数，包括缓冲区满时丢弃的日志和写文件失败的数据
+        uint64_t dropped_bytes{0};
+        // BLOCK模式下因为缓冲区满而等待的次数
+        uint64_t blocked{0};
+        uint64_t files{0};
+    };
+
+    explicit AsyncLogging(Options options);
+    ~AsyncLogging() override;
+
+    AsyncLogging(const AsyncLogging&) = delete;
+    AsyncLogging& operator=(const AsyncLogging&) = delete;
+
+    void start();
+
+    // 写完所有缓冲区中的日志之后退出后台线程
+    void stop();
+
+    void append(const char* data, std::size_t len) override;
+
+    // DROP模式下丢弃时返回false
+    bool tryAppend(const char* data, std::size_t len) override;
+
+    // 阻塞直到调用之前append的日志都写入文件
+    void flush() override;
+
+    [[nodiscard]] Stats stats() const;
+
+private:
+    detail::LogRing* localRing();
+    void wakeup();
+    void run();
+    // 把所有缓冲区的数据写入文件，返回是否写完
+    bool drain();
+    void roll();
+    void writeAll(struct iovec* iov, int count);
+
+private:
+    const Options options_;
+    // 区分不同的实例，线程局部的缓存通过它判断是否属于当前实例
+    const uint64_t id_;
+
+    std::mutex rings_mutex_;
+    std::vector<std::shared_ptr<detail::LogRing>> rings_;
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::condition_variable flushed_cond_;
+    std::atomic<bool> running_{false};
+    bool stop_{false};
+    uint64_t flush_requested_{0};
+    uint64_t flush_done_{0};
+    std::atomic<bool> wakeup_{false};
+    std::thread thread_;
+
+    // 只在后台线程中访问
+    int fd_{-1};
+    // 文件名中的序号，同一秒内可能滚动多次
+    uint64_t file_seq_{0};
+    // 每次drain从不同的缓冲区开始，避免排在后面的缓冲区一直等待
+    std::size_t drain_start_{0};
+    std::size_t file_bytes_{0};
+    std::chrono::steady_clock::time_point file_start_;
+
+    std::atomic<uint64_t> written_bytes_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> dropped_bytes_{0};
+    std::atomic<uint64_t> blocked_{0};
+    std::atomic<uint64_t> files_{0};
+};
+
+} // namespace pl
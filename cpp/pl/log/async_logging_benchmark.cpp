@@ -0,0 +1,119 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/log/async_logging.h"
+
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <unistd.h>
+
+/**
+ * 对比同步写文件和异步后端下每条日志在打日志线程上的开销
+ */
+namespace {
+
+std::filesystem::path tempPath(const char* name) {
+    return std::filesystem::temp_directory_path() /
+           (std::string(name) + "_" + std::to_string(::getpid()));
+}
+
+// 原来的同步方式：每条日志fwrite并且fflush
+class SyncFileSink : public pl::LogSink {
+public:
+    explicit SyncFileSink(const std::filesystem::path& path) : file_(::fopen(path.c_str(), "w")) {}
+
+    ~SyncFileSink() override { ::fclose(file_); }
+
+    void append(const char* data, std::size_t len) override {
+        std::lock_guard lock(mutex_);
+        ::fwrite(data, 1, len, file_);
+        ::fflush(file_);
+    }
+
+private:
+    std::mutex mutex_;
+    FILE* file_;
+};
+
+void logLines(benchmark::State& state) {
+    int64_t i = 0;
+    for (auto _ : state) {
+        LOG_INFO << "request done, id: " << i++ << ", latency: " << 1.5 << "ms, path: /index";
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_SyncLog(benchmark::State& state) {
+    static auto path = tempPath("sync_log_benchmark");
+    static SyncFileSink* sink = nullptr;
+    if (state.thread_index() == 0) {
+        sink = new SyncFileSink(path);
+        pl::Logger::setSink(sink);
+    }
+    logLines(state);
+    if (state.thread_index() == 0) {
+        pl::Logger::setSink(nullptr);
+        delete sink;
+        std::filesystem::remove(path);
+    }
+}
+
+void BM_AsyncLog(benchmark::State& state) {
+    static auto dir = tempPath("async_log_benchmark");
+    static pl::AsyncLogging* logging = nullptr;
+    if (state.thread_index() == 0) {
+        std::filesystem::create_directories(dir);
+        pl::AsyncLogging::Options options;
+        options.basename = (dir / "bench").string();
+        options.overflow = static_cast<pl::AsyncLogging::OverflowPolicy>(state.range(0));
+        logging = new pl::AsyncLogging(options);
+        logging->start();
+        pl::Logger::setSink(logging);
+    }
+    logLines(state);
+    if (state.thread_index() == 0) {
+        pl::Logger::setSink(nullptr);
+        logging->stop();
+        state.counters["dropped"] = static_cast<double>(logging->stats().dropped);
+        delete logging;
+        std::filesystem::remove_all(dir);
+    }
+}
+
+// 被运行期级别过滤掉的日志语句
+void BM_DisabledLog(benchmark::State& state) {
+    pl::Logger::setLevel(pl::Logger::LogLevel::PL_WARN);
+    int64_t i = 0;
+    for (auto _ : state) {
+        LOG_DEBUG << "request done, id: " << i++ << ", latency: " << 1.5 << "ms";
+        benchmark::DoNotOptimize(i);
+    }
+    pl::Logger::setLevel(pl::Logger::LogLevel::PL_TRACE);
+}
+
+} // namespace
+
+BENCHMARK(BM_DisabledLog);
+BENCHMARK(BM_SyncLog)->Threads(1)->Threads(4)->UseRealTime();
+BENCHMARK(BM_AsyncLog)
+    ->ArgName("block")
+    ->Arg(static_cast<int>(pl::AsyncLogging::OverflowPolicy::DROP))
+    ->Arg(static_cast<int>(pl::AsyncLogging::OverflowPolicy::BLOCK))
+    ->Threads(1)
+    ->Threads(4)
+    ->UseRealTime();
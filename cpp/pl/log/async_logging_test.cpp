@@ -0,0 +1,196 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/log/async_logging.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+class AsyncLoggingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = std::filesystem::temp_directory_path() /
+               ("async_logging_test_" + std::to_string(::getpid()));
+        std::filesystem::remove_all(dir_);
+        std::filesystem::create_directories(dir_);
+    }
+
+    void TearDown() override { std::filesystem::remove_all(dir_); }
+
+    pl::AsyncLogging::Options options() const {
+        pl::AsyncLogging::Options options;
+        options.basename = (dir_ / "test").string();
+        return options;
+    }
+
+    // 按文件名排序读取所有日志行
+    std::vector<std::string> readLines() const {
+        std::vector<std::filesystem::path> files;
+        for (const auto& entry : std::filesystem::directory_iterator(dir_)) {
+            files.push_back(entry.path());
+        }
+        std::sort(files.begin(), files.end());
+        std::vector<std::string> lines;
+        for (const auto& file : files) {
+            std::ifstream in(file);
+            std::string line;
+            while (std::getline(in, line)) {
+                lines.push_back(line);
+            }
+        }
+        return lines;
+    }
+
+    std::filesystem::path dir_;
+};
+
+} // namespace
+
+TEST_F(AsyncLoggingTest, multi_thread) {
+    constexpr int THREADS = 4;
+    constexpr int LINES = 5000;
+    auto opts = options();
+    opts.ring_size = 64 << 10;
+    opts.overflow = pl::AsyncLogging::OverflowPolicy::BLOCK;
+    pl::AsyncLogging logging(opts);
+    logging.start();
+    pl::Logger::setSink(&logging);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([t]() {
+            for (int i = 0; i < LINES; ++i) {
+                LOG_INFO << "thread=" << t << " seq=" << i;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    pl::Logger::setSink(nullptr);
+    logging.stop();
+
+    auto stats = logging.stats();
+    EXPECT_EQ(0, stats.dropped);
+    auto lines = readLines();
+    ASSERT_EQ(THREADS * LINES, lines.size());
+    // 同一个线程的日志保持顺序
+    std::map<int, int> next;
+    for (const auto& line : lines) {
+        auto pos = line.find("thread=");
+        ASSERT_NE(std::string::npos, pos) << line;
+        int t = 0;
+        int seq = 0;
+        ASSERT_EQ(2, std::sscanf(line.c_str() + pos, "thread=%d seq=%d", &t, &seq));
+        EXPECT_EQ(next[t]++, seq);
+    }
+}
+
+TEST_F(AsyncLoggingTest, flush) {
+    pl::AsyncLogging logging(options());
+    logging.start();
+    std::string line = "hello async logging\n";
+    logging.append(line.data(), line.size());
+    logging.flush();
+    auto lines = readLines();
+    ASSERT_EQ(1, lines.size());
+    EXPECT_EQ("hello async logging", lines[0]);
+    EXPECT_EQ(line.size(), logging.stats().written_bytes);
+}
+
+TEST_F(AsyncLoggingTest, roll_by_size) {
+    auto opts = options();
+    opts.roll_size = 1000;
+    pl::AsyncLogging logging(opts);
+    logging.start();
+    std::string line(99, 'x');
+    line += '\n';
+    for (int i = 0; i < 50; ++i) {
+        logging.append(line.data(), line.size());
+        if (i % 5 == 4) {
+            logging.flush();
+        }
+    }
+    logging.stop();
+    EXPECT_GE(logging.stats().files, 5);
+    EXPECT_EQ(50, readLines().size());
+}
+
+TEST_F(AsyncLoggingTest, drop_when_full) {
+    auto opts = options();
+    opts.ring_size = 4096;
+    pl::AsyncLogging logging(opts);
+    // 后台线程没有启动，缓冲区满了之后的日志被丢弃
+    std::string line(99, 'x');
+    line += '\n';
+    for (int i = 0; i < 100; ++i) {
+        logging.append(line.data(), line.size());
+    }
+    EXPECT_EQ(100 - 4096 / 100, logging.stats().dropped);
+    logging.start();
+    logging.stop();
+    EXPECT_EQ(4096 / 100, readLines().size());
+}
+
+TEST_F(AsyncLoggingTest, same_basename) {
+    // 同一秒内使用同一个前缀的两个实例不会写进同一个文件
+    pl::AsyncLogging first(options());
+    pl::AsyncLogging second(options());
+    first.start();
+    second.start();
+    std::string a = "from first\n";
+    std::string b = "from second\n";
+    first.append(a.data(), a.size());
+    second.append(b.data(), b.size());
+    first.stop();
+    second.stop();
+
+    std::vector<std::string> contents;
+    for (const auto& entry : std::filesystem::directory_iterator(dir_)) {
+        auto name = entry.path().filename().string();
+        EXPECT_NE(std::string::npos, name.find("." + std::to_string(::getpid()) + "."));
+        std::ifstream in(entry.path());
+        contents.emplace_back(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    std::sort(contents.begin(), contents.end());
+    ASSERT_EQ(2, contents.size());
+    EXPECT_EQ(a, contents[0]);
+    EXPECT_EQ(b, contents[1]);
+}
+
+TEST_F(AsyncLoggingTest, write_failure_counts_dropped_bytes) {
+    auto opts = options();
+    opts.basename = (dir_ / "missing" / "test").string();
+    pl::AsyncLogging logging(opts);
+    logging.start();
+    std::string line = "lost\n";
+    logging.append(line.data(), line.size());
+    logging.flush();
+    auto stats = logging.stats();
+    EXPECT_EQ(0, stats.files);
+    EXPECT_EQ(0, stats.written_bytes);
+    EXPECT_EQ(line.size(), stats.dropped_bytes);
+}
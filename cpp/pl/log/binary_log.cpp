@@ -0,0 +1,358 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/log/binary_log.h"
+#include "cpp/pl/thread/thread.h"
+
+#include <chrono>
+#include <ctime>
+#include <fmt/args.h>
+#include <mutex>
+#include <unistd.h>
+
+namespace pl::blog {
+
+namespace {
+
+std::atomic<LogSink*> g_sink{nullptr};
+// 奇数表示setSink正在替换sink，参见currentSink
+std::atomic<uint64_t> g_epoch{2};
+std::mutex g_sink_mutex;
+
+std::mutex g_sites_mutex;
+uint32_t g_next_id = 1;
+
+thread_local const uint32_t t_tid = static_cast<uint32_t>(gettid());
+
+template <typename T> void put(char*& p, T value) {
+    std::memcpy(p, &value, sizeof(value));
+    p += sizeof(value);
+}
+
+// 读取失败时返回false，不移动data
+template <typename T> bool get(std::string_view& data, T* value) {
+    if (data.size() < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(value, data.data(), sizeof(T));
+    data.remove_prefix(sizeof(T));
+    return true;
+}
+
+bool getString(std::string_view& data, std::string_view* value) {
+    uint16_t len = 0;
+    if (!get(data, &len) || data.size() < len) {
+        return false;
+    }
+    *value = data.substr(0, len);
+    data.remove_prefix(len);
+    return true;
+}
+
+// 会话头的pid和进程启动时间
+bool getSession(std::string_view body, std::pair<uint32_t, uint64_t>* process) {
+    return get(body, &process->first) && get(body, &process->second) && body.empty();
+}
+
+// 取出一条完整的记录，body不包括类型和长度
+bool nextRecord(std::string_view& data, RecordType* type, std::string_view* body) {
+    std::string_view p = data;
+    uint8_t t = 0;
+    uint16_t len = 0;
+    if (!get(p, &t) || !get(p, &len) || len < 3 || data.size() < len) {
+        return false;
+    }
+    *type = static_cast<RecordType>(t);
+    *body = data.substr(3, len - 3);
+    data.remove_prefix(len);
+    return true;
+}
+
+void appendTime(std::string* out, uint64_t nanos) {
+    auto seconds = static_cast<std::time_t>(nanos / 1000000000);
+    std::tm tm{};
+    ::localtime_r(&seconds, &tm);
+    char buf[32];
+    std::size_t n = std::strftime(buf, sizeof(buf), "%m-%d %H:%M:%S", &tm);
+    out->append(buf, n);
+    fmt::format_to(std::back_inserter(*out), ":{:03}", nanos / 1000000 % 1000);
+}
+
+} // namespace
+
+const std::string& sessionRecord() {
+    static const std::string record = []() {
+        auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::system_clock::now().time_since_epoch())
+                         .count();
+        char buf[detail::SESSION_RECORD_SIZE];
+        char* p = buf;
+        put(p, static_cast<uint8_t>(RecordType::SESSION));
+        put(p, static_cast<uint16_t>(detail::SESSION_RECORD_SIZE));
+        put(p, static_cast<uint32_t>(::getpid()));
+        put(p, static_cast<uint64_t>(nanos));
+        return std::string(buf, sizeof(buf));
+    }();
+    return record;
+}
+
+void setSink(LogSink* sink) {
+    if (sink != nullptr) {
+        const std::string& record = sessionRecord();
+        sink->append(record.data(), record.size());
+    }
+    // 新的sink需要重新写入格式定义，所以每个sink对应一个epoch。sink和epoch通过seqlock
+    // 一起发布：替换期间epoch是奇数，log()读到的sink和epoch总是属于同一次setSink
+    std::lock_guard lock(g_sink_mutex);
+    g_epoch.fetch_add(1, std::memory_order_acq_rel);
+    g_sink.store(sink, std::memory_order_release);
+    g_epoch.fetch_add(1, std::memory_order_release);
+}
+
+LogSink* sink() { return g_sink.load(std::memory_order_acquire); }
+
+namespace detail {
+
+uint32_t registerSite(FormatSite& site, const ArgType* types, std::size_t nargs) {
+    std::lock_guard lock(g_sites_mutex);
+    uint32_t id = site.id.load(std::memory_order_relaxed);
+    if (id == 0) {
+        site.types = types;
+        site.nargs = nargs;
+        id = g_next_id++;
+        site.id.store(id, std::memory_order_release);
+    }
+    return id;
+}
+
+LogSink* currentSink(uint64_t* epoch) {
+    for (;;) {
+        uint64_t begin = g_epoch.load(std::memory_order_acquire);
+        if ((begin & 1) != 0) {
+            continue;
+        }
+        LogSink* sink = g_sink.load(std::memory_order_acquire);
+        if (g_epoch.load(std::memory_order_acquire) == begin) {
+            *epoch = begin;
+            return sink;
+        }
+    }
+}
+
+bool writeDefinition(LogSink* sink, FormatSite& site, uint64_t epoch) {
+    // 类型、长度、id、级别、行号、文件名、格式字符串、参数类型
+    std::string_view file = site.file.source();
+    std::string_view format = site.format;
+    std::size_t len = 1 + 2 + 4 + 1 + 4 + 2 + file.size() + 2 + format.size() + 1 + site.nargs;
+    if (len > MAX_RECORD_SIZE) {
+        return false;
+    }
+    char buf[MAX_RECORD_SIZE];
+    char* p = buf;
+    put(p, static_cast<uint8_t>(RecordType::DEFINITION));
+    put(p, static_cast<uint16_t>(len));
+    put(p, site.id.load(std::memory_order_relaxed));
+    put(p, static_cast<uint8_t>(site.level));
+    put(p, static_cast<int32_t>(site.line));
+    put(p, static_cast<uint16_t>(file.size()));
+    std::memcpy(p, file.data(), file.size());
+    p += file.size();
+    put(p, static_cast<uint16_t>(format.size()));
+    std::memcpy(p, format.data(), format.size());
+    p += format.size();
+    put(p, static_cast<uint8_t>(site.nargs));
+    for (std::size_t i = 0; i < site.nargs; ++i) {
+        put(p, static_cast<uint8_t>(site.types[i]));
+    }
+    if (!sink->tryAppend(buf, len)) {
+        return false;
+    }
+    // 并发时可能重复写入定义，解码时同一个会话中后面的定义覆盖前面的，内容相同
+    site.epoch.store(epoch, std::memory_order_release);
+    return true;
+}
+
+void writeHeader(char* buf, uint16_t len, uint32_t id) {
+    auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::system_clock::now().time_since_epoch())
+                     .count();
+    char* p = buf;
+    put(p, static_cast<uint8_t>(RecordType::LOG));
+    put(p, len);
+    put(p, id);
+    put(p, static_cast<uint64_t>(nanos));
+    put(p, t_tid);
+}
+
+void logText(const FormatSite& site, fmt::string_view format, fmt::format_args args) {
+    Logger(site.file, site.line, site.level).stream() << fmt::vformat(format, args);
+}
+
+} // namespace detail
+
+bool BinaryLogDecoder::load(std::string_view data) {
+    RecordType type{};
+    std::string_view body;
+    uint32_t current = 0;
+    while (!data.empty()) {
+        if (!nextRecord(data, &type, &body)) {
+            return false;
+        }
+        if (type == RecordType::SESSION) {
+            std::pair<uint32_t, uint64_t> process;
+            if (!getSession(body, &process)) {
+                return false;
+            }
+            auto next = static_cast<uint32_t>(sessions_.size() + 1);
+            current = sessions_.try_emplace(process, next).first->second;
+            continue;
+        }
+        if (type != RecordType::DEFINITION) {
+            continue;
+        }
+        uint32_t id = 0;
+        uint8_t level = 0;
+        int32_t line = 0;
+        std::string_view file;
+        std::string_view format;
+        uint8_t nargs = 0;
+        if (!get(body, &id) || !get(body, &level) || !get(body, &line) ||
+            !getString(body, &file) || !getString(body, &format) || !get(body, &nargs) ||
+            body.size() != nargs) {
+            return false;
+        }
+        Site& site = sites_[key(current, id)];
+        site.level = static_cast<Logger::LogLevel>(level);
+        site.file = file;
+        site.line = line;
+        site.format = format;
+        site.types.clear();
+        for (char c : body) {
+            site.types.push_back(static_cast<ArgType>(c));
+        }
+    }
+    return true;
+}
+
+bool BinaryLogDecoder::decode(std::string_view data, std::string* out) const {
+    RecordType type{};
+    std::string_view body;
+    fmt::dynamic_format_arg_store<fmt::format_context> store;
+    uint32_t current = 0;
+    while (!data.empty()) {
+        if (!nextRecord(data, &type, &body)) {
+            return false;
+        }
+        if (type == RecordType::SESSION) {
+            std::pair<uint32_t, uint64_t> process;
+            if (!getSession(body, &process)) {
+                return false;
+            }
+            auto it = sessions_.find(process);
+            // 没有load过的会话，其中的日志都标注为未知调用点
+            current = it == sessions_.end() ? UINT32_MAX : it->second;
+            continue;
+        }
+        if (type != RecordType::LOG) {
+            continue;
+        }
+        uint32_t id = 0;
+        uint64_t nanos = 0;
+        uint32_t tid = 0;
+        if (!get(body, &id) || !get(body, &nanos) || !get(body, &tid)) {
+            return false;
+        }
+        auto it = sites_.find(key(current, id));
+        if (it == sites_.end()) {
+            out->append("UNKNOWN: ");
+            appendTime(out, nanos);
+            fmt::format_to(std::back_inserter(*out), ": * {} [unknown site {}]\n", tid, id);
+            continue;
+        }
+        const Site& site = it->second;
+        store.clear();
+        for (ArgType arg : site.types) {
+            bool ok = true;
+            switch (arg) {
+            case ArgType::INT64: {
+                int64_t v = 0;
+                ok = get(body, &v);
+                store.push_back(v);
+                break;
+            }
+            case ArgType::UINT64: {
+                uint64_t v = 0;
+                ok = get(body, &v);
+                store.push_back(v);
+                break;
+            }
+            case ArgType::DOUBLE: {
+                double v = 0;
+                ok = get(body, &v);
+                store.push_back(v);
+                break;
+            }
+            case ArgType::BOOL: {
+                uint8_t v = 0;
+                ok = get(body, &v);
+                store.push_back(v != 0);
+                break;
+            }
+            case ArgType::CHAR: {
+                char v = 0;
+                ok = get(body, &v);
+                store.push_back(v);
+                break;
+            }
+            case ArgType::POINTER: {
+                uint64_t v = 0;
+                ok = get(body, &v);
+                store.push_back(reinterpret_cast<const void*>(v));
+                break;
+            }
+            case ArgType::STRING: {
+                uint32_t len = 0;
+                ok = get(body, &len) && body.size() >= len;
+                if (ok) {
+                    // 拷贝一份，store中的参数在下一条日志之前一直有效
+                    store.push_back(std::string(body.substr(0, len)));
+                    body.remove_prefix(len);
+                }
+                break;
+            }
+            default:
+                ok = false;
+            }
+            if (!ok) {
+                return false;
+            }
+        }
+
+        fmt::format_to(std::back_inserter(*out), "{}: ", Logger::logLevel2String(site.level));
+        appendTime(out, nanos);
+        fmt::format_to(std::back_inserter(*out), ": * {} [{}:{}] ", tid, site.file, site.line);
+        try {
+            fmt::vformat_to(std::back_inserter(*out), site.format, store);
+        } catch (const fmt::format_error& e) {
+            // 格式字符串和参数不匹配时原样输出格式字符串
+            out->append(site.format).append(" <").append(e.what()).append(">");
+        }
+        out->push_back('\n');
+    }
+    return true;
+}
+
+} // namespace pl::blog
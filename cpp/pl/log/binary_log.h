@@ -0,0 +1,300 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include "cpp/pl/log/logger.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fmt/format.h>
+#include <map>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * NanoLog风格的二进制日志：格式字符串、文件名、行号这些静态信息每个调用点只记录一次(格式定义)，
+ * 每条日志只记录调用点的id、时间、tid以及参数的原始字节，不在打日志的线程上做任何格式化。
+ * 日志文件通过BinaryLogDecoder(或者log_decoder工具)离线还原成和文本日志相同格式的文本。
+ *
+ * 用法：BLOG_INFO("request {} took {}us", id, latency)，格式字符串使用fmt的语法，
+ * 参数只支持算术类型、字符串和指针
+ */
+namespace pl::blog {
+
+enum class ArgType : uint8_t {
+    INT64,
+    UINT64,
+    DOUBLE,
+    BOOL,
+    CHAR,
+    STRING,
+    POINTER,
+};
+
+// 记录类型，每条记录以类型和记录总长度(uint16)开头
+enum class RecordType : uint8_t {
+    // 调用点的格式定义
+    DEFINITION = 'D',
+    // 一条日志
+    LOG = 'L',
+    // 会话头，标识写入后续记录的进程。调用点的id在每个进程中都从1开始分配，
+    // 不同进程的记录只能通过会话区分
+    SESSION = 'S',
+};
+
+template <typename> inline constexpr bool ALWAYS_FALSE = false;
+
+template <typename T> constexpr ArgType argType() {
+    using U = std::decay_t<T>;
+    if constexpr (std::is_same_v<U, bool>) {
+        return ArgType::BOOL;
+    } else if constexpr (std::is_same_v<U, char>) {
+        return ArgType::CHAR;
+    } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+        return ArgType::INT64;
+    } else if constexpr (std::is_integral_v<U>) {
+        return ArgType::UINT64;
+    } else if constexpr (std::is_floating_point_v<U>) {
+        return ArgType::DOUBLE;
+    } else if constexpr (std::is_convertible_v<const U&, std::string_view>) {
+        return ArgType::STRING;
+    } else if constexpr (std::is_pointer_v<U>) {
+        return ArgType::POINTER;
+    } else {
+        static_assert(ALWAYS_FALSE<U>, "unsupported binary log argument");
+    }
+}
+
+/**
+ * 一个调用点的静态信息，作为函数内的静态变量在编译期初始化，第一次使用时分配id
+ */
+struct FormatSite {
+    constexpr FormatSite(Logger::LogLevel level, Logger::SourceFile file, int line,
+                         const char* format)
+        : level(level), file(file), line(line), format(format) {}
+
+    const Logger::LogLevel level;
+    const Logger::SourceFile file;
+    const int line;
+    const char* const format;
+    const ArgType* types{nullptr};
+    std::size_t nargs{0};
+    std::atomic<uint32_t> id{0};
+    // 已经向哪个epoch的sink写过格式定义
+    std::atomic<uint64_t> epoch{0};
+};
+
+/**
+ * @brief 设置二进制日志的输出，通常是一个独立的AsyncLogging。为nullptr时二进制日志
+ * 直接格式化成文本，通过Logger输出
+ */
+void setSink(LogSink* sink);
+
+[[nodiscard]] LogSink* sink();
+
+/**
+ * @brief 当前进程的会话头记录。setSink会先把它写入新的sink；按文件滚动的sink
+ * 需要在每个文件的开头写入它(参见AsyncLogging::Options::file_header)，
+ * 这样每个文件都可以单独解码，多个进程的文件拼接在一起也不会混淆
+ */
+[[nodiscard]] const std::string& sessionRecord();
+
+namespace detail {
+
+// 每条日志的固定部分：类型、长度、id、时间、tid
+constexpr std::size_t LOG_HEADER_SIZE = 1 + 2 + 4 + 8 + 4;
+// 会话头：类型、长度、pid、进程启动时间
+constexpr std::size_t SESSION_RECORD_SIZE = 1 + 2 + 4 + 8;
+constexpr std::size_t MAX_RECORD_SIZE = 4000;
+
+uint32_t registerSite(FormatSite& site, const ArgType* types, std::size_t nargs);
+
+// 当前的sink以及它的epoch，两者总是属于同一次setSink
+[[nodiscard]] LogSink* currentSink(uint64_t* epoch);
+
+// 写入格式定义，sink没有接受(例如被丢弃)或者定义超过MAX_RECORD_SIZE时返回false，
+// 此时site.epoch保持不变，下一条日志会重新写入
+bool writeDefinition(LogSink* sink, FormatSite& site, uint64_t epoch);
+
+void writeHeader(char* buf, uint16_t len, uint32_t id);
+
+// 没有sink时的文本输出
+void logText(const FormatSite& site, fmt::string_view format, fmt::format_args args);
+
+template <typename T> constexpr std::size_t fixedSize() {
+    constexpr ArgType type = argType<T>();
+    if constexpr (type == ArgType::BOOL || type == ArgType::CHAR) {
+        return 1;
+    } else if constexpr (type == ArgType::STRING) {
+        return 4;
+    } else {
+        return 8;
+    }
+}
+
+// 字符串参数，空指针当作空字符串
+template <typename T> std::string_view stringArg(const T& value) {
+    if constexpr (std::is_pointer_v<T>) {
+        return value == nullptr ? std::string_view() : std::string_view(value);
+    } else {
+        return std::string_view(value);
+    }
+}
+
+// 文本输出时的参数，C字符串转换成string_view，避免空指针
+template <typename T> decltype(auto) textArg(const T& value) {
+    if constexpr (std::is_pointer_v<T> && argType<T>() == ArgType::STRING) {
+        return stringArg(value);
+    } else {
+        return (value);
+    }
+}
+
+template <typename... Ts>
+void logTextArgs(const FormatSite& site, fmt::string_view format, const Ts&... args) {
+    logText(site, format, fmt::make_format_args(args...));
+}
+
+template <typename T> char* encode(char* p, const T& value, std::size_t& string_budget) {
+    constexpr ArgType type = argType<T>();
+    if constexpr (type == ArgType::BOOL || type == ArgType::CHAR) {
+        *p = static_cast<char>(value);
+        return p + 1;
+    } else if constexpr (type == ArgType::INT64) {
+        auto v = static_cast<int64_t>(value);
+        std::memcpy(p, &v, sizeof(v));
+        return p + sizeof(v);
+    } else if constexpr (type == ArgType::UINT64) {
+        auto v = static_cast<uint64_t>(value);
+        std::memcpy(p, &v, sizeof(v));
+        return p + sizeof(v);
+    } else if constexpr (type == ArgType::DOUBLE) {
+        auto v = static_cast<double>(value);
+        std::memcpy(p, &v, sizeof(v));
+        return p + sizeof(v);
+    } else if constexpr (type == ArgType::POINTER) {
+        auto v = reinterpret_cast<uint64_t>(value);
+        std::memcpy(p, &v, sizeof(v));
+        return p + sizeof(v);
+    } else {
+        // 超出单条记录大小的字符串被截断
+        std::string_view s = stringArg(value);
+        auto len = static_cast<uint32_t>(std::min(s.size(), string_budget));
+        string_budget -= len;
+        std::memcpy(p, &len, sizeof(len));
+        // 空指针的字符串data()为nullptr，即使长度为0也不能传给memcpy
+        if (len > 0) {
+            std::memcpy(p + sizeof(len), s.data(), len);
+        }
+        return p + sizeof(len) + len;
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief format和site.format是同一个字符串，只用于在编译期检查格式字符串和参数是否匹配
+ */
+template <typename... Args>
+void log(FormatSite& site,
+         [[maybe_unused]] fmt::format_string<const Args&...> format,
+         const Args&... args) {
+    static constexpr ArgType TYPES[sizeof...(Args) + 1] = {argType<Args>()...};
+    uint32_t id = site.id.load(std::memory_order_acquire);
+    if (id == 0) {
+        id = detail::registerSite(site, TYPES, sizeof...(Args));
+    }
+    uint64_t epoch = 0;
+    LogSink* out = detail::currentSink(&epoch);
+    if (out == nullptr) {
+        detail::logTextArgs(site, site.format, detail::textArg(args)...);
+        return;
+    }
+    if (site.epoch.load(std::memory_order_acquire) != epoch &&
+        !detail::writeDefinition(out, site, epoch)) {
+        // 没有格式定义的日志无法解码，直接丢弃
+        return;
+    }
+
+    constexpr std::size_t FIXED = detail::LOG_HEADER_SIZE + (detail::fixedSize<Args>() + ... + 0);
+    static_assert(FIXED < detail::MAX_RECORD_SIZE, "too many binary log arguments");
+    [[maybe_unused]] std::size_t string_budget = detail::MAX_RECORD_SIZE - FIXED;
+    char buf[detail::MAX_RECORD_SIZE];
+    char* p = buf + detail::LOG_HEADER_SIZE;
+    ((p = detail::encode(p, args, string_budget)), ...);
+    auto len = static_cast<uint16_t>(p - buf);
+    detail::writeHeader(buf, len, id);
+    out->append(buf, len);
+}
+
+/**
+ * @class BinaryLogDecoder
+ * @brief 把二进制日志还原成文本。同一个调用点的格式定义可能出现在使用它的日志之后
+ * (不同线程的缓冲区写入文件的顺序不确定)，也可能在之前滚动出去的文件里，
+ * 所以需要先通过load加载所有相关文件的格式定义，再逐个decode。
+ * 格式定义按(会话, id)区分，每次load/decode从数据开头的会话头开始，遇到新的会话头时切换，
+ * 没有会话头的数据属于同一个匿名会话
+ */
+class BinaryLogDecoder {
+public:
+    // 加载data中的格式定义，数据损坏时返回false
+    bool load(std::string_view data);
+
+    // 每条日志输出一行，遇到损坏的数据时返回false。未知调用点(格式定义丢失)的日志输出
+    // 一行标注，然后继续解码后面的日志
+    bool decode(std::string_view data, std::string* out) const;
+
+private:
+    struct Site {
+        Logger::LogLevel level;
+        std::string file;
+        int line;
+        std::string format;
+        std::vector<ArgType> types;
+    };
+
+    static uint64_t key(uint32_t session, uint32_t id) {
+        return static_cast<uint64_t>(session) << 32 | id;
+    }
+
+    // (pid, 启动时间) -> 会话编号，0留给没有会话头的数据
+    std::map<std::pair<uint32_t, uint64_t>, uint32_t> sessions_;
+    std::unordered_map<uint64_t, Site> sites_;
+};
+
+} // namespace pl::blog
+
+#define __PL_BLOG(level, format, ...)                                                             \
+    do {                                                                                           \
+        if (pl::Logger::enabled(pl::Logger::LogLevel::PL##level)) {                                \
+            static pl::blog::FormatSite __pl_blog_site(pl::Logger::LogLevel::PL##level, __FILE__,  \
+                                                       __LINE__, format);                          \
+            pl::blog::log(__pl_blog_site, format __VA_OPT__(, ) __VA_ARGS__);                      \
+        }                                                                                          \
+    } while (0)
+
+#define BLOG(level, format, ...) __PL_BLOG(_##level, format __VA_OPT__(, ) __VA_ARGS__)
+#define BLOG_TRACE(format, ...)  BLOG(TRACE, format __VA_OPT__(, ) __VA_ARGS__)
+#define BLOG_DEBUG(format, ...)  BLOG(DEBUG, format __VA_OPT__(, ) __VA_ARGS__)
+#define BLOG_INFO(format, ...)   BLOG(INFO, format __VA_OPT__(, ) __VA_ARGS__)
+#define BLOG_WARN(format, ...)   BLOG(WARN, format __VA_OPT__(, ) __VA_ARGS__)
+#define BLOG_ERROR(format, ...)  BLOG(ERROR, format __VA_OPT__(, ) __VA_ARGS__)
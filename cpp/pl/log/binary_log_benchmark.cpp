@@ -0,0 +1,60 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/log/binary_log.h"
+
+#include <benchmark/benchmark.h>
+
+/**
+ * 对比文本日志和二进制日志在打日志线程上的开销，sink只做最简单的拷贝
+ */
+namespace {
+
+class NullSink : public pl::LogSink {
+public:
+    void append(const char* data, std::size_t len) override {
+        benchmark::DoNotOptimize(data);
+        bytes_ += len;
+    }
+
+private:
+    std::size_t bytes_{0};
+};
+
+void BM_TextLog(benchmark::State& state) {
+    NullSink sink;
+    pl::Logger::setSink(&sink);
+    int64_t i = 0;
+    for (auto _ : state) {
+        LOG_INFO << "request " << i++ << " took " << 1.5 << "us, path: " << "/index";
+    }
+    pl::Logger::setSink(nullptr);
+}
+
+void BM_BinaryLog(benchmark::State& state) {
+    NullSink sink;
+    pl::blog::setSink(&sink);
+    int64_t i = 0;
+    for (auto _ : state) {
+        BLOG_INFO("request {} took {}us, path: {}", i++, 1.5, "/index");
+    }
+    pl::blog::setSink(nullptr);
+}
+
+} // namespace
+
+BENCHMARK(BM_TextLog);
+BENCHMARK(BM_BinaryLog);
@@ -0,0 +1,337 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/log/binary_log.h"
+#include "cpp/pl/thread/thread.h"
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+class CaptureSink : public pl::LogSink {
+public:
+    void append(const char* data, std::size_t len) override {
+        records.emplace_back(data, len);
+        bytes.append(data, len);
+    }
+
+    std::vector<std::string> records;
+    std::string bytes;
+};
+
+// CaptureSink不是线程安全的，通过互斥锁串行化
+class LockedSink : public pl::LogSink {
+public:
+    explicit LockedSink(std::mutex& mutex, CaptureSink& sink) : mutex_(mutex), sink_(sink) {}
+
+    void append(const char* data, std::size_t len) override {
+        std::lock_guard lock(mutex_);
+        sink_.append(data, len);
+    }
+
+private:
+    std::mutex& mutex_;
+    CaptureSink& sink_;
+};
+
+class BinaryLogTest : public ::testing::Test {
+protected:
+    void SetUp() override { pl::blog::setSink(&sink_); }
+
+    void TearDown() override { pl::blog::setSink(nullptr); }
+
+    // 去掉时间和tid之前的部分，只比较[file:line]之后的内容
+    static std::vector<std::string> messages(const std::string& text) {
+        std::vector<std::string> result;
+        std::size_t start = 0;
+        while (start < text.size()) {
+            std::size_t end = text.find('\n', start);
+            std::string line = text.substr(start, end - start);
+            result.push_back(line.substr(line.find("] ") + 2));
+            start = end + 1;
+        }
+        return result;
+    }
+
+    CaptureSink sink_;
+};
+
+} // namespace
+
+TEST_F(BinaryLogTest, round_trip) {
+    std::string name = "sstable";
+    const char* path = "/data/000001.sst";
+    for (int i = 0; i < 3; ++i) {
+        BLOG_INFO("open {} at {}, index {} size {} ratio {:.2f} ok {} tag {}", name, path, i,
+                  uint64_t{1} << 40, 0.125, i % 2 == 0, 'x');
+    }
+    BLOG_WARN("no arguments");
+    // 会话头之后，每个调用点只写一次格式定义
+    ASSERT_EQ(7, sink_.records.size());
+    EXPECT_EQ(pl::blog::sessionRecord(), sink_.records[0]);
+
+    pl::blog::BinaryLogDecoder decoder;
+    ASSERT_TRUE(decoder.load(sink_.bytes));
+    std::string text;
+    ASSERT_TRUE(decoder.decode(sink_.bytes, &text));
+    auto lines = messages(text);
+    ASSERT_EQ(4, lines.size());
+    EXPECT_EQ("open sstable at /data/000001.sst, index 0 size 1099511627776 ratio 0.12 ok true "
+              "tag x",
+              lines[0]);
+    EXPECT_EQ("open sstable at /data/000001.sst, index 1 size 1099511627776 ratio 0.12 ok false "
+              "tag x",
+              lines[1]);
+    EXPECT_EQ("no arguments", lines[3]);
+
+    // 前缀与文本日志的格式一致
+    std::string prefix = fmt::format(": * {} [binary_log_test.cpp:", pl::gettid());
+    EXPECT_EQ(0, text.find("INFO: "));
+    EXPECT_NE(std::string::npos, text.find(prefix));
+    EXPECT_NE(std::string::npos, text.find("WARN: "));
+}
+
+TEST_F(BinaryLogTest, definition_after_use) {
+    auto log = [](int i) { BLOG_INFO("value {}", i); };
+    log(1);
+    log(2);
+    ASSERT_EQ(4, sink_.records.size());
+    // 定义排在日志之后(例如来自另一个线程的缓冲区)，先load再decode即可
+    std::string data = sink_.records[0] + sink_.records[2] + sink_.records[3] + sink_.records[1];
+    pl::blog::BinaryLogDecoder decoder;
+    ASSERT_TRUE(decoder.load(data));
+    std::string text;
+    ASSERT_TRUE(decoder.decode(data, &text));
+    auto lines = messages(text);
+    ASSERT_EQ(2, lines.size());
+    EXPECT_EQ("value 1", lines[0]);
+    EXPECT_EQ("value 2", lines[1]);
+
+    // 没有定义时标注出来，继续解码后面的日志
+    text.clear();
+    pl::blog::BinaryLogDecoder empty;
+    ASSERT_TRUE(empty.decode(sink_.records[2] + sink_.records[3], &text));
+    lines = messages(text);
+    ASSERT_EQ(2, lines.size());
+    EXPECT_EQ(0, text.find("UNKNOWN: "));
+    EXPECT_NE(std::string::npos, lines[0].find("unknown site"));
+    // 截断的记录
+    EXPECT_FALSE(decoder.decode(sink_.records[2].substr(0, 10), &text));
+}
+
+TEST_F(BinaryLogTest, new_sink_rewrites_definitions) {
+    auto log = []() { BLOG_INFO("hello {}", "world"); };
+    log();
+    CaptureSink other;
+    pl::blog::setSink(&other);
+    log();
+    ASSERT_EQ(3, other.records.size());
+    pl::blog::BinaryLogDecoder decoder;
+    ASSERT_TRUE(decoder.load(other.bytes));
+    std::string text;
+    ASSERT_TRUE(decoder.decode(other.bytes, &text));
+    EXPECT_EQ("hello world", messages(text)[0]);
+    pl::blog::setSink(&sink_);
+}
+
+TEST_F(BinaryLogTest, dropped_definition) {
+    // 第一条记录(格式定义)被丢弃
+    class DropFirstSink : public CaptureSink {
+    public:
+        bool tryAppend(const char* data, std::size_t len) override {
+            if (drop_) {
+                drop_ = false;
+                return false;
+            }
+            append(data, len);
+            return true;
+        }
+
+    private:
+        bool drop_{true};
+    } dropping;
+    pl::blog::setSink(&dropping);
+    auto log = [](int i) { BLOG_INFO("value {}", i); };
+    log(1);
+    log(2);
+    // 定义被丢弃时日志也不写入，下一条日志重新写入定义
+    ASSERT_EQ(3, dropping.records.size());
+    pl::blog::BinaryLogDecoder decoder;
+    ASSERT_TRUE(decoder.load(dropping.bytes));
+    std::string text;
+    ASSERT_TRUE(decoder.decode(dropping.bytes, &text));
+    EXPECT_EQ("value 2", messages(text)[0]);
+    pl::blog::setSink(&sink_);
+}
+
+TEST_F(BinaryLogTest, sessions_with_colliding_ids) {
+    auto alpha = [](int i) { BLOG_INFO("alpha {}", i); };
+    auto beta = [](int i) { BLOG_INFO("beta {}", i); };
+    alpha(1);
+    beta(2);
+    ASSERT_EQ(5, sink_.records.size());
+    // 模拟另一个进程：beta的调用点在那个进程中先被使用，分到了alpha在这个进程中的id
+    uint32_t alpha_id = 0;
+    std::memcpy(&alpha_id, sink_.records[1].data() + 3, sizeof(alpha_id));
+    std::string other_session = sink_.records[0];
+    other_session[3] ^= 1;
+    std::string other_definition = sink_.records[3];
+    std::string other_log = sink_.records[4];
+    std::memcpy(other_definition.data() + 3, &alpha_id, sizeof(alpha_id));
+    std::memcpy(other_log.data() + 3, &alpha_id, sizeof(alpha_id));
+    // 两次运行的日志拼接在同一个文件中
+    std::string data = sink_.records[0] + sink_.records[1] + sink_.records[2] + other_session +
+                       other_definition + other_log;
+
+    pl::blog::BinaryLogDecoder decoder;
+    ASSERT_TRUE(decoder.load(data));
+    std::string text;
+    ASSERT_TRUE(decoder.decode(data, &text));
+    auto lines = messages(text);
+    ASSERT_EQ(2, lines.size());
+    EXPECT_EQ("alpha 1", lines[0]);
+    EXPECT_EQ("beta 2", lines[1]);
+
+    // 分开的文件也一样，解码时每个文件从自己的会话头开始
+    pl::blog::BinaryLogDecoder separate;
+    std::string second = other_session + other_definition + other_log;
+    ASSERT_TRUE(separate.load(second));
+    ASSERT_TRUE(separate.load(sink_.bytes));
+    text.clear();
+    ASSERT_TRUE(separate.decode(second, &text));
+    ASSERT_TRUE(separate.decode(sink_.bytes, &text));
+    lines = messages(text);
+    ASSERT_EQ(3, lines.size());
+    EXPECT_EQ("beta 2", lines[0]);
+    EXPECT_EQ("alpha 1", lines[1]);
+    EXPECT_EQ("beta 2", lines[2]);
+}
+
+TEST_F(BinaryLogTest, long_string_truncated) {
+    std::string big(10000, 'a');
+    BLOG_INFO("{} {}", big, 42);
+    ASSERT_EQ(3, sink_.records.size());
+    EXPECT_LE(sink_.records[2].size(), pl::blog::detail::MAX_RECORD_SIZE);
+    pl::blog::BinaryLogDecoder decoder;
+    ASSERT_TRUE(decoder.load(sink_.bytes));
+    std::string text;
+    ASSERT_TRUE(decoder.decode(sink_.bytes, &text));
+    auto line = messages(text)[0];
+    EXPECT_EQ(" 42", line.substr(line.size() - 3));
+}
+
+TEST_F(BinaryLogTest, level_filter) {
+    pl::Logger::setLevel(pl::Logger::LogLevel::PL_WARN);
+    BLOG_INFO("filtered {}", 1);
+    pl::Logger::setLevel(pl::Logger::LogLevel::PL_TRACE);
+    // 只有会话头
+    EXPECT_EQ(1, sink_.records.size());
+}
+
+TEST_F(BinaryLogTest, text_fallback) {
+    pl::blog::setSink(nullptr);
+    CaptureSink text;
+    pl::Logger::setSink(&text);
+    BLOG_ERROR("failed to read block {} of {}", 7, "a.sst");
+    pl::Logger::setSink(nullptr);
+    ASSERT_EQ(1, text.records.size());
+    EXPECT_EQ(0, text.records[0].find("ERROR: "));
+    EXPECT_EQ("failed to read block 7 of a.sst\n", messages(text.records[0])[0] + "\n");
+}
+
+TEST_F(BinaryLogTest, null_string) {
+    const char* name = nullptr;
+    BLOG_INFO("name [{}]", name);
+    pl::blog::BinaryLogDecoder decoder;
+    ASSERT_TRUE(decoder.load(sink_.bytes));
+    std::string text;
+    ASSERT_TRUE(decoder.decode(sink_.bytes, &text));
+    EXPECT_EQ("name []", messages(text)[0]);
+
+    pl::blog::setSink(nullptr);
+    CaptureSink fallback;
+    pl::Logger::setSink(&fallback);
+    BLOG_INFO("name [{}]", name);
+    pl::Logger::setSink(nullptr);
+    ASSERT_EQ(1, fallback.records.size());
+    EXPECT_EQ("name []", messages(fallback.records[0])[0].substr(0, 7));
+}
+
+TEST_F(BinaryLogTest, multi_thread) {
+    std::mutex mutex;
+    LockedSink locked(mutex, sink_);
+    pl::blog::setSink(&locked);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([t]() {
+            for (int i = 0; i < 1000; ++i) {
+                BLOG_DEBUG("thread {} seq {}", t, i);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    pl::blog::BinaryLogDecoder decoder;
+    ASSERT_TRUE(decoder.load(sink_.bytes));
+    std::string text;
+    ASSERT_TRUE(decoder.decode(sink_.bytes, &text));
+    EXPECT_EQ(4000, messages(text).size());
+}
+
+TEST_F(BinaryLogTest, switch_sink_while_logging) {
+    // 不停地切换sink，每个sink中的日志都能找到自己的格式定义
+    std::mutex mutex;
+    CaptureSink first;
+    CaptureSink second;
+    LockedSink a(mutex, first);
+    LockedSink b(mutex, second);
+    pl::blog::setSink(&a);
+
+    std::atomic<bool> done{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([t, &done]() {
+            for (int i = 0; !done.load(std::memory_order_relaxed) || i < 1000; ++i) {
+                BLOG_DEBUG("thread {} seq {}", t, i);
+            }
+        });
+    }
+    for (int i = 0; i < 2000; ++i) {
+        pl::blog::setSink(i % 2 == 0 ? &b : &a);
+    }
+    done.store(true);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    pl::blog::setSink(&sink_);
+
+    for (const CaptureSink* sink : {&first, &second}) {
+        pl::blog::BinaryLogDecoder decoder;
+        ASSERT_TRUE(decoder.load(sink->bytes));
+        std::string text;
+        ASSERT_TRUE(decoder.decode(sink->bytes, &text));
+        EXPECT_EQ(std::string::npos, text.find("unknown site"));
+    }
+}
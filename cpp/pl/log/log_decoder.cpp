@@ -0,0 +1,65 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/log/binary_log.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * 把二进制日志文件还原成文本输出到stdout。滚动出来的多个文件需要一起传入，
+ * 格式定义可能在之前的文件中
+ *
+ * usage: log_decoder <file>...
+ */
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        ::fprintf(stderr, "usage: %s <file>...\n", argv[0]);
+        return 1;
+    }
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        std::ifstream in(argv[i], std::ios::binary);
+        if (!in) {
+            ::fprintf(stderr, "failed to open %s\n", argv[i]);
+            return 1;
+        }
+        std::ostringstream ss;
+        ss << in.rdbuf();
+        files.push_back(std::move(ss).str());
+    }
+
+    pl::blog::BinaryLogDecoder decoder;
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        if (!decoder.load(files[i])) {
+            ::fprintf(stderr, "corrupted file %s\n", argv[i + 1]);
+            return 1;
+        }
+    }
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        std::string text;
+        bool ok = decoder.decode(files[i], &text);
+        ::fwrite(text.data(), 1, text.size(), stdout);
+        if (!ok) {
+            ::fprintf(stderr, "failed to decode %s\n", argv[i + 1]);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -17,12 +17,63 @@
 #include "cpp/pl/log/logger.h"
 #include "cpp/pl/thread/thread.h"
 
+#include <atomic>
 #include <cstdio>
-#include <fmt/chrono.h>
+#include <ctime>
 #include <fmt/format.h>
 
 namespace pl {
 
+namespace {
+
+std::atomic<LogSink*> g_sink{nullptr};
+
+/**
+ * 每个线程缓存精确到秒的时间前缀和tid，同一秒内的日志只需要格式化毫秒部分，
+ * 也避免了std::localtime的全局状态
+ */
+struct ThreadCache {
+    std::time_t second{-1};
+    // "MM-dd HH:mm:ss:SSS"
+    char time[32]{};
+    std::size_t time_len{0};
+    char tid[16]{};
+    std::size_t tid_len{0};
+
+    ThreadCache() {
+        auto result = fmt::format_to_n(tid, sizeof(tid), "{}", gettid());
+        tid_len = result.size;
+    }
+
+    std::string_view format(std::chrono::system_clock::time_point time_point) {
+        auto since_epoch = time_point.time_since_epoch();
+        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+        auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(since_epoch - seconds);
+        std::time_t now = seconds.count();
+        if (now != second) {
+            std::tm tm{};
+            ::localtime_r(&now, &tm);
+            time_len = std::strftime(time, sizeof(time), "%m-%d %H:%M:%S", &tm);
+            second = now;
+        }
+        // 毫秒部分固定3位，直接写在秒的后面
+        auto ms = static_cast<int>(millis.count());
+        time[time_len] = ':';
+        time[time_len + 1] = static_cast<char>('0' + ms / 100);
+        time[time_len + 2] = static_cast<char>('0' + ms / 10 % 10);
+        time[time_len + 3] = static_cast<char>('0' + ms % 10);
+        return {time, time_len + 4};
+    }
+};
+
+thread_local ThreadCache t_cache;
+
+} // namespace
+
+void Logger::setSink(LogSink* sink) { g_sink.store(sink, std::memory_order_release); }
+
+LogSink* Logger::sink() { return g_sink.load(std::memory_order_acquire); }
+
 Logger::Logger(Logger::SourceFile source, int line) : impl_(source, line, LogLevel::PL_INFO) {}
 
 Logger::Logger(Logger::SourceFile source, int line, Logger::LogLevel log_level)
@@ -30,22 +81,23 @@ Logger::Logger(Logger::SourceFile source, int line, Logger::LogLevel log_level)
 
 Logger::~Logger() { impl_.flush(); }
 
-std::string Logger::Impl::fmtTime() {
-    auto now_time_t = std::chrono::system_clock::to_time_t(time_);
-    std::tm now_tm = *std::localtime(&now_time_t);
-    auto duration = time_.time_since_epoch();
-    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(duration) % 1000;
-    return fmt::format("{:%m-%d %H:%M:%S}:{:03}", now_tm, millis.count());
-}
-
 void Logger::Impl::startSession() {
-    stream_ << logLevel2String(log_level_) << ": " << fmtTime() << ": * " << gettid() << " ["
-            << source_file_.source() << ":" << line_ << "] ";
+    stream_ << logLevel2String(log_level_) << ": " << t_cache.format(time_) << ": * "
+            << std::string_view(t_cache.tid, t_cache.tid_len) << " [" << source_file_.source()
+            << ":" << line_ << "] ";
 }
 
 void Logger::Impl::flush() {
     stream_ << '\n';
     const auto& buffer = stream_.buffer();
+    LogSink* sink = Logger::sink();
+    if (sink != nullptr) {
+        sink->append(buffer.data(), buffer.size());
+        if (log_level_ == LogLevel::PL_FATAL) {
+            sink->flush();
+        }
+        return;
+    }
     ::fwrite(buffer.data(), 1, buffer.size(), stdout);
     ::fflush(stdout);
 }
@@ -18,11 +18,40 @@
 
 #include "cpp/pl/log/logstream.h"
 
+#include <atomic>
 #include <chrono>
+#include <cstddef>
 #include <string_view>
 
+// 编译期的日志级别，低于这个级别的日志语句在编译期被去掉，参数也不会被求值。
+// 取值与Logger::LogLevel一致，例如-DPL_LOG_ACTIVE_LEVEL=2只保留INFO及以上的日志
+#ifndef PL_LOG_ACTIVE_LEVEL
+#define PL_LOG_ACTIVE_LEVEL 0
+#endif
+
 namespace pl {
 
+/**
+ * @class LogSink
+ * @brief 日志输出的目的地，append会在打日志的线程中并发调用，实现需要保证线程安全
+ */
+class LogSink {
+public:
+    virtual ~LogSink() = default;
+
+    // data是一条完整的日志，包括结尾的换行符
+    virtual void append(const char* data, std::size_t len) = 0;
+
+    // 和append相同，返回数据是否被接受，缓冲区满时丢弃数据的实现需要覆盖它
+    virtual bool tryAppend(const char* data, std::size_t len) {
+        append(data, len);
+        return true;
+    }
+
+    // 把已经append的日志写出去，FATAL日志之后会调用
+    virtual void flush() {}
+};
+
 class Logger {
 public:
     // clang-format off
@@ -84,6 +113,26 @@ public:
 
     LogStream& stream() { return impl_.stream_; }
 
+    // 运行期的日志级别，默认输出所有级别
+    static void setLevel(LogLevel level) { level_.store(level, std::memory_order_relaxed); }
+
+    [[nodiscard]] static LogLevel level() { return level_.load(std::memory_order_relaxed); }
+
+    // level为常量时编译期的判断会被折叠，被过滤掉的日志语句不会生成任何代码
+    [[nodiscard]] static bool enabled(LogLevel level) {
+#if PL_LOG_ACTIVE_LEVEL > 0
+        if (static_cast<int>(level) < PL_LOG_ACTIVE_LEVEL) {
+            return false;
+        }
+#endif
+        return level >= level_.load(std::memory_order_relaxed);
+    }
+
+    // 设置全局的日志输出，nullptr表示同步写stdout。替换掉的sink需要等没有线程再使用它之后才能销毁
+    static void setSink(LogSink* sink);
+
+    [[nodiscard]] static LogSink* sink();
+
 private:
     class Impl {
     private:
@@ -97,7 +146,6 @@ private:
 
         void startSession();
         void flush();
-        std::string fmtTime();
 
         friend class Logger;
         std::chrono::time_point<std::chrono::system_clock> time_;
@@ -106,9 +154,26 @@ private:
         Logger::LogLevel log_level_;
         LogStream stream_;
     } impl_;
+
+    static inline std::atomic<LogLevel> level_{LogLevel::PL_TRACE};
+};
+
+/**
+ * 把LOG表达式的类型变成void，使它可以作为?:的一个分支。&的优先级低于<<，
+ * 所有<<都结合到stream()上之后才会调用operator&
+ */
+class LogVoidify {
+public:
+    void operator&(LogStream& /*stream*/) {}
 };
 
-#define __PL_LOG(level) pl::Logger(__FILE__, __LINE__, pl::Logger::LogLevel::PL##level).stream()
+// 被过滤掉的日志不会构造Logger，<<后面的参数也不会被求值。使用表达式而不是if-else，
+// 避免在不带花括号的if中使用时产生悬挂的else
+#define __PL_LOG(level)                                                                            \
+    !pl::Logger::enabled(pl::Logger::LogLevel::PL##level)                                          \
+        ? (void)0                                                                                  \
+        : pl::LogVoidify() &                                                                       \
+              pl::Logger(__FILE__, __LINE__, pl::Logger::LogLevel::PL##level).stream()
 
 #define LOG(level) __PL_LOG(_##level)
 #define LOG_TRACE  LOG(TRACE)
@@ -0,0 +1,131 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/log/logger.h"
+#include "cpp/pl/thread/thread.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+// TRACE在编译期被去掉，PL_LOG_ACTIVE_LEVEL在BUILD中定义
+static_assert(PL_LOG_ACTIVE_LEVEL == 1);
+
+namespace {
+
+class CaptureSink : public pl::LogSink {
+public:
+    void append(const char* data, std::size_t len) override { lines.emplace_back(data, len); }
+
+    std::vector<std::string> lines;
+};
+
+class LoggerLevelTest : public ::testing::Test {
+protected:
+    void SetUp() override { pl::Logger::setSink(&sink_); }
+
+    void TearDown() override {
+        pl::Logger::setSink(nullptr);
+        pl::Logger::setLevel(pl::Logger::LogLevel::PL_TRACE);
+    }
+
+    CaptureSink sink_;
+};
+
+int evaluated = 0;
+
+int sideEffect() { return ++evaluated; }
+
+} // namespace
+
+TEST_F(LoggerLevelTest, runtime_level) {
+    evaluated = 0;
+    pl::Logger::setLevel(pl::Logger::LogLevel::PL_WARN);
+    LOG_DEBUG << sideEffect();
+    LOG_INFO << sideEffect();
+    EXPECT_EQ(0, evaluated);
+    EXPECT_TRUE(sink_.lines.empty());
+
+    LOG_WARN << sideEffect();
+    LOG_ERROR << sideEffect();
+    EXPECT_EQ(2, evaluated);
+    EXPECT_EQ(2, sink_.lines.size());
+
+    pl::Logger::setLevel(pl::Logger::LogLevel::PL_DEBUG);
+    LOG_DEBUG << sideEffect();
+    EXPECT_EQ(3, evaluated);
+    EXPECT_EQ(3, sink_.lines.size());
+}
+
+TEST_F(LoggerLevelTest, compile_time_level) {
+    evaluated = 0;
+    EXPECT_FALSE(pl::Logger::enabled(pl::Logger::LogLevel::PL_TRACE));
+    LOG_TRACE << sideEffect();
+    EXPECT_EQ(0, evaluated);
+    EXPECT_TRUE(sink_.lines.empty());
+}
+
+TEST_F(LoggerLevelTest, dangling_else) {
+    bool flag = false;
+    if (flag)
+        LOG_INFO << "not reached";
+    else
+        flag = true;
+    EXPECT_TRUE(flag);
+    EXPECT_TRUE(sink_.lines.empty());
+}
+
+TEST_F(LoggerLevelTest, prefix) {
+    LOG_INFO << "first";
+    LOG_INFO << "second";
+    ASSERT_EQ(2, sink_.lines.size());
+    for (const auto& line : sink_.lines) {
+        // INFO: MM-dd HH:mm:ss:SSS: * tid [file:line] message
+        int month = 0;
+        int day = 0;
+        int hour = 0;
+        int minute = 0;
+        int second = 0;
+        int millis = 0;
+        int tid = 0;
+        int consumed = 0;
+        ASSERT_EQ(7, std::sscanf(line.c_str(), "INFO: %2d-%2d %2d:%2d:%2d:%3d: * %d [%n", &month,
+                                 &day, &hour, &minute, &second, &millis, &tid, &consumed))
+            << line;
+        EXPECT_EQ(pl::gettid(), tid);
+        EXPECT_LT(millis, 1000);
+        EXPECT_EQ(0, line.compare(consumed, 22, "logger_level_test.cpp:")) << line;
+        EXPECT_EQ('\n', line.back());
+    }
+    EXPECT_EQ(sink_.lines[0].substr(0, 6), sink_.lines[1].substr(0, 6));
+}
+
+TEST_F(LoggerLevelTest, unbraced_if) {
+    // LOG是一个表达式，可以直接用在不带花括号的if/else中
+    evaluated = 0;
+    pl::Logger::setLevel(pl::Logger::LogLevel::PL_WARN);
+    bool flag = true;
+    if (flag)
+        LOG_WARN << sideEffect();
+    else
+        LOG_ERROR << sideEffect();
+    if (!flag)
+        LOG_ERROR << sideEffect();
+    EXPECT_EQ(1, evaluated);
+    EXPECT_EQ(1, sink_.lines.size());
+}
@@ -88,16 +88,19 @@ public:
         return *this;
     }
 
+    // 直接格式化到栈上的缓冲区，不分配内存
     template <typename T, std::enable_if_t<std::is_arithmetic_v<T>>* = nullptr>
     LogStream& operator<<(const T v) {
-        const auto data = fmt::format("{}", v);
-        write(std::string_view(data));
+        char data[64];
+        auto result = fmt::format_to_n(data, sizeof(data), "{}", v);
+        write(std::string_view(data, result.size));
         return *this;
     }
 
     LogStream& operator<<(void* v) {
-        auto data = fmt::format("{}", v);
-        write(std::string_view(data));
+        char data[32];
+        auto result = fmt::format_to_n(data, sizeof(data), "{}", v);
+        write(std::string_view(data, result.size));
         return *this;
     }
 
@@ -0,0 +1,192 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/metrics/metrics.h"
+
+#include <fmt/format.h>
+#include <iterator>
+
+namespace pl::metrics {
+
+namespace {
+
+// name{labels} value，没有标签时省略花括号
+template <typename T>
+void appendLine(std::string& out, std::string_view name, std::string_view labels, T value) {
+    if (labels.empty()) {
+        fmt::format_to(std::back_inserter(out), "{} {}\n", name, value);
+    } else {
+        fmt::format_to(std::back_inserter(out), "{}{{{}}} {}\n", name, labels, value);
+    }
+}
+
+// 在标签中追加quantile，例如name{lane="high",quantile="0.99"}
+void appendQuantile(std::string& out,
+                    std::string_view name,
+                    std::string_view labels,
+                    std::string_view quantile,
+                    uint64_t value) {
+    fmt::format_to(std::back_inserter(out), "{}{{{}{}quantile=\"{}\"}} {}\n", name, labels,
+                   labels.empty() ? "" : ",", quantile, value);
+}
+
+} // namespace
+
+void HistogramSnapshot::merge(const HistogramSnapshot& other) {
+    if (other.count == 0) {
+        return;
+    }
+    if (buckets.size() < other.buckets.size()) {
+        buckets.resize(other.buckets.size(), 0);
+    }
+    for (std::size_t i = 0; i < other.buckets.size(); ++i) {
+        buckets[i] += other.buckets[i];
+    }
+    min = count == 0 ? other.min : std::min(min, other.min);
+    max = std::max(max, other.max);
+    count += other.count;
+    sum += other.sum;
+}
+
+uint64_t HistogramSnapshot::percentile(double p) const {
+    if (count == 0) {
+        return 0;
+    }
+    p = std::clamp(p, 0.0, 1.0);
+    // 第rank个值(从1开始)所在的桶
+    auto rank = static_cast<uint64_t>(p * static_cast<double>(count) + 0.5);
+    rank = std::clamp<uint64_t>(rank, 1, count);
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return std::clamp(Histogram::bucketUpper(i), min, max);
+        }
+    }
+    return max;
+}
+
+HistogramSnapshot Histogram::snapshot() const {
+    HistogramSnapshot result;
+    result.buckets.assign(NUM_BUCKETS, 0);
+    uint64_t min = UINT64_MAX;
+    for (std::size_t s = 0; s < NUM_SHARDS; ++s) {
+        const Shard& shard = shards_[s];
+        for (std::size_t i = 0; i < NUM_BUCKETS; ++i) {
+            result.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+        }
+        result.count += shard.count.load(std::memory_order_relaxed);
+        result.sum += shard.sum.load(std::memory_order_relaxed);
+        min = std::min(min, shard.min.load(std::memory_order_relaxed));
+        result.max = std::max(result.max, shard.max.load(std::memory_order_relaxed));
+    }
+    result.min = result.count == 0 ? 0 : min;
+    return result;
+}
+
+Registry& Registry::instance() {
+    // 不析构，避免其他静态对象析构时打点访问到已经销毁的注册表
+    static auto* registry = new Registry();
+    return *registry;
+}
+
+template <typename T>
+T& Registry::getOrCreate(std::map<std::string, Family<T>, std::less<>>& metrics,
+                         std::string_view name,
+                         std::string_view labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto family = metrics.find(name);
+    if (family == metrics.end()) {
+        family = metrics.emplace(std::string(name), Family<T>()).first;
+    }
+    auto it = family->second.find(labels);
+    if (it == family->second.end()) {
+        it = family->second.emplace(std::string(labels), std::make_unique<T>()).first;
+    }
+    return *it->second;
+}
+
+Counter& Registry::counter(std::string_view name, std::string_view labels) {
+    return getOrCreate(counters_, name, labels);
+}
+
+Gauge& Registry::gauge(std::string_view name, std::string_view labels) {
+    return getOrCreate(gauges_, name, labels);
+}
+
+Histogram& Registry::histogram(std::string_view name, std::string_view labels) {
+    return getOrCreate(histograms_, name, labels);
+}
+
+std::string Registry::dumpText() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string out;
+    for (const auto& [name, family] : counters_) {
+        for (const auto& [labels, counter] : family) {
+            appendLine(out, name, labels, counter->value());
+        }
+    }
+    for (const auto& [name, family] : gauges_) {
+        for (const auto& [labels, gauge] : family) {
+            appendLine(out, name, labels, gauge->value());
+        }
+    }
+    for (const auto& [name, family] : histograms_) {
+        for (const auto& [labels, histogram] : family) {
+            HistogramSnapshot snapshot = histogram->snapshot();
+            appendLine(out, name, labels,
+                       fmt::format("count={} mean={:.1f} p50={} p90={} p99={} p999={} max={}",
+                                   snapshot.count, snapshot.mean(), snapshot.percentile(0.5),
+                                   snapshot.percentile(0.9), snapshot.percentile(0.99),
+                                   snapshot.percentile(0.999), snapshot.max));
+        }
+    }
+    return out;
+}
+
+std::string Registry::dumpPrometheus() const {
+    static constexpr std::pair<const char*, double> QUANTILES[] = {
+        {"0.5", 0.5}, {"0.9", 0.9}, {"0.99", 0.99}, {"0.999", 0.999}};
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string out;
+    for (const auto& [name, family] : counters_) {
+        fmt::format_to(std::back_inserter(out), "# TYPE {} counter\n", name);
+        for (const auto& [labels, counter] : family) {
+            appendLine(out, name, labels, counter->value());
+        }
+    }
+    for (const auto& [name, family] : gauges_) {
+        fmt::format_to(std::back_inserter(out), "# TYPE {} gauge\n", name);
+        for (const auto& [labels, gauge] : family) {
+            appendLine(out, name, labels, gauge->value());
+        }
+    }
+    for (const auto& [name, family] : histograms_) {
+        fmt::format_to(std::back_inserter(out), "# TYPE {} summary\n", name);
+        for (const auto& [labels, histogram] : family) {
+            HistogramSnapshot snapshot = histogram->snapshot();
+            for (const auto& [quantile, p] : QUANTILES) {
+                appendQuantile(out, name, labels, quantile, snapshot.percentile(p));
+            }
+            appendLine(out, name + "_sum", labels, snapshot.sum);
+            appendLine(out, name + "_count", labels, snapshot.count);
+        }
+    }
+    return out;
+}
+
+} // namespace pl::metrics
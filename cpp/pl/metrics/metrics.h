@@ -0,0 +1,251 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * 热路径上使用的指标：计数器和直方图按线程分片，打点只是对本线程分片的一次relaxed原子加，
+ * 读取时再把所有分片合并。指标对象注册到全局的Registry之后一直存在，可以缓存引用
+ */
+namespace pl::metrics {
+
+namespace detail {
+
+inline std::atomic<std::size_t> next_shard{0};
+
+// 当前线程使用的分片，线程第一次打点时轮流分配。使用常量初始化的thread_local，
+// 访问时不需要经过动态初始化的检查
+inline std::size_t shardIndex() {
+    thread_local std::size_t index = SIZE_MAX;
+    if (__builtin_expect(index == SIZE_MAX, 0)) {
+        index = next_shard.fetch_add(1, std::memory_order_relaxed);
+    }
+    return index;
+}
+
+inline void atomicMax(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value > current &&
+           !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+inline void atomicMin(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value < current &&
+           !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace detail
+
+inline uint64_t nowNanos() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+/**
+ * @class Counter
+ * @brief 单调递增的计数器，每个分片独占一个cache line，避免多个线程同时打点时的伪共享
+ */
+class Counter {
+public:
+    static constexpr std::size_t NUM_SHARDS = 16;
+
+    void inc(uint64_t n = 1) {
+        slots_[detail::shardIndex() % NUM_SHARDS].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] uint64_t value() const {
+        uint64_t sum = 0;
+        for (const auto& slot : slots_) {
+            sum += slot.value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> value{0};
+    };
+
+    std::array<Slot, NUM_SHARDS> slots_;
+};
+
+/**
+ * @class Gauge
+ * @brief 可增可减的瞬时值，例如队列长度
+ */
+class Gauge {
+public:
+    void set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+
+    void add(int64_t n) { value_.fetch_add(n, std::memory_order_relaxed); }
+
+    [[nodiscard]] int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+/**
+ * 直方图的快照，多个快照可以合并，例如合并多个进程或者多个时间段的数据
+ */
+struct HistogramSnapshot {
+    std::vector<uint64_t> buckets;
+    uint64_t count{0};
+    uint64_t sum{0};
+    uint64_t min{0};
+    uint64_t max{0};
+
+    void merge(const HistogramSnapshot& other);
+
+    // p的取值范围是[0, 1]，返回的值的相对误差不超过1/32
+    [[nodiscard]] uint64_t percentile(double p) const;
+
+    [[nodiscard]] double mean() const {
+        return count == 0 ? 0 : static_cast<double>(sum) / static_cast<double>(count);
+    }
+};
+
+/**
+ * @class Histogram
+ * @brief HDR风格的对数线性直方图：小于32的值每个值一个桶，之后每个2的幂区间均分成32个桶，
+ * 相对误差不超过1/32。超过2^45(纳秒时约9.7小时)的值记录在最后一个桶中
+ */
+class Histogram {
+public:
+    static constexpr int SUB_BITS = 5;
+    static constexpr uint64_t SUB_COUNT = uint64_t{1} << SUB_BITS;
+    static constexpr int MAX_EXP = 45;
+    static constexpr std::size_t NUM_BUCKETS = (MAX_EXP - SUB_BITS + 1) * SUB_COUNT;
+    static constexpr std::size_t NUM_SHARDS = 8;
+
+    Histogram() : shards_(new Shard[NUM_SHARDS]) {}
+
+    void record(uint64_t value) {
+        Shard& shard = shards_[detail::shardIndex() % NUM_SHARDS];
+        shard.buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        shard.count.fetch_add(1, std::memory_order_relaxed);
+        shard.sum.fetch_add(value, std::memory_order_relaxed);
+        detail::atomicMin(shard.min, value);
+        detail::atomicMax(shard.max, value);
+    }
+
+    [[nodiscard]] HistogramSnapshot snapshot() const;
+
+    static std::size_t bucketIndex(uint64_t value) {
+        if (value < SUB_COUNT) {
+            return static_cast<std::size_t>(value);
+        }
+        int exp = 63 - __builtin_clzll(value);
+        if (exp >= MAX_EXP) {
+            return NUM_BUCKETS - 1;
+        }
+        auto sub = static_cast<std::size_t>((value >> (exp - SUB_BITS)) & (SUB_COUNT - 1));
+        return static_cast<std::size_t>(exp - SUB_BITS + 1) * SUB_COUNT + sub;
+    }
+
+    // 桶中最大的值
+    static uint64_t bucketUpper(std::size_t index) {
+        if (index < SUB_COUNT) {
+            return index;
+        }
+        int shift = static_cast<int>(index / SUB_COUNT) - 1;
+        uint64_t lower = (SUB_COUNT + index % SUB_COUNT) << shift;
+        return lower + (uint64_t{1} << shift) - 1;
+    }
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> min{UINT64_MAX};
+        std::atomic<uint64_t> max{0};
+        std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets{};
+    };
+
+    std::unique_ptr<Shard[]> shards_;
+};
+
+/**
+ * @class ScopedTimer
+ * @brief 析构时把经过的纳秒数记录到直方图中
+ */
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram& histogram) : histogram_(histogram), start_(nowNanos()) {}
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    ~ScopedTimer() { histogram_.record(nowNanos() - start_); }
+
+private:
+    Histogram& histogram_;
+    const uint64_t start_;
+};
+
+/**
+ * @class Registry
+ * @brief 全局的指标注册表。同一个名字和标签只会创建一个指标，返回的引用在进程内一直有效，
+ * 热路径上应该把引用缓存在静态变量中，不要每次都查找。标签使用prometheus的语法，例如lane="high"
+ */
+class Registry {
+public:
+    static Registry& instance();
+
+    Counter& counter(std::string_view name, std::string_view labels = "");
+
+    Gauge& gauge(std::string_view name, std::string_view labels = "");
+
+    Histogram& histogram(std::string_view name, std::string_view labels = "");
+
+    // 每个指标一行，直方图输出count、mean以及p50/p90/p99/p999/max
+    [[nodiscard]] std::string dumpText() const;
+
+    // prometheus的文本格式，直方图以summary的形式输出
+    [[nodiscard]] std::string dumpPrometheus() const;
+
+private:
+    template <typename T> using Family = std::map<std::string, std::unique_ptr<T>, std::less<>>;
+
+    template <typename T>
+    T& getOrCreate(std::map<std::string, Family<T>, std::less<>>& metrics,
+                   std::string_view name,
+                   std::string_view labels);
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Family<Counter>, std::less<>> counters_;
+    std::map<std::string, Family<Gauge>, std::less<>> gauges_;
+    std::map<std::string, Family<Histogram>, std::less<>> histograms_;
+};
+
+} // namespace pl::metrics
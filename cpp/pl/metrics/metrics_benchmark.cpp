@@ -0,0 +1,60 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/metrics/metrics.h"
+
+#include <atomic>
+#include <benchmark/benchmark.h>
+
+namespace {
+
+pl::metrics::Counter sharded;
+std::atomic<uint64_t> shared{0};
+pl::metrics::Histogram histogram;
+
+// 对比多线程打点时分片计数器和单个原子变量的开销
+void BM_ShardedCounter(benchmark::State& state) {
+    for (auto _ : state) {
+        sharded.inc();
+    }
+}
+BENCHMARK(BM_ShardedCounter)->ThreadRange(1, 8);
+
+void BM_SharedAtomic(benchmark::State& state) {
+    for (auto _ : state) {
+        shared.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+BENCHMARK(BM_SharedAtomic)->ThreadRange(1, 8);
+
+void BM_HistogramRecord(benchmark::State& state) {
+    uint64_t v = 12345;
+    for (auto _ : state) {
+        histogram.record(v);
+        v = v * 6364136223846793005ULL + 1442695040888963407ULL;
+        v >>= 40;
+    }
+}
+BENCHMARK(BM_HistogramRecord)->ThreadRange(1, 8);
+
+void BM_ScopedTimer(benchmark::State& state) {
+    for (auto _ : state) {
+        pl::metrics::ScopedTimer timer(histogram);
+    }
+}
+BENCHMARK(BM_ScopedTimer);
+
+} // namespace
@@ -0,0 +1,135 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/metrics/metrics.h"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <random>
+#include <thread>
+#include <vector>
+
+using pl::metrics::Counter;
+using pl::metrics::Gauge;
+using pl::metrics::Histogram;
+using pl::metrics::HistogramSnapshot;
+using pl::metrics::Registry;
+
+TEST(MetricsTest, counter_across_threads) {
+    Counter counter;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&counter]() {
+            for (int i = 0; i < 10000; ++i) {
+                counter.inc();
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(80000, counter.value());
+}
+
+TEST(MetricsTest, gauge) {
+    Gauge gauge;
+    gauge.set(10);
+    gauge.add(-3);
+    EXPECT_EQ(7, gauge.value());
+}
+
+TEST(MetricsTest, bucket_bounds) {
+    for (uint64_t v = 0; v < 100000; ++v) {
+        std::size_t index = Histogram::bucketIndex(v);
+        ASSERT_LE(v, Histogram::bucketUpper(index));
+        if (index > 0) {
+            ASSERT_GT(v, Histogram::bucketUpper(index - 1));
+        }
+    }
+    EXPECT_EQ(Histogram::NUM_BUCKETS - 1, Histogram::bucketIndex(UINT64_MAX));
+}
+
+TEST(MetricsTest, histogram_percentiles) {
+    Histogram histogram;
+    for (uint64_t v = 1; v <= 100000; ++v) {
+        histogram.record(v);
+    }
+    HistogramSnapshot snapshot = histogram.snapshot();
+    EXPECT_EQ(100000, snapshot.count);
+    EXPECT_EQ(1, snapshot.min);
+    EXPECT_EQ(100000, snapshot.max);
+    EXPECT_DOUBLE_EQ(50000.5, snapshot.mean());
+    for (double p : {0.5, 0.9, 0.99, 0.999}) {
+        double expected = p * 100000;
+        double actual = static_cast<double>(snapshot.percentile(p));
+        EXPECT_NEAR(expected, actual, expected / Histogram::SUB_COUNT) << p;
+    }
+    EXPECT_EQ(1, snapshot.percentile(0));
+    EXPECT_EQ(100000, snapshot.percentile(1));
+}
+
+TEST(MetricsTest, snapshot_merge) {
+    Histogram a;
+    Histogram b;
+    std::mt19937_64 rng(42);
+    std::vector<uint64_t> values;
+    for (int i = 0; i < 10000; ++i) {
+        uint64_t v = rng() % 1000000;
+        values.push_back(v);
+        (i % 2 == 0 ? a : b).record(v);
+    }
+    HistogramSnapshot merged = a.snapshot();
+    merged.merge(b.snapshot());
+    std::sort(values.begin(), values.end());
+    EXPECT_EQ(values.size(), merged.count);
+    EXPECT_EQ(values.front(), merged.min);
+    EXPECT_EQ(values.back(), merged.max);
+    double expected = static_cast<double>(values[values.size() * 99 / 100 - 1]);
+    EXPECT_NEAR(expected, static_cast<double>(merged.percentile(0.99)),
+                expected / Histogram::SUB_COUNT);
+
+    HistogramSnapshot empty;
+    empty.merge(merged);
+    EXPECT_EQ(merged.min, empty.min);
+    EXPECT_EQ(merged.percentile(0.5), empty.percentile(0.5));
+}
+
+TEST(MetricsTest, registry_returns_same_metric) {
+    auto& registry = Registry::instance();
+    Counter& c1 = registry.counter("metrics_test_total", "k=\"a\"");
+    Counter& c2 = registry.counter("metrics_test_total", "k=\"a\"");
+    Counter& c3 = registry.counter("metrics_test_total", "k=\"b\"");
+    EXPECT_EQ(&c1, &c2);
+    EXPECT_NE(&c1, &c3);
+    c1.inc(3);
+    c3.inc();
+
+    registry.histogram("metrics_test_latency_ns").record(100);
+    registry.gauge("metrics_test_depth").set(-2);
+
+    std::string text = registry.dumpText();
+    EXPECT_NE(std::string::npos, text.find("metrics_test_total{k=\"a\"} 3\n"));
+    EXPECT_NE(std::string::npos, text.find("metrics_test_depth -2\n"));
+    EXPECT_NE(std::string::npos, text.find("metrics_test_latency_ns count=1 mean=100.0 p50=100"));
+
+    std::string prom = registry.dumpPrometheus();
+    EXPECT_NE(std::string::npos, prom.find("# TYPE metrics_test_total counter\n"
+                                           "metrics_test_total{k=\"a\"} 3\n"
+                                           "metrics_test_total{k=\"b\"} 1\n"));
+    EXPECT_NE(std::string::npos, prom.find("# TYPE metrics_test_latency_ns summary\n"
+                                           "metrics_test_latency_ns{quantile=\"0.5\"} 100\n"));
+    EXPECT_NE(std::string::npos, prom.find("metrics_test_latency_ns_count 1\n"));
+}
@@ -15,6 +15,7 @@
 // Authors: liubang (it.liubang@gmail.com)
 
 #include "cpp/pl/sst/block.h"
+#include "cpp/pl/arena/object_pool.h"
 #include "cpp/pl/sst/cell.h"
 #include "cpp/pl/sst/encoding.h"
 
@@ -24,7 +25,11 @@
 namespace pl {
 
 Block::Block(const BlockContents& content)
-    : data_(content.data.data()), size_(content.data.size()), owned_(content.heap_allocated) {
+    : data_(content.data.data()),
+      size_(content.data.size()),
+      owned_(content.heap_allocated),
+      memory_resource_(content.memory_resource),
+      allocated_bytes_(content.allocated_bytes) {
     num_restarts_ = decodeInt<uint32_t>(data_ + size_ - 4);
     std::size_t max_num_restarts = (size_ - 4) / 4;
     if (num_restarts_ > max_num_restarts) {
@@ -37,7 +42,12 @@ Block::Block(const BlockContents& content)
 }
 
 Block::~Block() {
-    if (owned_) {
+    if (!owned_) {
+        return;
+    }
+    if (memory_resource_ != nullptr) {
+        memory_resource_->deallocate(const_cast<char*>(data_), allocated_bytes_, 1);
+    } else {
         delete[] data_;
     }
 }
@@ -48,14 +58,17 @@ public:
                   BlockRef block,
                   const char* data,
                   uint32_t restarts,
-                  uint32_t num_restarts)
+                  uint32_t num_restarts,
+                  std::pmr::memory_resource* resource)
         : comparator_(std::move(comparator)),
           block_(std::move(block)),
           data_(data),
           restarts_(restarts),
           num_restarts_(num_restarts),
           current_(restarts_),
-          current_restart_(num_restarts) {}
+          current_restart_(num_restarts),
+          resource_(resource),
+          cell_key_(resource != nullptr ? resource : std::pmr::new_delete_resource()) {}
 
     [[nodiscard]] bool valid() const override { return current_ < restarts_; }
 
@@ -199,7 +212,13 @@ private:
         cell_key_.resize(shared);
         cell_key_.append(p, non_shared);
         val_ = std::string_view(p + non_shared, value_size);
-        cell_ = std::make_shared<Cell>(cell_key_, rowkey_size, val_);
+        if (resource_ != nullptr) {
+            cell_ = std::allocate_shared<Cell>(std::pmr::polymorphic_allocator<Cell>(resource_),
+                                               cell_key_, rowkey_size, val_);
+        } else {
+            cell_ = std::allocate_shared<Cell>(ObjectPoolAllocator<Cell>(), cell_key_,
+                                               rowkey_size, val_);
+        }
         while (current_restart_ + 1 < num_restarts_ &&
                getRestartOffset(current_restart_) < current_) {
             ++current_restart_;
@@ -241,15 +260,16 @@ private:
     const uint32_t num_restarts_;             // restart的个数
     uint32_t current_{0};                     // 当前游标的偏移
     uint32_t current_restart_{0};             // 当前是第几个restart
-    std::string cell_key_;                    // 当前游标处的cellkey
+    std::pmr::memory_resource* resource_;     // cell的内存来源，为空时使用ObjectPool
+    std::pmr::string cell_key_;               // 当前游标处的cellkey
     CellRef cell_{nullptr};                   // 当前的cell
     std::string_view val_;                    // 当前游标处的value
     Status status_;
 };
 
-IteratorPtr Block::iterator(const ComparatorRef& comparator) {
-    return std::make_unique<BlockIterator>(comparator, shared_from_this(), data_, restart_offset_,
-                                           num_restarts_);
+IteratorPtr Block::iterator(const ComparatorRef& comparator, std::pmr::memory_resource* resource) {
+    return newIterator<BlockIterator>(resource, comparator, shared_from_this(), data_,
+                                      restart_offset_, num_restarts_, resource);
 }
 
 } // namespace pl
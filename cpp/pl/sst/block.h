@@ -21,6 +21,7 @@
 #include "cpp/pl/sst/sstable_format.h"
 
 #include <memory>
+#include <memory_resource>
 
 namespace pl {
 
@@ -34,7 +35,11 @@ public:
 
     [[nodiscard]] bool valid() const { return size_ > 0; }
 
-    IteratorPtr iterator(const ComparatorRef& comparator);
+    /**
+     * @brief 创建block迭代器，resource不为空时迭代器以及迭代过程中产生的cell都从resource中分配
+     */
+    IteratorPtr iterator(const ComparatorRef& comparator,
+                         std::pmr::memory_resource* resource = nullptr);
 
 private:
     class BlockIterator;
@@ -45,6 +50,8 @@ private:
     std::size_t num_restarts_{0};
     uint32_t restart_offset_{0};
     bool owned_{false};
+    std::pmr::memory_resource* memory_resource_{nullptr};
+    std::size_t allocated_bytes_{0};
 };
 
 using BlockRef = std::shared_ptr<Block>;
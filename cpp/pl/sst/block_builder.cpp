@@ -100,6 +100,7 @@ std::size_t BlockBuilder::sizeEstimate() const {
 void BlockBuilder::reset() {
     buffer_.clear();
     last_key_.clear();
+    last_rowkey_len_ = 0;
     counter_ = 0;
     finished_ = false;
     restarts_.clear();
@@ -17,14 +17,18 @@
 #pragma once
 
 #include "cpp/pl/arena/arena.h"
+#include "cpp/pl/arena/object_pool.h"
 #include "cpp/pl/sst/comparator.h"
 #include "cpp/pl/sst/encoding.h"
 
 #include <cassert>
 #include <cstdint>
 #include <cstring>
+#include <memory>
+#include <memory_resource>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace pl {
 
@@ -42,6 +46,8 @@ class Cell;
 using CellPtr = std::unique_ptr<Cell>;
 using CellRef = std::shared_ptr<Cell>;
 using CellVecRef = std::vector<CellRef>;
+// cell按值存放，内存来自调用方提供的memory resource
+using CellVec = std::pmr::vector<Cell>;
 
 struct CellKey {
     std::string_view rowkey;
@@ -153,26 +159,20 @@ public:
 
     CellPtr clone(Arena* arena) const {
         CellPtr new_cell = std::make_unique<Cell>();
-        new_cell->cell_key_.cell_type = cellType();
-        new_cell->cell_key_.timestamp = timestamp();
-
-        size_t size = rowkey().size() + cf().size() + col().size() + value().size();
-        char* buf = arena->allocate_aligned(size);
-        std::memcpy(buf, rowkey().data(), rowkey().size());
-        new_cell->cell_key_.rowkey = {buf, rowkey().size()};
-        buf += rowkey().size();
-
-        std::memcpy(buf, cf().data(), cf().size());
-        new_cell->cell_key_.cf = {buf, cf().size()};
-        buf += cf().size();
-
-        std::memcpy(buf, col().data(), col().size());
-        new_cell->cell_key_.col = {buf, col().size()};
-        buf += col().size();
+        new_cell->copyFrom(*this, arena->allocate_aligned(payloadSize()));
+        return new_cell;
+    }
 
-        std::memcpy(buf, value().data(), value().size());
-        new_cell->value_ = {buf, value().size()};
+    // cell本身从ObjectPool中分配，payload从arena中分配
+    [[nodiscard]] CellRef cloneShared(Arena* arena) const {
+        CellRef new_cell = std::allocate_shared<Cell>(ObjectPoolAllocator<Cell>());
+        new_cell->copyFrom(*this, arena->allocate_aligned(payloadSize()));
+        return new_cell;
+    }
 
+    [[nodiscard]] Cell clone(std::pmr::memory_resource* resource) const {
+        Cell new_cell;
+        new_cell.copyFrom(*this, static_cast<char*>(resource->allocate(payloadSize(), 1)));
         return new_cell;
     }
 
@@ -189,6 +189,31 @@ public:
         value_ = "";
     }
 
+private:
+    [[nodiscard]] std::size_t payloadSize() const {
+        return rowkey().size() + cf().size() + col().size() + value().size();
+    }
+
+    void copyFrom(const Cell& other, char* buf) {
+        cell_key_.cell_type = other.cellType();
+        cell_key_.timestamp = other.timestamp();
+
+        std::memcpy(buf, other.rowkey().data(), other.rowkey().size());
+        cell_key_.rowkey = {buf, other.rowkey().size()};
+        buf += other.rowkey().size();
+
+        std::memcpy(buf, other.cf().data(), other.cf().size());
+        cell_key_.cf = {buf, other.cf().size()};
+        buf += other.cf().size();
+
+        std::memcpy(buf, other.col().data(), other.col().size());
+        cell_key_.col = {buf, other.col().size()};
+        buf += other.col().size();
+
+        std::memcpy(buf, other.value().data(), other.value().size());
+        value_ = {buf, other.value().size()};
+    }
+
 private:
     CellKey cell_key_;
     std::string_view value_;
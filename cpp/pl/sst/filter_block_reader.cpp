@@ -16,6 +16,7 @@
 
 #include "cpp/pl/sst/filter_block_reader.h"
 #include "cpp/pl/sst/encoding.h"
+#include "cpp/pl/sst/perf_context.h"
 
 namespace pl {
 
@@ -36,6 +37,8 @@ FilterBlockReader::FilterBlockReader(FilterPolicyRef filter_policy, std::string_
 }
 
 bool FilterBlockReader::keyMayMatch(uint64_t block_offset, std::string_view key) {
+    PL_PERF_COUNTER_ADD(filter_check_count, 1);
+    PL_PERF_TIMER_GUARD(filter_nanos);
     uint64_t idx = block_offset >> base_lg_;
     if (idx >= num_) {
         return true;
@@ -43,8 +46,14 @@ bool FilterBlockReader::keyMayMatch(uint64_t block_offset, std::string_view key)
     auto start = decodeInt<uint32_t>(offset_ + idx * 4);
     auto limit = decodeInt<uint32_t>(offset_ + idx * 4 + 4);
     if (start <= limit && limit <= static_cast<size_t>(offset_ - data_)) {
-        return filter_policy_->keyMayMatch(key, std::string_view(data_ + start, limit - start));
+        bool match =
+            filter_policy_->keyMayMatch(key, std::string_view(data_ + start, limit - start));
+        if (!match) {
+            PL_PERF_COUNTER_ADD(filter_useful_count, 1);
+        }
+        return match;
     }
+    PL_PERF_COUNTER_ADD(filter_useful_count, 1);
     return false;
 }
 
@@ -16,10 +16,14 @@
 
 #pragma once
 
+#include "cpp/pl/arena/object_pool.h"
 #include "cpp/pl/sst/cell.h"
 #include "cpp/pl/status/status.h"
 
 #include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
 
 namespace pl {
 
@@ -47,6 +51,58 @@ public:
     [[nodiscard]] virtual CellRef cell() const = 0;
 };
 
-using IteratorPtr = std::unique_ptr<Iterator>;
+/**
+ * @class IteratorDeleter
+ * @brief 迭代器可能是从调用方传入的memory resource中分配的，释放的时候需要归还给它；
+ * 也可能是从ObjectPool中分配的，此时通过recycle归还；都为空时退化为普通的delete
+ */
+struct IteratorDeleter {
+    std::pmr::memory_resource* resource{nullptr};
+    std::size_t size{0};
+    std::size_t alignment{0};
+    void (*recycle)(Iterator*){nullptr};
+
+    IteratorDeleter() = default;
+
+    IteratorDeleter(std::pmr::memory_resource* resource, std::size_t size, std::size_t alignment)
+        : resource(resource), size(size), alignment(alignment) {}
+
+    explicit IteratorDeleter(void (*recycle)(Iterator*)) : recycle(recycle) {}
+
+    // 兼容std::make_unique创建的迭代器
+    template <typename T> IteratorDeleter(std::default_delete<T> /*unused*/) {}
+
+    void operator()(Iterator* iter) const {
+        if (recycle != nullptr) {
+            recycle(iter);
+            return;
+        }
+        if (resource == nullptr) {
+            delete iter;
+            return;
+        }
+        iter->~Iterator();
+        resource->deallocate(iter, size, alignment);
+    }
+};
+
+using IteratorPtr = std::unique_ptr<Iterator, IteratorDeleter>;
+
+/**
+ * @brief resource为空时迭代器从ObjectPool<T>中分配，否则从resource中分配
+ */
+template <typename T, typename... Args>
+IteratorPtr newIterator(std::pmr::memory_resource* resource, Args&&... args) {
+    static_assert(std::is_base_of_v<Iterator, T>);
+    if (resource == nullptr) {
+        T* iter = ObjectPool<T>::instance().create(std::forward<Args>(args)...);
+        return IteratorPtr(iter, IteratorDeleter([](Iterator* it) {
+                               ObjectPool<T>::instance().destroy(static_cast<T*>(it));
+                           }));
+    }
+    void* ptr = resource->allocate(sizeof(T), alignof(T));
+    return IteratorPtr(new (ptr) T(std::forward<Args>(args)...),
+                       IteratorDeleter(resource, sizeof(T), alignof(T)));
+}
 
 } // namespace pl
@@ -23,12 +23,16 @@
 #include <cstdint>
 #include <filesystem>
 #include <memory>
+#include <memory_resource>
 
 namespace pl {
 
 struct ReadOptions {
     ReadOptions() : comparator(std::make_shared<BytewiseComparator>()) {}
     const ComparatorRef comparator;
+    // 读路径上block、迭代器和cell的默认内存来源，为空时使用全局堆，
+    // 可以在SSTable::get/SSTable::iterator中按查询覆盖
+    std::pmr::memory_resource* memory_resource{nullptr};
 };
 
 using ReadOptionsPtr = std::unique_ptr<ReadOptions>;
@@ -0,0 +1,56 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/sst/perf_context.h"
+
+namespace pl {
+
+std::string PerfContext::toString(bool exclude_zero) const {
+    std::string result;
+    auto append = [&result, exclude_zero](const char* name, uint64_t value) {
+        if (exclude_zero && value == 0) {
+            return;
+        }
+        if (!result.empty()) {
+            result.append(", ");
+        }
+        result.append(name).append(" = ").append(std::to_string(value));
+    };
+#define PL_PERF_APPEND(metric) append(#metric, metric)
+    PL_PERF_APPEND(get_count);
+    PL_PERF_APPEND(get_nanos);
+    PL_PERF_APPEND(index_seek_nanos);
+    PL_PERF_APPEND(block_seek_nanos);
+    PL_PERF_APPEND(cell_count);
+    PL_PERF_APPEND(cell_clone_nanos);
+    PL_PERF_APPEND(filter_check_count);
+    PL_PERF_APPEND(filter_useful_count);
+    PL_PERF_APPEND(filter_nanos);
+    PL_PERF_APPEND(block_read_count);
+    PL_PERF_APPEND(block_read_bytes);
+    PL_PERF_APPEND(block_read_nanos);
+    PL_PERF_APPEND(block_checksum_nanos);
+    PL_PERF_APPEND(block_decompress_count);
+    PL_PERF_APPEND(block_decompress_nanos);
+    PL_PERF_APPEND(iter_seek_count);
+    PL_PERF_APPEND(iter_seek_nanos);
+    PL_PERF_APPEND(iter_next_count);
+    PL_PERF_APPEND(iter_block_load_count);
+#undef PL_PERF_APPEND
+    return result;
+}
+
+} // namespace pl
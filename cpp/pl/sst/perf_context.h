@@ -0,0 +1,127 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include "cpp/pl/metrics/metrics.h"
+
+#include <cstdint>
+#include <string>
+
+namespace pl {
+
+/**
+ * perf context的采集级别，默认关闭，只在需要分析单次请求耗时的时候按线程打开
+ */
+enum class PerfLevel : uint8_t {
+    DISABLE = 0,
+    COUNT = 1, // 只统计次数和字节数
+    TIME = 2,  // 同时统计各个阶段的耗时，每个阶段多两次读时钟
+};
+
+/**
+ * @class PerfContext
+ * @brief 当前线程上的操作在各个阶段的次数和耗时(纳秒)，会一直累加，调用方在操作之前reset，
+ * 操作结束之后读取，例如:
+ *
+ *   pl::setPerfLevel(pl::PerfLevel::TIME);
+ *   pl::perfContext()->reset();
+ *   table->get(rowkey, &buf, &cells);
+ *   LOG_INFO << pl::perfContext()->toString();
+ */
+struct PerfContext {
+    // SSTable::get
+    uint64_t get_count{0};
+    uint64_t get_nanos{0};          // get的总耗时
+    uint64_t index_seek_nanos{0};   // 在索引块中查找数据块
+    uint64_t block_seek_nanos{0};   // 在数据块中查找rowkey
+    uint64_t cell_count{0};         // 返回的cell个数
+    uint64_t cell_clone_nanos{0};   // 遍历行内的cell并复制到调用方的内存中
+
+    // FilterBlockReader::keyMayMatch
+    uint64_t filter_check_count{0};
+    uint64_t filter_useful_count{0}; // 被过滤掉，省去一次数据块读取
+    uint64_t filter_nanos{0};
+
+    // BlockReader::readBlock
+    uint64_t block_read_count{0};
+    uint64_t block_read_bytes{0};
+    uint64_t block_read_nanos{0};       // pread
+    uint64_t block_checksum_nanos{0};
+    uint64_t block_decompress_count{0};
+    uint64_t block_decompress_nanos{0};
+
+    // SSTableIterator
+    uint64_t iter_seek_count{0};  // seek/first/last
+    uint64_t iter_seek_nanos{0};
+    uint64_t iter_next_count{0};  // next/prev
+    uint64_t iter_block_load_count{0};
+
+    void reset() { *this = PerfContext(); }
+
+    // 格式为"name = value, ..."，exclude_zero为true时不输出值为0的项
+    [[nodiscard]] std::string toString(bool exclude_zero = true) const;
+};
+
+namespace detail {
+
+// 都是常量初始化的，访问时不需要经过动态初始化的检查
+inline thread_local PerfLevel perf_level = PerfLevel::DISABLE;
+inline thread_local PerfContext perf_context;
+
+} // namespace detail
+
+inline void setPerfLevel(PerfLevel level) { detail::perf_level = level; }
+
+inline PerfLevel perfLevel() { return detail::perf_level; }
+
+inline PerfContext* perfContext() { return &detail::perf_context; }
+
+/**
+ * @class PerfTimer
+ * @brief 析构时把经过的时间累加到metric上，级别低于TIME时什么都不做
+ */
+class PerfTimer {
+public:
+    explicit PerfTimer(uint64_t* metric)
+        : metric_(detail::perf_level >= PerfLevel::TIME ? metric : nullptr),
+          start_(metric_ != nullptr ? metrics::nowNanos() : 0) {}
+
+    PerfTimer(const PerfTimer&) = delete;
+    PerfTimer& operator=(const PerfTimer&) = delete;
+
+    ~PerfTimer() {
+        if (metric_ != nullptr) {
+            *metric_ += metrics::nowNanos() - start_;
+        }
+    }
+
+private:
+    uint64_t* const metric_;
+    const uint64_t start_;
+};
+
+} // namespace pl
+
+#define PL_PERF_COUNTER_ADD(metric, value)                                                         \
+    do {                                                                                           \
+        if (::pl::detail::perf_level >= ::pl::PerfLevel::COUNT) {                                  \
+            ::pl::detail::perf_context.metric += (value);                                          \
+        }                                                                                          \
+    } while (0)
+
+#define PL_PERF_TIMER_GUARD(metric)                                                                \
+    ::pl::PerfTimer __pl_perf_timer_##metric(&::pl::detail::perf_context.metric)
@@ -15,13 +15,33 @@
 // Authors: liubang (it.liubang@gmail.com)
 
 #include "cpp/pl/sst/sstable.h"
+#include "cpp/pl/arena/object_pool.h"
 #include "cpp/pl/fs/posix_fs.h"
 #include "cpp/pl/log/logger.h"
+#include "cpp/pl/metrics/metrics.h"
 #include "cpp/pl/scope/scope.h"
+#include "cpp/pl/sst/perf_context.h"
 #include "cpp/pl/sst/sstable_iterator.h"
 
 namespace pl {
 
+namespace {
+
+struct GetMetrics {
+    metrics::Counter& total = metrics::Registry::instance().counter("sst_get_total");
+    // 被bloom filter过滤掉，不需要读取数据块的查询
+    metrics::Counter& filtered = metrics::Registry::instance().counter("sst_get_filtered_total");
+    metrics::Counter& found = metrics::Registry::instance().counter("sst_get_found_total");
+    metrics::Histogram& latency = metrics::Registry::instance().histogram("sst_get_latency_ns");
+};
+
+GetMetrics& getMetrics() {
+    static GetMetrics m;
+    return m;
+}
+
+} // namespace
+
 SSTable::SSTable(ReadOptionsRef options,
                  FileDescriptorRef fd,
                  FileSystemRef reader,
@@ -128,7 +148,8 @@ void SSTable::readFilter(const Footer& footer) {
     filter_ = std::make_shared<FilterBlockReader>(std::move(filter), block.data);
 }
 
-IteratorPtr SSTable::blockReader(std::string_view index_value) {
+IteratorPtr SSTable::blockReader(std::string_view index_value,
+                                 std::pmr::memory_resource* resource) {
     BlockHandle handle;
     auto s = handle.decodeFrom(index_value);
     if (!s.isOk()) {
@@ -137,23 +158,38 @@ IteratorPtr SSTable::blockReader(std::string_view index_value) {
     }
 
     BlockContents contents;
-    s = BlockReader::readBlock(reader_, fd_, handle, &contents);
+    s = BlockReader::readBlock(reader_, fd_, handle, &contents, resource);
 
     if (!s.isOk()) {
         LOG_ERROR << "read block error: " << s.msg();
         return nullptr;
     }
 
-    auto block = std::make_shared<Block>(contents);
-    auto iter = block->iterator(options_->comparator);
+    BlockRef block;
+    if (resource != nullptr) {
+        block = std::allocate_shared<Block>(std::pmr::polymorphic_allocator<Block>(resource),
+                                            contents);
+    } else {
+        block = std::allocate_shared<Block>(ObjectPoolAllocator<Block>(), contents);
+    }
+    auto iter = block->iterator(options_->comparator, resource);
 
     return iter;
 }
 
-// 将来会废弃这个接口，在上层统一实现query和scan操作语义
-Status SSTable::get(std::string_view rowkey, Arena* buf, CellVecRef* cells) {
-    auto iiter = index_block_->iterator(options_->comparator);
-    iiter->seek(rowkey);
+template <typename Fn>
+Status SSTable::getRow(std::string_view rowkey, std::pmr::memory_resource* resource, Fn&& fn) {
+    auto& m = getMetrics();
+    metrics::ScopedTimer timer(m.latency);
+    m.total.inc();
+    PL_PERF_COUNTER_ADD(get_count, 1);
+    PL_PERF_TIMER_GUARD(get_nanos);
+
+    auto iiter = index_block_->iterator(options_->comparator, resource);
+    {
+        PL_PERF_TIMER_GUARD(index_seek_nanos);
+        iiter->seek(rowkey);
+    }
     if (!iiter->valid()) {
         return iiter->status();
     }
@@ -168,17 +204,21 @@ Status SSTable::get(std::string_view rowkey, Arena* buf, CellVecRef* cells) {
             return st;
         }
         if (!filter_->keyMayMatch(handle.offset(), rowkey)) {
+            m.filtered.inc();
             st = Status::NewNotFound();
             // LOG_DEBUG << "key not found, rowkey:" << rowkey;
             return st;
         }
     }
-    auto data_iter = blockReader(idx_handle);
+    auto data_iter = blockReader(idx_handle, resource);
     if (data_iter == nullptr) {
         st = Status::NewCorruption("invalid data block");
         return st;
     }
-    data_iter->seek(rowkey);
+    {
+        PL_PERF_TIMER_GUARD(block_seek_nanos);
+        data_iter->seek(rowkey);
+    }
     if (!data_iter->valid()) {
         st = Status::NewNotFound();
         return st;
@@ -191,8 +231,11 @@ Status SSTable::get(std::string_view rowkey, Arena* buf, CellVecRef* cells) {
         return st;
     }
 
+    m.found.inc();
     // should copy
-    cells->emplace_back(cell->clone(buf));
+    PL_PERF_TIMER_GUARD(cell_clone_nanos);
+    fn(*cell);
+    PL_PERF_COUNTER_ADD(cell_count, 1);
     data_iter->next();
 
     // get all cells of the row
@@ -202,18 +245,40 @@ Status SSTable::get(std::string_view rowkey, Arena* buf, CellVecRef* cells) {
         if (options_->comparator->compare(cell->rowkey(), rowkey) != 0) {
             break;
         }
-        cells->emplace_back(cell->clone(buf));
+        fn(*cell);
+        PL_PERF_COUNTER_ADD(cell_count, 1);
         data_iter->next();
     }
 
     return st;
 }
 
-IteratorPtr SSTable::iterator() {
-    return std::make_unique<SSTableIterator>(index_block_->iterator(options_->comparator), filter_,
-                                             [that = this](std::string_view b) {
-                                                 return that->blockReader(b);
-                                             });
+// 将来会废弃这个接口，在上层统一实现query和scan操作语义
+Status SSTable::get(std::string_view rowkey, Arena* buf, CellVecRef* cells) {
+    return getRow(rowkey, options_->memory_resource, [buf, cells](const Cell& cell) {
+        cells->emplace_back(cell.cloneShared(buf));
+    });
+}
+
+Status SSTable::get(std::string_view rowkey, std::pmr::memory_resource* resource, CellVec* cells) {
+    if (resource == nullptr) {
+        resource = cells->get_allocator().resource();
+    }
+    return getRow(rowkey, resource, [resource, cells](const Cell& cell) {
+        cells->emplace_back(cell.clone(resource));
+    });
+}
+
+IteratorPtr SSTable::iterator(std::pmr::memory_resource* resource) {
+    if (resource == nullptr) {
+        resource = options_->memory_resource;
+    }
+    return newIterator<SSTableIterator>(
+        resource, index_block_->iterator(options_->comparator, resource), filter_,
+        [that = this, resource](std::string_view b) {
+            return that->blockReader(b, resource);
+        },
+        resource != nullptr ? resource : std::pmr::new_delete_resource());
 }
 
 } // namespace pl
@@ -26,6 +26,7 @@
 
 #include <cassert>
 #include <filesystem>
+#include <memory_resource>
 
 namespace pl {
 
@@ -55,7 +56,18 @@ public:
 
     Status get(std::string_view rowkey, Arena* buf, CellVecRef* cells);
 
-    IteratorPtr iterator();
+    /**
+     * @brief 查询一整行，查询过程中的block、迭代器以及返回的cell全部从resource中分配，
+     * 配合ArenaMemoryResource使用时，查询结束后整体释放即可。
+     * resource为空时使用cells自身的memory resource，resource需要比cells的生命周期更长
+     */
+    Status get(std::string_view rowkey, std::pmr::memory_resource* resource, CellVec* cells);
+
+    /**
+     * @brief resource为空时使用ReadOptions::memory_resource，resource需要比迭代器以及
+     * 迭代器返回的cell的生命周期更长
+     */
+    IteratorPtr iterator(std::pmr::memory_resource* resource = nullptr);
 
 private:
     SSTable(ReadOptionsRef options,
@@ -65,7 +77,10 @@ private:
             BlockRef index_block);
 
     void readFilter(const Footer& footer);
-    IteratorPtr blockReader(std::string_view index_value);
+    IteratorPtr blockReader(std::string_view index_value, std::pmr::memory_resource* resource);
+
+    template <typename Fn>
+    Status getRow(std::string_view rowkey, std::pmr::memory_resource* resource, Fn&& fn);
 
 private:
     const ReadOptionsRef options_;
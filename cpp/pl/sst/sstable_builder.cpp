@@ -17,6 +17,7 @@
 #include "cpp/pl/sst/sstable_builder.h"
 #include "cpp/pl/fs/posix_fs.h"
 #include "cpp/pl/log/logger.h"
+#include "cpp/pl/metrics/metrics.h"
 #include "cpp/pl/sst/encoding.h"
 
 #include "snappy.h"
@@ -27,6 +28,25 @@
 
 namespace pl {
 
+namespace {
+
+// 数据块和索引块写入前后的字节数，可以据此计算压缩率
+struct BuildMetrics {
+    metrics::Counter& blocks = metrics::Registry::instance().counter("sst_build_block_total");
+    metrics::Counter& raw_bytes =
+        metrics::Registry::instance().counter("sst_build_raw_bytes_total");
+    metrics::Counter& written_bytes =
+        metrics::Registry::instance().counter("sst_build_written_bytes_total");
+    metrics::Histogram& compress = metrics::Registry::instance().histogram("sst_build_compress_ns");
+};
+
+BuildMetrics& buildMetrics() {
+    static BuildMetrics m;
+    return m;
+}
+
+} // namespace
+
 SSTableBuilder::SSTableBuilder(BuildOptionsRef options) : options_(std::move(options)) {}
 
 Status SSTableBuilder::open() {
@@ -121,6 +141,10 @@ void SSTableBuilder::flush() {
 void SSTableBuilder::writeBlock(BlockBuilder* block, BlockHandle* handle) {
     assert(ok());
     auto raw = block->finish();
+    auto& m = buildMetrics();
+    m.blocks.inc();
+    m.raw_bytes.inc(raw.size());
+    uint64_t start = metrics::nowNanos();
     std::string compressed;
     switch (options_->compression_type) {
     case CompressionType::SNAPPY:
@@ -153,6 +177,10 @@ void SSTableBuilder::writeBlock(BlockBuilder* block, BlockHandle* handle) {
     default:
         break;
     }
+    if (options_->compression_type != CompressionType::NONE) {
+        m.compress.record(metrics::nowNanos() - start);
+    }
+    m.written_bytes.inc(raw.size());
     writeBlockRaw(raw, options_->compression_type, handle);
     block->reset();
 }
@@ -49,6 +49,9 @@ public:
 
     [[nodiscard]] bool ok() const { return status().isOk(); }
 
+    // open之后有效
+    [[nodiscard]] const std::string& sstFile() const { return sst_file_; }
+
 private:
     void writeBlock(BlockBuilder* block, BlockHandle* handle);
     void writeBlockRaw(std::string_view content, CompressionType type, BlockHandle* handle);
@@ -15,7 +15,9 @@
 // Authors: liubang (it.liubang@gmail.com)
 
 #include "cpp/pl/sst/sstable_format.h"
+#include "cpp/pl/metrics/metrics.h"
 #include "cpp/pl/sst/encoding.h"
+#include "cpp/pl/sst/perf_context.h"
 
 #include "snappy.h"
 #include <cassert>
@@ -24,6 +26,71 @@
 
 namespace pl {
 
+namespace {
+
+class BlockBuffer {
+public:
+    BlockBuffer(std::size_t size, std::pmr::memory_resource* resource)
+        : size_(size), resource_(resource) {
+        if (resource_ == nullptr) {
+            data_ = new char[size_];
+        } else {
+            data_ = static_cast<char*>(resource_->allocate(size_, 1));
+        }
+    }
+
+    BlockBuffer(const BlockBuffer&) = delete;
+    BlockBuffer& operator=(const BlockBuffer&) = delete;
+
+    ~BlockBuffer() {
+        if (data_ == nullptr) {
+            return;
+        }
+        if (resource_ == nullptr) {
+            delete[] data_;
+        } else {
+            resource_->deallocate(data_, size_, 1);
+        }
+    }
+
+    [[nodiscard]] char* get() const { return data_; }
+
+    [[nodiscard]] std::size_t size() const { return size_; }
+
+    // 将buffer的所有权转移给result
+    void releaseTo(std::size_t data_size, BlockContents* result) {
+        result->data = std::string_view(data_, data_size);
+        result->heap_allocated = true;
+        result->cachable = true;
+        result->memory_resource = resource_;
+        result->allocated_bytes = size_;
+        data_ = nullptr;
+    }
+
+private:
+    char* data_{nullptr};
+    const std::size_t size_;
+    std::pmr::memory_resource* const resource_;
+};
+
+// 读取数据块的指标，latency包含pread、crc校验和解压缩
+struct BlockReadMetrics {
+    metrics::Counter& blocks = metrics::Registry::instance().counter("sst_block_read_total");
+    metrics::Counter& bytes = metrics::Registry::instance().counter("sst_block_read_bytes_total");
+    metrics::Histogram& latency =
+        metrics::Registry::instance().histogram("sst_block_read_latency_ns");
+    metrics::Histogram& crc = metrics::Registry::instance().histogram("sst_block_crc_ns");
+    metrics::Histogram& decompress =
+        metrics::Registry::instance().histogram("sst_block_decompress_ns");
+};
+
+BlockReadMetrics& blockReadMetrics() {
+    static BlockReadMetrics m;
+    return m;
+}
+
+} // namespace
+
 void BlockHandle::encodeTo(std::string* dst) const {
     assert(offset_ != ~static_cast<uint64_t>(0));
     assert(size_ != ~static_cast<uint64_t>(0));
@@ -205,13 +272,23 @@ Status Footer::decodeFrom(std::string_view input) {
 Status BlockReader::readBlock(const FileSystemRef& reader,
                               const FileDescriptorRef& fd,
                               const BlockHandle& handle,
-                              BlockContents* result) {
+                              BlockContents* result,
+                              std::pmr::memory_resource* memory_resource) {
+    auto& m = blockReadMetrics();
+    metrics::ScopedTimer timer(m.latency);
+    m.blocks.inc();
+    PL_PERF_COUNTER_ADD(block_read_count, 1);
+
     // read block trailer
     auto s = static_cast<std::size_t>(handle.size());
-    auto buf = std::make_unique<char[]>(s + BLOCK_TRAILER_LEN);
+    BlockBuffer buf(s + BLOCK_TRAILER_LEN, memory_resource);
 
     std::string_view content;
-    auto status = reader->pread(fd, handle.offset(), s + BLOCK_TRAILER_LEN, buf.get(), &content);
+    Status status;
+    {
+        PL_PERF_TIMER_GUARD(block_read_nanos);
+        status = reader->pread(fd, handle.offset(), s + BLOCK_TRAILER_LEN, buf.get(), &content);
+    }
     if (!status.isOk()) {
         return status;
     }
@@ -219,53 +296,61 @@ Status BlockReader::readBlock(const FileSystemRef& reader,
     if (content.size() != s + BLOCK_TRAILER_LEN) {
         return Status::NewCorruption("invalid block");
     }
+    m.bytes.inc(content.size());
+    PL_PERF_COUNTER_ADD(block_read_bytes, content.size());
 
     // crc check
     const char* data = content.data();
     auto crc = decodeInt<uint32_t>(data + s + 1);
+    uint64_t start = metrics::nowNanos();
     auto actual_crc = ::crc32_iscsi((unsigned char*)data, s, 0);
+    uint64_t crc_nanos = metrics::nowNanos() - start;
+    m.crc.record(crc_nanos);
+    if (perfLevel() >= PerfLevel::TIME) {
+        perfContext()->block_checksum_nanos += crc_nanos;
+    }
     if (crc != actual_crc) {
         return Status::NewCorruption("crc error");
     }
     switch (static_cast<CompressionType>(data[s])) {
     case CompressionType::SNAPPY:
     {
+        metrics::ScopedTimer decompress_timer(m.decompress);
+        PL_PERF_COUNTER_ADD(block_decompress_count, 1);
+        PL_PERF_TIMER_GUARD(block_decompress_nanos);
         size_t ulen;
         if (!snappy::GetUncompressedLength(data, s, &ulen)) {
             return Status::NewCorruption("invalid data");
         }
-        auto ubuf = std::make_unique<char[]>(ulen);
+        BlockBuffer ubuf(ulen, memory_resource);
         if (!snappy::RawUncompress(data, s, ubuf.get())) {
             return Status::NewCorruption("invalid data");
         }
-        result->data = std::string_view(ubuf.release(), ulen);
-        result->heap_allocated = true;
-        result->cachable = true;
+        ubuf.releaseTo(ulen, result);
         break;
     }
     case CompressionType::ZSTD:
     {
+        metrics::ScopedTimer decompress_timer(m.decompress);
+        PL_PERF_COUNTER_ADD(block_decompress_count, 1);
+        PL_PERF_TIMER_GUARD(block_decompress_nanos);
         size_t ulen = ZSTD_getFrameContentSize(data, s);
         if (ulen == 0) {
             return Status::NewCorruption("invalid data");
         }
-        auto ubuf = std::make_unique<char[]>(ulen);
+        BlockBuffer ubuf(ulen, memory_resource);
         ZSTD_DCtx* ctx = ZSTD_createDCtx();
         size_t outlen = ZSTD_decompressDCtx(ctx, ubuf.get(), ulen, data, s);
         ZSTD_freeDCtx(ctx);
         if (ZSTD_isError(outlen) != 0u) {
             return Status::NewCorruption("invalid data");
         }
-        result->data = std::string_view(ubuf.release(), ulen);
-        result->heap_allocated = true;
-        result->cachable = true;
+        ubuf.releaseTo(ulen, result);
         break;
     }
     default:
     {
-        result->data = std::string_view(buf.release(), s);
-        result->heap_allocated = true;
-        result->cachable = true;
+        buf.releaseTo(s, result);
         break;
     }
     }
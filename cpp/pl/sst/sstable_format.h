@@ -21,6 +21,7 @@
 #include "cpp/pl/status/status.h"
 
 #include <cstdint>
+#include <memory_resource>
 #include <sstream>
 #include <string>
 #include <string_view>
@@ -250,14 +251,21 @@ struct BlockContents {
     std::string_view data;
     bool cachable;
     bool heap_allocated;
+    // 不为空时，data是从该memory resource中分配的，大小为allocated_bytes
+    std::pmr::memory_resource* memory_resource{nullptr};
+    std::size_t allocated_bytes{0};
 };
 
 class BlockReader {
 public:
+    /**
+     * @brief 读取并校验一个block，memory_resource为空时使用new[]分配内存
+     */
     static Status readBlock(const FileSystemRef& reader,
                             const FileDescriptorRef& fd,
                             const BlockHandle& handle,
-                            BlockContents* result);
+                            BlockContents* result,
+                            std::pmr::memory_resource* memory_resource = nullptr);
 };
 
 } // namespace pl
@@ -15,12 +15,15 @@
 // Authors: liubang (it.liubang@gmail.com)
 
 #include "cpp/pl/sst/sstable_iterator.h"
+#include "cpp/pl/sst/perf_context.h"
 
 #include <cassert>
 
 namespace pl {
 
 void SSTableIterator::seek(std::string_view target) {
+    PL_PERF_COUNTER_ADD(iter_seek_count, 1);
+    PL_PERF_TIMER_GUARD(iter_seek_nanos);
     index_iter_->seek(target);
     initDataBlock();
     if (data_iter_ != nullptr) {
@@ -30,6 +33,8 @@ void SSTableIterator::seek(std::string_view target) {
 }
 
 void SSTableIterator::first() {
+    PL_PERF_COUNTER_ADD(iter_seek_count, 1);
+    PL_PERF_TIMER_GUARD(iter_seek_nanos);
     index_iter_->first();
     initDataBlock();
     if (data_iter_ != nullptr) {
@@ -39,6 +44,8 @@ void SSTableIterator::first() {
 }
 
 void SSTableIterator::last() {
+    PL_PERF_COUNTER_ADD(iter_seek_count, 1);
+    PL_PERF_TIMER_GUARD(iter_seek_nanos);
     index_iter_->last();
     initDataBlock();
     if (data_iter_ != nullptr) {
@@ -49,12 +56,14 @@ void SSTableIterator::last() {
 
 void SSTableIterator::next() {
     assert(valid());
+    PL_PERF_COUNTER_ADD(iter_next_count, 1);
     data_iter_->next();
     forwardSkipEmptyData();
 }
 
 void SSTableIterator::prev() {
     assert(valid());
+    PL_PERF_COUNTER_ADD(iter_next_count, 1);
     data_iter_->prev();
     backwardSkipEmptyData();
 }
@@ -87,6 +96,7 @@ void SSTableIterator::initDataBlock() {
     if (data_iter_ != nullptr && handle.compare(data_block_handle_) == 0) {
         // do nothing
     } else {
+        PL_PERF_COUNTER_ADD(iter_block_load_count, 1);
         data_iter_ = data_block_func_(handle);
         data_block_handle_.assign(handle.data(), handle.size());
     }
@@ -20,6 +20,8 @@
 #include "cpp/pl/sst/iterator.h"
 
 #include <functional>
+#include <memory_resource>
+#include <string>
 
 namespace pl {
 
@@ -27,9 +29,13 @@ using BlockFunc = std::function<IteratorPtr(std::string_view)>;
 
 class SSTableIterator : public Iterator {
 public:
-    SSTableIterator(IteratorPtr index_iter, FilterBlockReaderRef filter, BlockFunc block_func)
+    SSTableIterator(IteratorPtr index_iter,
+                    FilterBlockReaderRef filter,
+                    BlockFunc block_func,
+                    std::pmr::memory_resource* resource = std::pmr::new_delete_resource())
         : index_iter_(std::move(index_iter)),
           filter_(std::move(filter)),
+          data_block_handle_(resource),
           data_block_func_(std::move(block_func)) {}
 
     ~SSTableIterator() override = default;
@@ -60,7 +66,7 @@ private:
     IteratorPtr index_iter_;
     IteratorPtr data_iter_;
     FilterBlockReaderRef filter_;
-    std::string data_block_handle_;
+    std::pmr::string data_block_handle_;
     BlockFunc data_block_func_;
 };
 
@@ -14,8 +14,10 @@
 
 // Authors: liubang (it.liubang@gmail.com)
 
+#include "cpp/pl/arena/arena_resource.h"
 #include "cpp/pl/log/logger.h"
 #include "cpp/pl/random/random.h"
+#include "cpp/pl/sst/perf_context.h"
 #include "cpp/pl/sst/sstable.h"
 #include "cpp/pl/sst/sstable_builder.h"
 
@@ -306,6 +308,112 @@ TEST_F(SSTableTest, query) {
     }
 }
 
+TEST_F(SSTableTest, query_with_memory_resource) {
+    auto sst_file = sst_files[2];
+    auto cells = cellses[2];
+
+    auto table = pl::SSTable::open(read_options, sst_file, &st);
+    EXPECT_TRUE(st.isOk());
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<> dis(0, ROW_NUM - 1);
+    for (int i = 0; i < 333; ++i) {
+        int idx = dis(gen) * 2 * COL_NUM;
+        auto citer = cells.begin();
+        std::advance(citer, idx);
+
+        // 每次查询使用独立的arena，查询结束后整体释放
+        Arena arena;
+        ArenaMemoryResource resource(&arena);
+        CellVec row(&resource);
+        auto get_st = table->get(citer->rowkey, &resource, &row);
+        EXPECT_TRUE(get_st.isOk());
+        EXPECT_EQ(16, row.size());
+
+        for (const auto& cell : row) {
+            EXPECT_EQ(citer->rowkey, cell.rowkey());
+            EXPECT_EQ(citer->cf, cell.cf());
+            EXPECT_EQ(citer->col, cell.col());
+            EXPECT_EQ(citer->ts, cell.timestamp());
+            EXPECT_EQ(citer->type, cell.cellType());
+            EXPECT_EQ(citer->val, cell.value());
+            ++citer;
+        }
+    }
+
+    // 迭代器以及data block同样从arena中分配
+    Arena arena;
+    ArenaMemoryResource resource(&arena);
+    auto citer = cells.begin();
+    auto iter = table->iterator(&resource);
+    iter->first();
+    while (iter->valid()) {
+        EXPECT_TRUE(citer != cells.end());
+        EXPECT_EQ(citer->rowkey, iter->cell()->rowkey());
+        EXPECT_EQ(citer->val, iter->cell()->value());
+        iter->next();
+        ++citer;
+    }
+    EXPECT_TRUE(citer == cells.end());
+    EXPECT_GT(arena.memory_usage(), 0);
+}
+
+TEST_F(SSTableTest, perf_context) {
+    auto sst_file = sst_files[2];
+    auto cells = cellses[2];
+
+    auto table = pl::SSTable::open(read_options, sst_file, &st);
+    EXPECT_TRUE(st.isOk());
+
+    setPerfLevel(PerfLevel::TIME);
+    perfContext()->reset();
+    Arena buf;
+    CellVecRef row;
+    EXPECT_TRUE(table->get(cells.begin()->rowkey, &buf, &row).isOk());
+    const PerfContext& ctx = *perfContext();
+    LOG(INFO) << ctx.toString();
+    EXPECT_EQ(1, ctx.get_count);
+    EXPECT_EQ(row.size(), ctx.cell_count);
+    EXPECT_EQ(1, ctx.filter_check_count);
+    EXPECT_EQ(0, ctx.filter_useful_count);
+    EXPECT_EQ(1, ctx.block_read_count);
+    EXPECT_EQ(1, ctx.block_decompress_count);
+    EXPECT_GT(ctx.block_read_bytes, 0);
+    EXPECT_GT(ctx.get_nanos, 0);
+    EXPECT_GE(ctx.get_nanos, ctx.index_seek_nanos + ctx.block_read_nanos +
+                                 ctx.block_checksum_nanos + ctx.block_decompress_nanos);
+
+    // 不存在的key大多数会被bloom filter过滤掉，不需要读取数据块
+    perfContext()->reset();
+    for (int i = 0; i < 100; ++i) {
+        CellVecRef empty;
+        EXPECT_TRUE(table->get(pl::random_string(ROWKEY_LEN * 3), &buf, &empty).isNotFound());
+    }
+    EXPECT_GT(ctx.filter_useful_count, 0);
+    EXPECT_EQ(ctx.filter_check_count - ctx.filter_useful_count, ctx.block_read_count);
+
+    // 关闭之后不再统计
+    setPerfLevel(PerfLevel::DISABLE);
+    perfContext()->reset();
+    EXPECT_TRUE(table->get(cells.begin()->rowkey, &buf, &row).isOk());
+    EXPECT_EQ(0, ctx.get_count);
+    EXPECT_EQ("", ctx.toString());
+
+    // 迭代器
+    setPerfLevel(PerfLevel::COUNT);
+    auto iter = table->iterator();
+    std::size_t n = 0;
+    for (iter->first(); iter->valid(); iter->next()) {
+        ++n;
+    }
+    EXPECT_EQ(1, ctx.iter_seek_count);
+    EXPECT_EQ(n, ctx.iter_next_count);
+    EXPECT_EQ(ctx.iter_block_load_count, ctx.block_read_count);
+    EXPECT_EQ(0, ctx.iter_seek_nanos);
+    setPerfLevel(PerfLevel::DISABLE);
+}
+
 TEST_F(SSTableTest, cleanup) {
     for (const auto& sst_file : sst_files) {
         std::remove(sst_file.c_str());
@@ -0,0 +1,154 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace pl {
+
+/**
+ * @class ChaseLevDeque
+ * @brief Chase-Lev work-stealing双端队列，实现参考
+ * "Correct and Efficient Work-Stealing for Weak Memory Models" (Lê et al. PPoPP'13)
+ *
+ * 只有owner线程可以调用push/pop，在bottom端后进先出；其他线程通过steal从top端先进先出地
+ * 窃取。T必须是可以原子读写的平凡类型，一般是指针。队列满时自动扩容，旧的数组在队列析构前
+ * 不会释放，因为并发的steal可能还在读。
+ */
+template <typename T> class ChaseLevDeque {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+    explicit ChaseLevDeque(std::size_t capacity = 1024) {
+        assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+        garbage_.emplace_back(std::make_unique<Array>(capacity));
+        array_.store(garbage_.back().get(), std::memory_order_relaxed);
+    }
+
+    ChaseLevDeque(const ChaseLevDeque&) = delete;
+    ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+    void push(T item) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        Array* a = array_.load(std::memory_order_relaxed);
+        if (b - t > static_cast<int64_t>(a->capacity()) - 1) {
+            a = grow(a, t, b);
+        }
+        a->put(b, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+
+    bool pop(T* item) {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Array* a = array_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        if (t > b) {
+            // 队列为空
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        *item = a->get(b);
+        if (t == b) {
+            // 只剩最后一个元素，需要和steal竞争
+            bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    bool steal(T* item) {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) {
+            return false;
+        }
+        Array* a = array_.load(std::memory_order_acquire);
+        T value = a->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return false;
+        }
+        *item = value;
+        return true;
+    }
+
+    // 并发场景下只是一个近似值
+    [[nodiscard]] std::size_t size() const {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        return b > t ? static_cast<std::size_t>(b - t) : 0;
+    }
+
+    [[nodiscard]] bool empty() const { return size() == 0; }
+
+    [[nodiscard]] std::size_t capacity() const {
+        return array_.load(std::memory_order_relaxed)->capacity();
+    }
+
+private:
+    class Array {
+    public:
+        explicit Array(std::size_t capacity)
+            : mask_(capacity - 1), items_(new std::atomic<T>[capacity]) {}
+
+        [[nodiscard]] std::size_t capacity() const { return mask_ + 1; }
+
+        void put(int64_t i, T item) {
+            items_[static_cast<std::size_t>(i) & mask_].store(item, std::memory_order_relaxed);
+        }
+
+        T get(int64_t i) const {
+            return items_[static_cast<std::size_t>(i) & mask_].load(std::memory_order_relaxed);
+        }
+
+    private:
+        const std::size_t mask_;
+        std::unique_ptr<std::atomic<T>[]> items_;
+    };
+
+    Array* grow(Array* a, int64_t t, int64_t b) {
+        auto bigger = std::make_unique<Array>(a->capacity() * 2);
+        for (int64_t i = t; i < b; ++i) {
+            bigger->put(i, a->get(i));
+        }
+        Array* result = bigger.get();
+        garbage_.emplace_back(std::move(bigger));
+        array_.store(result, std::memory_order_release);
+        return result;
+    }
+
+private:
+    alignas(64) std::atomic<int64_t> top_{0};
+    alignas(64) std::atomic<int64_t> bottom_{0};
+    alignas(64) std::atomic<Array*> array_{nullptr};
+    // 只有owner线程会修改
+    std::vector<std::unique_ptr<Array>> garbage_;
+};
+
+} // namespace pl
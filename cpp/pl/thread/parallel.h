@@ -0,0 +1,308 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include "cpp/pl/thread/task_group.h"
+#include "cpp/pl/thread/work_stealing_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * 基于WorkStealingPool的并行算法，接口与tbb中的同名算法类似。
+ *
+ * 区间按二分递归切分，右半部分作为子任务提交，左半部分在当前线程继续切分，直到区间大小不超过
+ * grain。grain为0时自动选择：保证每个worker大约能分到AUTO_CHUNKS_PER_WORKER个子区间，
+ * 这样既能让空闲的worker窃取到任务，又不至于产生过多的小任务。
+ */
+namespace pl {
+
+namespace parallel_detail {
+
+constexpr std::size_t AUTO_CHUNKS_PER_WORKER = 8;
+
+inline std::size_t grainSize(const WorkStealingPool& pool, std::size_t n, std::size_t grain) {
+    if (grain > 0) {
+        return grain;
+    }
+    return std::max<std::size_t>(1, n / (pool.size() * AUTO_CHUNKS_PER_WORKER));
+}
+
+template <typename Index, typename Fn>
+void forRange(TaskGroup& group, Index begin, Index end, std::size_t grain, const Fn& fn) {
+    while (static_cast<std::size_t>(end - begin) > grain) {
+        Index mid = begin + (end - begin) / 2;
+        group.run([&group, mid, end, grain, &fn]() {
+            forRange(group, mid, end, grain, fn);
+        });
+        end = mid;
+    }
+    fn(begin, end);
+}
+
+template <typename Index, typename T, typename MapFn, typename ReduceFn>
+T reduceRange(WorkStealingPool& pool,
+              Index begin,
+              Index end,
+              std::size_t grain,
+              const T& identity,
+              const MapFn& map,
+              const ReduceFn& reduce) {
+    if (static_cast<std::size_t>(end - begin) <= grain) {
+        return map(begin, end, identity);
+    }
+    Index mid = begin + (end - begin) / 2;
+    std::optional<T> right;
+    TaskGroup group(pool);
+    group.run([&]() {
+        right.emplace(reduceRange(pool, mid, end, grain, identity, map, reduce));
+    });
+    T left = reduceRange(pool, begin, mid, grain, identity, map, reduce);
+    group.wait();
+    return reduce(std::move(left), std::move(*right));
+}
+
+template <typename Iter, typename Compare>
+void sortRange(TaskGroup& group, Iter first, Iter last, std::size_t grain, Compare comp) {
+    while (static_cast<std::size_t>(last - first) > grain) {
+        // 三数取中，然后三路划分，避免大量重复元素时退化
+        Iter mid = first + (last - first) / 2;
+        Iter back = last - 1;
+        if (comp(*mid, *first)) {
+            std::iter_swap(mid, first);
+        }
+        if (comp(*back, *mid)) {
+            std::iter_swap(back, mid);
+            if (comp(*mid, *first)) {
+                std::iter_swap(mid, first);
+            }
+        }
+        auto pivot = *mid;
+        Iter lt = std::partition(first, last, [&](const auto& v) { return comp(v, pivot); });
+        Iter gt = std::partition(lt, last, [&](const auto& v) { return !comp(pivot, v); });
+        // 较小的一半交给其他线程，较大的一半在当前线程继续划分
+        if (lt - first < last - gt) {
+            group.run([&group, first, lt, grain, comp]() {
+                sortRange(group, first, lt, grain, comp);
+            });
+            first = gt;
+        } else {
+            group.run([&group, gt, last, grain, comp]() {
+                sortRange(group, gt, last, grain, comp);
+            });
+            last = lt;
+        }
+    }
+    std::sort(first, last, comp);
+}
+
+} // namespace parallel_detail
+
+/**
+ * @brief 对[begin, end)并行执行fn(sub_begin, sub_end)
+ */
+template <typename Index, typename Fn>
+void parallel_for(WorkStealingPool& pool, Index begin, Index end, Fn&& fn, std::size_t grain = 0) {
+    if (!(begin < end)) {
+        return;
+    }
+    grain = parallel_detail::grainSize(pool, static_cast<std::size_t>(end - begin), grain);
+    TaskGroup group(pool);
+    parallel_detail::forRange(group, begin, end, grain, fn);
+    group.wait();
+}
+
+/**
+ * @brief map(sub_begin, sub_end, identity)计算每个子区间的结果，再用reduce两两合并，
+ * reduce需要满足结合律
+ */
+template <typename Index, typename T, typename MapFn, typename ReduceFn>
+T parallel_reduce(WorkStealingPool& pool,
+                  Index begin,
+                  Index end,
+                  const T& identity,
+                  MapFn&& map,
+                  ReduceFn&& reduce,
+                  std::size_t grain = 0) {
+    if (!(begin < end)) {
+        return identity;
+    }
+    grain = parallel_detail::grainSize(pool, static_cast<std::size_t>(end - begin), grain);
+    return parallel_detail::reduceRange(pool, begin, end, grain, identity, map, reduce);
+}
+
+/**
+ * @brief 并行的inclusive scan，结果写入out，op需要满足结合律。
+ * 分两遍：第一遍并行计算每个分块的和，串行求出每个分块的前缀后，第二遍并行地在每个分块内做scan
+ */
+template <typename InputIt, typename OutputIt, typename T, typename BinaryOp>
+OutputIt parallel_scan(WorkStealingPool& pool,
+                       InputIt first,
+                       InputIt last,
+                       OutputIt out,
+                       const T& identity,
+                       BinaryOp op,
+                       std::size_t grain = 0) {
+    const auto n = static_cast<std::size_t>(last - first);
+    if (n == 0) {
+        return out;
+    }
+    grain = parallel_detail::grainSize(pool, n, grain);
+    const std::size_t chunks = (n + grain - 1) / grain;
+    std::vector<T> sums(chunks, identity);
+
+    parallel_for(
+        pool, std::size_t{0}, chunks,
+        [&](std::size_t b, std::size_t e) {
+            for (std::size_t c = b; c < e; ++c) {
+                InputIt it = first + c * grain;
+                InputIt end = first + std::min(n, (c + 1) * grain);
+                T sum = identity;
+                for (; it != end; ++it) {
+                    sum = op(sum, *it);
+                }
+                sums[c] = std::move(sum);
+            }
+        },
+        1);
+
+    // 每个分块之前所有元素的和
+    T carry = identity;
+    for (auto& sum : sums) {
+        T next = op(carry, sum);
+        sum = std::move(carry);
+        carry = std::move(next);
+    }
+
+    parallel_for(
+        pool, std::size_t{0}, chunks,
+        [&](std::size_t b, std::size_t e) {
+            for (std::size_t c = b; c < e; ++c) {
+                std::size_t i = c * grain;
+                std::size_t end = std::min(n, (c + 1) * grain);
+                T acc = sums[c];
+                for (; i < end; ++i) {
+                    acc = op(acc, first[i]);
+                    out[i] = acc;
+                }
+            }
+        },
+        1);
+    return out + n;
+}
+
+template <typename InputIt, typename OutputIt>
+OutputIt parallel_scan(WorkStealingPool& pool, InputIt first, InputIt last, OutputIt out) {
+    using T = typename std::iterator_traits<InputIt>::value_type;
+    return parallel_scan(pool, first, last, out, T{}, std::plus<>());
+}
+
+/**
+ * @brief 并行快速排序，不是稳定排序，子区间不超过grain时使用std::sort
+ */
+template <typename RandomIt, typename Compare>
+void parallel_sort(WorkStealingPool& pool,
+                   RandomIt first,
+                   RandomIt last,
+                   Compare comp,
+                   std::size_t grain = 0) {
+    const auto n = static_cast<std::size_t>(last - first);
+    if (n < 2) {
+        return;
+    }
+    // 排序的子任务粒度太小时，划分的开销会超过并行的收益
+    constexpr std::size_t MIN_SORT_GRAIN = 1024;
+    grain = std::max(parallel_detail::grainSize(pool, n, grain), MIN_SORT_GRAIN);
+    TaskGroup group(pool);
+    parallel_detail::sortRange(group, first, last, grain, comp);
+    group.wait();
+}
+
+template <typename RandomIt>
+void parallel_sort(WorkStealingPool& pool, RandomIt first, RandomIt last) {
+    parallel_sort(pool, first, last, std::less<>());
+}
+
+/**
+ * @brief 三段式的流水线：source在调用线程上串行产生输入，返回std::nullopt表示结束；
+ * transform在线程池中并行执行；sink在调用线程上按输入顺序串行消费结果。
+ * 同时处理中的元素不超过max_tokens个
+ */
+template <typename Source, typename Transform, typename Sink>
+void parallel_pipeline(WorkStealingPool& pool,
+                       std::size_t max_tokens,
+                       Source&& source,
+                       Transform&& transform,
+                       Sink&& sink) {
+    using Input = typename std::invoke_result_t<Source&>::value_type;
+    using Output = std::invoke_result_t<Transform&, Input&&>;
+
+    struct Slot {
+        std::optional<Output> value;
+        std::atomic<bool> ready{false};
+    };
+
+    max_tokens = std::max<std::size_t>(max_tokens, 1);
+    std::unique_ptr<Slot[]> slots(new Slot[max_tokens]);
+    TaskGroup group(pool);
+    std::size_t produced = 0;
+    std::size_t consumed = 0;
+    bool exhausted = false;
+
+    while (!exhausted || consumed < produced) {
+        while (!exhausted && produced - consumed < max_tokens) {
+            std::optional<Input> input = source();
+            if (!input) {
+                exhausted = true;
+                break;
+            }
+            Slot* slot = &slots[produced % max_tokens];
+            group.run([slot, &transform, input = std::move(*input)]() mutable {
+                // 即使transform抛出异常也要标记完成，异常在group.wait中重新抛出
+                struct MarkReady {
+                    Slot* slot;
+                    ~MarkReady() { slot->ready.store(true, std::memory_order_release); }
+                } mark{slot};
+                slot->value.emplace(transform(std::move(input)));
+            });
+            ++produced;
+        }
+
+        Slot* slot = &slots[consumed % max_tokens];
+        if (consumed < produced && slot->ready.load(std::memory_order_acquire)) {
+            if (slot->value) {
+                sink(std::move(*slot->value));
+                slot->value.reset();
+            }
+            slot->ready.store(false, std::memory_order_relaxed);
+            ++consumed;
+        } else if (!pool.runPendingTask()) {
+            std::this_thread::yield();
+        }
+    }
+    group.wait();
+}
+
+} // namespace pl
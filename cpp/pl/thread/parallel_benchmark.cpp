@@ -0,0 +1,216 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/thread/parallel.h"
+
+#include <nanobench.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_pipeline.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/parallel_scan.h>
+#include <tbb/parallel_sort.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <optional>
+#include <thread>
+#include <vector>
+
+constexpr std::size_t n = 1 << 22;
+
+static pl::WorkStealingPool& pool() {
+    static pl::WorkStealingPool pool(std::max(std::thread::hardware_concurrency(), 2U));
+    return pool;
+}
+
+static std::vector<float> randomData() {
+    std::vector<float> a(n);
+    for (auto& v : a) {
+        v = std::rand() * (1.f / (float)RAND_MAX);
+    }
+    return a;
+}
+
+// parallel for
+static void test1(std::vector<float>& a) {
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, n),
+                      [&](tbb::blocked_range<std::size_t> r) {
+                          for (std::size_t i = r.begin(); i < r.end(); ++i) {
+                              a[i] = std::sin(i);
+                          }
+                      });
+}
+
+static void test2(std::vector<float>& a) {
+    pl::parallel_for(pool(), std::size_t{0}, n, [&](std::size_t b, std::size_t e) {
+        for (std::size_t i = b; i < e; ++i) {
+            a[i] = std::sin(i);
+        }
+    });
+}
+
+// parallel reduce
+static float test3(const std::vector<float>& a) {
+    return tbb::parallel_reduce(
+        tbb::blocked_range<std::size_t>(0, n), 0.f,
+        [&](tbb::blocked_range<std::size_t> r, float local) {
+            for (std::size_t i = r.begin(); i < r.end(); ++i) {
+                local += a[i];
+            }
+            return local;
+        },
+        [](float x, float y) {
+            return x + y;
+        });
+}
+
+static float test4(const std::vector<float>& a) {
+    return pl::parallel_reduce(
+        pool(), std::size_t{0}, n, 0.f,
+        [&](std::size_t b, std::size_t e, float local) {
+            for (std::size_t i = b; i < e; ++i) {
+                local += a[i];
+            }
+            return local;
+        },
+        [](float x, float y) {
+            return x + y;
+        });
+}
+
+// parallel scan
+static void test5(const std::vector<float>& a, std::vector<float>& out) {
+    tbb::parallel_scan(
+        tbb::blocked_range<std::size_t>(0, n), 0.f,
+        [&](tbb::blocked_range<std::size_t> r, float local, auto is_final) {
+            for (std::size_t i = r.begin(); i < r.end(); ++i) {
+                local += a[i];
+                if (is_final) {
+                    out[i] = local;
+                }
+            }
+            return local;
+        },
+        [](float x, float y) {
+            return x + y;
+        });
+}
+
+static void test6(const std::vector<float>& a, std::vector<float>& out) {
+    pl::parallel_scan(pool(), a.begin(), a.end(), out.begin());
+}
+
+// parallel sort
+static void test7(std::vector<float> a) {
+    tbb::parallel_sort(a.begin(), a.end());
+}
+
+static void test8(std::vector<float> a) {
+    pl::parallel_sort(pool(), a.begin(), a.end());
+}
+
+// pipeline: 串行读入，并行计算，按顺序串行输出
+constexpr std::size_t chunk = 1 << 14;
+constexpr std::size_t tokens = 16;
+
+static float compute(std::size_t begin) {
+    float sum = 0;
+    for (std::size_t i = begin; i < begin + chunk; ++i) {
+        sum += std::sqrt(std::abs(std::sin(i)));
+    }
+    return sum;
+}
+
+static float test9() {
+    std::size_t next = 0;
+    float total = 0;
+    tbb::parallel_pipeline(
+        tokens,
+        tbb::make_filter<void, std::size_t>(tbb::filter_mode::serial_in_order,
+                                            [&](tbb::flow_control& fc) -> std::size_t {
+                                                if (next >= n) {
+                                                    fc.stop();
+                                                    return 0;
+                                                }
+                                                std::size_t begin = next;
+                                                next += chunk;
+                                                return begin;
+                                            }) &
+            tbb::make_filter<std::size_t, float>(tbb::filter_mode::parallel, &compute) &
+            tbb::make_filter<float, void>(tbb::filter_mode::serial_in_order, [&](float v) {
+                total += v;
+            }));
+    return total;
+}
+
+static float test10() {
+    std::size_t next = 0;
+    float total = 0;
+    pl::parallel_pipeline(
+        pool(), tokens,
+        [&]() -> std::optional<std::size_t> {
+            if (next >= n) {
+                return std::nullopt;
+            }
+            std::size_t begin = next;
+            next += chunk;
+            return begin;
+        },
+        compute,
+        [&](float v) {
+            total += v;
+        });
+    return total;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<float> a = randomData();
+    std::vector<float> out(n);
+
+    ankerl::nanobench::Bench().run("test1", [&] {
+        test1(out);
+    });
+    ankerl::nanobench::Bench().run("test2", [&] {
+        test2(out);
+    });
+    ankerl::nanobench::Bench().run("test3", [&] {
+        ankerl::nanobench::doNotOptimizeAway(test3(a));
+    });
+    ankerl::nanobench::Bench().run("test4", [&] {
+        ankerl::nanobench::doNotOptimizeAway(test4(a));
+    });
+    ankerl::nanobench::Bench().run("test5", [&] {
+        test5(a, out);
+    });
+    ankerl::nanobench::Bench().run("test6", [&] {
+        test6(a, out);
+    });
+    ankerl::nanobench::Bench().run("test7", [&] {
+        test7(a);
+    });
+    ankerl::nanobench::Bench().run("test8", [&] {
+        test8(a);
+    });
+    ankerl::nanobench::Bench().run("test9", [&] {
+        ankerl::nanobench::doNotOptimizeAway(test9());
+    });
+    ankerl::nanobench::Bench().run("test10", [&] {
+        ankerl::nanobench::doNotOptimizeAway(test10());
+    });
+    return 0;
+}
@@ -0,0 +1,182 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/thread/parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+class ParallelTest : public ::testing::Test {
+protected:
+    pl::WorkStealingPool pool_{4};
+};
+
+TEST_F(ParallelTest, parallel_for) {
+    std::vector<int> data(100000, 0);
+    pl::parallel_for(pool_, std::size_t{0}, data.size(), [&](std::size_t b, std::size_t e) {
+        for (std::size_t i = b; i < e; ++i) {
+            data[i] += static_cast<int>(i);
+        }
+    });
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        ASSERT_EQ(data[i], static_cast<int>(i));
+    }
+
+    // 指定grain，每个子区间都不超过grain
+    std::atomic<std::size_t> max_chunk{0};
+    pl::parallel_for(
+        pool_, 0, 1000,
+        [&](int b, int e) {
+            std::size_t size = e - b;
+            std::size_t cur = max_chunk.load();
+            while (size > cur && !max_chunk.compare_exchange_weak(cur, size)) {
+            }
+        },
+        10);
+    EXPECT_LE(max_chunk.load(), 10);
+
+    // 空区间
+    pl::parallel_for(pool_, 5, 5, [](int, int) { FAIL(); });
+}
+
+TEST_F(ParallelTest, parallel_reduce) {
+    std::vector<uint64_t> data(100000);
+    std::iota(data.begin(), data.end(), 1);
+    uint64_t sum = pl::parallel_reduce(
+        pool_, std::size_t{0}, data.size(), uint64_t{0},
+        [&](std::size_t b, std::size_t e, uint64_t init) {
+            return std::accumulate(data.begin() + b, data.begin() + e, init);
+        },
+        std::plus<>());
+    EXPECT_EQ(sum, data.size() * (data.size() + 1) / 2);
+
+    // reduce不要求满足交换律，结果需要保持顺序
+    std::string str = pl::parallel_reduce(
+        pool_, 0, 26, std::string(),
+        [](int b, int e, std::string init) {
+            for (int i = b; i < e; ++i) {
+                init.push_back(static_cast<char>('a' + i));
+            }
+            return init;
+        },
+        [](std::string a, const std::string& b) { return a + b; }, 1);
+    EXPECT_EQ(str, "abcdefghijklmnopqrstuvwxyz");
+}
+
+TEST_F(ParallelTest, parallel_scan) {
+    std::vector<int64_t> data(12345);
+    std::iota(data.begin(), data.end(), -100);
+    std::vector<int64_t> expected(data.size());
+    std::inclusive_scan(data.begin(), data.end(), expected.begin());
+
+    std::vector<int64_t> out(data.size());
+    auto end = pl::parallel_scan(pool_, data.begin(), data.end(), out.begin());
+    EXPECT_EQ(end, out.end());
+    EXPECT_EQ(out, expected);
+
+    std::fill(out.begin(), out.end(), 0);
+    pl::parallel_scan(pool_, data.begin(), data.end(), out.begin(), int64_t{0}, std::plus<>(), 7);
+    EXPECT_EQ(out, expected);
+}
+
+TEST_F(ParallelTest, parallel_sort) {
+    std::mt19937 rng(42);
+    std::vector<int> data(200000);
+    for (auto& v : data) {
+        v = static_cast<int>(rng() % 1000);
+    }
+    std::vector<int> expected = data;
+    std::sort(expected.begin(), expected.end());
+    pl::parallel_sort(pool_, data.begin(), data.end());
+    EXPECT_EQ(data, expected);
+
+    pl::parallel_sort(pool_, data.begin(), data.end(), std::greater<>());
+    EXPECT_TRUE(std::is_sorted(data.begin(), data.end(), std::greater<>()));
+
+    // 全部相等
+    std::vector<int> same(50000, 7);
+    pl::parallel_sort(pool_, same.begin(), same.end());
+    EXPECT_TRUE(std::all_of(same.begin(), same.end(), [](int v) { return v == 7; }));
+}
+
+TEST_F(ParallelTest, parallel_pipeline) {
+    int next = 0;
+    std::vector<std::string> results;
+    pl::parallel_pipeline(
+        pool_, 8,
+        [&]() -> std::optional<int> {
+            if (next == 1000) {
+                return std::nullopt;
+            }
+            return next++;
+        },
+        [](int v) { return std::to_string(v * 2); },
+        [&](std::string s) { results.push_back(std::move(s)); });
+    ASSERT_EQ(results.size(), 1000);
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(results[i], std::to_string(i * 2));
+    }
+}
+
+TEST_F(ParallelTest, nested_and_exception) {
+    // 在worker内部嵌套使用并行算法
+    std::atomic<int> count{0};
+    pl::parallel_for(
+        pool_, 0, 8,
+        [&](int b, int e) {
+            for (int i = b; i < e; ++i) {
+                pl::parallel_for(pool_, 0, 100, [&](int bb, int ee) { count += ee - bb; });
+            }
+        },
+        1);
+    EXPECT_EQ(count.load(), 800);
+
+    EXPECT_THROW(pl::parallel_for(
+                     pool_, 0, 100,
+                     [](int b, int) {
+                         if (b == 0) {
+                             throw std::runtime_error("oops");
+                         }
+                     },
+                     1),
+                 std::runtime_error);
+}
+
+TEST_F(ParallelTest, task_group_run_throws) {
+    // 拷贝时抛异常的任务不会被提交，wait不能一直等待它
+    struct ThrowOnCopy {
+        ThrowOnCopy() = default;
+        ThrowOnCopy(const ThrowOnCopy&) { throw std::runtime_error("copy"); }
+        void operator()() const {}
+    };
+
+    std::atomic<int> count{0};
+    pl::TaskGroup group(pool_);
+    group.run([&] { ++count; });
+    ThrowOnCopy task;
+    EXPECT_THROW(group.run(task), std::runtime_error);
+    group.run([&] { ++count; });
+    group.wait();
+    EXPECT_EQ(count.load(), 2);
+}
@@ -0,0 +1,123 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace pl {
+
+/**
+ * @class Task
+ * @brief 只能移动的void()可调用对象，与std::function不同，不要求可拷贝，
+ * 并且不超过INLINE_SIZE的闭包直接存放在对象内部，不需要额外的堆内存分配
+ */
+class Task {
+public:
+    static constexpr std::size_t INLINE_SIZE = 48;
+
+    Task() = default;
+
+    template <typename F,
+              typename Fn = std::decay_t<F>,
+              typename = std::enable_if_t<!std::is_same_v<Fn, Task>>>
+    Task(F&& f) { // NOLINT
+        static_assert(std::is_invocable_v<Fn&>);
+        if constexpr (fitsInline<Fn>()) {
+            new (storage_) Fn(std::forward<F>(f));
+            vtable_ = &INLINE_VTABLE<Fn>;
+        } else {
+            *reinterpret_cast<Fn**>(storage_) = new Fn(std::forward<F>(f));
+            vtable_ = &HEAP_VTABLE<Fn>;
+        }
+    }
+
+    Task(Task&& other) noexcept : vtable_(other.vtable_) {
+        if (vtable_ != nullptr) {
+            vtable_->move(other.storage_, storage_);
+            other.vtable_ = nullptr;
+        }
+    }
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            vtable_ = other.vtable_;
+            if (vtable_ != nullptr) {
+                vtable_->move(other.storage_, storage_);
+                other.vtable_ = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() { reset(); }
+
+    void operator()() { vtable_->invoke(storage_); }
+
+    explicit operator bool() const { return vtable_ != nullptr; }
+
+    void reset() {
+        if (vtable_ != nullptr) {
+            vtable_->destroy(storage_);
+            vtable_ = nullptr;
+        }
+    }
+
+    // 闭包是否可以直接存放在Task内部
+    template <typename Fn> static constexpr bool fitsInline() {
+        return sizeof(Fn) <= INLINE_SIZE && alignof(Fn) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible_v<Fn>;
+    }
+
+private:
+    struct VTable {
+        void (*invoke)(void* storage);
+        void (*move)(void* from, void* to) noexcept;
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template <typename Fn>
+    static constexpr VTable INLINE_VTABLE = {
+        [](void* storage) { (*static_cast<Fn*>(storage))(); },
+        [](void* from, void* to) noexcept {
+            new (to) Fn(std::move(*static_cast<Fn*>(from)));
+            static_cast<Fn*>(from)->~Fn();
+        },
+        [](void* storage) noexcept { static_cast<Fn*>(storage)->~Fn(); },
+    };
+
+    template <typename Fn>
+    static constexpr VTable HEAP_VTABLE = {
+        [](void* storage) { (**static_cast<Fn**>(storage))(); },
+        [](void* from, void* to) noexcept {
+            *static_cast<Fn**>(to) = *static_cast<Fn**>(from);
+        },
+        [](void* storage) noexcept { delete *static_cast<Fn**>(storage); },
+    };
+
+private:
+    alignas(std::max_align_t) unsigned char storage_[INLINE_SIZE];
+    const VTable* vtable_{nullptr};
+};
+
+} // namespace pl
@@ -0,0 +1,101 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include "cpp/pl/thread/work_stealing_pool.h"
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace pl {
+
+/**
+ * @class TaskGroup
+ * @brief fork-join任务组，wait的时候当前线程会帮忙执行线程池中的任务，所以可以在worker内部
+ * 嵌套使用而不会死锁。任务抛出的第一个异常会在wait中重新抛出
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(WorkStealingPool& pool) : pool_(pool) {}
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    ~TaskGroup() { waitIdle(); }
+
+    template <typename F> void run(F&& f) {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        // 拷贝闭包或者向已经停止的线程池提交都可能抛异常，此时任务不会执行，要撤销计数，
+        // 否则wait会一直等下去
+        try {
+            pool_.execute([this, f = std::forward<F>(f)]() mutable {
+                invoke(std::move(f));
+                pending_.fetch_sub(1, std::memory_order_release);
+            });
+        } catch (...) {
+            pending_.fetch_sub(1, std::memory_order_release);
+            throw;
+        }
+    }
+
+    void wait() {
+        waitIdle();
+        std::exception_ptr exception;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::swap(exception, exception_);
+        }
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    [[nodiscard]] WorkStealingPool& pool() const { return pool_; }
+
+private:
+    // 闭包在计数减一之前析构，wait返回之后不会再访问闭包捕获的对象
+    template <typename F> void invoke(F f) {
+        try {
+            f();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!exception_) {
+                exception_ = std::current_exception();
+            }
+        }
+    }
+
+    void waitIdle() {
+        while (pending_.load(std::memory_order_acquire) != 0) {
+            if (!pool_.runPendingTask()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    WorkStealingPool& pool_;
+    std::atomic<std::size_t> pending_{0};
+    std::mutex mutex_;
+    std::exception_ptr exception_;
+};
+
+} // namespace pl
@@ -16,7 +16,12 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <future>
 #include <mutex>
@@ -26,14 +31,73 @@
 #include <vector>
 
 #include "cpp/pl/log/logger.h"
+#include "cpp/pl/metrics/metrics.h"
 
 namespace pl {
 
+/**
+ * 任务优先级，worker总是优先执行高优先级队列中的任务
+ */
+enum class Priority : uint8_t {
+    HIGH = 0,
+    NORMAL = 1,
+    LOW = 2,
+};
+
+struct TaskOptions {
+    using Clock = std::chrono::steady_clock;
+
+    Priority priority{Priority::NORMAL};
+    // 任务出队时如果已经超过deadline，直接丢弃，对应的future会抛出broken_promise
+    Clock::time_point deadline{Clock::time_point::max()};
+
+    TaskOptions() = default;
+    TaskOptions(Priority priority) : priority(priority) {} // NOLINT
+    TaskOptions(Priority priority, Clock::time_point deadline)
+        : priority(priority), deadline(deadline) {}
+    TaskOptions(Priority priority, Clock::duration timeout)
+        : priority(priority), deadline(Clock::now() + timeout) {}
+};
+
+/**
+ * 每个优先级队列的统计信息
+ */
+struct LaneStats {
+    uint64_t submitted{0};      // 提交的任务数
+    uint64_t executed{0};       // 已经开始执行的任务数
+    uint64_t expired{0};        // 超过deadline被丢弃的任务数
+    std::size_t queue_depth{0}; // 当前排队的任务数
+    std::size_t running{0};     // 当前正在执行的任务数
+    std::chrono::nanoseconds total_wait{0}; // 出队任务的排队时间之和
+    std::chrono::nanoseconds max_wait{0};   // 出队任务的最大排队时间
+
+    [[nodiscard]] std::chrono::nanoseconds avgWait() const {
+        uint64_t n = executed + expired;
+        return n == 0 ? std::chrono::nanoseconds(0) : total_wait / static_cast<int64_t>(n);
+    }
+};
+
+/**
+ * @class ThreadPool
+ * @brief 多优先级线程池。每个优先级一个FIFO队列，可以限制每个优先级同时执行的任务数，
+ * 例如把compaction放到LOW并限制并发，避免后台任务占满所有线程影响前台请求的延迟
+ */
 class ThreadPool {
+    using Clock = TaskOptions::Clock;
     using Task = std::function<void()>;
 
 public:
+    static constexpr std::size_t NUM_LANES = 3;
+
     ThreadPool(size_t threads) {
+        static constexpr const char* LANE_LABELS[NUM_LANES] = {
+            "lane=\"high\"", "lane=\"normal\"", "lane=\"low\""};
+        auto& registry = metrics::Registry::instance();
+        for (std::size_t i = 0; i < NUM_LANES; ++i) {
+            lanes_[i].queue_wait = &registry.histogram("thread_pool_queue_wait_ns", LANE_LABELS[i]);
+            lanes_[i].run_time = &registry.histogram("thread_pool_run_ns", LANE_LABELS[i]);
+            lanes_[i].expired = &registry.counter("thread_pool_expired_total", LANE_LABELS[i]);
+        }
         for (size_t i = 0; i < threads; ++i) {
             workers_.emplace_back(&ThreadPool::execute, this);
         }
@@ -50,49 +114,151 @@ public:
         }
     }
 
+    /**
+     * @brief 限制某个优先级同时执行的任务数，0表示不限制
+     */
+    void setConcurrencyLimit(Priority priority, std::size_t limit) {
+        {
+            std::unique_lock<std::mutex> lk(queue_mutex_);
+            lane(priority).limit = limit;
+        }
+        condition_.notify_all();
+    }
+
     template <class F, class... Args>
     auto submit(F&& f, Args&&... args) -> std::future<std::invoke_result_t<F&&, Args&&...>> {
+        return submit(TaskOptions(), std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    template <class F, class... Args>
+    auto submit(const TaskOptions& options, F&& f, Args&&... args)
+        -> std::future<std::invoke_result_t<F&&, Args&&...>> {
         using R = std::invoke_result_t<F&&, Args&&...>;
-        auto task = std::make_shared<std::packaged_task<R(Args && ...)>>(
+        auto task = std::make_shared<std::packaged_task<R()>>(
             std::bind(std::forward<F>(f), std::forward<Args>(args)...));
         auto future = task->get_future();
         {
             std::unique_lock<std::mutex> lk(queue_mutex_);
             if (stop_) {
-                throw std::runtime_error("");
+                throw std::runtime_error("submit on stopped ThreadPool");
             }
-            tasks_.emplace([task = std::move(task)]() {
-                (*task)();
-            });
+            Lane& l = lane(options.priority);
+            l.tasks.push({[task = std::move(task)]() {
+                              (*task)();
+                          },
+                          Clock::now(), options.deadline});
+            ++l.stats.submitted;
         }
         condition_.notify_one();
         return future;
     }
 
+    [[nodiscard]] LaneStats stats(Priority priority) const {
+        std::unique_lock<std::mutex> lk(queue_mutex_);
+        const Lane& l = lanes_[static_cast<std::size_t>(priority)];
+        LaneStats stats = l.stats;
+        stats.queue_depth = l.tasks.size();
+        stats.running = l.running;
+        return stats;
+    }
+
+    [[nodiscard]] std::size_t size() const { return workers_.size(); }
+
 private:
+    struct Entry {
+        Task task;
+        Clock::time_point enqueue_time;
+        Clock::time_point deadline;
+    };
+
+    struct Lane {
+        std::queue<Entry> tasks;
+        std::size_t limit{0};
+        std::size_t running{0};
+        LaneStats stats;
+        // 注册表中的指标，所有线程池共享，进程内一直有效
+        metrics::Histogram* queue_wait{nullptr};
+        metrics::Histogram* run_time{nullptr};
+        metrics::Counter* expired{nullptr};
+
+        [[nodiscard]] bool runnable() const {
+            return !tasks.empty() && (limit == 0 || running < limit);
+        }
+    };
+
+    Lane& lane(Priority priority) { return lanes_[static_cast<std::size_t>(priority)]; }
+
+    // 返回优先级最高的可以执行的队列，没有时返回nullptr
+    Lane* pickLane() {
+        for (auto& l : lanes_) {
+            if (l.runnable()) {
+                return &l;
+            }
+        }
+        return nullptr;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return std::all_of(lanes_.begin(), lanes_.end(), [](const Lane& l) {
+            return l.tasks.empty();
+        });
+    }
+
     void execute() {
         for (;;) {
             Task task;
+            Lane* l = nullptr;
+            std::chrono::nanoseconds wait{0};
             {
                 std::unique_lock<std::mutex> lk(queue_mutex_);
-                condition_.wait(lk, [that = this] {
-                    return that->stop_ || !that->tasks_.empty();
+                condition_.wait(lk, [that = this, &l] {
+                    l = that->pickLane();
+                    return l != nullptr || (that->stop_ && that->empty());
                 });
-                if (stop_ && tasks_.empty()) {
+                if (l == nullptr) {
                     LOG_DEBUG << "thread stopped";
                     break;
                 }
-                task = std::move(tasks_.front());
-                tasks_.pop();
+                Entry entry = std::move(l->tasks.front());
+                l->tasks.pop();
+                auto now = Clock::now();
+                wait = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    now - entry.enqueue_time);
+                l->stats.total_wait += wait;
+                l->stats.max_wait = std::max(l->stats.max_wait, wait);
+                if (now > entry.deadline) {
+                    // 在锁外析构，packaged_task析构时会唤醒等待future的线程
+                    ++l->stats.expired;
+                    lk.unlock();
+                    l->expired->inc();
+                    continue;
+                }
+                ++l->stats.executed;
+                ++l->running;
+                task = std::move(entry.task);
+            }
+            l->queue_wait->record(static_cast<uint64_t>(wait.count()));
+            {
+                metrics::ScopedTimer timer(*l->run_time);
+                task();
+            }
+            bool limited = false;
+            {
+                std::unique_lock<std::mutex> lk(queue_mutex_);
+                --l->running;
+                limited = l->limit != 0;
+            }
+            // 并发数受限的队列可能因为这个任务结束而重新变得可以执行
+            if (limited) {
+                condition_.notify_one();
             }
-            task();
         }
     }
 
 private:
     std::vector<std::thread> workers_;
-    std::queue<Task> tasks_;
-    std::mutex queue_mutex_;
+    std::array<Lane, NUM_LANES> lanes_;
+    mutable std::mutex queue_mutex_;
     std::condition_variable condition_;
     bool stop_{false};
 };
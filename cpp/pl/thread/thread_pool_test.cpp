@@ -16,9 +16,11 @@
 
 #include "cpp/pl/thread/thread_pool.h"
 
+#include <atomic>
 #include <chrono>
 #include <future>
 #include <iostream>
+#include <mutex>
 #include <utility>
 #include <vector>
 
@@ -47,3 +49,75 @@ TEST(thread_pool, thread_pool) {
 
     std::cout << "Elapsed time: " << duration.count() << "(ms)" << std::endl;
 }
+
+TEST(thread_pool, priority) {
+    pl::ThreadPool pool(1);
+    std::promise<void> gate;
+    auto blocker = pool.submit([f = gate.get_future().share()] { f.wait(); });
+
+    std::mutex mutex;
+    std::vector<int> order;
+    auto record = [&](int v) {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(v);
+    };
+    std::vector<std::future<void>> results;
+    results.emplace_back(pool.submit(pl::Priority::LOW, record, 3));
+    results.emplace_back(pool.submit(pl::Priority::NORMAL, record, 2));
+    results.emplace_back(pool.submit(pl::Priority::HIGH, record, 1));
+    results.emplace_back(pool.submit(pl::Priority::HIGH, record, 1));
+    EXPECT_EQ(pool.stats(pl::Priority::HIGH).queue_depth, 2);
+
+    gate.set_value();
+    blocker.get();
+    for (auto& result : results) {
+        result.get();
+    }
+    EXPECT_EQ(order, (std::vector<int>{1, 1, 2, 3}));
+    EXPECT_EQ(pool.stats(pl::Priority::HIGH).executed, 2);
+    EXPECT_EQ(pool.stats(pl::Priority::LOW).submitted, 1);
+}
+
+TEST(thread_pool, concurrency_limit) {
+    pl::ThreadPool pool(4);
+    pool.setConcurrencyLimit(pl::Priority::LOW, 1);
+    std::atomic<int> running{0};
+    std::atomic<int> max_running{0};
+    std::vector<std::future<void>> results;
+    for (int i = 0; i < 8; ++i) {
+        results.emplace_back(pool.submit(pl::Priority::LOW, [&] {
+            int cur = ++running;
+            int prev = max_running.load();
+            while (cur > prev && !max_running.compare_exchange_weak(prev, cur)) {
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            --running;
+        }));
+    }
+    // 受限的队列不影响其他优先级的任务
+    EXPECT_EQ(pool.submit(pl::Priority::HIGH, [] { return 42; }).get(), 42);
+    for (auto& result : results) {
+        result.get();
+    }
+    EXPECT_EQ(max_running.load(), 1);
+}
+
+TEST(thread_pool, deadline) {
+    pl::ThreadPool pool(1);
+    std::promise<void> gate;
+    auto blocker = pool.submit([f = gate.get_future().share()] { f.wait(); });
+
+    auto expired = pool.submit(pl::TaskOptions(pl::Priority::NORMAL, std::chrono::milliseconds(1)),
+                               [] { return 1; });
+    auto alive = pool.submit(pl::TaskOptions(pl::Priority::NORMAL, std::chrono::hours(1)),
+                             [] { return 2; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    gate.set_value();
+
+    EXPECT_THROW(expired.get(), std::future_error);
+    EXPECT_EQ(alive.get(), 2);
+    auto stats = pool.stats(pl::Priority::NORMAL);
+    EXPECT_EQ(stats.expired, 1);
+    EXPECT_EQ(stats.executed, 2);
+    EXPECT_GE(stats.max_wait, std::chrono::milliseconds(10));
+}
@@ -0,0 +1,213 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/thread/work_stealing_pool.h"
+#include "cpp/pl/log/logger.h"
+
+#include <exception>
+#include <functional>
+
+namespace pl {
+
+namespace {
+
+// 当前线程所属的线程池以及worker下标
+thread_local WorkStealingPool* current_pool = nullptr;
+thread_local int current_index = -1;
+
+// 空闲时在睡眠之前自旋查找任务的轮数
+constexpr int SPIN_ROUNDS = 64;
+
+uint32_t nextRandom() {
+    thread_local uint32_t state = static_cast<uint32_t>(
+        std::hash<std::thread::id>()(std::this_thread::get_id()) | 1);
+    // xorshift32
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(std::size_t threads, std::size_t inject_capacity)
+    : inject_(inject_capacity) {
+    if (threads == 0) {
+        threads = 1;
+    }
+    workers_.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back(std::make_unique<Worker>());
+    }
+    // 所有worker的队列创建好之后再启动线程，避免窃取的时候访问到还未创建的队列
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers_[i]->thread = std::thread(&WorkStealingPool::run, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    stop_.store(true, std::memory_order_seq_cst);
+    // 检查stop_之前已经开始的提交，要等任务放入注入队列之后才能确定没有遗漏
+    while (submitters_.load(std::memory_order_seq_cst) > 0) {
+        std::this_thread::yield();
+    }
+    epoch_.fetch_add(1, std::memory_order_seq_cst);
+    epoch_.notify_all();
+    for (auto& worker : workers_) {
+        worker->thread.join();
+    }
+    // worker退出之后才放入队列的任务在当前线程执行，保证future都能就绪、闭包都被释放
+    Task* task = nullptr;
+    for (;;) {
+        if (inject_.tryPop(&task)) {
+            runTask(task);
+            continue;
+        }
+        bool found = false;
+        for (auto& worker : workers_) {
+            if (worker->deque.steal(&task)) {
+                runTask(task);
+                found = true;
+            }
+        }
+        if (!found) {
+            break;
+        }
+    }
+}
+
+int WorkStealingPool::currentWorkerIndex() const {
+    return current_pool == this ? current_index : -1;
+}
+
+std::size_t WorkStealingPool::pendingTasks() const {
+    std::size_t n = inject_.size();
+    for (const auto& worker : workers_) {
+        n += worker->deque.size();
+    }
+    return n;
+}
+
+void WorkStealingPool::post(Task* task) {
+    int index = currentWorkerIndex();
+    if (index >= 0) {
+        workers_[index]->deque.push(task);
+        notify();
+        return;
+    }
+    submitters_.fetch_add(1, std::memory_order_seq_cst);
+    if (stop_.load(std::memory_order_seq_cst)) {
+        submitters_.fetch_sub(1, std::memory_order_seq_cst);
+        ObjectPool<Task>::instance().destroy(task);
+        throw std::runtime_error("submit on stopped WorkStealingPool");
+    }
+    // 注入队列满的时候让出cpu，等待worker消费
+    while (!inject_.tryPush(std::move(task))) {
+        std::this_thread::yield();
+    }
+    notify();
+    // 最后才减少计数，之后析构函数可能随时返回
+    submitters_.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+void WorkStealingPool::notify() {
+    epoch_.fetch_add(1, std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_seq_cst) > 0) {
+        epoch_.notify_one();
+    }
+}
+
+bool WorkStealingPool::runPendingTask() {
+    Task* task = findTask(currentWorkerIndex());
+    if (task == nullptr) {
+        return false;
+    }
+    runTask(task);
+    return true;
+}
+
+Task* WorkStealingPool::findTask(int index) {
+    Task* task = nullptr;
+    if (index >= 0 && workers_[index]->deque.pop(&task)) {
+        return task;
+    }
+    if (inject_.tryPop(&task)) {
+        return task;
+    }
+    const std::size_t n = workers_.size();
+    const std::size_t start = nextRandom() % n;
+    for (std::size_t i = 0; i < n; ++i) {
+        std::size_t victim = (start + i) % n;
+        if (static_cast<int>(victim) != index && workers_[victim]->deque.steal(&task)) {
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+void WorkStealingPool::runTask(Task* task) {
+    try {
+        (*task)();
+    } catch (const std::exception& e) {
+        LOG_ERROR << "uncaught exception in task: " << e.what();
+    } catch (...) {
+        LOG_ERROR << "uncaught unknown exception in task";
+    }
+    ObjectPool<Task>::instance().destroy(task);
+}
+
+void WorkStealingPool::run(std::size_t index) {
+    current_pool = this;
+    current_index = static_cast<int>(index);
+
+    int idle_rounds = 0;
+    for (;;) {
+        Task* task = findTask(current_index);
+        if (task != nullptr) {
+            runTask(task);
+            idle_rounds = 0;
+            continue;
+        }
+        if (++idle_rounds < SPIN_ROUNDS) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // 先读epoch再做最后一次检查，检查之后提交的任务一定会改变epoch
+        uint32_t epoch = epoch_.load(std::memory_order_seq_cst);
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+        task = findTask(current_index);
+        if (task != nullptr) {
+            sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+            runTask(task);
+            idle_rounds = 0;
+            continue;
+        }
+        if (stop_.load(std::memory_order_seq_cst)) {
+            sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+            break;
+        }
+        epoch_.wait(epoch, std::memory_order_seq_cst);
+        sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+        idle_rounds = 0;
+    }
+
+    LOG_DEBUG << "work stealing thread " << index << " stopped";
+    current_pool = nullptr;
+    current_index = -1;
+}
+
+} // namespace pl
@@ -0,0 +1,113 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include "cpp/pl/arena/object_pool.h"
+#include "cpp/pl/thread/chase_lev_deque.h"
+#include "cpp/pl/thread/mpmc_queue.h"
+#include "cpp/pl/thread/task.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace pl {
+
+/**
+ * @class WorkStealingPool
+ * @brief work-stealing线程池
+ *
+ * 每个worker有一个Chase-Lev双端队列，worker内部提交的任务放到自己的队列里，后进先出地执行；
+ * 外部线程提交的任务放到一个有界的无锁注入队列里。worker本地队列为空时，先取注入队列，再随机
+ * 地从其他worker的队列头部窃取。任务对象从ObjectPool中分配，较小的闭包直接存放在任务对象内部。
+ */
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(std::size_t threads, std::size_t inject_capacity = 1 << 16);
+
+    // 等待已经提交的任务全部执行完再退出，之后外部线程的提交会抛出std::runtime_error
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * @brief 提交一个不需要返回值的任务，任务中抛出的异常会被记录日志后忽略
+     */
+    template <typename F> void execute(F&& f) {
+        post(ObjectPool<Task>::instance().create(std::forward<F>(f)));
+    }
+
+    template <class F, class... Args>
+    auto submit(F&& f, Args&&... args) -> std::future<std::invoke_result_t<F&&, Args&&...>> {
+        using R = std::invoke_result_t<F&&, Args&&...>;
+        auto fn = [f = std::forward<F>(f),
+                   args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+            return std::apply(std::move(f), std::move(args));
+        };
+        std::packaged_task<R()> task(std::move(fn));
+        auto future = task.get_future();
+        execute([task = std::move(task)]() mutable { task(); });
+        return future;
+    }
+
+    /**
+     * @brief 在当前线程执行一个待处理的任务，返回是否执行了任务。
+     * 用于在worker内部等待其他任务完成时帮忙干活，避免所有worker都阻塞在等待上
+     */
+    bool runPendingTask();
+
+    [[nodiscard]] std::size_t size() const { return workers_.size(); }
+
+    // 当前线程如果是本线程池的worker，返回其下标，否则返回-1
+    [[nodiscard]] int currentWorkerIndex() const;
+
+    // 近似值
+    [[nodiscard]] std::size_t pendingTasks() const;
+
+private:
+    struct alignas(64) Worker {
+        ChaseLevDeque<Task*> deque;
+        std::thread thread;
+    };
+
+    void post(Task* task);
+    void run(std::size_t index);
+    Task* findTask(int index);
+    void runTask(Task* task);
+    void notify();
+
+private:
+    std::vector<std::unique_ptr<Worker>> workers_;
+    MpmcQueue<Task*> inject_;
+    std::atomic<bool> stop_{false};
+    // 正在向注入队列提交任务的外部线程数，析构时等待它们完成，保证提交成功的任务都会被执行
+    std::atomic<int> submitters_{0};
+    // eventcount: 空闲的worker等待epoch变化，提交任务的时候递增epoch
+    alignas(64) std::atomic<uint32_t> epoch_{0};
+    alignas(64) std::atomic<int> sleepers_{0};
+};
+
+} // namespace pl
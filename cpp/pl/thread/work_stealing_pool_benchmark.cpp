@@ -0,0 +1,161 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/thread/thread_pool.h"
+#include "cpp/pl/thread/work_stealing_pool.h"
+
+#include <nanobench.h>
+#include <tbb/task_arena.h>
+#include <tbb/task_group.h>
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <latch>
+#include <thread>
+#include <vector>
+
+constexpr std::size_t n = 10000;
+constexpr std::size_t fanout = 100;
+
+static std::size_t threads() {
+    return std::max<std::size_t>(std::thread::hardware_concurrency(), 2);
+}
+
+// 外部线程提交大量小任务
+static void test1(pl::ThreadPool& pool) {
+    std::atomic<std::size_t> sum{0};
+    std::vector<std::future<void>> futures;
+    futures.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        futures.emplace_back(pool.submit([&sum, i]() {
+            sum.fetch_add(i, std::memory_order_relaxed);
+        }));
+    }
+    for (auto& f : futures) {
+        f.get();
+    }
+    ankerl::nanobench::doNotOptimizeAway(sum);
+}
+
+static void test2(pl::WorkStealingPool& pool) {
+    std::atomic<std::size_t> sum{0};
+    std::latch latch(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        pool.execute([&sum, &latch, i]() {
+            sum.fetch_add(i, std::memory_order_relaxed);
+            latch.count_down();
+        });
+    }
+    latch.wait();
+    ankerl::nanobench::doNotOptimizeAway(sum);
+}
+
+static void test3(tbb::task_arena& arena) {
+    std::atomic<std::size_t> sum{0};
+    tbb::task_group tg;
+    arena.execute([&]() {
+        for (std::size_t i = 0; i < n; ++i) {
+            tg.run([&sum, i]() {
+                sum.fetch_add(i, std::memory_order_relaxed);
+            });
+        }
+        tg.wait();
+    });
+    ankerl::nanobench::doNotOptimizeAway(sum);
+}
+
+// 任务内部再提交子任务
+static void test4(pl::ThreadPool& pool) {
+    std::atomic<std::size_t> sum{0};
+    std::latch latch(fanout * fanout);
+    std::vector<std::future<void>> futures;
+    futures.reserve(fanout);
+    for (std::size_t i = 0; i < fanout; ++i) {
+        futures.emplace_back(pool.submit([&]() {
+            for (std::size_t j = 0; j < fanout; ++j) {
+                // 子任务的future不需要等待，通过latch同步
+                (void)pool.submit([&sum, &latch, j]() {
+                    sum.fetch_add(j, std::memory_order_relaxed);
+                    latch.count_down();
+                });
+            }
+        }));
+    }
+    latch.wait();
+    ankerl::nanobench::doNotOptimizeAway(sum);
+}
+
+static void test5(pl::WorkStealingPool& pool) {
+    std::atomic<std::size_t> sum{0};
+    std::latch latch(fanout * fanout);
+    for (std::size_t i = 0; i < fanout; ++i) {
+        pool.execute([&]() {
+            for (std::size_t j = 0; j < fanout; ++j) {
+                pool.execute([&sum, &latch, j]() {
+                    sum.fetch_add(j, std::memory_order_relaxed);
+                    latch.count_down();
+                });
+            }
+        });
+    }
+    latch.wait();
+    ankerl::nanobench::doNotOptimizeAway(sum);
+}
+
+static void test6(tbb::task_arena& arena) {
+    std::atomic<std::size_t> sum{0};
+    tbb::task_group tg;
+    arena.execute([&]() {
+        for (std::size_t i = 0; i < fanout; ++i) {
+            tg.run([&]() {
+                for (std::size_t j = 0; j < fanout; ++j) {
+                    tg.run([&sum, j]() {
+                        sum.fetch_add(j, std::memory_order_relaxed);
+                    });
+                }
+            });
+        }
+        tg.wait();
+    });
+    ankerl::nanobench::doNotOptimizeAway(sum);
+}
+
+int main(int argc, char* argv[]) {
+    pl::ThreadPool thread_pool(threads());
+    pl::WorkStealingPool work_stealing_pool(threads());
+    tbb::task_arena arena(static_cast<int>(threads()));
+
+    ankerl::nanobench::Bench().run("test1", [&] {
+        test1(thread_pool);
+    });
+    ankerl::nanobench::Bench().run("test2", [&] {
+        test2(work_stealing_pool);
+    });
+    ankerl::nanobench::Bench().run("test3", [&] {
+        test3(arena);
+    });
+    ankerl::nanobench::Bench().run("test4", [&] {
+        test4(thread_pool);
+    });
+    ankerl::nanobench::Bench().run("test5", [&] {
+        test5(work_stealing_pool);
+    });
+    ankerl::nanobench::Bench().run("test6", [&] {
+        test6(arena);
+    });
+    return 0;
+}
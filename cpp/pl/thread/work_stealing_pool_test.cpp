@@ -0,0 +1,220 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/thread/work_stealing_pool.h"
+
+#include <array>
+#include <atomic>
+#include <future>
+#include <latch>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(task, small_buffer) {
+    int called = 0;
+    pl::Task small([&called]() { ++called; });
+    small();
+    EXPECT_EQ(called, 1);
+
+    // 超过INLINE_SIZE的闭包放在堆上
+    std::array<char, 128> big{};
+    big[0] = 1;
+    pl::Task large([&called, big]() { called += big[0]; });
+    pl::Task moved(std::move(large));
+    EXPECT_FALSE(large);
+    moved();
+    EXPECT_EQ(called, 2);
+
+    // 只能移动的闭包
+    auto ptr = std::make_unique<int>(40);
+    pl::Task unique([p = std::move(ptr), &called]() { called += *p; });
+    small = std::move(unique);
+    small();
+    EXPECT_EQ(called, 42);
+}
+
+TEST(chase_lev_deque, owner) {
+    pl::ChaseLevDeque<int> deque(2);
+    for (int i = 0; i < 100; ++i) {
+        deque.push(i);
+    }
+    EXPECT_EQ(deque.size(), 100);
+    EXPECT_GE(deque.capacity(), 100);
+
+    int v;
+    EXPECT_TRUE(deque.steal(&v));
+    EXPECT_EQ(v, 0);
+    for (int i = 99; i > 0; --i) {
+        EXPECT_TRUE(deque.pop(&v));
+        EXPECT_EQ(v, i);
+    }
+    EXPECT_FALSE(deque.pop(&v));
+    EXPECT_FALSE(deque.steal(&v));
+}
+
+TEST(chase_lev_deque, concurrent_steal) {
+    constexpr int N = 100000;
+    constexpr int THIEVES = 3;
+    pl::ChaseLevDeque<int> deque(64);
+    std::vector<std::vector<int>> stolen(THIEVES);
+    std::vector<int> popped;
+    std::atomic<bool> done{false};
+
+    std::vector<std::thread> thieves;
+    for (int i = 0; i < THIEVES; ++i) {
+        thieves.emplace_back([&, i]() {
+            int v;
+            while (!done.load(std::memory_order_acquire) || !deque.empty()) {
+                if (deque.steal(&v)) {
+                    stolen[i].push_back(v);
+                }
+            }
+        });
+    }
+    for (int i = 0; i < N; ++i) {
+        deque.push(i);
+        int v;
+        if (i % 3 == 0 && deque.pop(&v)) {
+            popped.push_back(v);
+        }
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& t : thieves) {
+        t.join();
+    }
+
+    // 每个元素恰好被取走一次
+    std::set<int> all(popped.begin(), popped.end());
+    std::size_t total = popped.size();
+    for (const auto& s : stolen) {
+        all.insert(s.begin(), s.end());
+        total += s.size();
+    }
+    EXPECT_EQ(total, N);
+    EXPECT_EQ(all.size(), N);
+}
+
+TEST(mpmc_queue, bounded) {
+    pl::MpmcQueue<std::string> queue(4);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.tryPush(std::to_string(i)));
+    }
+    std::string s = "full";
+    EXPECT_FALSE(queue.tryPush(std::move(s)));
+    EXPECT_EQ(s, "full");
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.tryPop(&s));
+        EXPECT_EQ(s, std::to_string(i));
+    }
+    EXPECT_FALSE(queue.tryPop(&s));
+}
+
+TEST(work_stealing_pool, submit) {
+    pl::WorkStealingPool pool(4);
+    std::vector<std::future<std::pair<int, int>>> results;
+    for (int i = 0; i < 1000; ++i) {
+        results.emplace_back(pool.submit(
+            [](int a, int b) {
+                return std::make_pair(a, b);
+            },
+            i, i));
+    }
+    for (auto& result : results) {
+        auto pair = result.get();
+        EXPECT_EQ(pair.first, pair.second);
+    }
+
+    auto f = pool.submit([]() -> int { throw std::runtime_error("oops"); });
+    EXPECT_THROW(f.get(), std::runtime_error);
+}
+
+TEST(work_stealing_pool, nested) {
+    constexpr int N = 100;
+    pl::WorkStealingPool pool(4);
+    std::atomic<int> count{0};
+    std::latch latch(N * N);
+    for (int i = 0; i < N; ++i) {
+        pool.execute([&]() {
+            EXPECT_GE(pool.currentWorkerIndex(), 0);
+            // worker内部提交的任务进入本地队列，可以被其他worker窃取
+            for (int j = 0; j < N; ++j) {
+                pool.execute([&]() {
+                    count.fetch_add(1, std::memory_order_relaxed);
+                    latch.count_down();
+                });
+            }
+        });
+    }
+    latch.wait();
+    EXPECT_EQ(count.load(), N * N);
+    EXPECT_EQ(pool.currentWorkerIndex(), -1);
+}
+
+TEST(work_stealing_pool, help_while_waiting) {
+    // 只有一个worker，在worker内部等待子任务时必须自己执行子任务
+    pl::WorkStealingPool pool(1);
+    auto f = pool.submit([&pool]() {
+        std::atomic<bool> done{false};
+        pool.execute([&done]() { done.store(true); });
+        while (!done.load()) {
+            pool.runPendingTask();
+        }
+        return 42;
+    });
+    EXPECT_EQ(f.get(), 42);
+}
+
+TEST(work_stealing_pool, drain_on_destroy) {
+    std::atomic<int> count{0};
+    {
+        pl::WorkStealingPool pool(2, 16);
+        for (int i = 0; i < 1000; ++i) {
+            pool.execute([&count]() { count.fetch_add(1); });
+        }
+    }
+    EXPECT_EQ(count.load(), 1000);
+}
+
+TEST(work_stealing_pool, submit_racing_with_destroy) {
+    std::atomic<int> count{0};
+    std::latch release(1);
+    auto* pool = new pl::WorkStealingPool(1, 2);
+    // worker被阻塞，注入队列被填满，之后的提交在post中等待队列有空位
+    pool->execute([&]() {
+        release.wait();
+        count.fetch_add(1);
+    });
+    while (pool->pendingTasks() > 0) {
+        std::this_thread::yield();
+    }
+    for (int i = 0; i < 2; ++i) {
+        pool->execute([&count]() { count.fetch_add(1); });
+    }
+    std::thread submitter([&]() { pool->execute([&count]() { count.fetch_add(1); }); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    // 析构开始之后提交才完成，任务仍然要被执行
+    std::thread destroyer([&]() { delete pool; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    release.count_down();
+    destroyer.join();
+    submitter.join();
+    EXPECT_EQ(count.load(), 4);
+}
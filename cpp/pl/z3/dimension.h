@@ -16,8 +16,10 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 
 namespace pl::curve {
@@ -51,17 +53,39 @@ public:
 
     virtual ~BitNormalizedDimension() = default;
 
-    double min() override { return min_; }
+    double min() final { return min_; }
 
-    double max() override { return max_; }
+    double max() final { return max_; }
 
-    uint64_t max_index() override { return max_index_; }
+    uint64_t max_index() final { return max_index_; }
 
-    uint64_t normalize(double x) override {
-        return x >= max_ ? max_index_ : (uint64_t)std::floor((x - min_) * normalizer_);
+    /**
+     * @brief Values out of [min, max] are clamped to [0, max_index], NaN is normalized to 0
+     */
+    uint64_t normalize(double x) final {
+        double v = (x - min_) * normalizer_;
+        if (!(v > 0)) {
+            return 0;
+        }
+        return v >= static_cast<double>(max_index_) ? max_index_ : static_cast<uint64_t>(v);
     }
 
-    double denormalize(uint64_t x) override {
+    /**
+     * @brief Normalize a batch of values without virtual calls, the loop can be vectorized.
+     * The result is the same as normalize(double)
+     */
+    template <typename T> void normalize(const T* values, std::size_t n, uint32_t* out) const {
+        const auto max_index = static_cast<double>(max_index_);
+        for (std::size_t i = 0; i < n; ++i) {
+            double v = (static_cast<double>(values[i]) - min_) * normalizer_;
+            // NaN fails the comparison and becomes 0. max_index is less than 2^31, truncation
+            // is the same as floor for v >= 0
+            v = std::min(v > 0 ? v : 0.0, max_index);
+            out[i] = static_cast<uint32_t>(static_cast<int32_t>(v));
+        }
+    }
+
+    double denormalize(uint64_t x) final {
         return x >= max_index_ ? min_ + ((double)max_index_ + 0.5) * denormalizer_
                                : min_ + ((double)x + 0.5) * denormalizer_;
     }
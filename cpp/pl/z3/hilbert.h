@@ -0,0 +1,257 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include "types.h"
+#include "zbatch.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace pl::curve {
+
+/**
+ * @class HilbertN
+ * @brief Hilbert curve over Dims dimensions with BitsPerDim bits each, see: John Skilling.
+ * Programming the Hilbert curve.
+ *
+ * Like the z-order curve, every aligned cell of the space is a single contiguous range of
+ * hilbert values, but two consecutive cells are always adjacent in space, so a query window
+ * is covered by fewer and longer ranges.
+ *
+ * @tparam Dims number of dimensions, 2 or 3
+ * @tparam BitsPerDim bits of every dimension
+ */
+template <int32_t Dims, int32_t BitsPerDim> class HilbertN {
+public:
+    static_assert(Dims == 2 || Dims == 3, "only 2 and 3 dimensions are supported");
+    static_assert(Dims * BitsPerDim < 64, "hilbert value must fit in 63 bits");
+
+    using Point = std::array<uint32_t, Dims>;
+
+    // an axis-aligned box in index space, inclusive
+    struct Window {
+        Point min;
+        Point max;
+    };
+
+    /**
+     * @brief Calculates the hilbert value of the point, only the lowest BitsPerDim bits of
+     * every dimension are considered
+     */
+    [[nodiscard]] static uint64_t encode(Point p) {
+        for (auto& v : p) {
+            v &= MAX_MASK;
+        }
+        // inverse undo
+        for (uint32_t q = uint32_t{1} << (BITS_PER_DIM - 1); q > 1; q >>= 1) {
+            uint32_t mask = q - 1;
+            for (int32_t i = 0; i < DIMS; ++i) {
+                if (p[i] & q) {
+                    p[0] ^= mask;
+                } else {
+                    uint32_t t = (p[0] ^ p[i]) & mask;
+                    p[0] ^= t;
+                    p[i] ^= t;
+                }
+            }
+        }
+        // gray encode
+        for (int32_t i = 1; i < DIMS; ++i) {
+            p[i] ^= p[i - 1];
+        }
+        uint32_t t = 0;
+        for (uint32_t q = uint32_t{1} << (BITS_PER_DIM - 1); q > 1; q >>= 1) {
+            if (p[DIMS - 1] & q) {
+                t ^= q - 1;
+            }
+        }
+        for (auto& v : p) {
+            v ^= t;
+        }
+        return interleave(p);
+    }
+
+    /**
+     * @brief Opposite of encode
+     */
+    [[nodiscard]] static Point decode(uint64_t h) {
+        Point p = deinterleave(h);
+        // gray decode
+        uint32_t t = p[DIMS - 1] >> 1;
+        for (int32_t i = DIMS - 1; i > 0; --i) {
+            p[i] ^= p[i - 1];
+        }
+        p[0] ^= t;
+        // undo excess work
+        for (uint32_t q = 2; q != (uint32_t{1} << BITS_PER_DIM); q <<= 1) {
+            uint32_t mask = q - 1;
+            for (int32_t i = DIMS - 1; i >= 0; --i) {
+                if (p[i] & q) {
+                    p[0] ^= mask;
+                } else {
+                    uint32_t t = (p[0] ^ p[i]) & mask;
+                    p[0] ^= t;
+                    p[i] ^= t;
+                }
+            }
+        }
+        return p;
+    }
+
+    /**
+     * @brief Calculates ranges in index space that match any of the windows. The space is
+     * divided breadth-first, a cell at level l covers the hilbert values sharing the highest
+     * l * Dims bits. Levels with a single partially overlapped cell are not counted in
+     * max_recurse, as they are the common prefix of the z-order curve.
+     *
+     * @param windows search space
+     * @param precision precision to consider, in bits (max 64)
+     * @param max_ranges loose cap on the number of ranges to return
+     * @param max_recurse max levels of recursion to apply before stopping
+     * @param idx_ranges ranges covering the search space, sorted and not overlapping
+     */
+    static void ranges(const std::vector<Window>& windows,
+                       int32_t precision,
+                       int32_t max_ranges,
+                       int32_t max_recurse,
+                       std::vector<IndexRange>* idx_ranges) {
+        if (windows.empty()) {
+            return;
+        }
+        std::vector<IndexRange> ranges;
+        std::vector<Cell> remaining = {Cell{.origin = {}, .bits = BITS_PER_DIM}};
+        std::vector<Cell> next;
+
+        auto check_cell = [&](const Cell& cell) {
+            int32_t overlap = 0;
+            for (const auto& w : windows) {
+                overlap = std::max(overlap, relation(cell, w));
+                if (overlap == CONTAINED) {
+                    break;
+                }
+            }
+            if (overlap == DISJOINT) {
+                return;
+            }
+            int32_t offset = cell.bits * DIMS;
+            if (overlap == CONTAINED || offset < 64 - precision || cell.bits == 0) {
+                ranges.push_back(to_range(cell, overlap == CONTAINED));
+            } else {
+                next.push_back(cell);
+            }
+        };
+
+        int32_t level = 0;
+        while (level < max_recurse && !remaining.empty() &&
+               ranges.size() < static_cast<std::size_t>(max_ranges)) {
+            std::size_t i = 0;
+            for (; i < remaining.size() && ranges.size() < static_cast<std::size_t>(max_ranges);
+                 ++i) {
+                const Cell& cell = remaining[i];
+                uint32_t half = uint32_t{1} << (cell.bits - 1);
+                for (uint32_t child = 0; child < (uint32_t{1} << DIMS); ++child) {
+                    Cell c{.origin = cell.origin, .bits = cell.bits - 1};
+                    for (int32_t d = 0; d < DIMS; ++d) {
+                        if (child & (1U << d)) {
+                            c.origin[d] |= half;
+                        }
+                    }
+                    check_cell(c);
+                }
+            }
+            // reached max_ranges, keep the unprocessed cells as partial matches
+            for (; i < remaining.size(); ++i) {
+                ranges.push_back(to_range(remaining[i], false));
+            }
+            if (!(ranges.empty() && next.size() == 1)) {
+                ++level;
+            }
+            remaining.swap(next);
+            next.clear();
+        }
+        for (const auto& cell : remaining) {
+            ranges.push_back(to_range(cell, false));
+        }
+        merge_ranges(&ranges, idx_ranges);
+    }
+
+    static constexpr int32_t DEFAULT_RECURSE = 7;
+
+private:
+    // an aligned cell with 2^bits values in every dimension
+    struct Cell {
+        Point origin;
+        int32_t bits;
+    };
+
+    static constexpr int32_t DISJOINT = 0;
+    static constexpr int32_t OVERLAPPED = 1;
+    static constexpr int32_t CONTAINED = 2;
+
+    static int32_t relation(const Cell& cell, const Window& w) {
+        bool contained = true;
+        for (int32_t d = 0; d < DIMS; ++d) {
+            uint64_t min = cell.origin[d];
+            uint64_t max = min + (uint64_t{1} << cell.bits) - 1;
+            if (max < w.min[d] || min > w.max[d]) {
+                return DISJOINT;
+            }
+            contained = contained && min >= w.min[d] && max <= w.max[d];
+        }
+        return contained ? CONTAINED : OVERLAPPED;
+    }
+
+    static IndexRange to_range(const Cell& cell, bool contained) {
+        uint64_t mask = (uint64_t{1} << (cell.bits * DIMS)) - 1;
+        uint64_t lower = encode(cell.origin) & ~mask;
+        return {lower, lower | mask, contained};
+    }
+
+    // the highest bit of every group comes from the first dimension
+    static uint64_t interleave(const Point& p) {
+        if constexpr (DIMS == 2) {
+            return zbatch::detail::z2_split(p[0]) << 1 | zbatch::detail::z2_split(p[1]);
+        } else {
+            return zbatch::detail::z3_split(p[0]) << 2 | zbatch::detail::z3_split(p[1]) << 1 |
+                   zbatch::detail::z3_split(p[2]);
+        }
+    }
+
+    static Point deinterleave(uint64_t h) {
+        if constexpr (DIMS == 2) {
+            return {static_cast<uint32_t>(zbatch::detail::z2_combine(h >> 1)),
+                    static_cast<uint32_t>(zbatch::detail::z2_combine(h))};
+        } else {
+            return {static_cast<uint32_t>(zbatch::detail::z3_combine(h >> 2)),
+                    static_cast<uint32_t>(zbatch::detail::z3_combine(h >> 1)),
+                    static_cast<uint32_t>(zbatch::detail::z3_combine(h))};
+        }
+    }
+
+    static constexpr int32_t DIMS = Dims;
+    static constexpr int32_t BITS_PER_DIM = BitsPerDim;
+    static constexpr uint32_t MAX_MASK = (uint32_t{1} << BitsPerDim) - 1;
+};
+
+using Hilbert2 = HilbertN<2, 31>;
+using Hilbert3 = HilbertN<3, 21>;
+
+} // namespace pl::curve
@@ -0,0 +1,112 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/z3/hilbertsfc.h"
+#include "cpp/pl/z3/z3sfc.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+
+namespace {
+
+using pl::curve::BinnedTime;
+using pl::curve::Box;
+using pl::curve::HilbertSFC3;
+using pl::curve::IndexRange;
+using pl::curve::TimePeriod;
+using pl::curve::TimeRange;
+using pl::curve::Z3SFC;
+
+constexpr std::size_t N = 1 << 20;
+
+struct Point {
+    double x;
+    double y;
+    uint64_t t;
+};
+
+// 北京周边(2° x 2°)一周内均匀分布的点
+const std::vector<Point>& points() {
+    static const std::vector<Point> p = [] {
+        std::mt19937_64 rng(17);
+        std::uniform_real_distribution<double> lon(115.4, 117.4);
+        std::uniform_real_distribution<double> lat(39.0, 41.0);
+        std::vector<Point> v(N);
+        for (auto& pt : v) {
+            pt = {lon(rng), lat(rng), rng() % BinnedTime<TimePeriod::Week>::max_offset()};
+        }
+        return v;
+    }();
+    return p;
+}
+
+template <typename Sfc> const std::vector<uint64_t>& sorted_keys() {
+    static const std::vector<uint64_t> keys = [] {
+        Sfc sfc;
+        std::vector<uint64_t> v;
+        v.reserve(N);
+        for (const auto& p : points()) {
+            v.push_back(sfc.index(p.x, p.y, p.t));
+        }
+        std::sort(v.begin(), v.end());
+        return v;
+    }();
+    return keys;
+}
+
+/**
+ * 一个城市范围内的正方形窗口一小时内的查询，统计生成的区间数(seek次数)、区间计算的耗时，
+ * 以及按区间扫描排好序的key时需要读取的行数
+ */
+template <typename Sfc> void BM_Ranges(benchmark::State& state) {
+    auto max_ranges = static_cast<int32_t>(state.range(0));
+    auto max_recurse = static_cast<int32_t>(state.range(1));
+    Sfc sfc;
+    const auto& keys = sorted_keys<Sfc>();
+    std::vector<Box> boxes = {{116.2, 39.8, 116.5, 40.1}};
+    std::vector<TimeRange> times = {{36000, 39600}};
+
+    std::vector<IndexRange> ranges;
+    for (auto _ : state) {
+        ranges.clear();
+        sfc.ranges(boxes, times, 64, max_ranges, &ranges, max_recurse);
+        benchmark::DoNotOptimize(ranges.data());
+    }
+
+    std::size_t scanned = 0;
+    for (const auto& r : ranges) {
+        auto lo = std::lower_bound(keys.begin(), keys.end(), r.lower);
+        auto hi = std::upper_bound(lo, keys.end(), r.upper);
+        scanned += static_cast<std::size_t>(hi - lo);
+    }
+    std::size_t matched = std::count_if(points().begin(), points().end(), [&](const Point& p) {
+        return p.x >= boxes[0].xmin && p.x <= boxes[0].xmax && p.y >= boxes[0].ymin &&
+               p.y <= boxes[0].ymax && p.t >= times[0].tmin && p.t <= times[0].tmax;
+    });
+    state.counters["ranges"] = static_cast<double>(ranges.size());
+    state.counters["rows_scanned"] = static_cast<double>(scanned);
+    state.counters["rows_matched"] = static_cast<double>(matched);
+}
+BENCHMARK_TEMPLATE(BM_Ranges, Z3SFC<TimePeriod::Week>)
+    ->ArgNames({"max_ranges", "max_recurse"})
+    ->ArgsProduct({{10, 100, 1000}, {7, 32}})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_Ranges, HilbertSFC3<TimePeriod::Week>)
+    ->ArgNames({"max_ranges", "max_recurse"})
+    ->ArgsProduct({{10, 100, 1000}, {7, 32}})
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace
@@ -0,0 +1,151 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include "binned_time.h"
+#include "dimension.h"
+#include "hilbert.h"
+#include "types.h"
+
+#include <cassert>
+#include <tuple>
+#include <vector>
+
+namespace pl::curve {
+
+/**
+ * @class HilbertSFC2
+ * @brief Hilbert curve for points (lon, lat), an alternative to Z2SFC
+ */
+class HilbertSFC2 {
+public:
+    // precision (bits) per dimension must be in [1, 31];
+    HilbertSFC2(uint32_t precision) : lon_(precision), lat_(precision) {
+        assert(precision > 0 && precision < 32);
+    }
+
+    HilbertSFC2() : HilbertSFC2(31) {}
+
+    uint64_t index(double x, double y) {
+        return Hilbert2::encode({static_cast<uint32_t>(lon_.normalize(x)),
+                                 static_cast<uint32_t>(lat_.normalize(y))});
+    }
+
+    std::tuple<double, double> invert(uint64_t h) {
+        auto p = Hilbert2::decode(h);
+        return {lon_.denormalize(p[0]), lat_.denormalize(p[1])};
+    }
+
+    /**
+     * @brief Calculates hilbert ranges covering the spatial bounds. The result is sorted by
+     * lower and the ranges do not overlap
+     *
+     * @param xy spatial bounds
+     * @param precision precision to consider, in bits (max 64)
+     * @param max_ranges loose cap on the number of ranges to return
+     * @param idx_ranges
+     * @param max_recurse max levels of recursion to apply before stopping
+     */
+    void ranges(const std::vector<Box>& xy,
+                int32_t precision,
+                int32_t max_ranges,
+                std::vector<IndexRange>* idx_ranges,
+                int32_t max_recurse = Hilbert2::DEFAULT_RECURSE) {
+        std::vector<Hilbert2::Window> windows;
+        windows.reserve(xy.size());
+        for (const auto& box : xy) {
+            windows.push_back({{static_cast<uint32_t>(lon_.normalize(box.xmin)),
+                                static_cast<uint32_t>(lat_.normalize(box.ymin))},
+                               {static_cast<uint32_t>(lon_.normalize(box.xmax)),
+                                static_cast<uint32_t>(lat_.normalize(box.ymax))}});
+        }
+        Hilbert2::ranges(windows, precision, max_ranges, max_recurse, idx_ranges);
+    }
+
+private:
+    NormalizedLon lon_;
+    NormalizedLat lat_;
+};
+
+/**
+ * @class HilbertSFC3
+ * @brief Hilbert curve for points with time (lon, lat, offset in a BinnedTime period), an
+ * alternative to Z3SFC
+ */
+template <TimePeriod period> class HilbertSFC3 {
+public:
+    // precision (bits) per dimension must be in [1, 21];
+    HilbertSFC3(uint32_t precision)
+        : lon_(precision),
+          lat_(precision),
+          time_(precision, BinnedTime<period>::max_offset()) {
+        assert(precision > 0 && precision < 22);
+    }
+
+    HilbertSFC3() : HilbertSFC3<period>(21) {}
+
+    uint64_t index(double x, double y, uint64_t t) {
+        return Hilbert3::encode({static_cast<uint32_t>(lon_.normalize(x)),
+                                 static_cast<uint32_t>(lat_.normalize(y)),
+                                 static_cast<uint32_t>(time_.normalize(t))});
+    }
+
+    std::tuple<double, double, uint64_t> invert(uint64_t h) {
+        auto p = Hilbert3::decode(h);
+        return {lon_.denormalize(p[0]), lat_.denormalize(p[1]),
+                static_cast<uint64_t>(time_.denormalize(p[2]))};
+    }
+
+    /**
+     * @brief Calculates hilbert ranges covering every combination of spatial and temporal
+     * bounds. The result is sorted by lower and the ranges do not overlap
+     *
+     * @param xy spatial bounds
+     * @param t temporal bounds, offsets within a BinnedTime period
+     * @param precision precision to consider, in bits (max 64)
+     * @param max_ranges loose cap on the number of ranges to return
+     * @param idx_ranges
+     * @param max_recurse max levels of recursion to apply before stopping
+     */
+    void ranges(const std::vector<Box>& xy,
+                const std::vector<TimeRange>& t,
+                int32_t precision,
+                int32_t max_ranges,
+                std::vector<IndexRange>* idx_ranges,
+                int32_t max_recurse = Hilbert3::DEFAULT_RECURSE) {
+        std::vector<Hilbert3::Window> windows;
+        windows.reserve(xy.size() * t.size());
+        for (const auto& box : xy) {
+            for (const auto& range : t) {
+                windows.push_back({{static_cast<uint32_t>(lon_.normalize(box.xmin)),
+                                    static_cast<uint32_t>(lat_.normalize(box.ymin)),
+                                    static_cast<uint32_t>(time_.normalize(range.tmin))},
+                                   {static_cast<uint32_t>(lon_.normalize(box.xmax)),
+                                    static_cast<uint32_t>(lat_.normalize(box.ymax)),
+                                    static_cast<uint32_t>(time_.normalize(range.tmax))}});
+            }
+        }
+        Hilbert3::ranges(windows, precision, max_ranges, max_recurse, idx_ranges);
+    }
+
+private:
+    NormalizedLon lon_;
+    NormalizedLat lat_;
+    NormalizedTime time_;
+};
+
+} // namespace pl::curve
@@ -16,8 +16,10 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <vector>
 
 namespace pl::curve {
 
@@ -61,4 +63,32 @@ struct ZPrefix {
     int32_t precision;
 };
 
+/**
+ * @brief Sort the ranges and merge the adjacent and overlapping ones, a merged range is
+ * contained only if all of its parts are contained
+ *
+ * @param ranges ranges to merge, will be sorted
+ * @param idx_ranges merged ranges
+ */
+inline void merge_ranges(std::vector<IndexRange>* ranges, std::vector<IndexRange>* idx_ranges) {
+    if (ranges->empty()) {
+        return;
+    }
+    std::sort(ranges->begin(), ranges->end(), [](const IndexRange& a, const IndexRange& b) {
+        return a.lower != b.lower ? a.lower < b.lower : a.upper < b.upper;
+    });
+    IndexRange current = (*ranges)[0];
+    for (std::size_t i = 1; i < ranges->size(); ++i) {
+        const IndexRange& range = (*ranges)[i];
+        if (current.upper == UINT64_MAX || range.lower <= current.upper + 1) {
+            current.upper = std::max(current.upper, range.upper);
+            current.contained = current.contained && range.contained;
+        } else {
+            idx_ranges->push_back(current);
+            current = range;
+        }
+    }
+    idx_ranges->push_back(current);
+}
+
 } // namespace pl::curve
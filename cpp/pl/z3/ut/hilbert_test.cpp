@@ -0,0 +1,117 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/z3/hilbert.h"
+#include "cpp/pl/z3/hilbertsfc.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+namespace pl::curve {
+
+using SmallHilbert2 = HilbertN<2, 4>;
+using SmallHilbert3 = HilbertN<3, 3>;
+
+TEST(HilbertTest, encode) {
+    std::mt19937_64 rng(5);
+    for (int i = 0; i < 1000; ++i) {
+        Hilbert2::Point p2 = {static_cast<uint32_t>(rng() & 0x7FFFFFFF),
+                              static_cast<uint32_t>(rng() & 0x7FFFFFFF)};
+        EXPECT_EQ(p2, Hilbert2::decode(Hilbert2::encode(p2)));
+        Hilbert3::Point p3 = {static_cast<uint32_t>(rng() & 0x1FFFFF),
+                              static_cast<uint32_t>(rng() & 0x1FFFFF),
+                              static_cast<uint32_t>(rng() & 0x1FFFFF)};
+        EXPECT_EQ(p3, Hilbert3::decode(Hilbert3::encode(p3)));
+    }
+}
+
+// 相邻的hilbert值在空间上也相邻，并且是一个双射
+TEST(HilbertTest, adjacent) {
+    auto check = [](auto curve, uint64_t side, uint64_t n) {
+        using Curve = decltype(curve);
+        std::vector<bool> seen(n, false);
+        auto prev = Curve::decode(0);
+        for (uint64_t h = 0; h < n; ++h) {
+            auto p = Curve::decode(h);
+            ASSERT_EQ(h, Curve::encode(p));
+            uint64_t distance = 0;
+            uint64_t linear = 0;
+            for (std::size_t d = 0; d < p.size(); ++d) {
+                distance += p[d] > prev[d] ? p[d] - prev[d] : prev[d] - p[d];
+                linear = linear * side + p[d];
+            }
+            ASSERT_EQ(h == 0 ? 0 : 1, distance) << h;
+            ASSERT_FALSE(seen[linear]);
+            seen[linear] = true;
+            prev = p;
+        }
+    };
+    check(SmallHilbert2(), 16, 256);
+    check(SmallHilbert3(), 8, 512);
+}
+
+TEST(HilbertTest, ranges) {
+    std::mt19937_64 rng(13);
+    for (int n = 0; n < 50; ++n) {
+        uint32_t xs[2] = {static_cast<uint32_t>(rng() % 16), static_cast<uint32_t>(rng() % 16)};
+        uint32_t ys[2] = {static_cast<uint32_t>(rng() % 16), static_cast<uint32_t>(rng() % 16)};
+        SmallHilbert2::Window w = {{std::min(xs[0], xs[1]), std::min(ys[0], ys[1])},
+                                   {std::max(xs[0], xs[1]), std::max(ys[0], ys[1])}};
+        std::vector<IndexRange> ranges;
+        SmallHilbert2::ranges({w}, 64, 32, SmallHilbert2::DEFAULT_RECURSE, &ranges);
+        ASSERT_FALSE(ranges.empty());
+        for (std::size_t i = 1; i < ranges.size(); ++i) {
+            EXPECT_GT(ranges[i].lower, ranges[i - 1].upper + 1);
+        }
+        for (uint32_t x = 0; x < 16; ++x) {
+            for (uint32_t y = 0; y < 16; ++y) {
+                uint64_t h = SmallHilbert2::encode({x, y});
+                auto it = std::find_if(ranges.begin(), ranges.end(), [h](const IndexRange& r) {
+                    return h >= r.lower && h <= r.upper;
+                });
+                bool inside = x >= w.min[0] && x <= w.max[0] && y >= w.min[1] && y <= w.max[1];
+                if (inside) {
+                    EXPECT_NE(it, ranges.end());
+                } else if (it != ranges.end()) {
+                    EXPECT_FALSE(it->contained);
+                }
+            }
+        }
+    }
+}
+
+TEST(HilbertTest, sfc) {
+    HilbertSFC2 sfc2;
+    auto [x, y] = sfc2.invert(sfc2.index(116.397, 39.909));
+    EXPECT_NEAR(116.397, x, 1e-6);
+    EXPECT_NEAR(39.909, y, 1e-6);
+
+    HilbertSFC3<TimePeriod::Week> sfc3;
+    auto [x3, y3, t3] = sfc3.invert(sfc3.index(116.397, 39.909, 36000));
+    EXPECT_NEAR(116.397, x3, 1e-3);
+    EXPECT_NEAR(39.909, y3, 1e-3);
+    EXPECT_NEAR(36000, static_cast<double>(t3), 1);
+
+    std::vector<IndexRange> ranges;
+    sfc3.ranges({{116.2, 39.8, 116.5, 40.1}}, {{36000, 39600}}, 64, 100, &ranges);
+    ASSERT_FALSE(ranges.empty());
+    uint64_t h = sfc3.index(116.397, 39.909, 37000);
+    EXPECT_TRUE(std::any_of(ranges.begin(), ranges.end(), [h](const IndexRange& r) {
+        return h >= r.lower && h <= r.upper;
+    }));
+}
+
+} // namespace pl::curve
@@ -0,0 +1,130 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+
+#include "cpp/pl/z3/xzsfc.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+namespace pl::curve {
+
+namespace {
+
+bool intersects(const Box& a, const Box& b) {
+    return a.xmin <= b.xmax && a.xmax >= b.xmin && a.ymin <= b.ymax && a.ymax >= b.ymin;
+}
+
+bool within(const Box& a, const Box& b) {
+    return a.xmin >= b.xmin && a.xmax <= b.xmax && a.ymin >= b.ymin && a.ymax <= b.ymax;
+}
+
+const IndexRange* find(const std::vector<IndexRange>& ranges, uint64_t code) {
+    for (const auto& r : ranges) {
+        if (code >= r.lower && code <= r.upper) {
+            return &r;
+        }
+    }
+    return nullptr;
+}
+
+// 北京附近大小不一的矩形
+Box randomBox(std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> lon(115.0, 118.0);
+    std::uniform_real_distribution<double> lat(39.0, 41.0);
+    std::exponential_distribution<double> size(20.0);
+    double x = lon(rng);
+    double y = lat(rng);
+    return {x, y, x + size(rng), y + size(rng)};
+}
+
+} // namespace
+
+TEST(XZSFCTest, index) {
+    XZ2SFC sfc(12);
+    // 点和覆盖整个空间的对象
+    EXPECT_EQ(12UL, sfc.index(-180.0, -90.0, -180.0, -90.0));
+    EXPECT_EQ(1UL, sfc.index(-180.0, -90.0, 180.0, 90.0));
+    // 大小相同的对象按所在的位置排序
+    EXPECT_LT(sfc.index(10.0, 10.0, 10.1, 10.1), sfc.index(100.0, 10.0, 100.1, 10.1));
+    // 跨越单元格边界的对象使用更大的单元
+    EXPECT_LT(sfc.index(-0.01, -0.01, 0.01, 0.01), sfc.index(0.01, 0.01, 0.03, 0.03));
+}
+
+TEST(XZSFCTest, xz2_ranges) {
+    std::mt19937_64 rng(5);
+    std::vector<Box> objects;
+    for (int i = 0; i < 2000; ++i) {
+        objects.push_back(randomBox(rng));
+    }
+    XZ2SFC sfc(12);
+    std::vector<uint64_t> codes;
+    for (const auto& o : objects) {
+        codes.push_back(sfc.index(o.xmin, o.ymin, o.xmax, o.ymax));
+    }
+    for (int32_t max_ranges : {10, 100, 1000, INT32_MAX}) {
+        for (int n = 0; n < 20; ++n) {
+            Box query = randomBox(rng);
+            std::vector<IndexRange> ranges;
+            sfc.ranges({query}, max_ranges, &ranges);
+            for (std::size_t i = 1; i < ranges.size(); ++i) {
+                EXPECT_GT(ranges[i].lower, ranges[i - 1].upper + 1);
+            }
+            for (std::size_t i = 0; i < objects.size(); ++i) {
+                const IndexRange* range = find(ranges, codes[i]);
+                if (intersects(objects[i], query)) {
+                    EXPECT_NE(nullptr, range);
+                }
+                if (range != nullptr && range->contained) {
+                    EXPECT_TRUE(within(objects[i], query));
+                }
+            }
+        }
+    }
+}
+
+TEST(XZSFCTest, xz3_ranges) {
+    std::mt19937_64 rng(9);
+    XZ3SFC<TimePeriod::Week> sfc(10);
+    std::uniform_int_distribution<uint64_t> time(0, 500000);
+    struct Object {
+        Box box;
+        uint64_t tmin;
+        uint64_t tmax;
+    };
+    std::vector<Object> objects;
+    for (int i = 0; i < 2000; ++i) {
+        uint64_t t = time(rng);
+        objects.push_back({randomBox(rng), t, t + time(rng) / 50});
+    }
+    for (int n = 0; n < 20; ++n) {
+        Box query = randomBox(rng);
+        uint64_t t = time(rng);
+        TimeRange range{t, t + 20000};
+        std::vector<IndexRange> ranges;
+        sfc.ranges({query}, {range}, 500, &ranges);
+        ASSERT_FALSE(ranges.empty());
+        for (const auto& o : objects) {
+            uint64_t code = sfc.index(o.box.xmin, o.box.ymin, o.tmin, o.box.xmax, o.box.ymax,
+                                      o.tmax);
+            if (intersects(o.box, query) && o.tmin <= range.tmax && o.tmax >= range.tmin) {
+                EXPECT_NE(nullptr, find(ranges, code));
+            }
+        }
+    }
+}
+
+} // namespace pl::curve
@@ -0,0 +1,91 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+
+#include "cpp/pl/z3/z2.h"
+#include "cpp/pl/z3/z2sfc.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+namespace pl::curve {
+
+TEST(Z2Test, encode) {
+    EXPECT_EQ(1UL, Z2(1, 0).val());
+    EXPECT_EQ(2UL, Z2(0, 1).val());
+    EXPECT_EQ(0x3FFFFFFFFFFFFFFFUL, Z2(0x7FFFFFFF, 0x7FFFFFFF).val());
+
+    std::mt19937_64 rng(3);
+    for (int i = 0; i < 1000; ++i) {
+        uint64_t x = rng() & 0x7FFFFFFF;
+        uint64_t y = rng() & 0x7FFFFFFF;
+        auto [dx, dy] = Z2(Z2(x, y).val()).decode();
+        EXPECT_EQ(x, dx);
+        EXPECT_EQ(y, dy);
+    }
+}
+
+TEST(Z2Test, ranges) {
+    std::mt19937_64 rng(11);
+    for (int n = 0; n < 50; ++n) {
+        uint64_t xs[2] = {rng() % 64, rng() % 64};
+        uint64_t ys[2] = {rng() % 64, rng() % 64};
+        uint64_t xmin = std::min(xs[0], xs[1]);
+        uint64_t xmax = std::max(xs[0], xs[1]);
+        uint64_t ymin = std::min(ys[0], ys[1]);
+        uint64_t ymax = std::max(ys[0], ys[1]);
+        std::vector<IndexRange> ranges;
+        Z2(0).zranges({Zrange(Z2(xmin, ymin).val(), Z2(xmax, ymax).val())}, 64, 32,
+                      Z2::DEFAULT_RECURSE, &ranges);
+        ASSERT_FALSE(ranges.empty());
+        for (std::size_t i = 1; i < ranges.size(); ++i) {
+            EXPECT_GT(ranges[i].lower, ranges[i - 1].upper + 1);
+        }
+        for (uint64_t x = 0; x < 64; ++x) {
+            for (uint64_t y = 0; y < 64; ++y) {
+                uint64_t z = Z2(x, y).val();
+                auto it = std::find_if(ranges.begin(), ranges.end(), [z](const IndexRange& r) {
+                    return z >= r.lower && z <= r.upper;
+                });
+                bool inside = x >= xmin && x <= xmax && y >= ymin && y <= ymax;
+                if (inside) {
+                    EXPECT_NE(it, ranges.end());
+                } else if (it != ranges.end()) {
+                    EXPECT_FALSE(it->contained);
+                }
+            }
+        }
+    }
+}
+
+TEST(Z2Test, sfc) {
+    Z2SFC sfc;
+    auto [x, y] = sfc.invert(sfc.index(116.397, 39.909));
+    EXPECT_NEAR(116.397, x, 1e-6);
+    EXPECT_NEAR(39.909, y, 1e-6);
+
+    std::vector<IndexRange> ranges;
+    sfc.ranges({{116.2, 39.8, 116.5, 40.1}}, 64, 100, &ranges);
+    ASSERT_FALSE(ranges.empty());
+    EXPECT_LE(ranges.front().lower, sfc.index(116.2, 39.8));
+    EXPECT_GE(ranges.back().upper, sfc.index(116.5, 40.1));
+    uint64_t z = sfc.index(116.397, 39.909);
+    EXPECT_TRUE(std::any_of(ranges.begin(), ranges.end(), [z](const IndexRange& r) {
+        return z >= r.lower && z <= r.upper;
+    }));
+}
+
+} // namespace pl::curve
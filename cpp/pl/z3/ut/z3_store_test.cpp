@@ -0,0 +1,238 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/thread/thread_pool.h"
+#include "cpp/pl/z3/z3_store.h"
+
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+#include <stdexcept>
+
+namespace pl::curve {
+
+class Z3StoreTest : public ::testing::Test {
+protected:
+    using Store = Z3Store<TimePeriod::Day>;
+
+    void SetUp() override {
+        std::filesystem::create_directories("/tmp/z3_store/MAJOR");
+        build_options_ = std::make_shared<BuildOptions>();
+        build_options_->data_dir = "/tmp/z3_store";
+        build_options_->sst_type = SSTType::MAJOR;
+        build_options_->sst_version = SSTVersion::V1;
+        build_options_->filter_type = FilterPolicyType::BLOOM_FILTER;
+        read_options_ = std::make_shared<ReadOptions>();
+
+        // 100条轨迹，三天内每分钟一个点
+        std::mt19937_64 rng(17);
+        std::uniform_real_distribution<double> step(-0.002, 0.002);
+        std::uniform_real_distribution<double> lon(116.0, 116.8);
+        std::uniform_real_distribution<double> lat(39.6, 40.2);
+        TimePoint start{std::chrono::hours(24 * 19000)};
+        for (int v = 0; v < 100; ++v) {
+            double x = lon(rng);
+            double y = lat(rng);
+            for (int m = 0; m < 3 * 24 * 60; m += 7) {
+                x += step(rng);
+                y += step(rng);
+                points_.push_back({"v" + std::to_string(v), x, y,
+                                   start + std::chrono::minutes(m) + std::chrono::milliseconds(v),
+                                   std::to_string(m)});
+            }
+        }
+    }
+
+    void TearDown() override { std::filesystem::remove_all("/tmp/z3_store"); }
+
+    std::set<std::string> expected(const Z3Query& query) const {
+        std::set<std::string> result;
+        for (const auto& p : points_) {
+            bool in_box = std::any_of(query.boxes.begin(), query.boxes.end(), [&p](const Box& b) {
+                return p.x >= b.xmin && p.x <= b.xmax && p.y >= b.ymin && p.y <= b.ymax;
+            });
+            if (in_box && p.time >= query.start && p.time <= query.end) {
+                result.insert(p.id + "/" + p.payload);
+            }
+        }
+        return result;
+    }
+
+    static std::set<std::string> keys(const std::vector<TrackPoint>& points) {
+        std::set<std::string> result;
+        for (const auto& p : points) {
+            result.insert(p.id + "/" + p.payload);
+        }
+        return result;
+    }
+
+    void check(Store* store) {
+        std::string sst_file;
+        ASSERT_TRUE(store->write(build_options_, points_, &sst_file).isOk());
+        ASSERT_TRUE(store->open(read_options_, sst_file).isOk());
+
+        TimePoint start{std::chrono::hours(24 * 19000)};
+        std::vector<Z3Query> queries = {
+            // 一天之内
+            {{{116.2, 39.8, 116.4, 40.0}}, start + std::chrono::hours(2),
+             start + std::chrono::hours(5)},
+            // 跨越多个时间分区
+            {{{116.3, 39.9, 116.35, 39.95}}, start + std::chrono::hours(20),
+             start + std::chrono::hours(52)},
+            // 多个空间范围
+            {{{116.0, 39.6, 116.1, 39.7}, {116.6, 40.0, 116.8, 40.2}},
+             start + std::chrono::hours(30), start + std::chrono::hours(31)},
+            // 没有数据
+            {{{10.0, 10.0, 11.0, 11.0}}, start, start + std::chrono::hours(72)},
+        };
+        for (const auto& query : queries) {
+            std::vector<TrackPoint> results;
+            Z3QueryStats stats;
+            auto st = store->query(query, &results, &stats);
+            ASSERT_TRUE(st.isOk()) << st.msg();
+            auto exp = expected(query);
+            EXPECT_EQ(exp, keys(results));
+            EXPECT_EQ(exp.size(), stats.matched);
+            EXPECT_LT(stats.scanned, points_.size() / 4);
+        }
+    }
+
+    BuildOptionsRef build_options_;
+    ReadOptionsRef read_options_;
+    std::vector<TrackPoint> points_;
+};
+
+TEST_F(Z3StoreTest, query) {
+    Store store;
+    check(&store);
+}
+
+TEST_F(Z3StoreTest, parallel_query) {
+    ThreadPool pool(4);
+    Store::Options options;
+    options.shards = 8;
+    options.max_ranges = 64;
+    options.pool = &pool;
+    Store store(options);
+    check(&store);
+}
+
+TEST_F(Z3StoreTest, plan) {
+    Store::Options options;
+    options.shards = 3;
+    Store store(options);
+    std::string sst_file;
+    ASSERT_TRUE(store.write(build_options_, points_, &sst_file).isOk());
+    ASSERT_TRUE(store.open(read_options_, sst_file).isOk());
+
+    // 跨越三个时间分区
+    TimePoint start{std::chrono::hours(24 * 19000)};
+    Z3Query query{{{116.2, 39.8, 116.4, 40.0}}, start + std::chrono::hours(20),
+                  start + std::chrono::hours(52)};
+    auto parts = store.plan(query);
+    ASSERT_EQ(3 * 3, parts.size());
+    for (std::size_t i = 0; i < parts.size(); ++i) {
+        EXPECT_EQ(i % 3, parts[i].shard);
+        EXPECT_FALSE(parts[i].ranges.empty());
+        EXPECT_TRUE(parts[i].cube.has_value());
+        for (const auto& range : parts[i].ranges) {
+            EXPECT_EQ(parts[i].bin, range.lower.bin());
+        }
+        if (i > 0) {
+            EXPECT_LE(parts[i - 1].bin, parts[i].bin);
+        }
+    }
+    EXPECT_EQ(parts.front().bin + 2, parts.back().bin);
+}
+
+TEST_F(Z3StoreTest, query_stream) {
+    ThreadPool pool(4);
+    Store::Options options;
+    options.shards = 8;
+    options.pool = &pool;
+    options.max_inflight = 3;
+    Store store(options);
+    std::string sst_file;
+    ASSERT_TRUE(store.write(build_options_, points_, &sst_file).isOk());
+    ASSERT_TRUE(store.open(read_options_, sst_file).isOk());
+
+    TimePoint start{std::chrono::hours(24 * 19000)};
+    Z3Query query{{{116.0, 39.6, 116.8, 40.2}}, start, start + std::chrono::hours(72)};
+    auto parts = store.plan(query);
+
+    // 按照plan的顺序返回结果，时间分区递增
+    std::vector<TrackPoint> results;
+    std::size_t part_index = 0;
+    Z3QueryStats stats;
+    auto st = store.query_stream(
+        query,
+        [&](const Z3QueryPart& part, std::vector<TrackPoint>* points) {
+            EXPECT_EQ(parts[part_index].bin, part.bin);
+            EXPECT_EQ(parts[part_index].shard, part.shard);
+            ++part_index;
+            for (auto& p : *points) {
+                EXPECT_EQ(part.bin, BinnedTime<TimePeriod::Day>::of(p.time).bin());
+                results.push_back(std::move(p));
+            }
+            return true;
+        },
+        &stats);
+    ASSERT_TRUE(st.isOk()) << st.msg();
+    EXPECT_EQ(parts.size(), part_index);
+    EXPECT_EQ(parts.size(), stats.parts);
+    EXPECT_EQ(expected(query), keys(results));
+
+    // 提前结束
+    std::size_t consumed = 0;
+    st = store.query_stream(query, [&consumed](const Z3QueryPart&, std::vector<TrackPoint>*) {
+        return ++consumed < 2;
+    });
+    ASSERT_TRUE(st.isOk()) << st.msg();
+    EXPECT_EQ(2, consumed);
+
+    // 消费者抛出异常时，等正在执行的分区扫描结束之后再把异常抛出去
+    consumed = 0;
+    EXPECT_THROW(store.query_stream(query,
+                                    [&consumed](const Z3QueryPart&, std::vector<TrackPoint>*) {
+                                        if (++consumed == 2) {
+                                            throw std::runtime_error("consumer failed");
+                                        }
+                                        return true;
+                                    }),
+                 std::runtime_error);
+    EXPECT_EQ(2, consumed);
+}
+
+TEST_F(Z3StoreTest, decode) {
+    Store store;
+    std::string sst_file;
+    ASSERT_TRUE(store.write(build_options_, {points_[0]}, &sst_file).isOk());
+    ASSERT_TRUE(store.open(read_options_, sst_file).isOk());
+    std::vector<TrackPoint> results;
+    Z3Query query{{{-180, -90, 180, 90}}, points_[0].time, points_[0].time};
+    ASSERT_TRUE(store.query(query, &results).isOk());
+    ASSERT_EQ(1, results.size());
+    EXPECT_EQ(points_[0].id, results[0].id);
+    EXPECT_EQ(points_[0].x, results[0].x);
+    EXPECT_EQ(points_[0].y, results[0].y);
+    EXPECT_EQ(points_[0].time, results[0].time);
+    EXPECT_EQ(points_[0].payload, results[0].payload);
+
+    EXPECT_TRUE(store.write(build_options_, {}, &sst_file).isInvalidArgument());
+}
+
+} // namespace pl::curve
@@ -0,0 +1,169 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/z3/z2.h"
+#include "cpp/pl/z3/z2sfc.h"
+#include "cpp/pl/z3/z3.h"
+#include "cpp/pl/z3/z3sfc.h"
+#include "cpp/pl/z3/zbatch.h"
+
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+
+namespace pl::curve {
+
+namespace {
+
+// 不是4的整数倍，覆盖AVX2的尾部处理
+constexpr std::size_t N = 1027;
+
+std::vector<zbatch::Isa> supportedIsas() {
+    std::vector<zbatch::Isa> isas;
+    for (auto isa : {zbatch::Isa::SCALAR, zbatch::Isa::AVX2, zbatch::Isa::BMI2}) {
+        if (zbatch::supported(isa)) {
+            isas.push_back(isa);
+        }
+    }
+    return isas;
+}
+
+std::vector<uint32_t> randomValues(std::mt19937_64& rng, uint32_t bits) {
+    std::vector<uint32_t> values(N);
+    for (auto& v : values) {
+        v = static_cast<uint32_t>(rng()) & ((1U << bits) - 1);
+    }
+    return values;
+}
+
+} // namespace
+
+TEST(ZBatchTest, z2) {
+    std::mt19937_64 rng(1);
+    auto x = randomValues(rng, 31);
+    auto y = randomValues(rng, 31);
+    for (auto isa : supportedIsas()) {
+        std::vector<uint64_t> z(N);
+        zbatch::z2_encode(x.data(), y.data(), N, z.data(), isa);
+        std::vector<uint32_t> dx(N);
+        std::vector<uint32_t> dy(N);
+        zbatch::z2_decode(z.data(), N, dx.data(), dy.data(), isa);
+        for (std::size_t i = 0; i < N; ++i) {
+            ASSERT_EQ(Z2(x[i], y[i]).val(), z[i]) << static_cast<int>(isa);
+            ASSERT_EQ(x[i], dx[i]);
+            ASSERT_EQ(y[i], dy[i]);
+        }
+    }
+}
+
+TEST(ZBatchTest, z3) {
+    std::mt19937_64 rng(2);
+    auto x = randomValues(rng, 21);
+    auto y = randomValues(rng, 21);
+    auto t = randomValues(rng, 21);
+    for (auto isa : supportedIsas()) {
+        std::vector<uint64_t> z(N);
+        zbatch::z3_encode(x.data(), y.data(), t.data(), N, z.data(), isa);
+        std::vector<uint32_t> dx(N);
+        std::vector<uint32_t> dy(N);
+        std::vector<uint32_t> dt(N);
+        zbatch::z3_decode(z.data(), N, dx.data(), dy.data(), dt.data(), isa);
+        for (std::size_t i = 0; i < N; ++i) {
+            ASSERT_EQ(Z3(x[i], y[i], t[i]).val(), z[i]) << static_cast<int>(isa);
+            ASSERT_EQ(x[i], dx[i]);
+            ASSERT_EQ(y[i], dy[i]);
+            ASSERT_EQ(t[i], dt[i]);
+        }
+    }
+}
+
+TEST(ZBatchTest, sfc) {
+    std::mt19937_64 rng(3);
+    std::uniform_real_distribution<double> lon(-180.0, 180.0);
+    std::uniform_real_distribution<double> lat(-90.0, 90.0);
+    std::vector<double> x(N);
+    std::vector<double> y(N);
+    std::vector<uint64_t> t(N);
+    for (std::size_t i = 0; i < N; ++i) {
+        x[i] = lon(rng);
+        y[i] = lat(rng);
+        t[i] = rng() % BinnedTime<TimePeriod::Week>::max_offset();
+    }
+    // 边界值
+    x[0] = -180.0;
+    y[0] = 90.0;
+    t[0] = BinnedTime<TimePeriod::Week>::max_offset();
+
+    Z3SFC<TimePeriod::Week> z3sfc;
+    std::vector<uint64_t> z3(N);
+    z3sfc.index(x, y, t, z3);
+    Z2SFC z2sfc;
+    std::vector<uint64_t> z2(N);
+    z2sfc.index(x, y, z2);
+    for (std::size_t i = 0; i < N; ++i) {
+        ASSERT_EQ(z3sfc.index(x[i], y[i], t[i]), z3[i]);
+        ASSERT_EQ(z2sfc.index(x[i], y[i]), z2[i]);
+    }
+}
+
+TEST(ZBatchTest, out_of_range) {
+    // 超出范围的值被截断到边界，NaN当作最小值
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<double> x = {-200.0, 200.0, nan, -180.0, 180.0, -1e300, 1e300, 0.0};
+    std::vector<double> y = {-100.0, 100.0, 0.0, nan, 90.0, 1e300, -1e300, -90.5};
+    std::vector<uint64_t> t = {0, 0, 1, 2, 3, 4, 5, BinnedTime<TimePeriod::Week>::max_offset() * 2};
+    Z3SFC<TimePeriod::Week> z3sfc;
+    std::vector<uint64_t> z3(x.size());
+    z3sfc.index(x, y, t, z3);
+    Z2SFC z2sfc;
+    std::vector<uint64_t> z2(x.size());
+    z2sfc.index(x, y, z2);
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        EXPECT_EQ(z3sfc.index(x[i], y[i], t[i]), z3[i]) << i;
+        EXPECT_EQ(z2sfc.index(x[i], y[i]), z2[i]) << i;
+    }
+    EXPECT_EQ(z2sfc.index(-180.0, -90.0), z2sfc.index(-200.0, -100.0));
+    EXPECT_EQ(z2sfc.index(180.0, 90.0), z2sfc.index(200.0, 100.0));
+    EXPECT_EQ(z2sfc.index(-180.0, 0.0), z2sfc.index(nan, 0.0));
+}
+
+TEST(ZBatchTest, z2_31_bits) {
+    // 只使用低31位，所有实现的结果一致
+    std::vector<uint32_t> x = {0xFFFFFFFFU, 0x80000000U, 0x7FFFFFFFU};
+    std::vector<uint32_t> y = {0x80000001U, 0xFFFFFFFFU, 0U};
+    std::vector<uint64_t> expected(x.size());
+    zbatch::z2_encode(x.data(), y.data(), x.size(), expected.data(), zbatch::Isa::SCALAR);
+    for (auto isa : supportedIsas()) {
+        std::vector<uint64_t> z(x.size());
+        zbatch::z2_encode(x.data(), y.data(), x.size(), z.data(), isa);
+        EXPECT_EQ(expected, z);
+        std::vector<uint64_t> full = {~0ULL};
+        uint32_t dx = 0;
+        uint32_t dy = 0;
+        zbatch::z2_decode(full.data(), 1, &dx, &dy, isa);
+        EXPECT_EQ(0x7FFFFFFFU, dx);
+        EXPECT_EQ(0x7FFFFFFFU, dy);
+    }
+}
+
+TEST(ZBatchTest, best_isa) {
+    auto isa = zbatch::best_isa();
+    EXPECT_TRUE(zbatch::supported(isa));
+    // 微码实现的pdep/pext比AVX2和标量实现都慢
+    EXPECT_EQ(pl::fast_bmi2(), isa == zbatch::Isa::BMI2);
+}
+
+} // namespace pl::curve
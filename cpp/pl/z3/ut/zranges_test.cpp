@@ -0,0 +1,208 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/z3/z3.h"
+#include "cpp/pl/z3/z3index.h"
+#include "cpp/pl/z3/z3sfc.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+namespace pl::curve {
+
+namespace {
+
+struct Cube {
+    uint64_t xmin, ymin, tmin, xmax, ymax, tmax;
+
+    [[nodiscard]] bool contains(uint64_t z) const {
+        auto [x, y, t] = Z3(z).decode();
+        return x >= xmin && x <= xmax && y >= ymin && y <= ymax && t >= tmin && t <= tmax;
+    }
+
+    [[nodiscard]] uint64_t zmin() const { return Z3(xmin, ymin, tmin).val(); }
+
+    [[nodiscard]] uint64_t zmax() const { return Z3(xmax, ymax, tmax).val(); }
+};
+
+// 每一维的取值范围是[0, 16)
+Cube randomCube(std::mt19937_64& rng) {
+    auto pick = [&rng](uint64_t* lo, uint64_t* hi) {
+        uint64_t a = rng() % 16;
+        uint64_t b = rng() % 16;
+        *lo = std::min(a, b);
+        *hi = std::max(a, b);
+    };
+    Cube cube{};
+    pick(&cube.xmin, &cube.xmax);
+    pick(&cube.ymin, &cube.ymax);
+    pick(&cube.tmin, &cube.tmax);
+    return cube;
+}
+
+bool covered(const std::vector<IndexRange>& ranges, uint64_t z) {
+    return std::any_of(ranges.begin(), ranges.end(), [z](const IndexRange& r) {
+        return z >= r.lower && z <= r.upper;
+    });
+}
+
+} // namespace
+
+TEST(Z3RangesTest, zdivide) {
+    std::mt19937_64 rng(7);
+    for (int n = 0; n < 50; ++n) {
+        Cube cube = randomCube(rng);
+        uint64_t rmin = cube.zmin();
+        uint64_t rmax = cube.zmax();
+        for (uint64_t z = rmin + 1; z < rmax; ++z) {
+            if (cube.contains(z)) {
+                continue;
+            }
+            uint64_t litmax = z - 1;
+            while (!cube.contains(litmax)) {
+                --litmax;
+            }
+            uint64_t bigmin = z + 1;
+            while (!cube.contains(bigmin)) {
+                ++bigmin;
+            }
+            auto [actual_litmax, actual_bigmin] = Z3(0).zdivide(z, rmin, rmax);
+            ASSERT_EQ(litmax, actual_litmax) << z;
+            ASSERT_EQ(bigmin, actual_bigmin) << z;
+        }
+    }
+}
+
+TEST(Z3RangesTest, exact) {
+    std::mt19937_64 rng(42);
+    for (int n = 0; n < 50; ++n) {
+        Cube cube = randomCube(rng);
+        std::vector<IndexRange> ranges;
+        Z3(0).zranges({Zrange(cube.zmin(), cube.zmax())}, 64, INT32_MAX, 64, &ranges);
+        ASSERT_FALSE(ranges.empty());
+        for (uint64_t z = 0; z < 4096; ++z) {
+            ASSERT_EQ(cube.contains(z), covered(ranges, z)) << z;
+        }
+        for (const auto& r : ranges) {
+            EXPECT_TRUE(r.contained);
+        }
+    }
+}
+
+TEST(Z3RangesTest, max_ranges) {
+    std::mt19937_64 rng(1234);
+    for (int32_t max_ranges : {1, 4, 16, 64}) {
+        for (int n = 0; n < 20; ++n) {
+            Cube cube = randomCube(rng);
+            std::vector<IndexRange> ranges;
+            Z3(0).zranges({Zrange(cube.zmin(), cube.zmax())}, 64, max_ranges, 64, &ranges);
+            for (std::size_t i = 1; i < ranges.size(); ++i) {
+                // 有序并且合并了相邻的区间
+                ASSERT_GT(ranges[i].lower, ranges[i - 1].upper + 1);
+            }
+            for (uint64_t z = 0; z < 4096; ++z) {
+                if (cube.contains(z)) {
+                    ASSERT_TRUE(covered(ranges, z)) << z;
+                }
+            }
+            for (const auto& r : ranges) {
+                if (!r.contained) {
+                    continue;
+                }
+                for (uint64_t z = r.lower; z <= r.upper; ++z) {
+                    ASSERT_TRUE(cube.contains(z)) << z;
+                }
+            }
+        }
+    }
+}
+
+TEST(Z3RangesTest, multiple_bounds) {
+    std::mt19937_64 rng(99);
+    Cube a = randomCube(rng);
+    Cube b = randomCube(rng);
+    std::vector<IndexRange> ranges;
+    Z3(0).zranges({Zrange(a.zmin(), a.zmax()), Zrange(b.zmin(), b.zmax())}, 64, INT32_MAX, 64,
+                  &ranges);
+    for (uint64_t z = 0; z < 4096; ++z) {
+        ASSERT_EQ(a.contains(z) || b.contains(z), covered(ranges, z)) << z;
+    }
+}
+
+TEST(Z3IndexKeySpaceTest, index_values) {
+    using KeySpace = Z3IndexKeySpace<TimePeriod::Week>;
+    KeySpace::TimePoint start{std::chrono::seconds(604800 * 100 + 3600)};
+    KeySpace::TimePoint end{std::chrono::seconds(604800 * 103 + 7200)};
+    KeySpace key_space;
+    auto values = key_space.get_index_values({{116.0, 39.0, 117.0, 40.0}}, start, end);
+    ASSERT_EQ(4, values.temporal_bounds.size());
+    EXPECT_EQ(3600, values.temporal_bounds[100][0].tmin);
+    EXPECT_EQ(604800, values.temporal_bounds[100][0].tmax);
+    EXPECT_EQ(0, values.temporal_bounds[101][0].tmin);
+    EXPECT_EQ(604800, values.temporal_bounds[102][0].tmax);
+    EXPECT_EQ(0, values.temporal_bounds[103][0].tmin);
+    EXPECT_EQ(7200, values.temporal_bounds[103][0].tmax);
+
+    EXPECT_TRUE(key_space.get_index_values({{0, 0, 1, 1}}, end, start).temporal_bounds.empty());
+}
+
+TEST(Z3IndexKeySpaceTest, range_bytes) {
+    using KeySpace = Z3IndexKeySpace<TimePeriod::Day>;
+    KeySpace key_space;
+    KeySpace::TimePoint start{std::chrono::hours(24 * 19000 + 6)};
+    KeySpace::TimePoint end = start + std::chrono::hours(30);
+    Box box{116.2, 39.8, 116.5, 40.1};
+    auto values = key_space.get_index_values({box}, start, end);
+    auto ranges = key_space.get_ranges(values, 64);
+    ASSERT_FALSE(ranges.empty());
+    auto bytes = KeySpace::get_range_bytes(ranges, 4);
+    ASSERT_EQ(ranges.size() * 4, bytes.size());
+    for (std::size_t i = 1; i < bytes.size(); ++i) {
+        ASSERT_LT(bytes[i - 1].start, bytes[i].start);
+        ASSERT_LE(bytes[i - 1].stop, bytes[i].start);
+    }
+
+    auto in_range = [&bytes](const std::string& key) {
+        return std::any_of(bytes.begin(), bytes.end(), [&key](const ByteRange& r) {
+            return key >= r.start && (r.stop.empty() || key < r.stop);
+        });
+    };
+    std::mt19937_64 rng(5);
+    std::uniform_real_distribution<double> lon(box.xmin, box.xmax);
+    std::uniform_real_distribution<double> lat(box.ymin, box.ymax);
+    for (int i = 0; i < 1000; ++i) {
+        auto time = start + std::chrono::seconds(rng() % (30 * 3600));
+        auto shard = static_cast<uint8_t>(rng() % 4);
+        std::string key = key_space.to_idx_key(shard, "id" + std::to_string(i), lon(rng),
+                                               lat(rng), time);
+        ASSERT_TRUE(in_range(key)) << i;
+
+        Z3RowKey decoded{};
+        ASSERT_TRUE(KeySpace::from_idx_key(key, &decoded));
+        EXPECT_EQ(shard, decoded.shard);
+        EXPECT_EQ("id" + std::to_string(i), decoded.id);
+        auto [x, y, t] = key_space.sfc().invert(decoded.z);
+        EXPECT_GE(x, box.xmin - 1e-3);
+        EXPECT_LE(x, box.xmax + 1e-3);
+        EXPECT_GE(y, box.ymin - 1e-3);
+        EXPECT_LE(y, box.ymax + 1e-3);
+    }
+    // 查询范围之外的点
+    std::string outside = key_space.to_idx_key(0, "x", 0.0, 0.0, start);
+    EXPECT_FALSE(in_range(outside));
+}
+
+} // namespace pl::curve
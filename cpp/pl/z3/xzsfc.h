@@ -0,0 +1,334 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+
+#pragma once
+
+#include "binned_time.h"
+#include "types.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace pl::curve {
+
+/**
+ * @class XZSFC
+ * @brief Extended z-order curve for objects with extent (bounding boxes, line strings and
+ * polygons), see: Böhm, Klump, Kriegel. XZ-Ordering: A Space-Filling Curve for Objects with
+ * Spatial Extension.
+ *
+ * The space is recursively divided into 2^Dims cells, the element of a cell is extended to
+ * twice of its size in every dimension. An object is indexed by the sequence code of the
+ * smallest element that contains it, so it is stored exactly once without being split.
+ *
+ * @tparam Dims number of dimensions, 2 or 3
+ */
+template <int32_t Dims> class XZSFC {
+public:
+    static_assert(Dims == 2 || Dims == 3, "only 2 and 3 dimensions are supported");
+
+    using Point = std::array<double, Dims>;
+
+    struct Bounds {
+        double min;
+        double max;
+    };
+
+    // an axis-aligned box in user space
+    struct Window {
+        Point min;
+        Point max;
+    };
+
+    /**
+     * @param g resolution, the max number of times the space is divided
+     * @param bounds bounds of every dimension
+     */
+    XZSFC(int32_t g, const std::array<Bounds, Dims>& bounds) : g_(g), bounds_(bounds) {
+        // the number of sequence codes is (2^(Dims*(g+1)) - 1) / (2^Dims - 1)
+        assert(g > 0 && Dims * (g + 1) < 64);
+    }
+
+    /**
+     * @brief Index an object by its bounding box, values out of bounds are clamped
+     */
+    [[nodiscard]] uint64_t index(const Point& min, const Point& max) const {
+        Point nmin;
+        Point nmax;
+        double width = 0;
+        for (int32_t d = 0; d < Dims; ++d) {
+            nmin[d] = normalize(min[d], d);
+            nmax[d] = normalize(max[d], d);
+            assert(nmin[d] <= nmax[d]);
+            width = std::max(width, nmax[d] - nmin[d]);
+        }
+
+        // the element at level l1 is larger than the object, so the object is contained by
+        // an element of level l1, or by an element of level l1 + 1 if it does not cross the
+        // boundary of the cells
+        int32_t length = g_;
+        if (width > 0) {
+            auto l1 = static_cast<int32_t>(std::floor(std::log(width) / std::log(0.5)));
+            if (l1 < g_) {
+                double w2 = std::pow(0.5, l1 + 1);
+                bool fits = true;
+                for (int32_t d = 0; d < Dims; ++d) {
+                    fits = fits && nmax[d] <= std::floor(nmin[d] / w2) * w2 + 2 * w2;
+                }
+                length = fits ? l1 + 1 : l1;
+            }
+        }
+        return sequence_code(nmin, length);
+    }
+
+    /**
+     * @brief Calculates ranges of sequence codes whose extended elements overlap any of the
+     * query windows. Uses breadth-first searching to allow a limit on the number of ranges.
+     * The result is sorted by lower and the ranges do not overlap
+     *
+     * @param windows query windows in user space
+     * @param max_ranges loose cap on the number of ranges to return
+     * @param idx_ranges
+     */
+    void ranges(const std::vector<Window>& windows,
+                int32_t max_ranges,
+                std::vector<IndexRange>* idx_ranges) const {
+        if (windows.empty()) {
+            return;
+        }
+        std::vector<Window> query;
+        query.reserve(windows.size());
+        for (const auto& window : windows) {
+            Window w;
+            for (int32_t d = 0; d < Dims; ++d) {
+                w.min[d] = normalize(window.min[d], d);
+                w.max[d] = normalize(window.max[d], d);
+            }
+            query.push_back(w);
+        }
+
+        std::vector<IndexRange> ranges;
+        std::deque<Element> remaining;
+        std::deque<Element> next;
+
+        auto check_value = [&](const Element& element, int32_t level) {
+            if (contained(query, element)) {
+                // every element in the subtree matches
+                uint64_t min = sequence_code(element.min, level);
+                ranges.push_back({min, min + subtree_size(level) - 1, true});
+            } else if (overlapped(query, element)) {
+                // the element itself is a partial match, its children are checked in the
+                // next level
+                uint64_t code = sequence_code(element.min, level);
+                ranges.push_back({code, code, false});
+                element.children(&next);
+            }
+        };
+
+        Element root;
+        root.min.fill(0.0);
+        root.length = 1.0;
+        root.children(&remaining);
+        int32_t level = 1;
+        while (level < g_ && !remaining.empty() &&
+               ranges.size() < static_cast<std::size_t>(max_ranges)) {
+            while (!remaining.empty() && ranges.size() < static_cast<std::size_t>(max_ranges)) {
+                check_value(remaining.front(), level);
+                remaining.pop_front();
+            }
+            if (!remaining.empty()) {
+                // reached max_ranges
+                break;
+            }
+            remaining.swap(next);
+            ++level;
+        }
+
+        // the elements not processed match with their whole subtree
+        for (const auto& element : remaining) {
+            uint64_t min = sequence_code(element.min, level);
+            ranges.push_back({min, min + subtree_size(level) - 1, false});
+        }
+        for (const auto& element : next) {
+            uint64_t min = sequence_code(element.min, level + 1);
+            ranges.push_back({min, min + subtree_size(level + 1) - 1, false});
+        }
+        merge_ranges(&ranges, idx_ranges);
+    }
+
+    [[nodiscard]] int32_t resolution() const { return g_; }
+
+private:
+    static constexpr uint64_t CHILDREN = uint64_t{1} << Dims;
+
+    // an element of the quad/oct tree, in normalized space
+    struct Element {
+        Point min;
+        double length;
+
+        // the extended element is twice of the cell in every dimension
+        [[nodiscard]] bool contained_by(const Window& w) const {
+            for (int32_t d = 0; d < Dims; ++d) {
+                if (w.min[d] > min[d] || w.max[d] < min[d] + 2 * length) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        [[nodiscard]] bool overlaps(const Window& w) const {
+            for (int32_t d = 0; d < Dims; ++d) {
+                if (w.max[d] < min[d] || w.min[d] > min[d] + 2 * length) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void children(std::deque<Element>* out) const {
+            double half = length / 2;
+            for (uint64_t q = 0; q < CHILDREN; ++q) {
+                Element child;
+                for (int32_t d = 0; d < Dims; ++d) {
+                    child.min[d] = ((q >> d) & 1) != 0 ? min[d] + half : min[d];
+                }
+                child.length = half;
+                out->push_back(child);
+            }
+        }
+    };
+
+    static bool contained(const std::vector<Window>& query, const Element& element) {
+        return std::any_of(query.begin(), query.end(), [&element](const Window& w) {
+            return element.contained_by(w);
+        });
+    }
+
+    static bool overlapped(const std::vector<Window>& query, const Element& element) {
+        return std::any_of(query.begin(), query.end(), [&element](const Window& w) {
+            return element.overlaps(w);
+        });
+    }
+
+    [[nodiscard]] double normalize(double value, int32_t d) const {
+        const Bounds& b = bounds_[d];
+        return (std::clamp(value, b.min, b.max) - b.min) / (b.max - b.min);
+    }
+
+    // number of sequence codes in the subtree of an element of the level, including itself
+    [[nodiscard]] uint64_t subtree_size(int32_t level) const {
+        return ((uint64_t{1} << (Dims * (g_ - level + 1))) - 1) / (CHILDREN - 1);
+    }
+
+    /**
+     * @brief Sequence code of the element of the given level that contains the point. The
+     * elements are numbered in depth-first order, an element precedes its children
+     */
+    [[nodiscard]] uint64_t sequence_code(const Point& point, int32_t length) const {
+        Point min;
+        Point max;
+        min.fill(0.0);
+        max.fill(1.0);
+        uint64_t code = 0;
+        for (int32_t i = 0; i < length; ++i) {
+            uint64_t quad = 0;
+            for (int32_t d = 0; d < Dims; ++d) {
+                double center = (min[d] + max[d]) / 2;
+                if (point[d] < center) {
+                    max[d] = center;
+                } else {
+                    quad |= uint64_t{1} << d;
+                    min[d] = center;
+                }
+            }
+            code += 1 + quad * subtree_size(i + 1);
+        }
+        return code;
+    }
+
+private:
+    const int32_t g_;
+    const std::array<Bounds, Dims> bounds_;
+};
+
+/**
+ * @class XZ2SFC
+ * @brief XZ curve of (lon, lat)
+ */
+class XZ2SFC : public XZSFC<2> {
+public:
+    explicit XZ2SFC(int32_t g = 12) : XZSFC<2>(g, {{{-180.0, 180.0}, {-90.0, 90.0}}}) {}
+
+    [[nodiscard]] uint64_t index(double xmin, double ymin, double xmax, double ymax) const {
+        return XZSFC<2>::index({xmin, ymin}, {xmax, ymax});
+    }
+
+    void ranges(const std::vector<Box>& xy,
+                int32_t max_ranges,
+                std::vector<IndexRange>* idx_ranges) const {
+        std::vector<Window> windows;
+        windows.reserve(xy.size());
+        for (const auto& box : xy) {
+            windows.push_back({{box.xmin, box.ymin}, {box.xmax, box.ymax}});
+        }
+        XZSFC<2>::ranges(windows, max_ranges, idx_ranges);
+    }
+};
+
+/**
+ * @class XZ3SFC
+ * @brief XZ curve of (lon, lat, time), time is the offset within a BinnedTime period
+ */
+template <TimePeriod period> class XZ3SFC : public XZSFC<3> {
+public:
+    explicit XZ3SFC(int32_t g = 12)
+        : XZSFC<3>(g,
+                   {{{-180.0, 180.0},
+                     {-90.0, 90.0},
+                     {0.0, static_cast<double>(BinnedTime<period>::max_offset())}}}) {}
+
+    [[nodiscard]] uint64_t index(
+        double xmin, double ymin, uint64_t tmin, double xmax, double ymax, uint64_t tmax) const {
+        return XZSFC<3>::index(
+            {xmin, ymin, static_cast<double>(tmin)}, {xmax, ymax, static_cast<double>(tmax)});
+    }
+
+    /**
+     * @brief Calculates ranges covering every combination of spatial and temporal bounds
+     */
+    void ranges(const std::vector<Box>& xy,
+                const std::vector<TimeRange>& t,
+                int32_t max_ranges,
+                std::vector<IndexRange>* idx_ranges) const {
+        std::vector<Window> windows;
+        windows.reserve(xy.size() * t.size());
+        for (const auto& box : xy) {
+            for (const auto& range : t) {
+                windows.push_back({{box.xmin, box.ymin, static_cast<double>(range.tmin)},
+                                   {box.xmax, box.ymax, static_cast<double>(range.tmax)}});
+            }
+        }
+        XZSFC<3>::ranges(windows, max_ranges, idx_ranges);
+    }
+};
+
+} // namespace pl::curve
@@ -0,0 +1,89 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+
+#pragma once
+
+#include "zbatch.h"
+#include "zn.h"
+
+#include <bitset>
+#include <cstdint>
+#include <ostream>
+#include <tuple>
+
+namespace pl::curve {
+
+class Z2 : public ZN<2, 31, 62, 0x7FFFFFFFUL> {
+public:
+    // the bits will be encoded in reverse order:
+    // ......y1x1y0x0
+    Z2(uint64_t x, uint64_t y) { zval_ = (split(x) | split(y) << 1); }
+
+    // constructed by z2 value
+    Z2(uint64_t z) { zval_ = z; }
+
+    ~Z2() override = default;
+
+    [[nodiscard]] std::tuple<uint64_t, uint64_t> decode() const {
+        return {combine(zval_), combine(zval_ >> 1)};
+    }
+
+    [[nodiscard]] uint64_t val() const { return zval_; }
+
+    friend std::ostream& operator<<(std::ostream& os, const Z2& z2) {
+        std::bitset<64> bs(z2.zval_);
+        os << bs << '\n';
+        return os;
+    }
+
+private:
+    // insert 0 between every bit in value. Only first 31 bits can be considered.
+    [[nodiscard]] uint64_t split(uint64_t val) const override {
+        return zbatch::detail::z2_split(val);
+    }
+
+    // combine every second bit to from a value. Max value is 31 bits
+    [[nodiscard]] uint64_t combine(uint64_t z) const override {
+        return zbatch::detail::z2_combine(z);
+    }
+
+    [[nodiscard]] bool contains(const Zrange& range, uint64_t value) const override {
+        auto [vx, vy] = Z2(value).decode();
+        auto [minx, miny] = Z2(range.min).decode();
+        auto [maxx, maxy] = Z2(range.max).decode();
+        return vx >= minx && vx <= maxx && vy >= miny && vy <= maxy;
+    }
+
+    [[nodiscard]] bool overlaps(const Zrange& range, const Zrange& value) const override {
+        auto [minrx, minry] = Z2(range.min).decode();
+        auto [maxrx, maxry] = Z2(range.max).decode();
+
+        auto [minvx, minvy] = Z2(value.min).decode();
+        auto [maxvx, maxvy] = Z2(value.max).decode();
+
+        return overlaps(minrx, maxrx, minvx, maxvx) && overlaps(minry, maxry, minvy, maxvy);
+    }
+
+    [[nodiscard]] bool overlaps(int64_t a1, int64_t a2, int64_t b1, int64_t b2) const {
+        return std::max(a1, b1) <= std::min(a2, b2);
+    }
+
+private:
+    uint64_t zval_;
+};
+
+} // namespace pl::curve
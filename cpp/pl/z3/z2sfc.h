@@ -0,0 +1,98 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include "dimension.h"
+#include "types.h"
+#include "z2.h"
+#include "zbatch.h"
+
+#include <algorithm>
+#include <cassert>
+#include <span>
+#include <vector>
+
+namespace pl::curve {
+
+/**
+ * @class Z2SFC
+ * @brief Space filling curve of (lon, lat) for pure spatial keys
+ */
+class Z2SFC {
+public:
+    // precision (bits) per dimension must be in [1, 31];
+    Z2SFC(uint32_t precision) : lon_(precision), lat_(precision) {
+        assert(precision > 0 && precision < 32);
+    }
+
+    Z2SFC() : Z2SFC(31) {}
+
+    uint64_t index(double x, double y) { return Z2(lon_.normalize(x), lat_.normalize(y)).val(); }
+
+    /**
+     * @brief Batch version of index, out[i] = index(x[i], y[i])
+     */
+    void index(std::span<const double> x,
+               std::span<const double> y,
+               std::span<uint64_t> out) const {
+        assert(x.size() == y.size() && x.size() <= out.size());
+        uint32_t nx[BATCH_SIZE];
+        uint32_t ny[BATCH_SIZE];
+        for (std::size_t i = 0; i < x.size(); i += BATCH_SIZE) {
+            std::size_t n = std::min(BATCH_SIZE, x.size() - i);
+            lon_.normalize(x.data() + i, n, nx);
+            lat_.normalize(y.data() + i, n, ny);
+            zbatch::z2_encode(nx, ny, n, out.data() + i);
+        }
+    }
+
+    std::tuple<double, double> invert(uint64_t z) {
+        auto [x, y] = Z2(z).decode();
+        return {lon_.denormalize(x), lat_.denormalize(y)};
+    }
+
+    /**
+     * @brief Calculates z2 ranges covering the spatial bounds. The result is sorted by lower
+     * and the ranges do not overlap
+     *
+     * @param xy spatial bounds
+     * @param precision precision to consider, in bits (max 64)
+     * @param max_ranges loose cap on the number of ranges to return
+     * @param idx_ranges
+     * @param max_recurse max levels of recursion to apply before stopping
+     */
+    void ranges(const std::vector<Box>& xy,
+                int32_t precision,
+                int32_t max_ranges,
+                std::vector<IndexRange>* idx_ranges,
+                int32_t max_recurse = Z2::DEFAULT_RECURSE) {
+        std::vector<Zrange> zbounds;
+        zbounds.reserve(xy.size());
+        for (const auto& box : xy) {
+            zbounds.emplace_back(index(box.xmin, box.ymin), index(box.xmax, box.ymax));
+        }
+        Z2(0).zranges(zbounds, precision, max_ranges, max_recurse, idx_ranges);
+    }
+
+private:
+    static constexpr std::size_t BATCH_SIZE = 256;
+
+    NormalizedLon lon_;
+    NormalizedLat lat_;
+};
+
+} // namespace pl::curve
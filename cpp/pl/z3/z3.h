@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "zbatch.h"
 #include "zn.h"
 
 #include <bitset>
@@ -26,7 +27,7 @@
 
 namespace pl::curve {
 
-class Z3 : public ZN<3, 21, 64, 0x1FFFFFUL> {
+class Z3 : public ZN<3, 21, 63, 0x1FFFFFUL> {
 public:
     // the bits will be encoded in reverse order:
     // ......z1y1x1z0y0x0
@@ -52,39 +53,27 @@ public:
 private:
     // insert 00 between every bit in value. Only first 21 bits can be considered.
     [[nodiscard]] uint64_t split(uint64_t val) const override {
-        uint64_t x = val & MAX_MASK;
-        x = (x | x << 32) & 0x1F00000000FFFFUL;
-        x = (x | x << 16) & 0x1F0000FF0000FFUL;
-        x = (x | x << 8) & 0x100F00F00F00F00FUL;
-        x = (x | x << 4) & 0x10C30C30C30C30C3UL;
-        x = (x | x << 2) & 0x1249249249249249UL;
-        return x;
+        return zbatch::detail::z3_split(val);
     }
 
     // combine every third bit to from a value. Max value is 21 bits
     [[nodiscard]] uint64_t combine(uint64_t z) const override {
-        uint64_t x = z & 0x1249249249249249UL;
-        x = (x ^ (x >> 2)) & 0x10C30C30C30C30C3UL;
-        x = (x ^ (x >> 4)) & 0x100F00F00F00F00FUL;
-        x = (x ^ (x >> 8)) & 0x1F0000FF0000FFUL;
-        x = (x ^ (x >> 16)) & 0x1F00000000FFFFUL;
-        x = (x ^ (x >> 32)) & MAX_MASK;
-        return x;
+        return zbatch::detail::z3_combine(z);
     }
 
     [[nodiscard]] bool contains(const Zrange& range, uint64_t value) const override {
         auto [vx, vy, vz] = Z3(value).decode();
         auto [minx, miny, minz] = Z3(range.min).decode();
-        auto [maxx, maxy, maxz] = Z3(range.min).decode();
+        auto [maxx, maxy, maxz] = Z3(range.max).decode();
         return vx >= minx && vx <= maxx && vy >= miny && vy <= maxy && vz >= minz && vz <= maxz;
     }
 
     [[nodiscard]] bool overlaps(const Zrange& range, const Zrange& value) const override {
         auto [minrx, minry, minrz] = Z3(range.min).decode();
-        auto [maxrx, maxry, maxrz] = Z3(range.min).decode();
+        auto [maxrx, maxry, maxrz] = Z3(range.max).decode();
 
         auto [minvx, minvy, minvz] = Z3(value.min).decode();
-        auto [maxvx, maxvy, maxvz] = Z3(value.min).decode();
+        auto [maxvx, maxvy, maxvz] = Z3(value.max).decode();
 
         return overlaps(minrx, maxrx, minvx, maxvx) && overlaps(minry, maxry, minvy, maxvy) &&
                overlaps(minrz, maxrz, minvz, maxvz);
@@ -0,0 +1,438 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include "cpp/pl/sst/sstable.h"
+#include "cpp/pl/sst/sstable_builder.h"
+#include "cpp/pl/thread/thread_pool.h"
+#include "cpp/pl/z3/z3index.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace pl::curve {
+
+using TimePoint = std::chrono::time_point<std::chrono::system_clock>;
+
+/**
+ * A point of a trajectory, time is stored with millisecond precision
+ */
+struct TrackPoint {
+    std::string id;
+    double x;
+    double y;
+    TimePoint time;
+    std::string payload;
+};
+
+/**
+ * Matches the points inside any of the boxes within [start, end]
+ */
+struct Z3Query {
+    std::vector<Box> boxes;
+    TimePoint start;
+    TimePoint end;
+};
+
+struct Z3QueryStats {
+    uint64_t parts{0};   // (sstable, shard, bin) partitions
+    uint64_t ranges{0};  // rowkey ranges of all shards
+    uint64_t scanned{0}; // rowkeys read from the sstables
+    uint64_t matched{0};
+    uint64_t skipped{0}; // seeks to BIGMIN inside a partially matched range
+};
+
+/**
+ * A partition of a query, all z3 ranges of a time bin in a shard of an sstable. The partitions
+ * are independent of each other, and scanned by a single iterator each
+ */
+struct Z3QueryPart {
+    SSTable* table;
+    uint8_t shard;
+    uint16_t bin;
+    std::vector<Z3ScanRange> ranges;
+    // the query cube of the bin, set if the query has a single box and a single time range in
+    // the bin. It allows skipping to BIGMIN in partially matched ranges
+    std::optional<Zrange> cube;
+};
+
+namespace detail {
+
+inline uint64_t to_millis(const TimePoint& time) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+// x(8B) | y(8B) | millis(8B) | payload
+inline std::string encode_track_value(const TrackPoint& point) {
+    std::string value(24, '\0');
+    uint64_t millis = to_millis(point.time);
+    std::memcpy(value.data(), &point.x, 8);
+    std::memcpy(value.data() + 8, &point.y, 8);
+    std::memcpy(value.data() + 16, &millis, 8);
+    value.append(point.payload);
+    return value;
+}
+
+inline bool decode_track_value(std::string_view value, TrackPoint* point, uint64_t* millis) {
+    if (value.size() < 24) {
+        return false;
+    }
+    std::memcpy(&point->x, value.data(), 8);
+    std::memcpy(&point->y, value.data() + 8, 8);
+    std::memcpy(millis, value.data() + 16, 8);
+    return true;
+}
+
+} // namespace detail
+
+/**
+ * @class Z3Store
+ * @brief Spatio-temporal point store on top of sstables, rowkeys are created by
+ * Z3IndexKeySpace. A query is planned as (shard, bin, z3 ranges) partitions, the partitions are
+ * scanned in parallel, and the points are filtered with the exact coordinates
+ */
+template <TimePeriod period> class Z3Store {
+public:
+    struct Options {
+        uint8_t shards{4};
+        int32_t max_ranges{Z3IndexKeySpace<period>::DEFAULT_MAX_RANGES};
+        // scans run in the calling thread if the pool is null. Queries must not be issued from
+        // the workers of this pool, see query_stream
+        ThreadPool* pool{nullptr};
+        // partitions of a query scanned or buffered at the same time, 0 means twice the pool
+        // size. It bounds both the pool usage of a long query and the buffered results
+        std::size_t max_inflight{0};
+    };
+
+    /**
+     * Receives the matched points of the partitions in the order of the plan, returns false to
+     * stop the query
+     */
+    using PartConsumer = std::function<bool(const Z3QueryPart&, std::vector<TrackPoint>*)>;
+
+    Z3Store() : Z3Store(Options()) {}
+
+    explicit Z3Store(Options options) : options_(options) {
+        options_.shards = std::max<uint8_t>(options_.shards, 1);
+    }
+
+    /**
+     * @brief Sort the points by rowkey and write them into a new sstable
+     *
+     * @param sst_file path of the created sstable
+     */
+    Status write(const BuildOptionsRef& build_options,
+                 const std::vector<TrackPoint>& points,
+                 std::string* sst_file) {
+        if (points.empty()) {
+            return Status::NewInvalidArgument("no points to write");
+        }
+        struct Entry {
+            std::string rowkey;
+            uint64_t millis;
+            const TrackPoint* point;
+        };
+        std::vector<Entry> entries;
+        entries.reserve(points.size());
+        for (const auto& point : points) {
+            auto shard = static_cast<uint8_t>(std::hash<std::string_view>()(point.id) %
+                                              options_.shards);
+            entries.push_back({key_space_.to_idx_key(shard, point.id, point.x, point.y, point.time),
+                               detail::to_millis(point.time), &point});
+        }
+        // the same rowkey is ordered by timestamp descending, the same as cells
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+            int c = a.rowkey.compare(b.rowkey);
+            return c != 0 ? c < 0 : a.millis > b.millis;
+        });
+
+        SSTableBuilder builder(build_options);
+        auto st = builder.open();
+        if (!st.isOk()) {
+            return st;
+        }
+        for (const auto& entry : entries) {
+            builder.add(Cell(CellType::CT_PUT, entry.rowkey, "p", "",
+                             detail::encode_track_value(*entry.point), entry.millis));
+        }
+        st = builder.finish();
+        if (st.isOk() && sst_file != nullptr) {
+            *sst_file = builder.sstFile();
+        }
+        return st;
+    }
+
+    /**
+     * @brief Add an sstable created by write to the store
+     */
+    Status open(const ReadOptionsRef& options, const std::filesystem::path& sst_file) {
+        Status st;
+        auto table = SSTable::open(options, sst_file, &st);
+        if (!st.isOk()) {
+            return st;
+        }
+        tables_.emplace_back(std::move(table));
+        return st;
+    }
+
+    /**
+     * @brief Enumerate the (sstable, shard, bin) partitions of the query, ordered by bin, shard
+     * and sstable, so that the results of earlier time bins come first
+     */
+    std::vector<Z3QueryPart> plan(const Z3Query& query) {
+        auto values = key_space_.get_index_values(query.boxes, query.start, query.end);
+        auto ranges = key_space_.get_ranges(values, options_.max_ranges);
+
+        std::vector<Z3QueryPart> parts;
+        // the ranges are ordered by bin
+        for (auto first = ranges.begin(); first != ranges.end();) {
+            uint16_t bin = first->lower.bin();
+            auto last = std::find_if(first, ranges.end(), [bin](const Z3ScanRange& range) {
+                return range.lower.bin() != bin;
+            });
+            std::optional<Zrange> cube;
+            const auto& times = values.temporal_bounds[bin];
+            if (query.boxes.size() == 1 && times.size() == 1) {
+                const Box& box = query.boxes[0];
+                auto& sfc = key_space_.sfc();
+                cube.emplace(sfc.index(box.xmin, box.ymin, times[0].tmin),
+                             sfc.index(box.xmax, box.ymax, times[0].tmax));
+            }
+            for (uint8_t shard = 0; shard < options_.shards; ++shard) {
+                for (const auto& table : tables_) {
+                    parts.push_back({table.get(), shard, bin, {first, last}, cube});
+                }
+            }
+            first = last;
+        }
+        return parts;
+    }
+
+    Status query(const Z3Query& query,
+                 std::vector<TrackPoint>* results,
+                 Z3QueryStats* stats = nullptr) {
+        return query_stream(
+            query,
+            [results](const Z3QueryPart&, std::vector<TrackPoint>* points) {
+                results->insert(results->end(), std::make_move_iterator(points->begin()),
+                                std::make_move_iterator(points->end()));
+                return true;
+            },
+            stats);
+    }
+
+    /**
+     * @brief Scan the partitions of the query on the pool, at most max_inflight of them at the
+     * same time. The results are handed to the consumer in the order of the plan as soon as the
+     * partition and all partitions before it are finished.
+     *
+     * The calling thread blocks on the scans, so it must not be a worker of options.pool:
+     * with every worker waiting on its own query the scans would never run
+     */
+    Status query_stream(const Z3Query& query,
+                        const PartConsumer& consumer,
+                        Z3QueryStats* stats = nullptr) {
+        auto parts = plan(query);
+        Z3QueryStats total;
+        total.parts = parts.size();
+        for (const auto& part : parts) {
+            total.ranges += part.ranges.size();
+        }
+        if (!tables_.empty()) {
+            total.ranges /= tables_.size();
+        }
+
+        struct Output {
+            std::vector<TrackPoint> points;
+            Z3QueryStats stats;
+        };
+        auto finish = [&](const Z3QueryPart& part, Output* output, Status st) {
+            if (st.isOk()) {
+                total.scanned += output->stats.scanned;
+                total.matched += output->stats.matched;
+                total.skipped += output->stats.skipped;
+                if (!consumer(part, &output->points)) {
+                    // stopped by the consumer
+                    return false;
+                }
+            }
+            return st.isOk();
+        };
+
+        Status result = Status::NewOk();
+        if (options_.pool == nullptr) {
+            for (const auto& part : parts) {
+                Output output;
+                result = scan(query, part, &output.points, &output.stats);
+                if (!finish(part, &output, result)) {
+                    break;
+                }
+            }
+        } else {
+            std::size_t max_inflight = options_.max_inflight;
+            if (max_inflight == 0) {
+                max_inflight = std::max<std::size_t>(options_.pool->size() * 2, 1);
+            }
+            std::vector<Output> outputs(parts.size());
+            std::deque<std::future<Status>> inflight;
+            std::size_t next = 0;
+            auto submit = [&]() {
+                inflight.push_back(options_.pool->submit([this, &query, &parts, &outputs, next]() {
+                    return scan(query, parts[next], &outputs[next].points, &outputs[next].stats);
+                }));
+                ++next;
+            };
+            // the running scans refer to the locals, they must finish before returning or
+            // propagating an exception thrown by a scan, the pool or the consumer
+            auto wait_inflight = [&inflight]() {
+                for (auto& future : inflight) {
+                    if (future.valid()) {
+                        future.wait();
+                    }
+                }
+            };
+            try {
+                for (std::size_t i = 0; i < parts.size(); ++i) {
+                    while (next < parts.size() && inflight.size() < max_inflight) {
+                        submit();
+                    }
+                    result = inflight.front().get();
+                    inflight.pop_front();
+                    bool ok = finish(parts[i], &outputs[i], result);
+                    // release the results of the partition early
+                    std::vector<TrackPoint>().swap(outputs[i].points);
+                    if (!ok) {
+                        break;
+                    }
+                }
+            } catch (...) {
+                wait_inflight();
+                throw;
+            }
+            wait_inflight();
+        }
+        if (stats != nullptr) {
+            *stats = total;
+        }
+        return result;
+    }
+
+    [[nodiscard]] Z3IndexKeySpace<period>& key_space() { return key_space_; }
+
+    /**
+     * @brief Decode a cell written by write
+     */
+    static bool decode(const Cell& cell, TrackPoint* point, uint64_t* millis) {
+        Z3RowKey key{};
+        if (!Z3IndexKeySpace<period>::from_idx_key(cell.rowkey(), &key) ||
+            !detail::decode_track_value(cell.value(), point, millis)) {
+            return false;
+        }
+        point->id.assign(key.id);
+        point->time = TimePoint(std::chrono::milliseconds(*millis));
+        point->payload.assign(cell.value().substr(24));
+        return true;
+    }
+
+private:
+    static bool matches(const Z3Query& query, const TrackPoint& point, uint64_t millis) {
+        if (millis < detail::to_millis(query.start) || millis > detail::to_millis(query.end)) {
+            return false;
+        }
+        return std::any_of(query.boxes.begin(), query.boxes.end(), [&point](const Box& box) {
+            return point.x >= box.xmin && point.x <= box.xmax && point.y >= box.ymin &&
+                   point.y <= box.ymax;
+        });
+    }
+
+    static bool in_cube(const Zrange& cube, uint64_t z) {
+        auto [x, y, t] = Z3(z).decode();
+        auto [xmin, ymin, tmin] = Z3(cube.min).decode();
+        auto [xmax, ymax, tmax] = Z3(cube.max).decode();
+        return x >= xmin && x <= xmax && y >= ymin && y <= ymax && t >= tmin && t <= tmax;
+    }
+
+    Status scan(const Z3Query& query,
+                const Z3QueryPart& part,
+                std::vector<TrackPoint>* out,
+                Z3QueryStats* stats) const {
+        using KeySpace = Z3IndexKeySpace<period>;
+        const Zrange* cube = part.cube ? &*part.cube : nullptr;
+        auto iter = part.table->iterator();
+        for (const auto& range : part.ranges) {
+            ByteRange bytes = KeySpace::get_range_bytes(range, part.shard);
+            iter->seek(bytes.start);
+            while (iter->valid()) {
+                auto cell = iter->cell();
+                std::string_view rowkey = cell->rowkey();
+                if (!bytes.stop.empty() && rowkey >= bytes.stop) {
+                    break;
+                }
+                ++stats->scanned;
+                Z3RowKey key{};
+                if (!KeySpace::from_idx_key(rowkey, &key)) {
+                    return Status::NewCorruption("invalid z3 rowkey");
+                }
+                if (!range.contained && cube != nullptr && !in_cube(*cube, key.z)) {
+                    if (key.z > cube->max) {
+                        break;
+                    }
+                    uint64_t bigmin = cube->min;
+                    if (key.z > cube->min) {
+                        bigmin = Z3(0).zdivide(key.z, cube->min, cube->max).second;
+                    }
+                    if (bigmin > key.z) {
+                        ++stats->skipped;
+                        iter->seek(KeySpace::key_prefix(part.shard, key.bin, bigmin));
+                        continue;
+                    }
+                }
+                TrackPoint point;
+                uint64_t millis = 0;
+                if (!decode(*cell, &point, &millis)) {
+                    return Status::NewCorruption("invalid z3 value");
+                }
+                if (matches(query, point, millis)) {
+                    ++stats->matched;
+                    out->push_back(std::move(point));
+                }
+                iter->next();
+            }
+            // the sstable iterator reports NotFound once it is exhausted
+            if (!iter->status().isOk() && !iter->status().isNotFound()) {
+                return iter->status();
+            }
+        }
+        return Status::NewOk();
+    }
+
+private:
+    Options options_;
+    Z3IndexKeySpace<period> key_space_;
+    std::vector<SSTablePtr> tables_;
+};
+
+} // namespace pl::curve
@@ -0,0 +1,189 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+
+#include "cpp/pl/z3/z3_store.h"
+
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <random>
+
+namespace {
+
+using pl::BuildOptions;
+using pl::FilterPolicyType;
+using pl::ReadOptions;
+using pl::SSTable;
+using pl::SSTType;
+using pl::SSTVersion;
+using pl::curve::Box;
+using pl::curve::TimePeriod;
+using pl::curve::TimePoint;
+using pl::curve::TrackPoint;
+using pl::curve::Z3Query;
+using pl::curve::Z3QueryStats;
+using Store = pl::curve::Z3Store<TimePeriod::Week>;
+
+constexpr const char* DATA_DIR = "/tmp/z3_store_benchmark";
+
+/**
+ * 1000辆车在北京范围内随机游走一周，每5分钟一个点，共约两百万个点。
+ * 数据只生成一次，所有benchmark共用同一个sstable
+ */
+struct Dataset {
+    std::string sst_file;
+    TimePoint start{std::chrono::hours(24 * 19000)};
+    std::size_t points{0};
+
+    static Dataset& instance() {
+        static Dataset dataset;
+        return dataset;
+    }
+
+private:
+    Dataset() {
+        std::filesystem::remove_all(DATA_DIR);
+        std::filesystem::create_directories(std::string(DATA_DIR) + "/MAJOR");
+        auto build_options = std::make_shared<BuildOptions>();
+        build_options->data_dir = DATA_DIR;
+        build_options->sst_type = SSTType::MAJOR;
+        build_options->sst_version = SSTVersion::V1;
+        build_options->filter_type = FilterPolicyType::BLOOM_FILTER;
+
+        std::mt19937_64 rng(42);
+        std::uniform_real_distribution<double> step(-0.001, 0.001);
+        std::uniform_real_distribution<double> lon(115.7, 117.4);
+        std::uniform_real_distribution<double> lat(39.4, 41.0);
+        std::vector<TrackPoint> track;
+        for (int v = 0; v < 1000; ++v) {
+            double x = lon(rng);
+            double y = lat(rng);
+            for (int m = 0; m < 7 * 24 * 60; m += 5) {
+                x += step(rng);
+                y += step(rng);
+                track.push_back({"vehicle-" + std::to_string(v), x, y,
+                                 start + std::chrono::minutes(m), "gps"});
+            }
+        }
+        points = track.size();
+        Store store;
+        if (!store.write(build_options, track, &sst_file).isOk()) {
+            std::abort();
+        }
+    }
+};
+
+std::shared_ptr<ReadOptions> readOptions() { return std::make_shared<ReadOptions>(); }
+
+// 0.1° x 0.1°的范围，一小时
+Z3Query makeQuery(const Dataset& dataset) {
+    return {{{116.30, 39.90, 116.40, 40.00}},
+            dataset.start + std::chrono::hours(50),
+            dataset.start + std::chrono::hours(51)};
+}
+
+void BM_Z3Query(benchmark::State& state) {
+    auto& dataset = Dataset::instance();
+    Store::Options options;
+    options.max_ranges = static_cast<int32_t>(state.range(0));
+    Store store(options);
+    if (!store.open(readOptions(), dataset.sst_file).isOk()) {
+        state.SkipWithError("open sstable failed");
+        return;
+    }
+    Z3Query query = makeQuery(dataset);
+    Z3QueryStats stats;
+    std::vector<TrackPoint> results;
+    for (auto _ : state) {
+        results.clear();
+        (void)store.query(query, &results, &stats);
+        benchmark::DoNotOptimize(results.data());
+    }
+    state.counters["ranges"] = static_cast<double>(stats.ranges);
+    state.counters["scanned"] = static_cast<double>(stats.scanned);
+    state.counters["matched"] = static_cast<double>(stats.matched);
+}
+BENCHMARK(BM_Z3Query)->ArgName("max_ranges")->Arg(64)->Arg(512)->Arg(2000)->Unit(
+    benchmark::kMillisecond);
+
+void BM_FullScan(benchmark::State& state) {
+    auto& dataset = Dataset::instance();
+    pl::Status st;
+    auto table = SSTable::open(readOptions(), dataset.sst_file, &st);
+    if (!st.isOk()) {
+        state.SkipWithError("open sstable failed");
+        return;
+    }
+    Z3Query query = makeQuery(dataset);
+    const Box& box = query.boxes[0];
+    auto tmin = pl::curve::detail::to_millis(query.start);
+    auto tmax = pl::curve::detail::to_millis(query.end);
+    std::vector<TrackPoint> results;
+    uint64_t scanned = 0;
+    for (auto _ : state) {
+        results.clear();
+        scanned = 0;
+        auto iter = table->iterator();
+        for (iter->first(); iter->valid(); iter->next()) {
+            ++scanned;
+            TrackPoint point;
+            uint64_t millis = 0;
+            Store::decode(*iter->cell(), &point, &millis);
+            if (millis >= tmin && millis <= tmax && point.x >= box.xmin &&
+                point.x <= box.xmax && point.y >= box.ymin && point.y <= box.ymax) {
+                results.push_back(std::move(point));
+            }
+        }
+        benchmark::DoNotOptimize(results.data());
+    }
+    state.counters["scanned"] = static_cast<double>(scanned);
+    state.counters["matched"] = static_cast<double>(results.size());
+}
+BENCHMARK(BM_FullScan)->Unit(benchmark::kMillisecond);
+
+/**
+ * 整周的查询，按(shard, bin)拆分后在线程池中并发扫描，arg为线程数，0表示在调用线程中依次扫描
+ */
+void BM_Z3QueryFanOut(benchmark::State& state) {
+    auto& dataset = Dataset::instance();
+    std::unique_ptr<pl::ThreadPool> pool;
+    Store::Options options;
+    if (state.range(0) > 0) {
+        pool = std::make_unique<pl::ThreadPool>(state.range(0));
+        options.pool = pool.get();
+    }
+    Store store(options);
+    if (!store.open(readOptions(), dataset.sst_file).isOk()) {
+        state.SkipWithError("open sstable failed");
+        return;
+    }
+    Z3Query query{{{116.20, 39.80, 116.50, 40.10}},
+                  dataset.start,
+                  dataset.start + std::chrono::hours(7 * 24)};
+    Z3QueryStats stats;
+    std::vector<TrackPoint> results;
+    for (auto _ : state) {
+        results.clear();
+        (void)store.query(query, &results, &stats);
+        benchmark::DoNotOptimize(results.data());
+    }
+    state.counters["parts"] = static_cast<double>(stats.parts);
+    state.counters["matched"] = static_cast<double>(stats.matched);
+}
+BENCHMARK(BM_Z3QueryFanOut)->ArgName("threads")->Arg(0)->Arg(2)->Arg(4)->Arg(8)->Unit(
+    benchmark::kMillisecond)->UseRealTime();
+
+} // namespace
@@ -19,8 +19,13 @@
 #include "binned_time.h"
 #include "z3sfc.h"
 
+#include <algorithm>
+#include <chrono>
+#include <map>
 #include <memory>
+#include <string>
 #include <string_view>
+#include <vector>
 
 namespace pl::curve {
 
@@ -44,14 +49,66 @@ private:
     uint64_t z_;   // z3 value within the epoch
 };
 
-class Z3IndexValues {
-public:
-private:
-    std::vector<Box> spatial_bounds_;
+/**
+ * Decoded z3 rowkey, id points into the rowkey
+ */
+struct Z3RowKey {
+    uint8_t shard;
+    uint16_t bin;
+    uint64_t z;
+    std::string_view id;
+};
+
+/**
+ * Query values of the z3 index: spatial bounds, and temporal bounds for each time bin. The
+ * temporal bounds are offsets within the bin, in the unit of BinnedTime
+ */
+struct Z3IndexValues {
+    std::vector<Box> spatial_bounds;
+    std::map<uint16_t, std::vector<TimeRange>> temporal_bounds;
+};
+
+struct Z3ScanRange {
+    Z3IndexKey lower;
+    Z3IndexKey upper;
+    bool contained;
+};
+
+/**
+ * Rowkey range [start, stop), an empty stop means unbounded
+ */
+struct ByteRange {
+    std::string start;
+    std::string stop;
+    bool contained;
 };
 
+namespace detail {
+
+// big endian, so that rowkeys sort in the same order as the numbers
+template <typename T> void append_big_endian(std::string* dst, T value) {
+    for (int i = static_cast<int>(sizeof(T)) - 1; i >= 0; --i) {
+        dst->push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+    }
+}
+
+template <typename T> T read_big_endian(const char* src) {
+    T value = 0;
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        value = static_cast<T>((value << 8) | static_cast<uint8_t>(src[i]));
+    }
+    return value;
+}
+
+} // namespace detail
+
 template <TimePeriod period> class Z3IndexKeySpace {
 public:
+    using TimePoint = std::chrono::time_point<std::chrono::system_clock>;
+
+    static constexpr std::size_t KEY_PREFIX_LEN = 11;
+    static constexpr int32_t DEFAULT_MAX_RANGES = 2000;
+
     Z3IndexKeySpace() { sfc_ = std::make_unique<Z3SFC<period>>(); }
 
     /**
@@ -59,27 +116,153 @@ public:
      * | shard id | epoch time | z3(x, y, t) | feathre id |
      * +----------+------------+-------------+------------+
      * |<-- 1B -->|<--  2B  -->|<--   8B  -->|<--  ... -->|
+     *
+     * epoch time and z3 are big endian
      */
     std::string to_idx_key(uint8_t shard,
                            std::string_view id,
                            double x,
                            double y,
-                           const std::chrono::time_point<std::chrono::system_clock>& time) {
-        std::string rowkey;
-        rowkey.reserve(11 + id.size());
+                           const TimePoint& time) {
         auto binned_time = BinnedTime<period>::of(time);
         auto z = sfc_->index(x, y, binned_time.offset());
 
-        rowkey.append(reinterpret_cast<const char*>(&shard), sizeof(shard)); // 1 byte
-        rowkey.append(reinterpret_cast<const char*>(&binned_time.bin()),
-                      sizeof(binned_time.bin()));                    // 2 byte
-        rowkey.append(reinterpret_cast<const char*>(&z), sizeof(z)); // 8 byte
+        std::string rowkey;
+        rowkey.reserve(KEY_PREFIX_LEN + id.size());
+        append_key_prefix(&rowkey, shard, binned_time.bin(), z);
         rowkey.append(id);
         return rowkey;
     }
 
-    // TODO
-    void get_ranges() {}
+    /**
+     * @brief Decode a rowkey created by to_idx_key
+     *
+     * @return false if the rowkey is too short
+     */
+    static bool from_idx_key(std::string_view rowkey, Z3RowKey* key) {
+        if (rowkey.size() < KEY_PREFIX_LEN) {
+            return false;
+        }
+        key->shard = static_cast<uint8_t>(rowkey[0]);
+        key->bin = detail::read_big_endian<uint16_t>(rowkey.data() + 1);
+        key->z = detail::read_big_endian<uint64_t>(rowkey.data() + 3);
+        key->id = rowkey.substr(KEY_PREFIX_LEN);
+        return true;
+    }
+
+    /**
+     * @brief Split the time interval [start, end] into time bins
+     */
+    Z3IndexValues get_index_values(const std::vector<Box>& boxes,
+                                   const TimePoint& start,
+                                   const TimePoint& end) const {
+        Z3IndexValues values;
+        if (end < start) {
+            return values;
+        }
+        values.spatial_bounds = boxes;
+        auto lower = BinnedTime<period>::of(start);
+        auto upper = BinnedTime<period>::of(end);
+        constexpr uint64_t max_offset = BinnedTime<period>::max_offset();
+        if (lower.bin() == upper.bin()) {
+            values.temporal_bounds[lower.bin()].push_back({lower.offset(), upper.offset()});
+            return values;
+        }
+        values.temporal_bounds[lower.bin()].push_back({lower.offset(), max_offset});
+        for (uint32_t bin = lower.bin() + 1U; bin < upper.bin(); ++bin) {
+            values.temporal_bounds[static_cast<uint16_t>(bin)].push_back({0, max_offset});
+        }
+        values.temporal_bounds[upper.bin()].push_back({0, upper.offset()});
+        return values;
+    }
+
+    /**
+     * @brief Calculates the z3 ranges of each time bin. max_ranges is shared by all bins, and
+     * the ranges of whole bins are only calculated once
+     */
+    std::vector<Z3ScanRange> get_ranges(const Z3IndexValues& values,
+                                        int32_t max_ranges = DEFAULT_MAX_RANGES) {
+        std::vector<Z3ScanRange> result;
+        if (values.spatial_bounds.empty() || values.temporal_bounds.empty()) {
+            return result;
+        }
+        constexpr uint64_t max_offset = BinnedTime<period>::max_offset();
+        int32_t target = std::max<int32_t>(
+            1, max_ranges / static_cast<int32_t>(values.temporal_bounds.size()));
+
+        std::vector<IndexRange> whole;
+        std::vector<IndexRange> partial;
+        for (const auto& [bin, times] : values.temporal_bounds) {
+            const std::vector<IndexRange>* zranges = nullptr;
+            if (times.size() == 1 && times[0].tmin == 0 && times[0].tmax >= max_offset) {
+                if (whole.empty()) {
+                    sfc_->ranges(values.spatial_bounds, {{0, max_offset}}, 64, target, &whole);
+                }
+                zranges = &whole;
+            } else {
+                partial.clear();
+                sfc_->ranges(values.spatial_bounds, times, 64, target, &partial);
+                zranges = &partial;
+            }
+            for (const auto& r : *zranges) {
+                result.push_back({Z3IndexKey(bin, r.lower), Z3IndexKey(bin, r.upper), r.contained});
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Convert the z3 ranges to rowkey ranges of every shard, sorted by rowkey
+     */
+    static std::vector<ByteRange> get_range_bytes(const std::vector<Z3ScanRange>& ranges,
+                                                  uint8_t shards = 1) {
+        std::vector<ByteRange> result;
+        result.reserve(ranges.size() * std::max<std::size_t>(shards, 1));
+        for (uint32_t i = 0; i < std::max<uint32_t>(shards, 1); ++i) {
+            for (const auto& range : ranges) {
+                result.push_back(get_range_bytes(range, static_cast<uint8_t>(i)));
+            }
+        }
+        return result;
+    }
+
+    static ByteRange get_range_bytes(const Z3ScanRange& range, uint8_t shard) {
+        ByteRange r{key_prefix(shard, range.lower.bin(), range.lower.z()),
+                    key_prefix(shard, range.upper.bin(), range.upper.z()), range.contained};
+        next_prefix(&r.stop);
+        return r;
+    }
+
+    /**
+     * @brief The fixed length part of a rowkey, all rowkeys of the z3 cell start with it
+     */
+    static std::string key_prefix(uint8_t shard, uint16_t bin, uint64_t z) {
+        std::string prefix;
+        prefix.reserve(KEY_PREFIX_LEN);
+        append_key_prefix(&prefix, shard, bin, z);
+        return prefix;
+    }
+
+    [[nodiscard]] Z3SFC<period>& sfc() const { return *sfc_; }
+
+private:
+    static void append_key_prefix(std::string* dst, uint8_t shard, uint16_t bin, uint64_t z) {
+        dst->push_back(static_cast<char>(shard));
+        detail::append_big_endian(dst, bin);
+        detail::append_big_endian(dst, z);
+    }
+
+    // the smallest key greater than every key with the prefix, empty if there is none
+    static void next_prefix(std::string* prefix) {
+        while (!prefix->empty()) {
+            auto& c = prefix->back();
+            if (static_cast<uint8_t>(c) != 0xFF) {
+                c = static_cast<char>(static_cast<uint8_t>(c) + 1);
+                return;
+            }
+            prefix->pop_back();
+        }
+    }
 
 private:
     std::unique_ptr<Z3SFC<period>> sfc_;
@@ -20,40 +20,92 @@
 #include "dimension.h"
 #include "types.h"
 #include "z3.h"
+#include "zbatch.h"
 
-#include <memory>
+#include <algorithm>
+#include <cassert>
+#include <span>
 #include <vector>
 
 namespace pl::curve {
 
 template <TimePeriod period> class Z3SFC {
 public:
-    Z3SFC(uint32_t precision) {
-        // precision (bits) per dimendion must be in [1, 21];
+    // precision (bits) per dimendion must be in [1, 21];
+    Z3SFC(uint32_t precision)
+        : lon_(precision),
+          lat_(precision),
+          time_(precision, BinnedTime<period>::max_offset()) {
         assert(precision > 0 && precision < 22);
-        lon_ = std::make_unique<NormalizedLon>(precision);
-        lat_ = std::make_unique<NormalizedLat>(precision);
-        time_ = std::make_unique<NormalizedTime>(precision, BinnedTime<period>::max_offset());
     }
 
     Z3SFC() : Z3SFC<period>(21) {}
 
     uint64_t index(double x, double y, uint64_t t) {
-        return Z3(lon_->normalize(x), lat_->normalize(y), time_->normalize(t)).val();
+        return Z3(lon_.normalize(x), lat_.normalize(y), time_.normalize(t)).val();
     }
 
-    std::tuple<double, double, uint64_t> invert(uint64_t z) { return Z3(z).decode(); }
+    /**
+     * @brief Batch version of index, out[i] = index(x[i], y[i], t[i])
+     */
+    void index(std::span<const double> x,
+               std::span<const double> y,
+               std::span<const uint64_t> t,
+               std::span<uint64_t> out) const {
+        assert(x.size() == y.size() && x.size() == t.size() && x.size() <= out.size());
+        uint32_t nx[BATCH_SIZE];
+        uint32_t ny[BATCH_SIZE];
+        uint32_t nt[BATCH_SIZE];
+        for (std::size_t i = 0; i < x.size(); i += BATCH_SIZE) {
+            std::size_t n = std::min(BATCH_SIZE, x.size() - i);
+            lon_.normalize(x.data() + i, n, nx);
+            lat_.normalize(y.data() + i, n, ny);
+            time_.normalize(t.data() + i, n, nt);
+            zbatch::z3_encode(nx, ny, nt, n, out.data() + i);
+        }
+    }
+
+    std::tuple<double, double, uint64_t> invert(uint64_t z) {
+        auto [x, y, t] = Z3(z).decode();
+        return {lon_.denormalize(x), lat_.denormalize(y),
+                static_cast<uint64_t>(time_.denormalize(t))};
+    }
 
+    /**
+     * @brief Calculates z3 ranges covering every combination of spatial and temporal bounds.
+     * The result is sorted by lower and the ranges do not overlap
+     *
+     * @param xy spatial bounds
+     * @param t temporal bounds, offsets within a BinnedTime period
+     * @param precision precision to consider, in bits (max 64)
+     * @param max_ranges loose cap on the number of ranges to return
+     * @param idx_ranges
+     * @param max_recurse max levels of recursion to apply before stopping
+     */
     void ranges(const std::vector<Box>& xy,
                 const std::vector<TimeRange>& t,
                 int32_t precision,
                 int32_t max_ranges,
-                std::vector<IndexRange>* idx_ranges) {}
+                std::vector<IndexRange>* idx_ranges,
+                int32_t max_recurse = Z3::DEFAULT_RECURSE) {
+        std::vector<Zrange> zbounds;
+        zbounds.reserve(xy.size() * t.size());
+        for (const auto& box : xy) {
+            for (const auto& range : t) {
+                zbounds.emplace_back(index(box.xmin, box.ymin, range.tmin),
+                                     index(box.xmax, box.ymax, range.tmax));
+            }
+        }
+        Z3(0).zranges(zbounds, precision, max_ranges, max_recurse, idx_ranges);
+    }
 
 private:
-    std::unique_ptr<NormalizedDimension> lon_;
-    std::unique_ptr<NormalizedDimension> lat_;
-    std::unique_ptr<NormalizedDimension> time_;
+    static constexpr std::size_t BATCH_SIZE = 256;
+
+    // concrete types, so that the calls are not virtual
+    NormalizedLon lon_;
+    NormalizedLat lat_;
+    NormalizedTime time_;
 };
 
 } // namespace pl::curve
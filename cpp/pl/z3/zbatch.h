@@ -0,0 +1,360 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#pragma once
+
+#include "cpp/pl/bits/cpu.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+/**
+ * Batch encoding and decoding of z2/z3 values. The same work is implemented with scalar magic
+ * masks (also used by Z2/Z3), with BMI2 pdep/pext and with AVX2 (4 values per instruction),
+ * the implementation is selected by the cpu features at runtime
+ */
+namespace pl::curve::zbatch {
+
+enum class Isa {
+    SCALAR,
+    AVX2,
+    BMI2,
+};
+
+namespace detail {
+
+// bits of a single dimension in z2/z3 values, 31 bits for z2 and 21 bits for z3
+constexpr uint64_t Z2_MASK = 0x1555555555555555UL;
+constexpr uint64_t Z3_MASK = 0x1249249249249249UL;
+
+inline uint64_t z2_split(uint64_t x) {
+    x &= 0x7FFFFFFFUL;
+    x = (x | x << 16) & 0x0000FFFF0000FFFFUL;
+    x = (x | x << 8) & 0x00FF00FF00FF00FFUL;
+    x = (x | x << 4) & 0x0F0F0F0F0F0F0F0FUL;
+    x = (x | x << 2) & 0x3333333333333333UL;
+    x = (x | x << 1) & 0x5555555555555555UL;
+    return x;
+}
+
+inline uint64_t z2_combine(uint64_t z) {
+    uint64_t x = z & 0x5555555555555555UL;
+    x = (x ^ (x >> 1)) & 0x3333333333333333UL;
+    x = (x ^ (x >> 2)) & 0x0F0F0F0F0F0F0F0FUL;
+    x = (x ^ (x >> 4)) & 0x00FF00FF00FF00FFUL;
+    x = (x ^ (x >> 8)) & 0x0000FFFF0000FFFFUL;
+    x = (x ^ (x >> 16)) & 0x7FFFFFFFUL;
+    return x;
+}
+
+inline uint64_t z3_split(uint64_t x) {
+    x &= 0x1FFFFFUL;
+    x = (x | x << 32) & 0x1F00000000FFFFUL;
+    x = (x | x << 16) & 0x1F0000FF0000FFUL;
+    x = (x | x << 8) & 0x100F00F00F00F00FUL;
+    x = (x | x << 4) & 0x10C30C30C30C30C3UL;
+    x = (x | x << 2) & 0x1249249249249249UL;
+    return x;
+}
+
+inline uint64_t z3_combine(uint64_t z) {
+    uint64_t x = z & 0x1249249249249249UL;
+    x = (x ^ (x >> 2)) & 0x10C30C30C30C30C3UL;
+    x = (x ^ (x >> 4)) & 0x100F00F00F00F00FUL;
+    x = (x ^ (x >> 8)) & 0x1F0000FF0000FFUL;
+    x = (x ^ (x >> 16)) & 0x1F00000000FFFFUL;
+    x = (x ^ (x >> 32)) & 0x1FFFFFUL;
+    return x;
+}
+
+inline void z2_encode_scalar(const uint32_t* x, const uint32_t* y, std::size_t n, uint64_t* out) {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = z2_split(x[i]) | z2_split(y[i]) << 1;
+    }
+}
+
+inline void z2_decode_scalar(const uint64_t* z, std::size_t n, uint32_t* x, uint32_t* y) {
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = static_cast<uint32_t>(z2_combine(z[i]));
+        y[i] = static_cast<uint32_t>(z2_combine(z[i] >> 1));
+    }
+}
+
+inline void z3_encode_scalar(
+    const uint32_t* x, const uint32_t* y, const uint32_t* t, std::size_t n, uint64_t* out) {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = z3_split(x[i]) | z3_split(y[i]) << 1 | z3_split(t[i]) << 2;
+    }
+}
+
+inline void z3_decode_scalar(
+    const uint64_t* z, std::size_t n, uint32_t* x, uint32_t* y, uint32_t* t) {
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = static_cast<uint32_t>(z3_combine(z[i]));
+        y[i] = static_cast<uint32_t>(z3_combine(z[i] >> 1));
+        t[i] = static_cast<uint32_t>(z3_combine(z[i] >> 2));
+    }
+}
+
+#if defined(__x86_64__)
+
+__attribute__((target("bmi2"))) inline void z2_encode_bmi2(const uint32_t* x,
+                                                            const uint32_t* y,
+                                                            std::size_t n,
+                                                            uint64_t* out) {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = _pdep_u64(x[i], Z2_MASK) | _pdep_u64(y[i], Z2_MASK << 1);
+    }
+}
+
+__attribute__((target("bmi2"))) inline void z2_decode_bmi2(const uint64_t* z,
+                                                            std::size_t n,
+                                                            uint32_t* x,
+                                                            uint32_t* y) {
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = static_cast<uint32_t>(_pext_u64(z[i], Z2_MASK));
+        y[i] = static_cast<uint32_t>(_pext_u64(z[i], Z2_MASK << 1));
+    }
+}
+
+__attribute__((target("bmi2"))) inline void z3_encode_bmi2(
+    const uint32_t* x, const uint32_t* y, const uint32_t* t, std::size_t n, uint64_t* out) {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = _pdep_u64(x[i], Z3_MASK) | _pdep_u64(y[i], Z3_MASK << 1) |
+                 _pdep_u64(t[i], Z3_MASK << 2);
+    }
+}
+
+__attribute__((target("bmi2"))) inline void z3_decode_bmi2(
+    const uint64_t* z, std::size_t n, uint32_t* x, uint32_t* y, uint32_t* t) {
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = static_cast<uint32_t>(_pext_u64(z[i], Z3_MASK));
+        y[i] = static_cast<uint32_t>(_pext_u64(z[i], Z3_MASK << 1));
+        t[i] = static_cast<uint32_t>(_pext_u64(z[i], Z3_MASK << 2));
+    }
+}
+
+// the same steps as the scalar magic masks, 4 values at a time
+#define ZBATCH_STEP(v, shift, mask)                                                               \
+    v = _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi64(v, shift)),                        \
+                         _mm256_set1_epi64x(static_cast<int64_t>(mask)))
+
+#define ZBATCH_UNSTEP(v, shift, mask)                                                             \
+    v = _mm256_and_si256(_mm256_xor_si256(v, _mm256_srli_epi64(v, shift)),                       \
+                         _mm256_set1_epi64x(static_cast<int64_t>(mask)))
+
+__attribute__((target("avx2"))) inline __m256i z2_split_avx2(const uint32_t* p) {
+    __m256i v = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    v = _mm256_and_si256(v, _mm256_set1_epi64x(0x7FFFFFFFL));
+    ZBATCH_STEP(v, 16, 0x0000FFFF0000FFFFUL);
+    ZBATCH_STEP(v, 8, 0x00FF00FF00FF00FFUL);
+    ZBATCH_STEP(v, 4, 0x0F0F0F0F0F0F0F0FUL);
+    ZBATCH_STEP(v, 2, 0x3333333333333333UL);
+    ZBATCH_STEP(v, 1, 0x5555555555555555UL);
+    return v;
+}
+
+__attribute__((target("avx2"))) inline void z2_combine_avx2(__m256i z, uint32_t* p) {
+    __m256i v = _mm256_and_si256(z, _mm256_set1_epi64x(static_cast<int64_t>(Z2_MASK)));
+    ZBATCH_UNSTEP(v, 1, 0x3333333333333333UL);
+    ZBATCH_UNSTEP(v, 2, 0x0F0F0F0F0F0F0F0FUL);
+    ZBATCH_UNSTEP(v, 4, 0x00FF00FF00FF00FFUL);
+    ZBATCH_UNSTEP(v, 8, 0x0000FFFF0000FFFFUL);
+    ZBATCH_UNSTEP(v, 16, 0x7FFFFFFFUL);
+    // the low 32 bits of the 4 lanes
+    v = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm256_castsi256_si128(v));
+}
+
+__attribute__((target("avx2"))) inline __m256i z3_split_avx2(const uint32_t* p) {
+    __m256i v = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    v = _mm256_and_si256(v, _mm256_set1_epi64x(0x1FFFFFL));
+    ZBATCH_STEP(v, 32, 0x1F00000000FFFFUL);
+    ZBATCH_STEP(v, 16, 0x1F0000FF0000FFUL);
+    ZBATCH_STEP(v, 8, 0x100F00F00F00F00FUL);
+    ZBATCH_STEP(v, 4, 0x10C30C30C30C30C3UL);
+    ZBATCH_STEP(v, 2, 0x1249249249249249UL);
+    return v;
+}
+
+__attribute__((target("avx2"))) inline void z3_combine_avx2(__m256i z, uint32_t* p) {
+    __m256i v = _mm256_and_si256(z, _mm256_set1_epi64x(static_cast<int64_t>(Z3_MASK)));
+    ZBATCH_UNSTEP(v, 2, 0x10C30C30C30C30C3UL);
+    ZBATCH_UNSTEP(v, 4, 0x100F00F00F00F00FUL);
+    ZBATCH_UNSTEP(v, 8, 0x1F0000FF0000FFUL);
+    ZBATCH_UNSTEP(v, 16, 0x1F00000000FFFFUL);
+    ZBATCH_UNSTEP(v, 32, 0x1FFFFFUL);
+    v = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm256_castsi256_si128(v));
+}
+
+#undef ZBATCH_STEP
+#undef ZBATCH_UNSTEP
+
+__attribute__((target("avx2"))) inline void z2_encode_avx2(const uint32_t* x,
+                                                            const uint32_t* y,
+                                                            std::size_t n,
+                                                            uint64_t* out) {
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i z = _mm256_or_si256(z2_split_avx2(x + i),
+                                    _mm256_slli_epi64(z2_split_avx2(y + i), 1));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), z);
+    }
+    z2_encode_scalar(x + i, y + i, n - i, out + i);
+}
+
+__attribute__((target("avx2"))) inline void z2_decode_avx2(const uint64_t* z,
+                                                            std::size_t n,
+                                                            uint32_t* x,
+                                                            uint32_t* y) {
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(z + i));
+        z2_combine_avx2(v, x + i);
+        z2_combine_avx2(_mm256_srli_epi64(v, 1), y + i);
+    }
+    z2_decode_scalar(z + i, n - i, x + i, y + i);
+}
+
+__attribute__((target("avx2"))) inline void z3_encode_avx2(
+    const uint32_t* x, const uint32_t* y, const uint32_t* t, std::size_t n, uint64_t* out) {
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i z = _mm256_or_si256(
+            _mm256_or_si256(z3_split_avx2(x + i), _mm256_slli_epi64(z3_split_avx2(y + i), 1)),
+            _mm256_slli_epi64(z3_split_avx2(t + i), 2));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), z);
+    }
+    z3_encode_scalar(x + i, y + i, t + i, n - i, out + i);
+}
+
+__attribute__((target("avx2"))) inline void z3_decode_avx2(
+    const uint64_t* z, std::size_t n, uint32_t* x, uint32_t* y, uint32_t* t) {
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(z + i));
+        z3_combine_avx2(v, x + i);
+        z3_combine_avx2(_mm256_srli_epi64(v, 1), y + i);
+        z3_combine_avx2(_mm256_srli_epi64(v, 2), t + i);
+    }
+    z3_decode_scalar(z + i, n - i, x + i, y + i, t + i);
+}
+
+#endif
+
+} // namespace detail
+
+/**
+ * @brief Whether the isa is supported by the current cpu
+ */
+inline bool supported(Isa isa) {
+#if defined(__x86_64__)
+    switch (isa) {
+    case Isa::BMI2:
+        return __builtin_cpu_supports("bmi2");
+    case Isa::AVX2:
+        return __builtin_cpu_supports("avx2");
+    default:
+        return true;
+    }
+#else
+    return isa == Isa::SCALAR;
+#endif
+}
+
+/**
+ * @brief The isa used by default, pdep/pext need the fewest instructions per value, so BMI2
+ * is preferred if it is fast, then AVX2
+ */
+inline Isa best_isa() {
+    static const Isa isa = pl::fast_bmi2()        ? Isa::BMI2
+                           : supported(Isa::AVX2) ? Isa::AVX2
+                                                  : Isa::SCALAR;
+    return isa;
+}
+
+/**
+ * @brief out[i] = Z2(x[i], y[i]), only the lowest 31 bits of x and y are considered
+ */
+inline void z2_encode(
+    const uint32_t* x, const uint32_t* y, std::size_t n, uint64_t* out, Isa isa = best_isa()) {
+#if defined(__x86_64__)
+    if (isa == Isa::BMI2) {
+        return detail::z2_encode_bmi2(x, y, n, out);
+    }
+    if (isa == Isa::AVX2) {
+        return detail::z2_encode_avx2(x, y, n, out);
+    }
+#endif
+    detail::z2_encode_scalar(x, y, n, out);
+}
+
+inline void z2_decode(
+    const uint64_t* z, std::size_t n, uint32_t* x, uint32_t* y, Isa isa = best_isa()) {
+#if defined(__x86_64__)
+    if (isa == Isa::BMI2) {
+        return detail::z2_decode_bmi2(z, n, x, y);
+    }
+    if (isa == Isa::AVX2) {
+        return detail::z2_decode_avx2(z, n, x, y);
+    }
+#endif
+    detail::z2_decode_scalar(z, n, x, y);
+}
+
+/**
+ * @brief out[i] = Z3(x[i], y[i], t[i]), only the lowest 21 bits of x, y and t are considered
+ */
+inline void z3_encode(const uint32_t* x,
+                      const uint32_t* y,
+                      const uint32_t* t,
+                      std::size_t n,
+                      uint64_t* out,
+                      Isa isa = best_isa()) {
+#if defined(__x86_64__)
+    if (isa == Isa::BMI2) {
+        return detail::z3_encode_bmi2(x, y, t, n, out);
+    }
+    if (isa == Isa::AVX2) {
+        return detail::z3_encode_avx2(x, y, t, n, out);
+    }
+#endif
+    detail::z3_encode_scalar(x, y, t, n, out);
+}
+
+inline void z3_decode(const uint64_t* z,
+                      std::size_t n,
+                      uint32_t* x,
+                      uint32_t* y,
+                      uint32_t* t,
+                      Isa isa = best_isa()) {
+#if defined(__x86_64__)
+    if (isa == Isa::BMI2) {
+        return detail::z3_decode_bmi2(z, n, x, y, t);
+    }
+    if (isa == Isa::AVX2) {
+        return detail::z3_decode_avx2(z, n, x, y, t);
+    }
+#endif
+    detail::z3_decode_scalar(z, n, x, y, t);
+}
+
+} // namespace pl::curve::zbatch
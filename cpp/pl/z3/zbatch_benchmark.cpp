@@ -0,0 +1,148 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/z3/z3sfc.h"
+#include "cpp/pl/z3/zbatch.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+
+namespace {
+
+using pl::curve::BinnedTime;
+using pl::curve::TimePeriod;
+using pl::curve::Z3;
+using pl::curve::Z3SFC;
+namespace zbatch = pl::curve::zbatch;
+
+constexpr std::size_t N = 1 << 16;
+
+struct Points {
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<uint64_t> t;
+
+    Points() : x(N), y(N), t(N) {
+        std::mt19937_64 rng(42);
+        std::uniform_real_distribution<double> lon(-180.0, 180.0);
+        std::uniform_real_distribution<double> lat(-90.0, 90.0);
+        for (std::size_t i = 0; i < N; ++i) {
+            x[i] = lon(rng);
+            y[i] = lat(rng);
+            t[i] = rng() % BinnedTime<TimePeriod::Week>::max_offset();
+        }
+    }
+};
+
+const Points& points() {
+    static const Points p;
+    return p;
+}
+
+/**
+ * 逐点通过Z3SFC::index(double, double, uint64_t)编码
+ */
+void BM_Z3IndexScalar(benchmark::State& state) {
+    const auto& p = points();
+    Z3SFC<TimePeriod::Week> sfc;
+    std::vector<uint64_t> out(N);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < N; ++i) {
+            out[i] = sfc.index(p.x[i], p.y[i], p.t[i]);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.counters["points/s"] = benchmark::Counter(static_cast<double>(state.iterations() * N),
+                                                    benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Z3IndexScalar)->Unit(benchmark::kMicrosecond);
+
+/**
+ * 批量编码，包括归一化
+ */
+void BM_Z3IndexBatch(benchmark::State& state) {
+    const auto& p = points();
+    Z3SFC<TimePeriod::Week> sfc;
+    std::vector<uint64_t> out(N);
+    for (auto _ : state) {
+        sfc.index(p.x, p.y, p.t, out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.counters["points/s"] = benchmark::Counter(static_cast<double>(state.iterations() * N),
+                                                    benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Z3IndexBatch)->Unit(benchmark::kMicrosecond);
+
+/**
+ * 只比较不同指令集的交织部分，arg为zbatch::Isa
+ */
+void BM_Z3Encode(benchmark::State& state) {
+    auto isa = static_cast<zbatch::Isa>(state.range(0));
+    if (!zbatch::supported(isa)) {
+        state.SkipWithError("isa not supported");
+        return;
+    }
+    std::mt19937 rng(7);
+    std::vector<uint32_t> x(N), y(N), t(N);
+    for (std::size_t i = 0; i < N; ++i) {
+        x[i] = rng() & 0x1FFFFF;
+        y[i] = rng() & 0x1FFFFF;
+        t[i] = rng() & 0x1FFFFF;
+    }
+    std::vector<uint64_t> out(N);
+    for (auto _ : state) {
+        zbatch::z3_encode(x.data(), y.data(), t.data(), N, out.data(), isa);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.counters["points/s"] = benchmark::Counter(static_cast<double>(state.iterations() * N),
+                                                    benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Z3Encode)
+    ->ArgName("isa")
+    ->Arg(static_cast<int>(zbatch::Isa::SCALAR))
+    ->Arg(static_cast<int>(zbatch::Isa::AVX2))
+    ->Arg(static_cast<int>(zbatch::Isa::BMI2))
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_Z3Decode(benchmark::State& state) {
+    auto isa = static_cast<zbatch::Isa>(state.range(0));
+    if (!zbatch::supported(isa)) {
+        state.SkipWithError("isa not supported");
+        return;
+    }
+    std::mt19937_64 rng(7);
+    std::vector<uint64_t> z(N);
+    for (auto& v : z) {
+        v = rng() & 0x7FFFFFFFFFFFFFFFUL;
+    }
+    std::vector<uint32_t> x(N), y(N), t(N);
+    for (auto _ : state) {
+        zbatch::z3_decode(z.data(), N, x.data(), y.data(), t.data(), isa);
+        benchmark::DoNotOptimize(x.data());
+        benchmark::DoNotOptimize(y.data());
+        benchmark::DoNotOptimize(t.data());
+    }
+    state.counters["points/s"] = benchmark::Counter(static_cast<double>(state.iterations() * N),
+                                                    benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Z3Decode)
+    ->ArgName("isa")
+    ->Arg(static_cast<int>(zbatch::Isa::SCALAR))
+    ->Arg(static_cast<int>(zbatch::Isa::AVX2))
+    ->Arg(static_cast<int>(zbatch::Isa::BMI2))
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace
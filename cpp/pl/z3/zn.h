@@ -18,6 +18,8 @@
 
 #include "types.h"
 
+#include <algorithm>
+#include <cassert>
 #include <cmath>
 #include <cstdint>
 #include <functional>
@@ -86,8 +88,11 @@ public:
     [[nodiscard]] std::pair<uint64_t, uint64_t> zdivide(uint64_t p,
                                                         uint64_t rmin,
                                                         uint64_t rmax) const {
-        // TODO:
-        return {0, 0};
+        return zdiv(
+            [this](uint64_t target, uint64_t value, uint32_t bits, uint32_t dim) {
+                return load(target, value, bits, dim);
+            },
+            DIMS, p, rmin, rmax);
     }
 
     /**
@@ -105,10 +110,77 @@ public:
                  int32_t precision,
                  int32_t max_ranges,
                  int32_t max_recurse,
-                 std::vector<IndexRange>* idx_ranges) {
-        // TODO:
+                 std::vector<IndexRange>* idx_ranges) const {
+        if (zbounds.empty()) {
+            return;
+        }
+        std::vector<IndexRange> ranges;
+        // quadrants of the current level that partially overlap the search space
+        std::vector<Zrange> remaining;
+        std::vector<Zrange> next;
+
+        auto is_contained = [this, &zbounds](const Zrange& range) {
+            return std::any_of(zbounds.begin(), zbounds.end(), [this, &range](const Zrange& b) {
+                return contains(b, range);
+            });
+        };
+        auto is_overlapped = [this, &zbounds](const Zrange& range) {
+            return std::any_of(zbounds.begin(), zbounds.end(), [this, &range](const Zrange& b) {
+                return overlaps(b, range);
+            });
+        };
+
+        // only the bits after the common prefix need to be divided
+        std::vector<uint64_t> values;
+        values.reserve(zbounds.size() * 2);
+        for (const auto& b : zbounds) {
+            values.push_back(b.min);
+            values.push_back(b.max);
+        }
+        auto [common_prefix, common_bits] = max_common_prefix(values);
+        int32_t offset = 64 - common_bits;
+
+        // a quadrant either matches entirely (or reached the precision), is out of bounds,
+        // or is queued up to be divided in the next level
+        auto check_value = [&](uint64_t prefix, uint64_t quad, std::vector<Zrange>* out) {
+            uint64_t min = offset >= 64 ? prefix : prefix | (quad << offset);
+            uint64_t max = min | (offset >= 64 ? UINT64_MAX : (uint64_t{1} << offset) - 1);
+            Zrange quadrant(min, max);
+            if (is_contained(quadrant) || offset < 64 - precision) {
+                ranges.push_back({min, max, true});
+            } else if (is_overlapped(quadrant)) {
+                out->push_back(quadrant);
+            }
+        };
+
+        check_value(common_prefix, 0, &remaining);
+        int32_t level = 0;
+        while (level < max_recurse && !remaining.empty() &&
+               ranges.size() < static_cast<std::size_t>(max_ranges) && offset >= DIMS) {
+            offset -= DIMS;
+            std::size_t i = 0;
+            for (; i < remaining.size() && ranges.size() < static_cast<std::size_t>(max_ranges);
+                 ++i) {
+                for (uint64_t quad = 0; quad < QUADRANTS; ++quad) {
+                    check_value(remaining[i].min, quad, &next);
+                }
+            }
+            // reached max_ranges, keep the unprocessed quadrants as partial matches
+            for (; i < remaining.size(); ++i) {
+                ranges.push_back({remaining[i].min, remaining[i].max, false});
+            }
+            remaining.swap(next);
+            next.clear();
+            ++level;
+        }
+        for (const auto& range : remaining) {
+            ranges.push_back({range.min, range.max, false});
+        }
+        merge_ranges(&ranges, idx_ranges);
     }
 
+    static constexpr int32_t DEFAULT_RECURSE = 7;
+
 protected:
     using LoadFunc = std::function<uint64_t(uint64_t, uint64_t, uint32_t, uint32_t)>;
 
@@ -124,17 +196,17 @@ protected:
      * @param rmax max z-index of the query range, inclusive
      * @return (LITMAX, BIGMIN)
      */
-    [[nodiscard]] std::pair<uint64_t, uint64_t> zdiv(
-        LoadFunc&& load, uint32_t dims, uint64_t xd, uint64_t rmin, uint64_t rmax) const {
-        assert(rmin < rmax);
+    [[nodiscard]] static std::pair<uint64_t, uint64_t> zdiv(
+        LoadFunc&& load, uint32_t dims, uint64_t xd, uint64_t rmin, uint64_t rmax) {
+        assert(rmin <= rmax);
 
         uint64_t zmin = rmin;
         uint64_t zmax = rmax;
         uint64_t bigmin = 0;
         uint64_t litmax = 0;
 
-        auto bit = [](uint64_t x, uint32_t idx) -> uint64_t {
-            return (x & (1UL << idx)) >> idx;
+        auto bit = [](uint64_t x, int idx) -> uint64_t {
+            return (x >> idx) & 1;
         };
 
         auto over = [](uint64_t bits) -> uint64_t {
@@ -147,7 +219,7 @@ protected:
 
 #define ZN_MATCH_ALL(__x, __y, __z) if ((a == (__x)) && (b == (__y)) && (c == (__z)))
 
-        for (int i = 64; i > 0; --i) {
+        for (int i = 63; i >= 0; --i) {
             uint32_t bits = i / dims + 1;
             uint32_t dim = i % dims;
 
@@ -192,30 +264,50 @@ protected:
     }
 
     /**
-     * @brief Calculates the longest common binary prefix between two z longs
+     * @brief Load bits of a single dimension into the z-index, used by zdiv
+     *
+     * @param target z-index
+     * @param p the value to load, only the lowest bits are considered
+     * @param bits number of bits to replace
+     * @param dim dimension
+     * @return
+     */
+    [[nodiscard]] uint64_t load(uint64_t target, uint64_t p, uint32_t bits, uint32_t dim) const {
+        uint64_t mask = ~(split(MAX_MASK >> (BITS_PER_DIM - bits)) << dim);
+        return (target & mask) | (split(p) << dim);
+    }
+
+    /**
+     * @brief Calculates the longest common binary prefix between z values, the prefix is
+     * aligned to DIMS bits
      *
-     * @param a
-     * @param b
+     * @param values
      * @return (common prefix, number of bits in common)
      */
-    ZPrefix max_common_prefix(uint64_t a, uint64_t b) {
-        int32_t shift = TOTAL_BITS - DIMS;
-        uint64_t head = a >> shift;
-        while ((b >> shift) == head && shift > -1) {
-            shift -= DIMS;
-            head = a >> shift;
+    [[nodiscard]] static ZPrefix max_common_prefix(const std::vector<uint64_t>& values) {
+        // bits at and above shift are common
+        int32_t shift = TOTAL_BITS;
+        while (shift >= DIMS) {
+            int32_t next = shift - DIMS;
+            uint64_t head = values[0] >> next;
+            bool same = std::all_of(values.begin(), values.end(), [next, head](uint64_t v) {
+                return (v >> next) == head;
+            });
+            if (!same) {
+                break;
+            }
+            shift = next;
         }
-        shift += DIMS;
-        return {.prefix = a & (UINT64_MAX << shift), .precision = 64 - shift};
+        uint64_t mask = shift >= 64 ? 0 : UINT64_MAX << shift;
+        return {.prefix = values[0] & mask, .precision = 64 - shift};
     }
 
 protected:
-    static constexpr int32_t DEFAULT_RECURSE = 7;
     static constexpr int32_t DIMS = Dims;
     static constexpr int32_t BITS_PER_DIM = BitsPerDim;
     static constexpr int32_t TOTAL_BITS = TotalBits;
     static constexpr uint64_t MAX_MASK = MaxMask;
-    static constexpr double QUADRANTS = std::pow(2, Dims);
+    static constexpr uint64_t QUADRANTS = uint64_t{1} << Dims;
 };
 
 } // namespace pl::curve
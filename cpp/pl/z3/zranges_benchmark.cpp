@@ -0,0 +1,63 @@
+// Copyright (c) 2024 The Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Authors: liubang (it.liubang@gmail.com)
+
+#include "cpp/pl/z3/z3sfc.h"
+
+#include <benchmark/benchmark.h>
+
+namespace {
+
+using pl::curve::Box;
+using pl::curve::IndexRange;
+using pl::curve::TimePeriod;
+using pl::curve::TimeRange;
+using pl::curve::Z3;
+using pl::curve::Z3SFC;
+
+/**
+ * 一个城市范围(0.3° x 0.3°)一小时内的查询，统计不同max_ranges和max_recurse下生成的区间数，
+ * 以及区间覆盖的z3单元中不在查询范围内的比例(误判率)
+ */
+void BM_Z3Ranges(benchmark::State& state) {
+    auto max_ranges = static_cast<int32_t>(state.range(0));
+    auto max_recurse = static_cast<int32_t>(state.range(1));
+    Z3SFC<TimePeriod::Week> sfc;
+    std::vector<Box> boxes = {{116.2, 39.8, 116.5, 40.1}};
+    std::vector<TimeRange> times = {{36000, 39600}};
+
+    std::vector<IndexRange> ranges;
+    for (auto _ : state) {
+        ranges.clear();
+        sfc.ranges(boxes, times, 64, max_ranges, &ranges, max_recurse);
+        benchmark::DoNotOptimize(ranges.data());
+    }
+
+    auto [xmin, ymin, tmin] = Z3(sfc.index(boxes[0].xmin, boxes[0].ymin, times[0].tmin)).decode();
+    auto [xmax, ymax, tmax] = Z3(sfc.index(boxes[0].xmax, boxes[0].ymax, times[0].tmax)).decode();
+    auto exact = static_cast<long double>(xmax - xmin + 1) * (ymax - ymin + 1) * (tmax - tmin + 1);
+    long double covered = 0;
+    for (const auto& r : ranges) {
+        covered += static_cast<long double>(r.upper - r.lower) + 1;
+    }
+    state.counters["ranges"] = static_cast<double>(ranges.size());
+    state.counters["fp_rate"] = static_cast<double>(1 - exact / covered);
+}
+BENCHMARK(BM_Z3Ranges)
+    ->ArgNames({"max_ranges", "max_recurse"})
+    ->ArgsProduct({{10, 100, 1000, 10000}, {7, 32}})
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace